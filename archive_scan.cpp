@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "archive_reader.h"
+
+void printUsage(const char* programName) {
+    std::cout << "Использование: " << programName
+              << " <archive_file> [--from <мс>] [--to <мс>] [--bbox <минШир,минДолг,максШир,максДолг>] [--valid] [--stats]" << std::endl;
+    std::cout << "Пример: " << programName << " track.gca --from 36000000 --to 39600000 --stats" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    ArchiveReader::Predicate predicate;
+    bool statsOnly = false;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--from" && i + 1 < argc) {
+            predicate.fromTimestamp = std::strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "--to" && i + 1 < argc) {
+            predicate.toTimestamp = std::strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "--bbox" && i + 1 < argc) {
+            double box[4];
+            char* pos = argv[++i];
+            for (int k = 0; k < 4; k++) {
+                box[k] = std::strtod(pos, &pos);
+                if (*pos == ',') pos++;
+            }
+            predicate.setBox(box[0], box[1], box[2], box[3]);
+        } else if (arg == "--valid") {
+            predicate.validOnly = true;
+        } else if (arg == "--stats") {
+            statsOnly = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    ArchiveReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << "Ошибка открытия архива: " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    // Вывод в CSV в единицах GpsPoint; при --stats колонки не читаются
+    unsigned columns = statsOnly ? 0 : archive_format::ALL_COLUMNS;
+    if (!statsOnly) {
+        std::cout << "timestamp,latitude,longitude,altitude,speed,course,hdop,satellites,valid\n";
+    }
+    auto stats = reader.scan(predicate, columns, [&](const ArchiveReader::Batch& batch) {
+        if (statsOnly) return;
+        for (size_t i = 0; i < batch.count; i++) {
+            char line[256];
+            std::snprintf(line, sizeof(line), "%lld,%.7f,%.7f,%.2f,%.2f,%.2f,%.2f,%lld,%lld\n",
+                static_cast<long long>(batch.columns[archive_format::TIMESTAMP][i]),
+                batch.columns[archive_format::LATITUDE][i] / 1e7,
+                batch.columns[archive_format::LONGITUDE][i] / 1e7,
+                batch.columns[archive_format::ALTITUDE][i] / 100.0,
+                batch.columns[archive_format::SPEED][i] / 100.0,
+                batch.columns[archive_format::COURSE][i] / 100.0,
+                batch.columns[archive_format::HDOP][i] / 100.0,
+                static_cast<long long>(batch.columns[archive_format::SATELLITES][i]),
+                static_cast<long long>(batch.columns[archive_format::VALID][i]));
+            std::cout << line;
+        }
+    });
+    
+    std::cerr << "Группы: " << stats.groupsTotal << ", пропущено по статистике: " << stats.groupsSkipped
+              << ", строк прочитано: " << stats.rowsScanned << ", подошло: " << stats.rowsMatched << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "archive_format.h"
+#include "display_interface.h"
+#include "file_sink.h"
+#include "gps_point.h"
+#include "gps_time.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Вывод точек в колоночный архив (archive_format). Точки копятся в памяти
+// и записываются группой по rowGroupSize строк одним вызовом FileSink;
+// неполная группа записывается при flush() и в деструкторе. Отсутствие
+// фикса пишется строкой с VALID = 0; сообщения и события в архив не попадают.
+// Существующий архив дописывается; оборванная последняя группа отбрасывается.
+// Время строк неубывающее (gps_time::TrackClock): от эпохи, если дата
+// известна, иначе от полуночи первых суток с учетом перехода через полночь,
+// поэтому диапазоны времени групп верны и для многосуточных записей.
+class ArchiveDisplay : public IDisplay {
+public:
+    explicit ArchiveDisplay(const std::string& filename,
+                            std::uint32_t rowGroupSize = archive_format::DEFAULT_ROW_GROUP,
+                            bool rotate = false, size_t maxSize = 64 * 1024 * 1024,
+                            bool async = false, unsigned flushIntervalMs = 100,
+                            size_t flushBytes = 64 * 1024);
+    ~ArchiveDisplay() override;
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showParseError(const std::string& error) override;
+    void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    std::uint32_t getRowGroupSize() const;
+    // Записанные группы и строки (без ожидающих в памяти)
+    size_t getRowGroupCount() const;
+    size_t getRowCount() const;
+    const FileSink& getSink() const;
+    
+private:
+    // Возвращает наибольшее время записанных групп, -1 - групп нет
+    static std::int64_t dropIncompleteGroup(const std::string& filename);
+    void addRow(const PackedGpsPoint& row);
+    void writeGroup();
+    
+    std::unique_ptr<FileSink> sink_;
+    std::uint32_t rowGroupSize_;
+    std::vector<PackedGpsPoint> rows_;
+    gps_time::TrackClock clock_;
+    std::vector<std::int64_t> column_;   // переиспользуемые буферы кодирования
+    std::vector<std::uint8_t> group_;
+    size_t groupCount_ = 0;
+    size_t rowCount_ = 0;
+};
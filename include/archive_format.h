@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+// Колоночный архив точек (.gca): заголовок файла, затем группы строк.
+// Группа - заголовок со статистикой (zone map: диапазон времени,
+// прямоугольник и диапазон скорости по валидным точкам) и колонки,
+// каждая закодирована отдельно (column_codec). Читатель пропускает группы,
+// не подходящие под условие, по одному заголовку, не трогая колонки.
+// Значения колонок - в фиксированной точке PackedGpsPoint.
+// Группы самодостаточны: файл можно дописывать и ротировать.
+// Время неубывающее: мс от эпохи, если дата известна из RMC, иначе от
+// полуночи первых суток записи (следующие сутки - больше 86400000).
+namespace archive_format {
+    constexpr std::uint16_t VERSION = 1;
+    constexpr std::uint32_t DEFAULT_ROW_GROUP = 4096;
+    
+    constexpr char FILE_MAGIC[8] = {'G', 'P', 'S', 'A', 'R', 'C', 'H', '1'};
+    constexpr char GROUP_MAGIC[8] = {'G', 'P', 'S', 'G', 'R', 'O', 'U', 'P'};
+    
+    // Колонки в порядке хранения в группе
+    enum Column : unsigned {
+        TIMESTAMP,    // мс, неубывающее (см. выше)
+        LATITUDE,     // 1e-7 градуса
+        LONGITUDE,    // 1e-7 градуса
+        ALTITUDE,     // см
+        SPEED,        // 0.01 км/ч
+        COURSE,       // 0.01 градуса
+        HDOP,         // 0.01
+        SATELLITES,
+        VALID,        // 1 - валидная точка, 0 - нет фикса
+        COLUMN_COUNT
+    };
+    
+    constexpr unsigned columnBit(Column column) { return 1u << column; }
+    constexpr unsigned ALL_COLUMNS = (1u << COLUMN_COUNT) - 1;
+    
+    struct FileHeader {
+        char magic[8];
+        std::uint16_t version = VERSION;
+        std::uint16_t columnCount = COLUMN_COUNT;
+        std::uint32_t rowGroupSize = DEFAULT_ROW_GROUP;   // строк в полной группе
+        std::uint8_t reserved[16] = {};
+        
+        FileHeader() { std::memcpy(magic, FILE_MAGIC, sizeof(magic)); }
+        bool isValid() const {
+            return std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0 && version == VERSION &&
+                   columnCount == COLUMN_COUNT;
+        }
+    };
+    
+    struct RowGroupHeader {
+        char magic[8];
+        std::uint32_t rowCount = 0;
+        std::uint32_t validCount = 0;
+        std::uint32_t dataSize = 0;                    // байт колонок после заголовка
+        std::uint32_t columnSize[COLUMN_COUNT] = {};   // байт каждой колонки
+        // Статистика: время - по всем строкам, остальное - по валидным точкам
+        std::int64_t minTimestamp = 0;
+        std::int64_t maxTimestamp = 0;
+        std::int32_t minLatitudeE7 = 0;
+        std::int32_t maxLatitudeE7 = 0;
+        std::int32_t minLongitudeE7 = 0;
+        std::int32_t maxLongitudeE7 = 0;
+        std::uint16_t minSpeed = 0;
+        std::uint16_t maxSpeed = 0;
+        std::uint32_t reserved = 0;
+        
+        RowGroupHeader() { std::memcpy(magic, GROUP_MAGIC, sizeof(magic)); }
+        bool isValid() const {
+            return std::memcmp(magic, GROUP_MAGIC, sizeof(magic)) == 0 && rowCount > 0;
+        }
+    };
+    
+    static_assert(sizeof(FileHeader) == 32, "FileHeader layout");
+    static_assert(sizeof(RowGroupHeader) == 96, "RowGroupHeader layout");
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "archive_format.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Чтение колоночного архива (archive_format, ArchiveDisplay).
+// Файл отображается в память. scan() проходит группы по заголовкам,
+// пропускает не подходящие под условие по статистике и раскодирует только
+// запрошенные колонки (и нужные для условия) остальных.
+class ArchiveReader {
+public:
+    // Условие отбора строк; по умолчанию подходят все
+    struct Predicate {
+        std::int64_t fromTimestamp = std::numeric_limits<std::int64_t>::min();
+        std::int64_t toTimestamp = std::numeric_limits<std::int64_t>::max();   // включительно
+        // Прямоугольник в градусах; строки вне него и строки без фикса отбрасываются
+        bool hasBox = false;
+        double minLatitude = 0.0;
+        double minLongitude = 0.0;
+        double maxLatitude = 0.0;
+        double maxLongitude = 0.0;
+        bool validOnly = false;
+        
+        void setTimeRange(std::int64_t from, std::int64_t to);
+        void setBox(double minLat, double minLon, double maxLat, double maxLon);
+    };
+    
+    // Подходящие строки одной группы; заполнены только запрошенные колонки.
+    // Значения - в единицах archive_format::Column.
+    struct Batch {
+        size_t group = 0;
+        size_t count = 0;
+        std::vector<std::int64_t> columns[archive_format::COLUMN_COUNT];
+        
+        const std::int64_t* column(archive_format::Column c) const { return columns[c].data(); }
+    };
+    
+    struct ScanStats {
+        size_t groupsTotal = 0;
+        size_t groupsSkipped = 0;   // отброшены по статистике без чтения колонок
+        size_t rowsScanned = 0;     // строк в прочитанных группах
+        size_t rowsMatched = 0;
+    };
+    
+    ArchiveReader();
+    explicit ArchiveReader(const std::string& filename);
+    ~ArchiveReader();
+    
+    ArchiveReader(const ArchiveReader&) = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+    
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+    
+    size_t getRowGroupCount() const;
+    size_t getRowCount() const;
+    const archive_format::RowGroupHeader& getRowGroup(size_t group) const;
+    
+    // Раскодировать одну колонку группы целиком; false при испорченных данных
+    bool readColumn(size_t group, archive_format::Column column, std::vector<std::int64_t>& out) const;
+    
+    // Передать visitor подходящие строки каждой группы (группы без
+    // подходящих строк не передаются). columns - маска columnBit().
+    ScanStats scan(const Predicate& predicate, unsigned columns,
+                   const std::function<void(const Batch&)>& visitor) const;
+    
+    // Может ли группа содержать подходящие строки (по статистике)
+    static bool mayMatch(const archive_format::RowGroupHeader& group, const Predicate& predicate);
+    
+private:
+    void* mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    std::vector<const archive_format::RowGroupHeader*> groups_;
+    size_t rowCount_ = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "display_interface.h"
+#include "file_sink.h"
+#include "gps_time.h"
+#include "track_format.h"
+#include <memory>
+#include <string>
+
+// Вывод трека в двоичном формате track_format: 32 байта на точку вместо
+// ~200 байт текста, чтение без разбора (см. TrackReader). Пишутся точки и
+// отметки об отсутствии фикса (точка без флага валидности); текстовые
+// сообщения и события в трек не попадают.
+// Существующий файл того же формата дописывается, неполная последняя
+// запись после аварийного завершения отбрасывается. Ротации нет: каждый
+// файл трека должен начинаться с заголовка.
+// Время записей неубывающее (gps_time::TrackClock), в том числе через
+// полночь и после дописывания, - на этом основан поиск TrackReader::lowerBound.
+class BinaryTrackDisplay : public IDisplay {
+public:
+    explicit BinaryTrackDisplay(const std::string& filename,
+                                std::uint32_t blockRecords = track_format::DEFAULT_BLOCK_RECORDS,
+                                bool async = false, unsigned flushIntervalMs = 100,
+                                size_t flushBytes = 64 * 1024);
+    ~BinaryTrackDisplay() override;
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showParseError(const std::string& error) override;
+    void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    // Количество точек в файле, включая дописанные к существующему
+    size_t getRecordCount() const;
+    // Точек в блоке; для дописываемого файла берется из его заголовка
+    std::uint32_t getBlockRecords() const;
+    const FileSink& getSink() const;
+    
+private:
+    size_t resume(const std::string& filename);
+    void writeHeader();
+    void writeRecord(const PackedGpsPoint& record);
+    
+    std::unique_ptr<FileSink> sink_;
+    std::uint32_t blockRecords_;
+    size_t recordCount_ = 0;
+    gps_time::TrackClock clock_;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Кодирование колонки целых чисел для колоночного архива.
+// Значения (или их разности с предыдущим - для гладких колонок: время,
+// координаты) сдвигаются на минимум (frame of reference) и упаковываются
+// по битам одинаковой ширины. Вариант с разностями или без выбирается по
+// меньшей ширине для каждого куска отдельно. Константная колонка и время
+// с постоянным шагом занимают несколько байт на весь кусок.
+// Формат куска: режим (1 байт), ширина в битах (1 байт), [первое значение
+// varint zigzag - только для разностей], минимум varint zigzag, биты.
+namespace column_codec {
+    // Дописать закодированные значения в out
+    void encode(const std::int64_t* values, size_t count, std::vector<std::uint8_t>& out);
+    
+    // Раскодировать count значений; false, если кусок испорчен или обрезан
+    bool decode(const std::uint8_t* data, size_t size, size_t count, std::int64_t* out);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <mutex>
+#include <vector>
+#include "gps_point.h"
+
+// Статистика скорости по окну истории
+struct SpeedStats {
+    size_t count = 0;       // количество валидных точек в окне
+    double mean = 0.0;      // км/ч
+    double variance = 0.0;  // (км/ч)^2, дисперсия генеральной совокупности
+};
+
+// Ограничивающий прямоугольник по окну истории
+struct BoundingBox {
+    double minLatitude = 0.0;
+    double minLongitude = 0.0;
+    double maxLatitude = 0.0;
+    double maxLongitude = 0.0;
+    bool empty = true;
+};
+
+// История точек в колоночном виде (structure-of-arrays).
+// Каждое поле хранится в отдельном непрерывном массиве, поэтому оконная
+// аналитика читает только нужные колонки. Буферы "зеркальные": каждая
+// точка пишется по индексам i и i + capacity, так что любое окно последних
+// точек лежит в памяти одним непрерывным куском без разрыва кольца.
+// Конвейер его не использует (фильтры получают GpsHistory): это отдельный
+// класс для аналитики, который заполняет вызывающий код.
+class ColumnarHistory {
+public:
+    explicit ColumnarHistory(size_t maxSize = 10);
+    ~ColumnarHistory();
+
+    // Добавить точку в историю
+    void addPoint(const GpsPoint& point);
+
+    // Получить последнюю валидную точку
+    std::optional<GpsPoint> getLastValid() const;
+
+    // Получить точку по индексу (0 - самая старая)
+    GpsPoint getPoint(size_t index) const;
+
+    // Очистить историю
+    void clear();
+
+    // Получить размер истории
+    size_t size() const;
+
+    // Проверить, пуста ли история
+    bool empty() const;
+
+    // Установить / получить максимальный размер истории
+    void setMaxSize(size_t maxSize);
+    size_t getMaxSize() const;
+
+    // Непрерывные колонки, начиная с самой старой точки (size() элементов).
+    // Начало колонки берется под блокировкой, но сами значения - нет:
+    // указатели действительны до следующего изменения истории, и если
+    // addPoint() вызывается из другого потока, чтение колонок нужно
+    // синхронизировать снаружи. Оконная аналитика ниже и getPoint()
+    // блокируют историю сами.
+    const double* latitudes() const;
+    const double* longitudes() const;
+    const double* speeds() const;
+    const double* courses() const;
+    const double* altitudes() const;
+    const int* satellites() const;
+    const float* hdops() const;
+    const unsigned long long* timestamps() const;
+    const std::uint8_t* validFlags() const;
+
+    // Оконная аналитика по последним window точкам (window == 0 - вся история).
+    // Учитываются только валидные точки.
+    SpeedStats speedStats(size_t window = 0) const;
+    // Длина пути в метрах: гаверсинус между соседними валидными точками
+    // окна (невалидные пропускаются), как distance в GpsHistory::getStats
+    double pathLength(size_t window = 0) const;
+    BoundingBox boundingBox(size_t window = 0) const;
+
+private:
+    void reallocate(size_t capacity);
+    void append(const GpsPoint& point);
+    void store(size_t slot, const GpsPoint& point, double segment);
+    GpsPoint load(size_t slot) const;
+    size_t windowStart(size_t window, size_t& count) const;
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+    // Указатель на самую старую точку колонки под блокировкой
+    template <typename T>
+    const T* column(const std::vector<T>& values) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return values.data() + head_;
+    }
+
+    size_t maxSize_;
+    size_t head_ = 0;   // слот самой старой точки, [0, maxSize_)
+    size_t count_ = 0;
+    // Слот последней валидной точки, обновляется при добавлении
+    size_t lastValid_ = NO_SLOT;
+
+    std::vector<double> latitude_;
+    std::vector<double> longitude_;
+    std::vector<double> speed_;
+    std::vector<double> course_;
+    std::vector<double> altitude_;
+    std::vector<int> satellites_;
+    std::vector<float> hdop_;
+    std::vector<unsigned long long> timestamp_;
+    std::vector<std::uint8_t> valid_;
+    // Производные колонки для аналитики без ветвлений
+    std::vector<double> weight_;   // 1.0 для валидной точки, 0.0 иначе
+    std::vector<double> segment_;  // м от предыдущей валидной точки, 0.0 для невалидной
+
+    mutable std::mutex mutex_;
+};
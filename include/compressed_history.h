@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <mutex>
+#include <vector>
+#include "gps_point.h"
+
+// Сжатая история трека для длинных окон (часы при 1 Гц).
+// Точки группируются в блоки фиксированного размера. Заполненный блок
+// кодируется дельтами в фиксированной точке (координаты 1e-7 градуса,
+// скорость 0.01 км/ч, курс 0.01°, высота 1 см, HDOP 0.01) с zigzag-varint
+// (для времени и координат - разности дельт) и распаковывается только при
+// чтении. Последний, незаполненный блок
+// хранится как есть, поэтому свежие точки читаются без декодирования и
+// без потери точности. Для старых точек хранение - с потерями в пределах
+// указанного шага квантования.
+// Конвейер его не использует (фильтры получают GpsHistory): историю
+// заполняет вызывающий код, например для хранения трека за несколько часов.
+class CompressedHistory {
+public:
+    explicit CompressedHistory(size_t maxSize = 3600, size_t blockSize = 64);
+    ~CompressedHistory();
+    
+    // Добавить точку в историю
+    void addPoint(const GpsPoint& point);
+    
+    // Получить последнюю валидную точку
+    std::optional<GpsPoint> getLastValid() const;
+    
+    // Получить точку по индексу (0 - самая старая)
+    GpsPoint getPoint(size_t index) const;
+    
+    // Обойти все точки от старых к новым, распаковывая по одному блоку
+    void forEach(const std::function<void(const GpsPoint&)>& visitor) const;
+    
+    // Очистить историю
+    void clear();
+    
+    // Получить размер истории
+    size_t size() const;
+    
+    // Проверить, пуста ли история
+    bool empty() const;
+    
+    // Установить / получить максимальный размер истории
+    void setMaxSize(size_t maxSize);
+    size_t getMaxSize() const;
+    
+    size_t getBlockSize() const;
+    
+    // Оценка занимаемой памяти в байтах (данные блоков и хвост)
+    size_t memoryUsage() const;
+    
+private:
+    struct Block {
+        std::vector<std::uint8_t> data;
+        size_t count = 0;
+    };
+    
+    void sealTail();
+    void trim();
+    const std::vector<GpsPoint>& decoded(size_t blockIndex) const;
+    GpsPoint pointAt(size_t index) const;
+    size_t sizeLocked() const;
+    
+    static Block encodeBlock(const std::vector<GpsPoint>& points);
+    static void decodeBlock(const Block& block, std::vector<GpsPoint>& out);
+    
+    size_t maxSize_;
+    size_t blockSize_;
+    std::deque<Block> blocks_;
+    size_t frontOffset_ = 0;          // уже вытесненные точки первого блока
+    std::vector<GpsPoint> tail_;      // несжатый последний блок
+    
+    // Кеш последнего распакованного блока (номер считается от начала потока)
+    mutable size_t cachedBlock_ = SIZE_MAX;
+    mutable std::vector<GpsPoint> cache_;
+    size_t droppedBlocks_ = 0;        // сколько блоков вытеснено с начала
+    
+    mutable std::mutex mutex_;
+};
@@ -2,8 +2,7 @@
 
 #include "display_interface.h"
 #include <iostream>
-#include <iomanip>
-#include <sstream>
+#include <vector>
 
 class ConsoleDisplay : public IDisplay {
 public:
@@ -13,12 +12,10 @@ public:
     void showInvalidFix(unsigned long long timestamp) override;
     void showParseError(const std::string& error) override;
     void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
     void clear() override;
     
 private:
-    std::string formatTime(unsigned long long timestampMs) const;
-    std::string formatLatitude(double lat) const;
-    std::string formatLongitude(double lon) const;
-    
     std::ostream& out_;
-};
\ No newline at end of file
+    std::vector<char> buffer_;   // буфер записи, см. record_format
+};
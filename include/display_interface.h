@@ -2,6 +2,7 @@
 
 #include <string>
 #include "gps_point.h"
+#include "gps_event.h"
 
 class IDisplay {
 public:
@@ -11,5 +12,8 @@ public:
     virtual void showInvalidFix(unsigned long long timestamp) = 0;
     virtual void showParseError(const std::string& error) = 0;
     virtual void showRejected(const std::string& reason) = 0;
+    virtual void showEvent(const GpsEvent& event) = 0;
     virtual void clear() = 0;
+    // Вывести все, что задержано в буферах (вызывается в конце обработки)
+    virtual void flush() {}
 };
\ No newline at end of file
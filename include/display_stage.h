@@ -0,0 +1,25 @@
+#pragma once
+
+#include <memory>
+#include "display_interface.h"
+
+// Промежуточная стадия вывода: получает вызовы дисплея, может их
+// преобразовать и передает следующему дисплею в цепочке.
+// По умолчанию все вызовы передаются без изменений.
+class DisplayStage : public IDisplay {
+public:
+    explicit DisplayStage(std::unique_ptr<IDisplay> next);
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showParseError(const std::string& error) override;
+    void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    IDisplay* getNext() const;
+    
+protected:
+    std::unique_ptr<IDisplay> next_;
+};
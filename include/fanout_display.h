@@ -0,0 +1,111 @@
+#pragma once
+
+#include "display_interface.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Размножение потока вывода на несколько дисплеев.
+// У каждого дочернего дисплея своя ограниченная очередь и свой поток, поэтому
+// медленный дисплей не задерживает ни пайплайн, ни остальные дисплеи: при
+// переполнении очереди новая запись для него отбрасывается и учитывается в
+// getDroppedCount(). Маска записей задает, что получает дисплей (например,
+// только точки). clear() и flush() не отбрасываются; flush() ждет, пока все
+// дочерние дисплеи обработают очереди и выполнят свой flush().
+class FanoutDisplay : public IDisplay {
+public:
+    // Виды записей для маски
+    enum Record : unsigned {
+        POINTS = 1u << 0,
+        INVALID_FIX = 1u << 1,
+        REJECTED = 1u << 2,
+        PARSE_ERRORS = 1u << 3,
+        EVENTS = 1u << 4,
+        ALL = POINTS | INVALID_FIX | REJECTED | PARSE_ERRORS | EVENTS
+    };
+    
+    static const size_t DEFAULT_QUEUE_SIZE = 1024;
+    
+    FanoutDisplay() = default;
+    ~FanoutDisplay() override;
+    
+    FanoutDisplay(const FanoutDisplay&) = delete;
+    FanoutDisplay& operator=(const FanoutDisplay&) = delete;
+    
+    // Разбор маски из списка через запятую: points, nofix, rejected, errors
+    // (ошибки разбора), events, all. false - неизвестное имя.
+    static bool parseMask(const std::string& names, unsigned& mask);
+    
+    // Добавить дочерний дисплей; вызывается до первой записи
+    void addSink(std::unique_ptr<IDisplay> display, unsigned mask = ALL,
+                 size_t queueSize = DEFAULT_QUEUE_SIZE);
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showParseError(const std::string& error) override;
+    void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    size_t getSinkCount() const;
+    // Дочерний дисплей; обращаться к нему безопасно только после flush()
+    IDisplay* getSink(size_t index) const;
+    unsigned getMask(size_t index) const;
+    // Статистика по дочернему дисплею: отброшено при переполнении и передано
+    size_t getDroppedCount(size_t index) const;
+    size_t getDeliveredCount(size_t index) const;
+    
+private:
+    struct Message {
+        enum class Type {
+            POINT,
+            INVALID_FIX,
+            PARSE_ERROR,
+            REJECTED,
+            EVENT,
+            CLEAR,
+            FLUSH
+        };
+        
+        Type type = Type::POINT;
+        GpsPoint point;
+        unsigned long long timestamp = 0;
+        std::string text;
+        GpsEvent event;
+    };
+    
+    struct Sink {
+        std::unique_ptr<IDisplay> display;
+        unsigned mask = ALL;
+        size_t capacity = DEFAULT_QUEUE_SIZE;
+        
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable flushed;
+        std::vector<Message> queue;   // заполняется пайплайном
+        size_t taken = 0;             // забрано потоком и еще не обработано
+        unsigned long long flushRequested = 0;
+        unsigned long long flushDone = 0;
+        bool stop = false;
+        std::thread thread;
+        
+        std::atomic<size_t> dropped{0};
+        std::atomic<size_t> delivered{0};
+    };
+    
+    // Поставить запись в очереди дисплеев с битом record в маске;
+    // fill заполняет запись только если она кому-то нужна
+    template <typename Fill>
+    void publish(unsigned record, Fill fill);
+    // Управляющая запись: не отбрасывается
+    void enqueueControl(Sink& sink, Message::Type type);
+    void run(Sink& sink);
+    static void deliver(IDisplay& display, const Message& message);
+    
+    std::vector<std::unique_ptr<Sink>> sinks_;
+};
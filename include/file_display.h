@@ -1,33 +1,65 @@
 #pragma once
 
 #include "display_interface.h"
-#include <fstream>
+#include "file_sink.h"
+#include "mmap_sink.h"
+#include "segment_compressor.h"
+#include "uring_sink.h"
+#include <memory>
 #include <string>
-#include <chrono>
-#include <iomanip>
+#include <vector>
 
+// Вывод в файл. Каждая запись форматируется целиком и передается FileSink;
+// при async запись в файл идет в фоновом потоке (см. FileSink).
 class FileDisplay : public IDisplay {
 public:
-    FileDisplay(const std::string& filename, bool rotate = false, size_t maxSize = 1024 * 1024);
+    FileDisplay(const std::string& filename, bool rotate = false, size_t maxSize = 1024 * 1024,
+                bool async = false, unsigned flushIntervalMs = 100, size_t flushBytes = 64 * 1024);
     ~FileDisplay() override;
     
     void showPoint(const GpsPoint& point) override;
     void showInvalidFix(unsigned long long timestamp) override;
     void showParseError(const std::string& error) override;
     void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
     void clear() override;
+    void flush() override;
+    
+    // Сжимать отложенные при ротации файлы в фоне (level 1-9; 0 - не сжимать)
+    // и хранить не больше retainFiles файлов / retainBytes байт (0 - без
+    // ограничения). Вызывается до первой записи.
+    void enableCompression(int level = 1, size_t retainFiles = 0, size_t retainBytes = 0);
+    
+    // Писать через io_uring вместо write(2). Вызывается до первой записи;
+    // false, если io_uring недоступен - тогда остается обычный FileSink.
+    bool enableUring(unsigned queueDepth = 8);
+    // Писать в отображенные в память сегменты по maxSize байт (см. MmapSink).
+    // Вызывается до первой записи; false, если файл не удалось отобразить.
+    bool enableMmap();
+    
+    // Действителен, только если io_uring и mmap не включены
+    const FileSink& getSink() const;
+    // nullptr, если io_uring не включен
+    const UringSink* getUringSink() const;
+    // nullptr, если mmap не включен
+    const MmapSink* getMmapSink() const;
+    // nullptr, если сжатие не включено
+    const SegmentCompressor* getCompressor() const;
     
 private:
-    void checkRotation();
-    std::string formatTime(unsigned long long timestampMs) const;
-    std::string formatLatitude(double lat) const;
-    std::string formatLongitude(double lon) const;
-    std::string getCurrentTimestamp();
-    void rotateFile();
+    bool isOpen() const;
+    void write(size_t length);
     
     std::string filename_;
-    std::ofstream file_;
     bool rotate_;
     size_t maxSize_;
-    size_t currentSize_;
-};
\ No newline at end of file
+    bool async_;
+    unsigned flushIntervalMs_;
+    size_t flushBytes_;
+    // Объявлен до sink_: последняя ротация при закрытии файла еще попадает в очередь
+    std::unique_ptr<SegmentCompressor> compressor_;
+    std::unique_ptr<FileSink> sink_;
+    std::unique_ptr<UringSink> uring_;   // если включен, sink_ пуст
+    std::unique_ptr<MmapSink> mmap_;     // если включен, sink_ пуст
+    std::vector<char> buffer_;   // буфер записи, см. record_format
+};
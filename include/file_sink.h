@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Запись в файл с ротацией по размеру.
+// В синхронном режиме каждая запись - один вызов write(2).
+// В асинхронном режиме записи копируются в буфер в памяти, а фоновый поток
+// меняет буферы местами и пишет накопленное крупными вызовами write(2):
+// раз в flushIntervalMs или как только набралось flushBytes байт.
+// Буфер не растет больше нескольких flushBytes: если файл не успевает
+// записываться, append() ждет фоновый поток (записи не теряются -
+// двоичные форматы не допускают пропусков), ожидания считает getBlockedCount().
+// Размер файла для ротации считается самостоятельно, без запросов к файлу.
+// Граница ротации всегда проходит между записями. Деструктор дописывает все.
+class FileSink {
+public:
+    FileSink(const std::string& filename, bool rotate = false, size_t maxSize = 1024 * 1024,
+             bool async = false, unsigned flushIntervalMs = 100, size_t flushBytes = 64 * 1024);
+    ~FileSink();
+    
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+    
+    bool isOpen() const;
+    bool isAsync() const;
+    
+    // Заголовок, с которого начинается каждый файл (например, строка имен
+    // колонок CSV): пишется в пустой файл при вызове, после ротации и после
+    // truncate(). Вызывается до первой записи.
+    void setHeader(const std::string& header);
+    
+    // Вызывается с именем отложенного файла после каждой ротации (в потоке,
+    // который пишет файл). Устанавливается до первой записи.
+    void setRotationCallback(std::function<void(const std::string&)> callback);
+    
+    // Добавить одну запись (вызывается из потока пайплайна)
+    void append(const char* data, size_t size);
+    void append(const std::string& record);
+    
+    // Дождаться записи в файл всего, что добавлено до вызова
+    void flush();
+    // Очистить текущий файл
+    void truncate();
+    
+    // Свободное имя для файла, отложенного при ротации: filename.<время>[.N]
+    static std::string rotatedName(const std::string& filename);
+    
+    // Статистика: число вызовов write(2) и записанных байт
+    size_t getWriteCount() const;
+    size_t getBytesWritten() const;
+    // Число вызовов append(), ждавших освобождения буфера (асинхронный режим)
+    size_t getBlockedCount() const;
+    
+private:
+    void openFile();
+    void rotateFile();
+    void writeAll(const char* data, size_t size);
+    void writeBuffer(const std::string& buffer, const std::vector<size_t>& rotations);
+    void run();
+    static std::string getCurrentTimestamp();
+    
+    std::string filename_;
+    bool rotate_;
+    size_t maxSize_;
+    bool async_;
+    unsigned flushIntervalMs_;
+    size_t flushBytes_;
+    std::string header_;
+    std::function<void(const std::string&)> onRotate_;
+    
+    bool open_ = false;         // файл открыт при создании; не меняется после конструктора
+    int fd_ = -1;               // при ротации меняется пишущим потоком
+    size_t fileSize_ = 0;       // фактический размер файла (пишущий поток)
+    
+    // Асинхронный режим
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable written_;
+    std::condition_variable space_;     // фоновый поток забрал буфер
+    std::string front_;                 // заполняется пайплайном
+    std::string back_;                  // пишется фоновым потоком
+    std::vector<size_t> frontRotations_;   // смещения в front_, перед которыми нужна ротация
+    std::vector<size_t> backRotations_;
+    size_t pendingSize_ = 0;            // размер текущего файла с учетом буфера
+    unsigned long long appendedBytes_ = 0;
+    unsigned long long writtenBytes_ = 0;
+    bool flushRequested_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+    
+    std::atomic<size_t> writeCount_{0};
+    std::atomic<size_t> bytesWritten_{0};
+    std::atomic<size_t> blockedCount_{0};
+};
@@ -4,10 +4,13 @@
 #include "gps_point.h"
 #include "history.h"
 
+class IDisplay;
+
 enum class FilterResult {
     PASS,      // точка валидна, передать дальше
     REJECT,    // точка невалидна, отбросить
-    STOP       // точка обработана, прекратить цепочку
+    STOP,      // точка обработана, прекратить цепочку
+    SUPPRESS   // точка поглощена фильтром: не выводится и не попадает в историю
 };
 
 class IGpsFilter {
@@ -18,6 +21,11 @@ public:
     virtual void setEnabled(bool enabled) = 0;
     virtual bool isEnabled() const = 0;
     virtual std::string getName() const = 0;
+    
+    // Дисплей для событий фильтра; фильтры без событий его игнорируют
+    virtual void setDisplay(IDisplay* /*display*/) {}
+    // Завершить накопленное состояние в конце потока (например, выдать события)
+    virtual void flush() {}
 };
 
 using FilterPtr = std::unique_ptr<IGpsFilter>;
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+// Общие внутренние помощники индексов (RoadIndex, RoadGraph, GeofenceIndex)
+namespace geo {
+    // Квадрат расстояния от точки до отрезка в плоскости
+    inline double segmentDistance2(double px, double py, double ax, double ay, double bx, double by) {
+        double dx = bx - ax;
+        double dy = by - ay;
+        double len2 = dx * dx + dy * dy;
+        double t = 0.0;
+        if (len2 > 0.0) {
+            t = ((px - ax) * dx + (py - ay) * dy) / len2;
+            t = std::max(0.0, std::min(1.0, t));
+        }
+        double ex = ax + t * dx - px;
+        double ey = ay + t * dy - py;
+        return ex * ex + ey * ey;
+    }
+    
+    // Число из поля текстового файла: вся строка, допускаются пробелы и
+    // табуляции после числа
+    inline bool parseNumber(const std::string& text, double& value) {
+        const char* begin = text.c_str();
+        char* end = nullptr;
+        value = std::strtod(begin, &end);
+        if (end == begin) return false;
+        while (*end == ' ' || *end == '\t') end++;
+        return *end == '\0';
+    }
+}
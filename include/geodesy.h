@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cmath>
+
+namespace geo {
+    constexpr double EARTH_RADIUS = 6371000.0;   // средний радиус Земли, метры
+    constexpr double DEG_TO_RAD = M_PI / 180.0;
+    
+    // Расстояние между двумя точками (градусы) по формуле гаверсинуса, метры
+    double haversineDistance(double lat1, double lon1, double lat2, double lon2);
+    
+    // Начальный азимут из первой точки на вторую, градусы [0, 360)
+    double initialBearing(double lat1, double lon1, double lat2, double lon2);
+    
+    // Опорная точка для сравнения расстояний с порогом.
+    // Тригонометрия опорной точки считается один раз в set(); для каждой
+    // новой точки сначала берется плоская (равнопромежуточная) оценка с
+    // гарантированной границей погрешности, и только если порог попадает
+    // в эту границу, вызывается точный haversineDistance.
+    class DistanceReference {
+    public:
+        void set(double lat, double lon);
+        bool isSet() const { return set_; }
+        bool matches(double lat, double lon) const {
+            return set_ && lat == latitude_ && lon == longitude_;
+        }
+        
+        // Результат совпадает с haversineDistance(опорная, точка) > thresholdMeters
+        bool exceeds(double lat, double lon, double thresholdMeters) const;
+        
+    private:
+        bool set_ = false;
+        double latitude_ = 0.0;
+        double longitude_ = 0.0;
+        double cosLat_ = 1.0;
+        double absSinLat_ = 0.0;
+    };
+}
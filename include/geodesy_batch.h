@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+
+// Пакетные геодезические расчеты над массивами координат (structure-of-arrays).
+// На x86-64 используются векторные ядра SSE2 или AVX2+FMA, выбранные во время
+// выполнения по возможностям процессора; на остальных платформах - скалярный
+// код на стандартной библиотеке.
+//
+// Векторные ядра вычисляют sin/cos и atan2 полиномиальными приближениями
+// (по мотивам Cephes) вместо libm. Погрешность относительно правильно
+// округленного результата:
+//   sin, cos  - не более 2 ULP при |x| <= 2^30 (редукция Коди-Уэйта на pi/4);
+//   atan2     - не более 2 ULP (включая округление частного y/x);
+//   расстояние и азимут - относительная погрешность порядка 1e-15, то есть
+//   разница со скалярным geo::haversineDistance не превышает нанометров.
+// Результат для элемента не зависит от его позиции в массиве: хвост массива
+// обрабатывается тем же векторным кодом через дополненный буфер.
+namespace geo {
+    enum class SimdLevel {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+    
+    // Лучший уровень, поддерживаемый процессором и сборкой
+    SimdLevel detectSimdLevel();
+    // Текущий уровень (по умолчанию - detectSimdLevel())
+    SimdLevel getSimdLevel();
+    // Принудительно выбрать уровень (для тестов и сравнительных замеров).
+    // Неподдерживаемый уровень понижается до лучшего доступного.
+    // Не потокобезопасно: вызывать до начала расчетов.
+    void setSimdLevel(SimdLevel level);
+    const char* simdLevelName(SimdLevel level);
+    
+    // out[i] = расстояние (метры) между (lat1[i], lon1[i]) и (lat2[i], lon2[i]), градусы
+    void haversineBatch(const double* lat1, const double* lon1,
+                        const double* lat2, const double* lon2,
+                        double* out, size_t n);
+    
+    // out[i] = начальный азимут (градусы, [0, 360)) из точки 1 на точку 2
+    void bearingBatch(const double* lat1, const double* lon1,
+                      const double* lat2, const double* lon2,
+                      double* out, size_t n);
+    
+    // out[i] = расстояние между точками i и i + 1; out должен вмещать n - 1 значений
+    void consecutiveDistances(const double* lat, const double* lon, double* out, size_t n);
+    
+    // Длина трека из n точек, метры
+    double trackLength(const double* lat, const double* lon, size_t n);
+    
+    // Векторные элементарные функции, на которых построены ядра
+    void sinCosBatch(const double* x, double* sinOut, double* cosOut, size_t n);
+    void atan2Batch(const double* y, const double* x, double* out, size_t n);
+}
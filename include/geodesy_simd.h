@@ -0,0 +1,311 @@
+#pragma once
+
+// Внутренний заголовок пакетной геодезии: обобщенные векторные ядра и
+// обертки над интринсиками. Подключается из geodesy_batch.cpp (SSE2) и
+// geodesy_avx2.cpp (собирается с -mavx2 -mfma). Заголовок намеренно не
+// использует стандартную библиотеку: inline-функции, собранные с AVX2,
+// не должны попасть в общий код, выполняемый на процессорах без AVX2.
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace geo {
+namespace simd {
+
+// Таблица пакетных функций одного уровня
+struct BatchKernels {
+    void (*haversine)(const double*, const double*, const double*, const double*, double*, size_t);
+    void (*bearing)(const double*, const double*, const double*, const double*, double*, size_t);
+    void (*sinCos)(const double*, double*, double*, size_t);
+    void (*atan2)(const double*, const double*, double*, size_t);
+};
+
+#if defined(GEO_HAVE_AVX2)
+// Определена в geodesy_avx2.cpp
+const BatchKernels& avx2Kernels();
+#endif
+
+#if defined(__SSE2__)
+struct Sse2Ops {
+    using reg = __m128d;
+    static constexpr size_t WIDTH = 2;
+    
+    static reg load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm_div_pd(a, b); }
+    static reg sqrt(reg a) { return _mm_sqrt_pd(a); }
+    // a * b + c (без FMA - два округления)
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static reg bitAnd(reg a, reg b) { return _mm_and_pd(a, b); }
+    static reg bitOr(reg a, reg b) { return _mm_or_pd(a, b); }
+    static reg bitXor(reg a, reg b) { return _mm_xor_pd(a, b); }
+    static reg lt(reg a, reg b) { return _mm_cmplt_pd(a, b); }
+    static reg gt(reg a, reg b) { return _mm_cmpgt_pd(a, b); }
+    static reg ge(reg a, reg b) { return _mm_cmpge_pd(a, b); }
+    static reg eq(reg a, reg b) { return _mm_cmpeq_pd(a, b); }
+    static reg select(reg mask, reg a, reg b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+    static reg floor(reg x) {
+        // Округление через "магическое" число 1.5 * 2^52 (|x| < 2^51)
+        const reg magic = _mm_set1_pd(6755399441055744.0);
+        reg r = _mm_sub_pd(_mm_add_pd(x, magic), magic);
+        return _mm_sub_pd(r, _mm_and_pd(_mm_cmpgt_pd(r, x), _mm_set1_pd(1.0)));
+    }
+};
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+struct Avx2Ops {
+    using reg = __m256d;
+    static constexpr size_t WIDTH = 4;
+    
+    static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+    static reg set1(double v) { return _mm256_set1_pd(v); }
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    static reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+    static reg sqrt(reg a) { return _mm256_sqrt_pd(a); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+    static reg bitAnd(reg a, reg b) { return _mm256_and_pd(a, b); }
+    static reg bitOr(reg a, reg b) { return _mm256_or_pd(a, b); }
+    static reg bitXor(reg a, reg b) { return _mm256_xor_pd(a, b); }
+    static reg lt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static reg gt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static reg ge(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static reg eq(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static reg select(reg mask, reg a, reg b) { return _mm256_blendv_pd(b, a, mask); }
+    static reg floor(reg x) { return _mm256_floor_pd(x); }
+};
+#endif
+
+// Обобщенные ядра над набором операций V
+template <class V>
+struct Kernels {
+    using reg = typename V::reg;
+    
+    static reg abs(reg x) { return V::bitXor(x, V::bitAnd(x, V::set1(-0.0))); }
+    static reg signOf(reg x) { return V::bitAnd(x, V::set1(-0.0)); }
+    
+    // sin и cos одновременно: редукция на pi/4 по Коди-Уэйту и полиномы Cephes
+    static void sinCos(reg x, reg& s, reg& c) {
+        const reg sign = signOf(x);
+        x = abs(x);
+        
+        reg y = V::floor(V::mul(x, V::set1(1.27323954473516268615)));  // 4/pi
+        // Нечетный октант переносим в следующий: j всегда четно
+        const reg odd = V::sub(y, V::mul(V::set1(2.0), V::floor(V::mul(y, V::set1(0.5)))));
+        y = V::add(y, odd);
+        const reg j = V::sub(y, V::mul(V::set1(8.0), V::floor(V::mul(y, V::set1(0.125)))));
+        
+        reg z = V::fmadd(y, V::set1(-7.85398125648498535156E-1), x);
+        z = V::fmadd(y, V::set1(-3.77489470793079817668E-8), z);
+        z = V::fmadd(y, V::set1(-2.69515142907905952645E-15), z);
+        const reg zz = V::mul(z, z);
+        
+        reg ps = V::set1(1.58962301576546568060E-10);
+        ps = V::fmadd(ps, zz, V::set1(-2.50507477628578072866E-8));
+        ps = V::fmadd(ps, zz, V::set1(2.75573136213857245213E-6));
+        ps = V::fmadd(ps, zz, V::set1(-1.98412698295895385996E-4));
+        ps = V::fmadd(ps, zz, V::set1(8.33333333332211858878E-3));
+        ps = V::fmadd(ps, zz, V::set1(-1.66666666666666307295E-1));
+        ps = V::fmadd(V::mul(z, zz), ps, z);
+        
+        reg pc = V::set1(-1.13585365213876817300E-11);
+        pc = V::fmadd(pc, zz, V::set1(2.08757008419747316778E-9));
+        pc = V::fmadd(pc, zz, V::set1(-2.75573141792967388112E-7));
+        pc = V::fmadd(pc, zz, V::set1(2.48015872888517045348E-5));
+        pc = V::fmadd(pc, zz, V::set1(-1.38888888888730564116E-3));
+        pc = V::fmadd(pc, zz, V::set1(4.16666666666665929218E-2));
+        pc = V::fmadd(V::mul(zz, zz), pc, V::fmadd(V::set1(-0.5), zz, V::set1(1.0)));
+        
+        // j = 2, 6: sin и cos меняются местами
+        const reg swap = V::bitOr(V::eq(j, V::set1(2.0)), V::eq(j, V::set1(6.0)));
+        const reg sinPoly = V::select(swap, pc, ps);
+        const reg cosPoly = V::select(swap, ps, pc);
+        
+        // sin отрицателен в октантах 4 и 6, cos - в 2 и 4
+        const reg sinNeg = V::ge(j, V::set1(4.0));
+        const reg cosNeg = V::bitAnd(V::ge(j, V::set1(2.0)), V::lt(j, V::set1(5.0)));
+        s = V::bitXor(V::bitXor(sinPoly, V::bitAnd(sinNeg, V::set1(-0.0))), sign);
+        c = V::bitXor(cosPoly, V::bitAnd(cosNeg, V::set1(-0.0)));
+    }
+    
+    // atan по Cephes: редукция к |x| <= 0.66 и рациональное приближение
+    static reg atan(reg x) {
+        const reg sign = signOf(x);
+        x = abs(x);
+        
+        const reg big = V::gt(x, V::set1(2.41421356237309504880));   // tan(3pi/8)
+        const reg mid = V::gt(x, V::set1(0.66));
+        
+        const reg xBig = V::div(V::set1(-1.0), x);
+        const reg xMid = V::div(V::sub(x, V::set1(1.0)), V::add(x, V::set1(1.0)));
+        const reg base = V::select(big, V::set1(1.57079632679489661923),
+                                   V::select(mid, V::set1(0.78539816339744830962), V::set1(0.0)));
+        const reg moreBits = V::select(big, V::set1(6.123233995736765886130E-17),
+                                       V::select(mid, V::set1(3.061616997868382943065E-17), V::set1(0.0)));
+        x = V::select(big, xBig, V::select(mid, xMid, x));
+        
+        const reg z = V::mul(x, x);
+        reg p = V::set1(-8.750608600031904122785E-1);
+        p = V::fmadd(p, z, V::set1(-1.615753718733365076637E1));
+        p = V::fmadd(p, z, V::set1(-7.500855792314704667340E1));
+        p = V::fmadd(p, z, V::set1(-1.228866684490136173410E2));
+        p = V::fmadd(p, z, V::set1(-6.485021904942025371773E1));
+        reg q = V::add(z, V::set1(2.485846490142306297962E1));
+        q = V::fmadd(q, z, V::set1(1.650270098316988542046E2));
+        q = V::fmadd(q, z, V::set1(4.328810604912902668951E2));
+        q = V::fmadd(q, z, V::set1(4.853903996359136964868E2));
+        q = V::fmadd(q, z, V::set1(1.945506571482613964425E2));
+        
+        reg r = V::fmadd(x, V::div(V::mul(z, p), q), x);
+        r = V::add(V::add(r, moreBits), base);
+        return V::bitXor(r, sign);
+    }
+    
+    static reg atan2(reg y, reg x) {
+        const reg zero = V::set1(0.0);
+        reg r = atan(V::div(y, x));
+        // Левая полуплоскость: +-pi в зависимости от знака y
+        const reg shift = V::bitXor(V::set1(3.14159265358979323846), signOf(y));
+        r = V::select(V::lt(x, zero), V::add(r, shift), r);
+        // x = -0 дал бы -pi/2 вместо +pi/2: на оси y результат определяется только знаком y
+        const reg halfPi = V::bitXor(V::set1(1.57079632679489661923), signOf(y));
+        r = V::select(V::eq(x, zero), halfPi, r);
+        // x = y = 0: 0/0 дает NaN, возвращаем +-0 (или +-pi при x = -0)
+        const reg bothZero = V::bitAnd(V::eq(x, zero), V::eq(y, zero));
+        // Знак нуля сравнением не различить: 1 / -0 = -inf
+        const reg negativeZero = V::lt(V::div(V::set1(1.0), x), zero);
+        const reg zeroResult = V::select(negativeZero, V::set1(3.14159265358979323846), zero);
+        return V::select(bothZero, V::bitXor(zeroResult, signOf(y)), r);
+    }
+    
+    static reg toRadians(reg deg) {
+        // Тот же порядок операций, что и в скалярном коде: deg * pi / 180
+        return V::div(V::mul(deg, V::set1(3.14159265358979323846)), V::set1(180.0));
+    }
+    
+    static reg haversine(reg lat1, reg lon1, reg lat2, reg lon2) {
+        const reg phi1 = toRadians(lat1);
+        const reg phi2 = toRadians(lat2);
+        const reg dlat = V::sub(phi2, phi1);
+        const reg dlon = V::sub(toRadians(lon2), toRadians(lon1));
+        
+        reg sLat, cLat, sLon, cLon, s1, c1, s2, c2;
+        sinCos(V::mul(dlat, V::set1(0.5)), sLat, cLat);
+        sinCos(V::mul(dlon, V::set1(0.5)), sLon, cLon);
+        sinCos(phi1, s1, c1);
+        sinCos(phi2, s2, c2);
+        
+        const reg a = V::add(V::mul(sLat, sLat), V::mul(V::mul(V::mul(c1, c2), sLon), sLon));
+        const reg c = V::mul(V::set1(2.0), atan2(V::sqrt(a), V::sqrt(V::sub(V::set1(1.0), a))));
+        return V::mul(V::set1(6371000.0), c);
+    }
+    
+    static reg bearing(reg lat1, reg lon1, reg lat2, reg lon2) {
+        const reg phi1 = toRadians(lat1);
+        const reg phi2 = toRadians(lat2);
+        const reg dlon = V::sub(toRadians(lon2), toRadians(lon1));
+        
+        reg sLon, cLon, s1, c1, s2, c2;
+        sinCos(dlon, sLon, cLon);
+        sinCos(phi1, s1, c1);
+        sinCos(phi2, s2, c2);
+        
+        const reg y = V::mul(sLon, c2);
+        const reg x = V::sub(V::mul(c1, s2), V::mul(V::mul(s1, c2), cLon));
+        reg deg = V::div(V::mul(atan2(y, x), V::set1(180.0)), V::set1(3.14159265358979323846));
+        deg = V::select(V::lt(deg, V::set1(0.0)), V::add(deg, V::set1(360.0)), deg);
+        return V::select(V::ge(deg, V::set1(360.0)), V::set1(0.0), deg);
+    }
+    
+    // Проход по массивам: полные векторы, затем хвост через дополненный буфер
+    template <class F>
+    static void apply4(const double* a, const double* b, const double* c, const double* d,
+                       double* out, size_t n, F f) {
+        size_t i = 0;
+        for (; i + V::WIDTH <= n; i += V::WIDTH) {
+            V::store(out + i, f(V::load(a + i), V::load(b + i), V::load(c + i), V::load(d + i)));
+        }
+        if (i < n) {
+            double ta[V::WIDTH] = {}, tb[V::WIDTH] = {}, tc[V::WIDTH] = {}, td[V::WIDTH] = {}, to[V::WIDTH];
+            for (size_t k = 0; i + k < n; k++) {
+                ta[k] = a[i + k];
+                tb[k] = b[i + k];
+                tc[k] = c[i + k];
+                td[k] = d[i + k];
+            }
+            V::store(to, f(V::load(ta), V::load(tb), V::load(tc), V::load(td)));
+            for (size_t k = 0; i + k < n; k++) {
+                out[i + k] = to[k];
+            }
+        }
+    }
+    
+    static void haversineBatch(const double* lat1, const double* lon1,
+                               const double* lat2, const double* lon2, double* out, size_t n) {
+        apply4(lat1, lon1, lat2, lon2, out, n, haversine);
+    }
+    
+    static void bearingBatch(const double* lat1, const double* lon1,
+                             const double* lat2, const double* lon2, double* out, size_t n) {
+        apply4(lat1, lon1, lat2, lon2, out, n, bearing);
+    }
+    
+    static void sinCosBatch(const double* x, double* sOut, double* cOut, size_t n) {
+        size_t i = 0;
+        reg s, c;
+        for (; i + V::WIDTH <= n; i += V::WIDTH) {
+            sinCos(V::load(x + i), s, c);
+            V::store(sOut + i, s);
+            V::store(cOut + i, c);
+        }
+        if (i < n) {
+            double tx[V::WIDTH] = {}, ts[V::WIDTH], tc[V::WIDTH];
+            for (size_t k = 0; i + k < n; k++) tx[k] = x[i + k];
+            sinCos(V::load(tx), s, c);
+            V::store(ts, s);
+            V::store(tc, c);
+            for (size_t k = 0; i + k < n; k++) {
+                sOut[i + k] = ts[k];
+                cOut[i + k] = tc[k];
+            }
+        }
+    }
+    
+    static void atan2Batch(const double* y, const double* x, double* out, size_t n) {
+        size_t i = 0;
+        for (; i + V::WIDTH <= n; i += V::WIDTH) {
+            V::store(out + i, atan2(V::load(y + i), V::load(x + i)));
+        }
+        if (i < n) {
+            double ty[V::WIDTH] = {}, tx[V::WIDTH] = {}, to[V::WIDTH];
+            for (size_t k = 0; i + k < n; k++) {
+                ty[k] = y[i + k];
+                tx[k] = x[i + k];
+            }
+            V::store(to, atan2(V::load(ty), V::load(tx)));
+            for (size_t k = 0; i + k < n; k++) out[i + k] = to[k];
+        }
+    }
+    
+    static BatchKernels table() {
+        return BatchKernels{haversineBatch, bearingBatch, sinCosBatch, atan2Batch};
+    }
+};
+
+}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Зона геозонирования: один или несколько полигонов с дырами.
+// Принадлежность точки определяется по правилу чет-нечет по всем кольцам,
+// поэтому дыры и части мультиполигона обрабатываются одинаково.
+struct GeofenceZone {
+    std::string name;
+    std::vector<double> longitudes;   // вершины всех колец подряд
+    std::vector<double> latitudes;
+    std::vector<size_t> ringEnds;     // индекс конца каждого кольца
+    double minLatitude = 0.0;
+    double minLongitude = 0.0;
+    double maxLatitude = 0.0;
+    double maxLongitude = 0.0;
+    
+    // Точка внутри зоны
+    bool contains(double lat, double lon) const;
+    // Расстояние до ближайшего ребра в плоскости (lon * lonScale, lat), градусы
+    double edgeDistance(double lat, double lon, double lonScale) const;
+    // Расстояние до ограничивающего прямоугольника (0, если точка внутри), та же метрика
+    double boxDistance(double lat, double lon, double lonScale) const;
+};
+
+// Пространственный индекс зон на равномерной сетке.
+// Зона регистрируется во всех ячейках, которые пересекает ее ограничивающий
+// прямоугольник; очень большие зоны хранятся отдельным списком и
+// проверяются всегда. Зоны, пересекающие линию перемены дат, не поддерживаются.
+class GeofenceIndex {
+public:
+    explicit GeofenceIndex(double cellSizeDegrees = 0.01);
+    
+    // Загрузить зоны из файла: по одной на строку "имя;WKT" (или через табуляцию),
+    // WKT - POLYGON или MULTIPOLYGON в порядке "долгота широта".
+    // Пустые строки и строки с '#' пропускаются. Возвращает false, если файл не открыт.
+    bool loadFromFile(const std::string& filename);
+    
+    // Добавить зону из WKT; false при ошибке разбора
+    bool addZone(const std::string& name, const std::string& wkt);
+    void addZone(GeofenceZone zone);
+    
+    void clear();
+    size_t size() const;
+    const GeofenceZone& getZone(size_t index) const;
+    double getCellSize() const;
+    // Количество строк файла, пропущенных из-за ошибок разбора
+    size_t getSkippedLines() const;
+    
+    // Ячейка сетки, содержащая точку: зоны-кандидаты и ее границы
+    struct Cell {
+        const std::vector<std::uint32_t>* zones = nullptr;   // nullptr - в ячейке нет зон
+        double minLatitude = 0.0;
+        double minLongitude = 0.0;
+        double maxLatitude = 0.0;
+        double maxLongitude = 0.0;
+    };
+    Cell cellAt(double lat, double lon) const;
+    
+    // Зоны, не разложенные по ячейкам из-за размера
+    const std::vector<std::uint32_t>& largeZones() const;
+    
+    // Разбор WKT в зону (без имени)
+    static bool parseWkt(const std::string& wkt, GeofenceZone& zone);
+    
+private:
+    std::uint64_t cellKey(long long ix, long long iy) const;
+    
+    double cellSize_;
+    std::vector<GeofenceZone> zones_;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells_;
+    std::vector<std::uint32_t> largeZones_;
+    size_t skippedLines_ = 0;
+};
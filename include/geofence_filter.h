@@ -0,0 +1,68 @@
+#pragma once
+
+#include "filter_interface.h"
+#include "geofence.h"
+#include "gps_event.h"
+#include <vector>
+
+// Геозонирование: события входа, выхода и длительного пребывания в зонах.
+// Точки не отбрасываются. Состояние устройства кэшируется: после полной
+// проверки запоминается радиус, в пределах которого набор зон не может
+// измениться (расстояние до ближайшего ребра зон-кандидатов и до границы
+// ячейки сетки), и следующие точки внутри него не проверяются.
+class GeofenceFilter : public IGpsFilter {
+public:
+    explicit GeofenceFilter(double cellSizeDegrees = 0.01, double dwellSeconds = 0.0);
+    
+    FilterResult process(GpsPoint& point, const GpsHistory& history) override;
+    void setEnabled(bool enabled) override;
+    bool isEnabled() const override;
+    std::string getName() const override;
+    void setDisplay(IDisplay* display) override;
+    
+    // Загрузить зоны из файла (см. GeofenceIndex::loadFromFile)
+    bool loadZones(const std::string& filename);
+    GeofenceIndex& getIndex();
+    
+    // Время в зоне до события DWELL, секунды (0 - без события)
+    void setDwellTime(double seconds);
+    double getDwellTime() const;
+    
+    // Имена зон, в которых находится устройство
+    std::vector<std::string> getCurrentZones() const;
+    // Количество полных проверок (для диагностики кэша)
+    size_t getEvaluationCount() const;
+    
+    // Сбросить состояние устройства (без событий выхода)
+    void reset();
+    
+private:
+    struct Membership {
+        std::uint32_t zone;
+        unsigned long long enteredAt;
+        bool dwellReported;
+    };
+    
+    void evaluate(const GpsPoint& point);
+    void testZones(const std::vector<std::uint32_t>& zones, double lat, double lon,
+                   double lonScale, double& radius);
+    void emit(GpsEvent::Type type, const GeofenceZone& zone, const GpsPoint& point,
+              unsigned long long durationMs);
+    
+    bool enabled_;
+    unsigned long long dwellMs_;
+    GeofenceIndex index_;
+    IDisplay* display_ = nullptr;
+    
+    std::vector<Membership> inside_;        // отсортировано по zone
+    std::vector<std::uint32_t> scratch_;    // результат полной проверки
+    std::vector<Membership> merged_;
+    
+    // Кэш: точка последней полной проверки и безопасный радиус
+    bool cacheValid_ = false;
+    double cacheLatitude_ = 0.0;
+    double cacheLongitude_ = 0.0;
+    double cacheLonScale_ = 1.0;
+    double safeRadius2_ = 0.0;
+    size_t evaluations_ = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+// Событие, порождаемое фильтром (вход в зону, выход и т.п.).
+// Передается в дисплей наравне с точками.
+struct GpsEvent {
+    enum class Type {
+        ZONE_ENTER,   // точка вошла в зону
+        ZONE_EXIT,    // точка вышла из зоны; durationMs - время внутри
+        ZONE_DWELL,   // точка находится в зоне дольше заданного времени
+        STAY_START,   // начало стоянки; координаты - центр кластера точек
+        STAY_END      // конец стоянки; durationMs - длительность стоянки
+    };
+    
+    Type type = Type::ZONE_ENTER;
+    std::string source;                 // имя фильтра
+    std::string subject;                // объект события (имя зоны)
+    unsigned long long timestamp = 0;   // мс от начала суток UTC
+    double latitude = 0.0;
+    double longitude = 0.0;
+    unsigned long long durationMs = 0;
+};
+
+inline const char* eventTypeName(GpsEvent::Type type) {
+    switch (type) {
+        case GpsEvent::Type::ZONE_ENTER: return "ENTER";
+        case GpsEvent::Type::ZONE_EXIT: return "EXIT";
+        case GpsEvent::Type::ZONE_DWELL: return "DWELL";
+        case GpsEvent::Type::STAY_START: return "STAY_START";
+        case GpsEvent::Type::STAY_END: return "STAY_END";
+    }
+    return "UNKNOWN";
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cmath>
+#include <cstdint>
 
 struct GpsPoint {
     double latitude = 0.0;      // градусы, DD.DDDDD
@@ -11,9 +12,54 @@ struct GpsPoint {
     double altitude = 0.0;      // метры
     int satellites = 0;
     float hdop = 0.0f;
-    unsigned long long timestamp = 0;  // миллисекунды UTC
+    unsigned long long timestamp = 0;  // миллисекунды UTC от начала суток
+    // Номер суток UTC от эпохи; -1 - дата неизвестна (нет RMC). 32 бита
+    // вместе с isValid занимают бывшее выравнивание, размер точки не растет
+    std::int32_t dateDay = -1;
     bool isValid = false;
+    // Подпись точки (например, улица) от стадий ReverseGeocodeStage и
+    // MapMatchStage. Стадии записывают сюда только строки из internLabel():
+    // они живут до конца процесса, поэтому точку можно хранить и после
+    // удаления стадии и ее индекса.
+    const char* label = nullptr;
+    
+    // Начало суток UTC, мс от эпохи; -1 - дата неизвестна
+    std::int64_t dateMs() const;
+    void setDateMs(std::int64_t dayStart);
     
     std::string toString() const;
     bool operator==(const GpsPoint& other) const;
-};
\ No newline at end of file
+};
+
+// Постоянная копия подписи: одинаковые строки дают один указатель,
+// действительный до конца процесса. Пул не очищается, его размер
+// ограничен числом разных имен в индексах. nullptr и "" дают nullptr.
+const char* internLabel(const char* text);
+
+// Компактное представление точки в фиксированной точке, 32 байта:
+// две точки в строке кеша вместо одной. Хранение с потерями в пределах шага
+// квантования: координаты 1e-7 градуса (~1 см), скорость 0.01 км/ч,
+// курс 0.01°, высота 1 см, HDOP 0.01.
+struct PackedGpsPoint {
+    static constexpr std::uint8_t FLAG_VALID = 0x01;
+    static constexpr std::uint8_t FLAG_EPOCH = 0x02;   // timestamp от эпохи (дата известна)
+    
+    std::int64_t timestamp = 0;        // мс UTC: от эпохи с FLAG_EPOCH, иначе от полуночи
+    std::int32_t latitudeE7 = 0;       // 1e-7 градуса
+    std::int32_t longitudeE7 = 0;      // 1e-7 градуса
+    std::int32_t altitudeCm = 0;       // сантиметры
+    std::uint16_t speedCentiKmh = 0;   // 0.01 км/ч, до 655.35 км/ч
+    std::uint16_t courseCentiDeg = 0;  // 0.01 градуса
+    std::uint16_t hdopCenti = 0;       // 0.01
+    std::uint8_t satellites = 0;
+    std::uint8_t flags = 0;
+    std::uint8_t reserved[4] = {};
+    
+    bool isValid() const { return (flags & FLAG_VALID) != 0; }
+    bool hasEpochTime() const { return (flags & FLAG_EPOCH) != 0; }
+    
+    static PackedGpsPoint fromPoint(const GpsPoint& point);
+    GpsPoint toPoint() const;
+};
+
+static_assert(sizeof(PackedGpsPoint) == 32, "PackedGpsPoint must stay 32 bytes");
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+// Время точек: GpsPoint::timestamp - миллисекунды от полуночи UTC,
+// поэтому при вычитании меток учитывается переход через полночь
+namespace gps_time {
+    constexpr unsigned long long MS_PER_DAY = 24ULL * 3600 * 1000;
+    
+    // Время от метки from до метки to. Метка меньше предыдущей больше чем
+    // на полсуток - переход через полночь; меньший откат (точки пришли не по
+    // порядку) считается нулевым интервалом, а не почти сутками
+    inline unsigned long long elapsedMs(unsigned long long from, unsigned long long to) {
+        if (to >= from) return to - from;
+        if (from - to > MS_PER_DAY / 2) return to + MS_PER_DAY - from;
+        return 0;
+    }
+    
+    // Неубывающее время для файлов с поиском по времени (трек, архив), мс:
+    // от эпохи, если дата известна из RMC, иначе от полуночи первых суток
+    // записи. Переход через полночь (метка меньше предыдущей больше чем на
+    // полсуток) добавляет сутки; точка без даты после точки с датой
+    // относится к ее суткам. Точка, пришедшая не по порядку (запоздавшая до
+    // полуночи или с меньшей датой), получает последнее выданное время:
+    // бинарный поиск по файлу требует неубывающих меток.
+    class TrackClock {
+    public:
+        // Время точки; timeOfDay - мс от полуночи, dateMs - начало суток или -1
+        std::int64_t toMonotonic(unsigned long long timeOfDay, std::int64_t dateMs = -1) {
+            const std::int64_t time = static_cast<std::int64_t>(timeOfDay % MS_PER_DAY);
+            if (dateMs >= 0) {
+                dayStart_ = dateMs;
+            } else if (started_) {
+                const std::int64_t delta = time - lastTimeOfDay_;
+                if (delta < -DAY / 2) {
+                    dayStart_ += DAY;
+                } else if (delta > DAY / 2 && dayStart_ >= DAY) {
+                    // Запоздавшая точка до полуночи: сутки не меняются
+                    return clamp(dayStart_ - DAY + time);
+                }
+            }
+            started_ = true;
+            lastTimeOfDay_ = time;
+            return clamp(dayStart_ + time);
+        }
+        
+        // Продолжить после последнего записанного времени (дописывание файла)
+        void resume(std::int64_t lastTimestamp) {
+            if (lastTimestamp < 0) return;
+            dayStart_ = lastTimestamp - lastTimestamp % DAY;
+            lastTimeOfDay_ = lastTimestamp % DAY;
+            lastEmitted_ = lastTimestamp;
+            started_ = true;
+        }
+        
+        void reset() {
+            dayStart_ = 0;
+            lastTimeOfDay_ = 0;
+            lastEmitted_ = -1;
+            started_ = false;
+        }
+    
+    private:
+        static constexpr std::int64_t DAY = static_cast<std::int64_t>(MS_PER_DAY);
+        
+        std::int64_t clamp(std::int64_t value) {
+            if (value < lastEmitted_) return lastEmitted_;
+            lastEmitted_ = value;
+            return value;
+        }
+        
+        std::int64_t dayStart_ = 0;
+        std::int64_t lastTimeOfDay_ = 0;
+        std::int64_t lastEmitted_ = -1;
+        bool started_ = false;
+    };
+}
@@ -3,8 +3,19 @@
 #include <deque>
 #include <optional>
 #include <mutex>
+#include <utility>
 #include "gps_point.h"
 
+// Агрегаты по текущему окну истории (учитываются только валидные точки)
+struct HistoryStats {
+    size_t count = 0;           // количество валидных точек
+    double distance = 0.0;      // пройденный путь между соседними валидными точками, метры
+    double meanSpeed = 0.0;     // км/ч
+    double maxSpeed = 0.0;      // км/ч
+    double minAltitude = 0.0;   // метры
+    double maxAltitude = 0.0;   // метры
+};
+
 class GpsHistory {
 public:
     explicit GpsHistory(size_t maxSize = 10);
@@ -16,9 +27,18 @@ public:
     // Получить последнюю валидную точку
     std::optional<GpsPoint> getLastValid() const;
     
+    // Получить последнюю валидную точку без копирования (nullptr, если нет).
+    // Указатель действителен до следующего изменения истории.
+    const GpsPoint* getLastValidPtr() const;
+    
     // Получить все точки истории
     std::deque<GpsPoint> getAllPoints() const;
     
+    // Получить агрегаты окна за O(1). Агрегаты поддерживаются инкрементально
+    // с первого вызова (он пересчитывает окно целиком); до него addPoint
+    // не считает путь и экстремумы.
+    HistoryStats getStats() const;
+    
     // Очистить историю
     void clear();
     
@@ -34,8 +54,47 @@ public:
     // Получить максимальный размер истории
     size_t getMaxSize() const;
     
+    // Ограничить окно по времени: хранить только точки не старше durationMs
+    // относительно самой свежей (0 - без ограничения). Пока ограничение
+    // задано, размер окна определяется временем, а maxSize не действует;
+    // предел MAX_WINDOW_POINTS - на случай остановившихся меток времени.
+    void setMaxDuration(unsigned long long durationMs);
+    static constexpr size_t MAX_WINDOW_POINTS = 100000;
+    
+    // Получить ограничение окна по времени
+    unsigned long long getMaxDuration() const;
+    
 private:
+    size_t capacity() const;
+    void popFront();
+    void trim(unsigned long long newestTimestamp);
+    // Учесть в агрегатах точку seq; previous - предыдущая валидная точка окна
+    void addStats(unsigned long long seq, const GpsPoint* previous,
+                  unsigned long long previousSeq) const;
+    void rebuildStats() const;
+    void resetStats() const;
+    
     size_t maxSize_;
+    unsigned long long maxDurationMs_ = 0;
     std::deque<GpsPoint> points_;
+    // Последняя валидная точка внутри points_ (push_back/pop_front у deque
+    // не инвалидируют ссылки на остальные элементы)
+    const GpsPoint* lastValid_ = nullptr;
+    
+    // Точки нумеруются сквозным порядковым номером, frontSeq_ - номер points_.front()
+    unsigned long long frontSeq_ = 0;
+    unsigned long long lastValidSeq_ = 0;
+    
+    // Инкрементальные агрегаты; включаются первым getStats(), поэтому mutable
+    mutable bool statsEnabled_ = false;
+    mutable std::deque<double> segmentOut_;   // путь от точки до следующей валидной, параллельно points_
+    mutable size_t validCount_ = 0;
+    mutable double speedSum_ = 0.0;
+    mutable double distanceSum_ = 0.0;
+    // Монотонные очереди (номер точки, значение) для скользящих экстремумов
+    mutable std::deque<std::pair<unsigned long long, double>> maxSpeed_;
+    mutable std::deque<std::pair<unsigned long long, double>> maxAltitude_;
+    mutable std::deque<std::pair<unsigned long long, double>> minAltitude_;
+    
     mutable std::mutex mutex_;
-};
\ No newline at end of file
+};
@@ -11,6 +11,24 @@ struct FilterConfig {
     bool enabled = true;
     int priority = 0;
     std::map<std::string, double> params;
+    std::map<std::string, std::string> stringParams;   // строковые параметры (пути к файлам и т.п.)
+};
+
+// Стадия вывода между пайплайном и дисплеем (упрощение трека и т.п.)
+struct StageConfig {
+    std::string type;
+    std::map<std::string, double> params;
+    std::map<std::string, std::string> stringParams;
+};
+
+// Дочерний вывод для displayType "fanout". Остальные параметры вывода
+// (ротация, asyncOutput и т.п.) берутся из основной конфигурации.
+struct SinkConfig {
+    std::string type;              // displayType дочернего вывода
+    std::string outputFile;
+    std::string events = "all";    // через запятую: points, nofix, rejected, errors, events, all
+    size_t queueSize = 1024;       // записей в очереди, сверх - отбрасываются
+    std::string endpoint;          // "host:port" для "tcp" и "udp"
 };
 
 class JsonConfig {
@@ -22,19 +40,53 @@ public:
     bool saveToFile(const std::string& filename) const;
     
     int getHistorySize() const { return historySize_; }
+    double getHistoryDuration() const { return historyDuration_; }
     const std::string& getDisplayType() const { return displayType_; }
     const std::string& getOutputFile() const { return outputFile_; }
     bool isFileRotation() const { return fileRotation_; }
     size_t getMaxFileSize() const { return maxFileSize_; }
+    bool isAsyncOutput() const { return asyncOutput_; }
+    unsigned getFlushInterval() const { return flushInterval_; }
+    size_t getFlushBytes() const { return flushBytes_; }
+    bool isCompressRotated() const { return compressRotated_; }
+    int getCompressionLevel() const { return compressionLevel_; }
+    size_t getRetainFiles() const { return retainFiles_; }
+    size_t getRetainBytes() const { return retainBytes_; }
+    const std::string& getIoBackend() const { return ioBackend_; }
+    const std::string& getEndpoint() const { return endpoint_; }
+    const std::string& getNetworkFormat() const { return networkFormat_; }
+    size_t getBatchRecords() const { return batchRecords_; }
+    unsigned getLingerUs() const { return lingerUs_; }
+    size_t getSendBufferBytes() const { return sendBufferBytes_; }
     const std::vector<FilterConfig>& getFilters() const { return filters_; }
+    const std::vector<StageConfig>& getOutputStages() const { return outputStages_; }
+    const std::vector<SinkConfig>& getSinks() const { return sinks_; }
     
     void setHistorySize(int size) { historySize_ = size; }
+    void setHistoryDuration(double seconds) { historyDuration_ = seconds; }
     void setDisplayType(const std::string& type) { displayType_ = type; }
     void setOutputFile(const std::string& file) { outputFile_ = file; }
     void setFileRotation(bool rotate) { fileRotation_ = rotate; }
     void setMaxFileSize(size_t size) { maxFileSize_ = size; }
+    void setAsyncOutput(bool async) { asyncOutput_ = async; }
+    void setFlushInterval(unsigned ms) { flushInterval_ = ms; }
+    void setFlushBytes(size_t bytes) { flushBytes_ = bytes; }
+    void setCompressRotated(bool compress) { compressRotated_ = compress; }
+    void setCompressionLevel(int level) { compressionLevel_ = level; }
+    void setRetainFiles(size_t files) { retainFiles_ = files; }
+    void setRetainBytes(size_t bytes) { retainBytes_ = bytes; }
+    void setIoBackend(const std::string& backend) { ioBackend_ = backend; }
+    void setEndpoint(const std::string& endpoint) { endpoint_ = endpoint; }
+    void setNetworkFormat(const std::string& format) { networkFormat_ = format; }
+    void setBatchRecords(size_t records) { batchRecords_ = records; }
+    void setLingerUs(unsigned us) { lingerUs_ = us; }
+    void setSendBufferBytes(size_t bytes) { sendBufferBytes_ = bytes; }
     void addFilter(const FilterConfig& filter) { filters_.push_back(filter); }
     void clearFilters() { filters_.clear(); }
+    void addOutputStage(const StageConfig& stage) { outputStages_.push_back(stage); }
+    void clearOutputStages() { outputStages_.clear(); }
+    void addSink(const SinkConfig& sink) { sinks_.push_back(sink); }
+    void clearSinks() { sinks_.clear(); }
     
     bool isValid() const { return valid_; }
 
@@ -44,12 +96,32 @@ private:
     std::string extractValue(const std::string& json, const std::string& key) const;
     std::vector<std::string> extractArray(const std::string& json, const std::string& key) const;
     std::map<std::string, std::string> extractObject(const std::string& json) const;
+    void parseParams(const std::string& json, std::map<std::string, double>& params,
+                     std::map<std::string, std::string>& stringParams) const;
+    void writeParams(std::ostream& out, const std::map<std::string, double>& params,
+                     const std::map<std::string, std::string>& stringParams) const;
     
     int historySize_ = 10;
+    double historyDuration_ = 0.0;   // секунды, 0 - окно только по количеству точек
     std::string displayType_ = "console";
     std::string outputFile_;
     bool fileRotation_ = false;
     size_t maxFileSize_ = 1024 * 1024;
+    bool asyncOutput_ = false;       // запись файла в фоновом потоке
+    unsigned flushInterval_ = 100;   // мс, период записи буфера при asyncOutput
+    size_t flushBytes_ = 64 * 1024;  // размер буфера, при котором запись не ждет периода
+    bool compressRotated_ = false;   // сжимать отложенные при ротации файлы в фоне
+    int compressionLevel_ = 1;       // уровень gzip, 1-9
+    size_t retainFiles_ = 0;         // хранить не больше файлов ротации, 0 - без ограничения
+    size_t retainBytes_ = 0;         // хранить не больше байт файлов ротации, 0 - без ограничения
+    std::string ioBackend_ = "write";   // запись файла: "write", "uring" или "mmap"
+    std::string endpoint_;                  // "host:port" для displayType "tcp" и "udp"
+    std::string networkFormat_ = "ndjson";  // "ndjson" или "binary"
+    size_t batchRecords_ = 64;              // записей в сетевом пакете
+    unsigned lingerUs_ = 200;               // мкс ожидания неполного пакета
+    size_t sendBufferBytes_ = 1024 * 1024;  // буфер неотправленных записей, сверх - отбрасываются
     std::vector<FilterConfig> filters_;
+    std::vector<StageConfig> outputStages_;   // в порядке прохождения точек
+    std::vector<SinkConfig> sinks_;           // для displayType "fanout"
     bool valid_ = true;
 };
\ No newline at end of file
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "filter_interface.h"
-#include <cmath>
+#include "geodesy.h"
 
 class JumpFilter : public IGpsFilter {
 public:
@@ -16,8 +16,8 @@ public:
     double getMaxJump() const;
     
 private:
-    double calculateDistance(const GpsPoint& p1, const GpsPoint& p2) const;
-    
     bool enabled_;
     double maxJumpMeters_;
+    // Последняя принятая точка с предвычисленными cos/sin широты
+    geo::DistanceReference reference_;
 };
\ No newline at end of file
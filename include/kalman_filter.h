@@ -0,0 +1,59 @@
+#pragma once
+
+#include "filter_interface.h"
+
+// Фильтр Калмана с моделью постоянной скорости в локальной касательной
+// плоскости (восток-север, метры), привязанной к точке рядом с устройством.
+// Состояние [e, n, ve, vn], ковариация 4x4 хранится на стеке. Шум измерения
+// берется из HDOP и числа спутников, поэтому плохие фиксы не отбрасываются,
+// а получают меньший вес.
+class KalmanFilter : public IGpsFilter {
+public:
+    explicit KalmanFilter(double measurementNoise = 5.0, double processNoise = 1.0);
+    
+    FilterResult process(GpsPoint& point, const GpsHistory& history) override;
+    void setEnabled(bool enabled) override;
+    bool isEnabled() const override;
+    std::string getName() const override;
+    
+    // Ошибка псевдодальности (UERE), метры: sigma = UERE * HDOP
+    void setMeasurementNoise(double sigmaMeters);
+    double getMeasurementNoise() const;
+    // Спектральная плотность ускорения, м/с^2
+    void setProcessNoise(double sigmaAccel);
+    double getProcessNoise() const;
+    // Порог отбраковки по расстоянию Махаланобиса в сигмах (0 - без отбраковки)
+    void setGateSigma(double gate);
+    double getGateSigma() const;
+    // Максимальный разрыв между точками, секунды; после него фильтр перезапускается
+    void setMaxGap(double seconds);
+    double getMaxGap() const;
+    
+    // Сбросить состояние
+    void reset();
+    
+private:
+    void initialize(const GpsPoint& point, double variance);
+    void predict(double dt);
+    void reanchor();
+    double measurementVariance(const GpsPoint& point) const;
+    
+    bool enabled_;
+    double measurementNoise_;
+    double processNoise_;
+    double gateSigma_ = 0.0;
+    double maxGapSeconds_ = 10.0;
+    
+    bool initialized_ = false;
+    int consecutiveRejects_ = 0;
+    unsigned long long lastTimestamp_ = 0;
+    
+    // Начало локальной системы координат
+    double anchorLat_ = 0.0;
+    double anchorLon_ = 0.0;
+    double metersPerDegLat_ = 0.0;
+    double metersPerDegLon_ = 0.0;
+    
+    double x_[4] = {};      // e, n, ve, vn
+    double P_[4][4] = {};   // ковариация
+};
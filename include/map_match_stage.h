@@ -0,0 +1,92 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "display_stage.h"
+#include "road_graph.h"
+
+// Привязка точек к дорогам (map matching) скрытой марковской моделью.
+// Кандидаты - проекции точки на ребра графа в радиусе searchRadius.
+// Вероятность наблюдения - нормальная по расстоянию до ребра (sigma),
+// вероятность перехода - экспоненциальная по разности длины пути по
+// графу и расстояния между точками (beta). Декодирование Витерби с
+// фиксированной задержкой: точка выводится, когда за ней накопилось
+// lag точек, по наилучшему на этот момент пути.
+// Точка без кандидатов выводится без изменений; разрыв (нет пути между
+// кандидатами, потеря фикса, событие, flush) сначала выводит все ожидающие точки.
+// Память ограничена: окно из lag шагов по maxCandidates кандидатов и
+// кеш кратчайших путей на cacheSize источников.
+class MapMatchStage : public DisplayStage {
+public:
+    MapMatchStage(std::unique_ptr<IDisplay> next, double sigmaMeters = 10.0, double betaMeters = 50.0,
+                  size_t lag = 5);
+    ~MapMatchStage() override;
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    // Граф нужно загрузить или построить до первой точки
+    RoadGraph& getGraph();
+    const RoadGraph& getGraph() const;
+    
+    void setSearchRadius(double meters);
+    double getSearchRadius() const;
+    void setMaxCandidates(size_t count);
+    size_t getMaxCandidates() const;
+    // Ограничение длины пути между соседними точками и размер кеша путей
+    void setRouteCache(double limitMeters, size_t capacity);
+    const RouteCache& getRouteCache() const;
+    double getSigma() const;
+    double getBeta() const;
+    size_t getLag() const;
+    
+    // Статистика
+    size_t getMatchedCount() const;
+    size_t getUnmatchedCount() const;
+    size_t getBreakCount() const;
+    
+private:
+    struct Candidate {
+        std::uint32_t edge;
+        double fraction;     // положение на ребре от from к to, [0, 1]
+        double latitude;
+        double longitude;
+        double distance;     // до точки, метры
+        double score;        // логарифм вероятности наилучшего пути
+        int previous;        // кандидат предыдущего шага на этом пути
+    };
+    
+    struct Step {
+        GpsPoint point;
+        std::vector<Candidate> candidates;
+    };
+    
+    void findCandidates(const GpsPoint& point, std::vector<Candidate>& out);
+    double routeDistance(const Candidate& a, const Candidate& b);
+    int bestCandidate(const Step& step) const;
+    void emit(const Step& step, int candidate);
+    void emitOldest();
+    void emitAll();
+    
+    RoadGraph graph_;
+    RouteCache routes_;
+    double sigma_;
+    double beta_;
+    size_t lag_;
+    double searchRadius_ = 50.0;
+    size_t maxCandidates_ = 8;
+    
+    std::deque<Step> window_;
+    std::vector<RoadIndex::Match> matches_;
+    // Подпись (из internLabel) для ребра labelEdge_
+    bool hasLabel_ = false;
+    std::uint32_t labelEdge_ = 0;
+    const char* label_ = nullptr;
+    
+    size_t matchedCount_ = 0;
+    size_t unmatchedCount_ = 0;
+    size_t breakCount_ = 0;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Запись в файл через отображение в память.
+// Текущий файл заранее расширяется до segmentSize (fallocate) и отображается
+// целиком, так что запись - это memcpy в отображение. Фоновый поток держит
+// наготове следующий сегмент (скрытый файл .<имя>.next рядом с filename);
+// когда текущий заполнен, пайплайн лишь меняет отображения местами, а поток
+// дописывает старый сегмент на диск (msync), обрезает его до размера данных,
+// откладывает под именем FileSink::rotatedName и готовит следующий. Раз в
+// syncIntervalMs поток вызывает msync(MS_ASYNC) для новых данных.
+// Незаписанная часть файла заполнена нулями: читатель может отобразить файл
+// и читать до первого нулевого байта. При закрытии файл обрезается до данных.
+// Без ротации заполненный файл расширяется на segmentSize. Если расширить
+// файл не удалось, запись отбрасывается и учитывается в getDroppedCount().
+// append/flush/truncate вызываются из одного потока.
+class MmapSink {
+public:
+    MmapSink(const std::string& filename, bool rotate = true, size_t segmentSize = 1024 * 1024,
+             unsigned syncIntervalMs = 100);
+    ~MmapSink();
+    
+    MmapSink(const MmapSink&) = delete;
+    MmapSink& operator=(const MmapSink&) = delete;
+    
+    bool isOpen() const;
+    
+    // Вызывается с именем отложенного файла после каждой ротации (в фоновом
+    // потоке). Устанавливается до первой записи.
+    void setRotationCallback(std::function<void(const std::string&)> callback);
+    
+    void append(const char* data, size_t size);
+    void append(const std::string& record);
+    
+    // msync(MS_ASYNC) новых данных; дождаться обработки отложенного сегмента
+    void flush();
+    // Очистить текущий файл
+    void truncate();
+    
+    // Имя заранее созданного следующего сегмента
+    static std::string nextSegmentName(const std::string& filename);
+    
+    // Статистика: ротации, ожидания неготового сегмента, записанные байты
+    size_t getRotationCount() const;
+    size_t getStallCount() const;
+    size_t getBytesWritten() const;
+    // Записи, отброшенные из-за неудачного расширения файла
+    size_t getDroppedCount() const;
+    
+private:
+    struct Segment {
+        int fd = -1;
+        char* data = nullptr;
+        size_t capacity = 0;   // размер отображения
+        size_t used = 0;       // байт данных
+    };
+    
+    bool openActive();
+    bool prepareSegment(Segment& segment);
+    void retire(Segment& segment);
+    void roll();
+    void grow(size_t required);
+    void run();
+    
+    std::string filename_;
+    std::string nextName_;
+    bool rotate_;
+    size_t segmentSize_;
+    unsigned syncIntervalMs_;
+    std::function<void(const std::string&)> onRotate_;
+    
+    Segment active_;   // пишется пайплайном; заменяется под mutex_
+    std::atomic<size_t> activeUsed_{0};   // active_.used для фонового потока
+    
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable ready_;
+    Segment next_;
+    bool nextReady_ = false;
+    bool nextFailed_ = false;
+    Segment retired_;
+    bool hasRetired_ = false;
+    size_t synced_ = 0;   // граница msync в текущем сегменте
+    bool stop_ = false;
+    std::thread thread_;
+    
+    size_t rotationCount_ = 0;
+    size_t stallCount_ = 0;
+    size_t bytesWritten_ = 0;
+    size_t droppedCount_ = 0;
+};
@@ -9,13 +9,15 @@ struct DisplayCall {
         POINT,
         INVALID_FIX,
         PARSE_ERROR,
-        REJECTED
+        REJECTED,
+        EVENT
     };
     
     Type type;
     GpsPoint point;
     unsigned long long timestamp = 0;
     std::string message;
+    GpsEvent event;
 };
 
 class MockDisplay : public IDisplay {
@@ -24,6 +26,7 @@ public:
     void showInvalidFix(unsigned long long timestamp) override;
     void showParseError(const std::string& error) override;
     void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
     void clear() override;
     
     // Методы для тестирования
@@ -33,6 +36,7 @@ public:
     int getPointCount() const;
     int getInvalidFixCount() const;
     int getErrorCount() const;
+    int getEventCount() const;
     
 private:
     std::vector<DisplayCall> calls_;
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "display_interface.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Формат двоичных сообщений NetworkDisplay: заголовок и записи PackedGpsPoint
+namespace network_format {
+    constexpr char MAGIC[4] = {'G', 'P', 'S', 'N'};
+    constexpr std::uint16_t VERSION = 1;
+    
+    // Заголовок сообщения (пакета записей). По TCP сообщения идут подряд,
+    // по UDP сообщение - одна датаграмма. Поля в порядке байтов хоста.
+    struct FrameHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t recordSize;    // sizeof(PackedGpsPoint)
+        std::uint32_t recordCount;
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(FrameHeader) == 16, "FrameHeader must be 16 bytes");
+    
+    // Наибольшая датаграмма без фрагментации при MTU Ethernet (IPv4 и UDP)
+    constexpr size_t MAX_DATAGRAM = 1472;
+}
+
+// Передача записей по сети (TCP или UDP).
+// Пайплайн только копирует запись в буфер; отправляет фоновый поток, пакет
+// за раз: как только набралось batchRecords записей или через lingerUs
+// микросекунд после первой записи пакета. По TCP пакет уходит одним
+// вызовом writev, по UDP - датаграммами по MAX_DATAGRAM байт одним sendmmsg.
+//   NDJSON - объекты JSON по строкам, как у StructuredDisplay (по TCP
+//            поток строк без дополнительных заголовков);
+//   BINARY - network_format::FrameHeader и записи PackedGpsPoint; передаются
+//            только точки, отсутствие фикса - точкой без флага валидности.
+// Буфер ограничен bufferBytes (с учетом отправляемого пакета): если
+// получатель не успевает или недоступен, новые записи отбрасываются и
+// учитываются в getDroppedCount(). Разорванное TCP-соединение
+// восстанавливается с растущей паузой; неотправленный пакет передается
+// заново целиком по новому соединению (записи могут повториться).
+class NetworkDisplay : public IDisplay {
+public:
+    enum class Protocol {
+        TCP,
+        UDP
+    };
+    
+    enum class Format {
+        NDJSON,
+        BINARY
+    };
+    
+    NetworkDisplay(Protocol protocol, Format format, const std::string& host, unsigned short port,
+                   size_t batchRecords = 64, unsigned lingerUs = 200,
+                   size_t bufferBytes = 1024 * 1024);
+    ~NetworkDisplay() override;
+    
+    NetworkDisplay(const NetworkDisplay&) = delete;
+    NetworkDisplay& operator=(const NetworkDisplay&) = delete;
+    
+    // Протокол по displayType ("tcp", "udp"), формат по имени ("ndjson", "binary")
+    static bool parseProtocol(const std::string& name, Protocol& protocol);
+    static bool parseFormat(const std::string& name, Format& format);
+    // Адрес вида "host:port" или "[ipv6]:port"
+    static bool parseEndpoint(const std::string& endpoint, std::string& host, unsigned short& port);
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showParseError(const std::string& error) override;
+    void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
+    // Отбросить неотправленные записи
+    void clear() override;
+    // Отправить накопленное, не дожидаясь пакета; ждет отправки, неудачной
+    // попытки соединения или FLUSH_TIMEOUT
+    void flush() override;
+    
+    Protocol getProtocol() const;
+    Format getFormat() const;
+    bool isConnected() const;
+    
+    // Статистика: отправленные записи и пакеты, системные вызовы отправки,
+    // отброшенные записи, восстановления соединения
+    size_t getSentCount() const;
+    size_t getBatchCount() const;
+    size_t getSendCallCount() const;
+    size_t getDroppedCount() const;
+    size_t getReconnectCount() const;
+    
+    static constexpr std::chrono::milliseconds FLUSH_TIMEOUT{2000};
+
+private:
+    // Добавить запись в буфер (поток пайплайна)
+    void enqueue(const char* data, size_t size);
+    template <typename Render>
+    void enqueueText(Render render);
+    void run();
+    bool connectSocket();
+    void closeSocket();
+    // Отправить пакет из back_; false - ошибка соединения
+    bool sendBatch();
+    bool sendStream();
+    bool sendDatagrams();
+    // Дождаться готовности сокета к записи; false - остановка или таймаут
+    bool waitWritable();
+    
+    Protocol protocol_;
+    Format format_;
+    std::string host_;
+    unsigned short port_;
+    size_t batchRecords_;
+    std::chrono::microseconds linger_;
+    size_t bufferBytes_;
+    std::vector<char> record_;   // буфер форматирования (поток пайплайна)
+    
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable sent_;
+    std::vector<char> front_;            // заполняется пайплайном
+    std::vector<std::uint32_t> frontEnds_;   // концы записей в front_
+    std::chrono::steady_clock::time_point firstRecord_;
+    size_t inFlightBytes_ = 0;           // размер пакета, который отправляет поток
+    unsigned long long flushRequested_ = 0;
+    unsigned long long flushDone_ = 0;
+    bool stop_ = false;
+    
+    // Только фоновый поток
+    std::vector<char> back_;
+    std::vector<std::uint32_t> backEnds_;
+    int socket_ = -1;
+    std::chrono::steady_clock::time_point retryAt_;
+    std::chrono::milliseconds backoff_{0};
+    bool everConnected_ = false;
+    
+    std::atomic<bool> connected_{false};
+    std::atomic<size_t> sentCount_{0};
+    std::atomic<size_t> batchCount_{0};
+    std::atomic<size_t> sendCalls_{0};
+    std::atomic<size_t> droppedCount_{0};
+    std::atomic<size_t> reconnectCount_{0};
+    
+    std::thread thread_;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
@@ -36,6 +37,27 @@ namespace nmea {
         std::string geoidalUnit = "M";
     };
     
+    // Поля RMC и GGA для parseLinePacked: фиксированная точка, разобранная
+    // прямо из цифр, без промежуточных double
+    struct PackedRMCData {
+        unsigned long long timestamp = 0;
+        bool valid = false;
+        std::int32_t latitudeE7 = 0;
+        std::int32_t longitudeE7 = 0;
+        std::int64_t speedMilliKnots = 0;
+        std::int64_t courseCentiDeg = 0;
+    };
+    
+    struct PackedGGAData {
+        unsigned long long timestamp = 0;
+        std::int64_t quality = 0;
+        std::int64_t satellites = 0;
+        std::int32_t latitudeE7 = 0;
+        std::int32_t longitudeE7 = 0;
+        std::int64_t altitudeCm = 0;
+        std::int64_t hdopCenti = 0;
+    };
+    
     struct GSVData {
         int totalMessages = 0;
         int messageNumber = 0;
@@ -55,6 +77,11 @@ public:
     // Парсинг строки NMEA
     std::optional<GpsPoint> parseLine(const std::string& line);
     
+    // Парсинг строки NMEA в компактное представление без промежуточных double.
+    // Время - от эпохи с FLAG_EPOCH, если дата известна из RMC, иначе от полуночи.
+    // Состояние (неполные пары RMC/GGA) отдельное от parseLine.
+    std::optional<PackedGpsPoint> parseLinePacked(const std::string& line);
+    
     // Новый метод для получения GSV данных
     std::optional<nmea::GSVData> getLastGSV() const;
     
@@ -64,6 +91,16 @@ public:
     static double knotsToKmh(double knots);
     static unsigned long long parseTimeToMs(const std::string& timeStr);
     
+    // Разбор десятичного поля в целое с decimals знаками после точки
+    // (округление по следующей цифре); false, если поле не число или в нем
+    // больше MAX_FIXED_DIGITS значащих цифр (результат не поместился бы в int64)
+    static bool parseFixed(const std::string& field, int decimals, std::int64_t& value);
+    static constexpr int MAX_FIXED_DIGITS = 18;
+    // DDMM.MMMM / DDDMM.MMMM -> 1e-7 градуса без промежуточного double
+    static std::int32_t nmeaCoordinateToE7(const std::string& field, char hemisphere);
+    // DDMMYY -> миллисекунды от эпохи на начало суток; -1, если дата некорректна
+    static long long parseDateToEpochMs(const std::string& dateStr);
+    
     // Сброс внутреннего состояния (для тестов)
     void reset();
     
@@ -77,7 +114,20 @@ private:
     std::optional<nmea::GSVData> parseGSV(const std::vector<std::string>& fields);
     std::optional<GpsPoint> combineData(const nmea::RMCData& rmc, const nmea::GGAData& gga);
     
+    std::optional<nmea::PackedRMCData> parseRMCPacked(const std::vector<std::string>& fields);
+    std::optional<nmea::PackedGGAData> parseGGAPacked(const std::vector<std::string>& fields);
+    
+    // Запомнить дату RMC и время суток, к которому она относится
+    void rememberDate(const std::string& date, unsigned long long timeOfDay);
+    // Начало суток для времени timeOfDay по последней дате: GGA после полуночи
+    // может прийти раньше RMC с новой датой; -1, если дата неизвестна
+    long long dayStartFor(unsigned long long timeOfDay) const;
+    
     std::optional<nmea::RMCData> lastRMC_;
     std::optional<nmea::GGAData> lastGGA_;
     std::optional<nmea::GSVData> lastGSV_;  // Новое поле
+    std::optional<nmea::PackedRMCData> lastPackedRMC_;
+    std::optional<nmea::PackedGGAData> lastPackedGGA_;
+    long long lastDateMs_ = -1;              // начало суток по последней дате RMC
+    unsigned long long lastDateTime_ = 0;    // время суток RMC с этой датой
 };
\ No newline at end of file
@@ -26,15 +26,22 @@ public:
     // Обработка одной NMEA строки
     void process(const std::string& nmeaLine);
     
+    // Вывести точки, задержанные стадиями вывода (в конце обработки)
+    void flush();
+    
     // Настройка
     void setHistorySize(size_t size);
+    void setHistoryDuration(double seconds);
     GpsHistory& getHistory();
     const GpsHistory& getHistory() const;
+    // Первый дисплей цепочки вывода (с учетом стадий)
+    IDisplay* getDisplay() const;
     
     // Статистика
     int getProcessedCount() const;
     int getValidCount() const;
     int getRejectedCount() const;
+    int getSuppressedCount() const;
     int getErrorCount() const;
     
     // Получить текущую конфигурацию
@@ -43,6 +50,7 @@ public:
 private:
     // Приватные методы для создания компонентов
     std::unique_ptr<IDisplay> createDisplay(const JsonConfig& config);
+    std::unique_ptr<IDisplay> createStage(const StageConfig& config, std::unique_ptr<IDisplay> next);
     std::unique_ptr<IGpsFilter> createFilter(const FilterConfig& config);
     void setupFilters(const JsonConfig& config);
     void applyFilters(GpsPoint& point);
@@ -57,5 +65,6 @@ private:
     int processedCount_ = 0;
     int validCount_ = 0;
     int rejectedCount_ = 0;
+    int suppressedCount_ = 0;
     int errorCount_ = 0;
 };
\ No newline at end of file
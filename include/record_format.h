@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "gps_point.h"
+#include "gps_event.h"
+
+// Текстовые записи ConsoleDisplay и FileDisplay.
+// Запись формируется в буфер вызывающего без выделения памяти и без
+// потоков ввода-вывода: числа выводятся через std::to_chars.
+// Каждая функция возвращает полную длину записи; если она больше capacity,
+// буфер содержит только начало записи и нужно повторить с большим буфером.
+namespace record_format {
+    // Достаточный размер буфера для записей без длинных строк (подписи, ошибки)
+    constexpr size_t TYPICAL_CAPACITY = 512;
+    
+    size_t formatPoint(const GpsPoint& point, char* out, size_t capacity);
+    size_t formatInvalidFix(unsigned long long timestamp, char* out, size_t capacity);
+    size_t formatParseError(const std::string& error, char* out, size_t capacity);
+    size_t formatRejected(const std::string& reason, char* out, size_t capacity);
+    size_t formatEvent(const GpsEvent& event, char* out, size_t capacity);
+    
+    // Сформировать запись в buffer, увеличив его, если запись не поместилась.
+    // format(out, capacity) - одна из функций выше. Возвращает длину записи.
+    template <typename Format>
+    size_t render(std::vector<char>& buffer, Format format) {
+        size_t length = format(buffer.data(), buffer.size());
+        if (length > buffer.size()) {
+            buffer.resize(length);
+            format(buffer.data(), buffer.size());
+        }
+        return length;
+    }
+}
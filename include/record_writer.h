@@ -0,0 +1,148 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Посимвольная запись форматов вывода (record_format, StructuredDisplay)
+namespace record_format {
+    // Запись в буфер с подсчетом полной длины: символы за пределами
+    // capacity не пишутся, но учитываются
+    class Writer {
+    public:
+        Writer(char* out, size_t capacity) : out_(out), capacity_(capacity) {}
+        
+        void put(const char* data, size_t size) {
+            if (length_ < capacity_) {
+                size_t room = capacity_ - length_;
+                std::memcpy(out_ + length_, data, size < room ? size : room);
+            }
+            length_ += size;
+        }
+        
+        template <size_t N>
+        void put(const char (&literal)[N]) {
+            put(literal, N - 1);
+        }
+        
+        void put(const std::string& text) {
+            put(text.data(), text.size());
+        }
+        
+        void putChar(char c) {
+            put(&c, 1);
+        }
+        
+        template <typename Int>
+        void putInt(Int value) {
+            char buf[24];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            put(buf, static_cast<size_t>(result.ptr - buf));
+        }
+        
+        // Как std::fixed << std::setprecision(precision)
+        void putFixed(double value, int precision) {
+            char buf[352];   // наибольшее double в fixed с запасом на дробную часть
+            auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+            put(buf, static_cast<size_t>(result.ptr - buf));
+        }
+        
+        // Кратчайшее представление, которое читается обратно в то же число
+        template <typename Float>
+        void putShortest(Float value) {
+            char buf[32];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            put(buf, static_cast<size_t>(result.ptr - buf));
+        }
+        
+        // Строка JSON в кавычках; управляющие символы экранируются
+        void putJsonString(const char* text, size_t size) {
+            static const char HEX[] = "0123456789abcdef";
+            putChar('"');
+            size_t start = 0;
+            for (size_t i = 0; i < size; i++) {
+                unsigned char c = static_cast<unsigned char>(text[i]);
+                if (c >= 0x20 && c != '"' && c != '\\') continue;
+                put(text + start, i - start);
+                start = i + 1;
+                switch (c) {
+                    case '"': put("\\\""); break;
+                    case '\\': put("\\\\"); break;
+                    case '\n': put("\\n"); break;
+                    case '\r': put("\\r"); break;
+                    case '\t': put("\\t"); break;
+                    default: {
+                        char escaped[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF]};
+                        put(escaped, sizeof(escaped));
+                    }
+                }
+            }
+            put(text + start, size - start);
+            putChar('"');
+        }
+        
+        // Поле CSV (RFC 4180): в кавычках, только если содержит разделители
+        void putCsvField(const char* text, size_t size) {
+            bool quote = false;
+            for (size_t i = 0; i < size && !quote; i++) {
+                quote = text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r';
+            }
+            if (!quote) {
+                put(text, size);
+                return;
+            }
+            putChar('"');
+            size_t start = 0;
+            for (size_t i = 0; i < size; i++) {
+                if (text[i] == '"') {
+                    put(text + start, i + 1 - start);
+                    start = i;
+                }
+            }
+            put(text + start, size - start);
+            putChar('"');
+        }
+        
+        // Как std::setfill('0') << std::setw(2)
+        void putTwoDigits(int value) {
+            if (value >= 0 && value < 10) {
+                putChar('0');
+            }
+            putInt(value);
+        }
+        
+        void putTime(unsigned long long timestampMs) {
+            unsigned long long seconds = timestampMs / 1000;
+            int hours = seconds / 3600;
+            int minutes = (seconds % 3600) / 60;
+            int secs = seconds % 60;
+            
+            putChar('[');
+            putTwoDigits(hours);
+            putChar(':');
+            putTwoDigits(minutes);
+            putChar(':');
+            putTwoDigits(secs);
+            putChar(']');
+        }
+        
+        void putLatitude(double lat) {
+            putFixed(std::fabs(lat), 5);
+            if (lat >= 0) put("°N"); else put("°S");
+        }
+        
+        void putLongitude(double lon) {
+            putFixed(std::fabs(lon), 5);
+            if (lon >= 0) put("°E"); else put("°W");
+        }
+        
+        size_t length() const { return length_; }
+        
+    private:
+        char* out_;
+        size_t capacity_;
+        size_t length_ = 0;
+    };
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "display_stage.h"
+#include "road_index.h"
+
+// Обратное геокодирование: каждой точке присваивается подпись (label) -
+// имя ближайшего дорожного сегмента из локального индекса, если он не
+// дальше maxDistance метров. Сеть не используется.
+// Последнее попадание кешируется: точка на тех же координатах получает
+// тот же ответ без поиска, а для соседних точек найденный сегмент сразу
+// ограничивает радиус поиска.
+class ReverseGeocodeStage : public DisplayStage {
+public:
+    ReverseGeocodeStage(std::unique_ptr<IDisplay> next, double maxDistanceMeters = 50.0,
+                        double cellSizeDegrees = 0.005);
+    ~ReverseGeocodeStage() override;
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void clear() override;
+    
+    RoadIndex& getIndex();
+    const RoadIndex& getIndex() const;
+    
+    void setMaxDistance(double meters);
+    double getMaxDistance() const;
+    
+    // Статистика: число точек, ответов из кеша и точек с найденной подписью
+    size_t getQueryCount() const;
+    size_t getCacheHitCount() const;
+    size_t getMatchCount() const;
+    
+private:
+    void resetCache();
+    
+    RoadIndex index_;
+    double maxDistanceMeters_;
+    
+    // Кеш последнего запроса
+    bool hasLast_ = false;
+    double lastLatitude_ = 0.0;
+    double lastLongitude_ = 0.0;
+    RoadIndex::Match lastMatch_;
+    // Подпись (из internLabel) для сегмента labelSegment_
+    std::uint32_t labelSegment_ = RoadIndex::NO_SEGMENT;
+    const char* label_ = nullptr;
+    
+    size_t queryCount_ = 0;
+    size_t cacheHitCount_ = 0;
+    size_t matchCount_ = 0;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "road_index.h"
+
+// Дорожный граф для привязки к дорогам: узлы с координатами и
+// неориентированные ребра-отрезки. Ребра индексируются RoadIndex
+// (номер сегмента индекса совпадает с номером ребра).
+class RoadGraph {
+public:
+    static constexpr std::uint32_t NO_NODE = 0xFFFFFFFFu;
+    
+    struct Node {
+        double latitude;
+        double longitude;
+    };
+    
+    struct Edge {
+        std::uint32_t from;
+        std::uint32_t to;
+        double length;   // метры
+    };
+    
+    // Соседний узел и ребро, которое к нему ведет
+    struct Arc {
+        std::uint32_t node;
+        std::uint32_t edge;
+    };
+    
+    explicit RoadGraph(double cellSizeDegrees = 0.005);
+    
+    // Загрузить граф из файла и построить индекс. Строки:
+    //   N;<id>;<широта>;<долгота>   - узел (id - любое целое)
+    //   E;<id1>;<id2>;<имя>         - ребро между ранее объявленными узлами
+    // Пустые строки и строки с '#' пропускаются. Возвращает false, если файл не открыт.
+    bool loadFromFile(const std::string& filename);
+    
+    std::uint32_t addNode(double lat, double lon);
+    void addEdge(std::uint32_t from, std::uint32_t to, const std::string& name);
+    // Построить списки смежности и пространственный индекс
+    void build();
+    
+    void clear();
+    size_t nodeCount() const;
+    size_t edgeCount() const;
+    const Node& getNode(std::uint32_t node) const;
+    const Edge& getEdge(std::uint32_t edge) const;
+    const char* getEdgeName(std::uint32_t edge) const;
+    const RoadIndex& getIndex() const;
+    // Количество строк файла, пропущенных из-за ошибок разбора
+    size_t getSkippedLines() const;
+    
+    const Arc* arcsBegin(std::uint32_t node) const;
+    const Arc* arcsEnd(std::uint32_t node) const;
+    
+private:
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::vector<std::uint32_t> arcOffsets_;
+    std::vector<Arc> arcs_;
+    RoadIndex index_;
+    size_t skippedLines_ = 0;
+};
+
+// Кеш кратчайших путей по графу. Для узла-источника один раз считается
+// дерево Дейкстры, ограниченное limitMeters; деревья хранятся в LRU не
+// больше capacity штук, так что память ограничена.
+class RouteCache {
+public:
+    RouteCache(const RoadGraph& graph, double limitMeters = 1000.0, size_t capacity = 256);
+    
+    // Длина кратчайшего пути, метры; бесконечность, если путь длиннее limitMeters
+    double distance(std::uint32_t from, std::uint32_t to);
+    
+    // Изменить ограничения; кеш очищается
+    void setLimits(double limitMeters, size_t capacity);
+    
+    void clear();
+    size_t size() const;
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+    double getLimit() const;
+    
+private:
+    struct Tree {
+        std::unordered_map<std::uint32_t, double> distances;
+        std::list<std::uint32_t>::iterator position;
+    };
+    
+    const Tree& tree(std::uint32_t source);
+    
+    const RoadGraph& graph_;
+    double limitMeters_;
+    size_t capacity_;
+    std::unordered_map<std::uint32_t, Tree> trees_;
+    std::list<std::uint32_t> lru_;   // в начале - последний использованный источник
+    size_t hitCount_ = 0;
+    size_t missCount_ = 0;
+};
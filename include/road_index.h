@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Индекс дорожных сегментов для обратного геокодирования без сети.
+// Сегменты раскладываются по равномерной сетке (только по ячейкам, через
+// которые проходит отрезок) и хранятся в плоском виде: отсортированные ключи ячеек,
+// смещения и номера сегментов. Тот же образ записывается в файл и при
+// загрузке отображается в память (mmap) без разбора и копирования.
+// Сегменты, пересекающие линию перемены дат, не поддерживаются.
+class RoadIndex {
+public:
+    static constexpr std::uint32_t NO_SEGMENT = 0xFFFFFFFFu;
+    
+    explicit RoadIndex(double cellSizeDegrees = 0.005);
+    ~RoadIndex();
+    
+    RoadIndex(const RoadIndex&) = delete;
+    RoadIndex& operator=(const RoadIndex&) = delete;
+    
+    // Загрузить сегменты из файла и построить индекс: по одному на строку
+    // "имя;широта1;долгота1;широта2;долгота2" (или через табуляцию).
+    // Пустые строки и строки с '#' пропускаются. Возвращает false, если файл не открыт.
+    bool loadSegments(const std::string& filename);
+    
+    // Добавить сегмент; индекс перестраивается вызовом build()
+    void addSegment(const std::string& name, double lat1, double lon1, double lat2, double lon2);
+    void build();
+    
+    // Сохранить построенный индекс / отобразить готовый индекс в память
+    bool saveIndex(const std::string& filename) const;
+    bool loadIndex(const std::string& filename);
+    
+    // Результат поиска ближайшего сегмента
+    struct Match {
+        std::uint32_t segment = NO_SEGMENT;
+        double distance = 0.0;          // метры
+        const char* name = nullptr;     // строка принадлежит индексу
+    };
+    
+    // Ближайший сегмент не дальше maxDistanceMeters. hint - сегмент, найденный
+    // для предыдущей точки: его расстояние сразу ограничивает радиус поиска.
+    bool nearest(double lat, double lon, double maxDistanceMeters, Match& match,
+                 std::uint32_t hint = NO_SEGMENT) const;
+    
+    // Все сегменты не дальше radiusMeters, по возрастанию расстояния,
+    // не больше maxCount. Возвращает количество найденных.
+    size_t candidates(double lat, double lon, double radiusMeters, size_t maxCount,
+                      std::vector<Match>& out) const;
+    
+    void clear();
+    size_t size() const;
+    const char* getName(std::uint32_t segment) const;
+    double getCellSize() const;
+    bool isMapped() const;
+    // Количество пар (ячейка, сегмент) в сетке
+    size_t getEntryCount() const;
+    // Количество строк файла, пропущенных из-за ошибок разбора
+    size_t getSkippedLines() const;
+    
+private:
+    // Сегмент в образе индекса
+    struct Segment {
+        double lat1;
+        double lon1;
+        double lat2;
+        double lon2;
+        std::uint64_t nameOffset;
+    };
+    
+    struct Header {
+        char magic[8];
+        double cellSize;
+        std::uint64_t segmentCount;
+        std::uint64_t cellCount;
+        std::uint64_t entryCount;
+        std::uint64_t namesSize;
+    };
+    
+    // Смещения частей образа от его начала
+    struct Layout {
+        size_t segments;
+        size_t keys;
+        size_t offsets;
+        size_t entries;
+        size_t names;
+        size_t end;       // конец имен, без выравнивания
+    };
+    
+    // Раскладка образа по заголовку; false, если размеры переполняют size_t
+    static bool layout(const Header& header, Layout& out);
+    std::uint64_t cellKey(long long ix, long long iy) const;
+    long long cellIndex(double degrees) const;
+    bool attach(const std::uint8_t* data, size_t size);
+    void unmap();
+    double distance2(std::uint32_t segment, double lat, double lon, double lonScale) const;
+    // Обход ячеек в кольцах вокруг точки, пока нижняя граница кольца не больше bound()
+    template <typename Visit, typename Bound>
+    void forEachRing(double lat, double lon, double lonScale, long long maxRings,
+                     Visit visit, Bound bound) const;
+    
+    double cellSize_;
+    
+    // Сегменты, добавленные после последнего build()
+    struct PendingSegment {
+        std::string name;
+        double lat1, lon1, lat2, lon2;
+    };
+    std::vector<PendingSegment> pending_;
+    size_t skippedLines_ = 0;
+    
+    // Образ индекса: либо собственный буфер, либо отображенный файл
+    std::vector<std::uint64_t> storage_;
+    void* mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    const std::uint8_t* image_ = nullptr;
+    size_t imageSize_ = 0;
+    
+    // Представления частей образа
+    const Segment* segments_ = nullptr;
+    size_t segmentCount_ = 0;
+    const std::uint64_t* cellKeys_ = nullptr;
+    const std::uint32_t* cellOffsets_ = nullptr;
+    size_t cellCount_ = 0;
+    const std::uint32_t* entries_ = nullptr;
+    const char* names_ = nullptr;
+    size_t namesSize_ = 0;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Фоновое сжатие файлов, отложенных при ротации (filename.<время>), в gzip
+// и ограничение их количества / общего объема. Сегментами считаются только
+// имена из FileSink::rotatedName (filename.YYYYMMDD_HHMMSS_mmm[.N][.gz]):
+// другие файлы с тем же префиксом не трогаются.
+// submit() только ставит имя в ограниченную очередь и не ждет; при полной
+// очереди файл остается несжатым и подбирается повторным просмотром
+// каталога, когда поток освободится. Сжатие идет во временный файл
+// <сегмент>.gz.tmp, который после fsync переименовывается в <сегмент>.gz;
+// только затем удаляется исходный сегмент. При запуске недописанные .tmp
+// удаляются, а оставшиеся несжатые сегменты ставятся в очередь.
+// При level 0 или без zlib (GPS_HAVE_ZLIB) сегменты не сжимаются,
+// ограничение хранения действует.
+class SegmentCompressor {
+public:
+    // retainFiles / retainBytes - 0, если не ограничено
+    explicit SegmentCompressor(const std::string& filename, int level = 1, size_t queueCapacity = 8,
+                               size_t retainFiles = 0, size_t retainBytes = 0);
+    ~SegmentCompressor();
+    
+    SegmentCompressor(const SegmentCompressor&) = delete;
+    SegmentCompressor& operator=(const SegmentCompressor&) = delete;
+    
+    // Доступно ли сжатие в этой сборке
+    static bool isAvailable();
+    bool isCompressing() const;
+    
+    // Поставить сегмент в очередь; false, если очередь заполнена
+    bool submit(const std::string& segment);
+    
+    // Дождаться обработки очереди и ограничения хранения
+    void wait();
+    
+    // Статистика
+    size_t getCompressedCount() const;
+    size_t getOverflowCount() const;   // не попали в очередь (сжаты позже)
+    size_t getRemovedCount() const;    // удалены по ограничению хранения
+    size_t getFailedCount() const;
+    
+private:
+    void run();
+    void recover();
+    void rescan();
+    void applyRetention();
+    bool compressFile(const std::string& source, const std::string& target);
+    // Отложенные сегменты (сжатые и нет), от старых к новым
+    std::vector<std::string> listSegments() const;
+    
+    std::string filename_;
+    int level_;
+    size_t queueCapacity_;
+    size_t retainFiles_;
+    size_t retainBytes_;
+    
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<std::string> queue_;
+    bool busy_ = true;        // поток обрабатывает (при запуске - восстановление)
+    bool rescan_ = false;     // очередь переполнялась: просмотреть каталог
+    bool stop_ = false;
+    std::thread thread_;
+    
+    std::atomic<size_t> compressed_{0};
+    std::atomic<size_t> overflow_{0};
+    std::atomic<size_t> removed_{0};
+    std::atomic<size_t> failed_{0};
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include "display_stage.h"
+
+// Потоковое упрощение трека (алгоритм "открывающегося окна").
+// Точка выводится, только если без нее какая-либо из отброшенных точек
+// отклонилась бы от выведенной ломаной больше чем на tolerance метров.
+// Задержка ограничена: не более maxLookahead точек ожидают решения.
+// Перед событиями и потерей фикса, а также в flush(), выводится последняя
+// ожидающая точка, чтобы разрывы и конец трека сохранялись.
+class SimplifyStage : public DisplayStage {
+public:
+    SimplifyStage(std::unique_ptr<IDisplay> next, double toleranceMeters = 5.0,
+                  size_t maxLookahead = 100);
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    void setTolerance(double meters);
+    double getTolerance() const;
+    void setMaxLookahead(size_t points);
+    size_t getMaxLookahead() const;
+    
+    // Статистика: сколько точек получено и сколько выведено
+    size_t getInputCount() const;
+    size_t getOutputCount() const;
+    
+private:
+    void emit(const GpsPoint& point);
+    void emitPending();
+    bool fitsSegment(const GpsPoint& end) const;
+    
+    double tolerance_;
+    size_t maxLookahead_;
+    
+    bool hasAnchor_ = false;
+    GpsPoint anchor_;
+    std::vector<GpsPoint> pending_;   // точки после опорной; последняя - кандидат в вершины
+    
+    size_t inputCount_ = 0;
+    size_t outputCount_ = 0;
+};
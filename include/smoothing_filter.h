@@ -1,7 +1,6 @@
 #pragma once
 
 #include "filter_interface.h"
-#include <deque>
 #include <cmath>
 
 class SmoothingFilter : public IGpsFilter {
@@ -20,13 +19,27 @@ public:
     
 private:
     double lowPassFilter(double current, double previous, double alpha);
-    double calculateAlpha() const;
+    double calculateAlpha(double dt) const;
+    double alphaFor(const GpsPoint& point);
+    void updateCoefficients();
     
     bool enabled_;
     double cutoffFrequency_;  // частота среза в Гц
     double sampleRate_;       // частота дискретизации в Гц
     
-    // Кеш для предыдущих значений
-    std::deque<GpsPoint> previousPoints_;
-    static constexpr size_t MAX_PREVIOUS = 5;
+    // Коэффициенты, пересчитываемые только при смене параметров
+    double rc_ = 0.0;             // постоянная времени RC = 1 / (2 * pi * fc)
+    double nominalAlpha_ = 0.0;   // alpha для dt = 1 / sampleRate
+    // Последний dt по меткам времени и его alpha: при постоянной частоте
+    // приемника деление выполняется один раз
+    unsigned long long lastDtMs_ = 0;
+    double lastAlpha_ = 0.0;
+    
+    // Предыдущие (несглаженные) значения
+    bool hasPrevious_ = false;
+    double prevLatitude_ = 0.0;
+    double prevLongitude_ = 0.0;
+    double prevSpeed_ = 0.0;
+    double prevAltitude_ = 0.0;
+    unsigned long long prevTimestamp_ = 0;
 };
\ No newline at end of file
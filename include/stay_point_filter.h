@@ -0,0 +1,67 @@
+#pragma once
+
+#include "filter_interface.h"
+#include "gps_event.h"
+
+// Обнаружение стоянок. Медленные точки, лежащие в пределах радиуса от
+// центра кластера дольше minDuration, образуют стоянку: выдается событие
+// STAY_START, а последующие точки стоянки поглощаются (SUPPRESS) вместо
+// повторного вывода одной и той же позиции. При выходе за радиус
+// выдается STAY_END с длительностью и центром стоянки.
+// Если задан heartbeat, во время стоянки раз в heartbeat секунд
+// выводится точка в центре стоянки.
+class StayPointFilter : public IGpsFilter {
+public:
+    explicit StayPointFilter(double radiusMeters = 30.0, double minDurationSeconds = 120.0);
+    
+    FilterResult process(GpsPoint& point, const GpsHistory& history) override;
+    void setEnabled(bool enabled) override;
+    bool isEnabled() const override;
+    std::string getName() const override;
+    void setDisplay(IDisplay* display) override;
+    void flush() override;
+    
+    void setRadius(double meters);
+    double getRadius() const;
+    void setMinDuration(double seconds);
+    double getMinDuration() const;
+    // Скорость, ниже которой точка считается кандидатом в стоянку, км/ч
+    void setSpeedThreshold(double kmh);
+    double getSpeedThreshold() const;
+    // Период контрольных точек во время стоянки, секунды (0 - без них)
+    void setHeartbeat(double seconds);
+    double getHeartbeat() const;
+    
+    bool isStaying() const;
+    
+private:
+    // Кластер медленных точек: кандидат или подтвержденная стоянка
+    struct Cluster {
+        bool active = false;
+        unsigned long long start = 0;
+        unsigned long long last = 0;
+        double sumLatitude = 0.0;
+        double sumLongitude = 0.0;
+        size_t count = 0;
+        
+        double latitude() const { return sumLatitude / count; }
+        double longitude() const { return sumLongitude / count; }
+    };
+    
+    void startCluster(const GpsPoint& point);
+    void addToCluster(const GpsPoint& point);
+    bool withinRadius(const GpsPoint& point) const;
+    void endStay();
+    void emit(GpsEvent::Type type, unsigned long long timestamp, unsigned long long durationMs);
+    
+    bool enabled_;
+    double radiusMeters_;
+    unsigned long long minDurationMs_;
+    double speedThresholdKmh_ = 5.0;
+    unsigned long long heartbeatMs_ = 0;
+    IDisplay* display_ = nullptr;
+    
+    Cluster cluster_;
+    bool staying_ = false;
+    unsigned long long lastHeartbeat_ = 0;
+};
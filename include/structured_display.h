@@ -0,0 +1,57 @@
+#pragma once
+
+#include "display_interface.h"
+#include "file_sink.h"
+#include "structured_format.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Машиночитаемый вывод в файл: одна запись на строку.
+//   CSV     - строка имен колонок в начале каждого файла, затем записи
+//             с общим набором колонок (COLUMNS); пустое поле - нет значения.
+//   NDJSON  - объект JSON на строку.
+//   GEOJSON - последовательность GeoJSON Feature (RFC 8142: каждая запись
+//             начинается с символа RS 0x1E); у записей без координат
+//             geometry равна null.
+// Вид записи - поле type: point, nofix, rejected, error, event.
+// Числа пишутся кратчайшим точным представлением (std::to_chars),
+// запись формируется в переиспользуемом буфере без выделения памяти.
+class StructuredDisplay : public IDisplay {
+public:
+    enum class Format {
+        CSV,
+        NDJSON,
+        GEOJSON
+    };
+    
+    static constexpr const char* CSV_COLUMNS =
+        "type,timestamp,latitude,longitude,speed,course,altitude,satellites,hdop,"
+        "label,event,source,subject,durationMs,message";
+    
+    StructuredDisplay(Format format, const std::string& filename, bool rotate = false,
+                      size_t maxSize = 1024 * 1024, bool async = false,
+                      unsigned flushIntervalMs = 100, size_t flushBytes = 64 * 1024);
+    ~StructuredDisplay() override;
+    
+    // Формат по значению displayType: "csv", "ndjson", "geojson"
+    static bool parseFormat(const std::string& name, Format& format);
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void showParseError(const std::string& error) override;
+    void showRejected(const std::string& reason) override;
+    void showEvent(const GpsEvent& event) override;
+    void clear() override;
+    void flush() override;
+    
+    Format getFormat() const;
+    const FileSink& getSink() const;
+    
+private:
+    void write(const structured_format::Record& record);
+    
+    Format format_;
+    std::unique_ptr<FileSink> sink_;
+    std::vector<char> buffer_;
+};
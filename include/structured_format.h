@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "gps_point.h"
+#include "gps_event.h"
+
+// Машиночитаемые записи StructuredDisplay и NetworkDisplay (CSV, NDJSON,
+// GeoJSON). Функции format* работают как в record_format: пишут в буфер
+// вызывающего и возвращают полную длину записи.
+namespace structured_format {
+    // Поля записи любого вида; отсутствующие части - nullptr / false
+    struct Record {
+        const char* type = "";
+        bool hasTimestamp = false;
+        unsigned long long timestamp = 0;
+        bool hasPosition = false;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        const GpsPoint* point = nullptr;     // скорость, курс, высота и т.д.
+        const GpsEvent* event = nullptr;     // вид события, источник, объект
+        const std::string* message = nullptr;
+    };
+    
+    // Записи по видам; указатели ссылаются на аргументы
+    Record pointRecord(const GpsPoint& point);
+    Record invalidFixRecord(unsigned long long timestamp);
+    Record parseErrorRecord(const std::string& error);
+    Record rejectedRecord(const std::string& reason);
+    Record eventRecord(const GpsEvent& event);
+    
+    size_t formatCsv(const Record& r, char* out, size_t capacity);
+    size_t formatNdjson(const Record& r, char* out, size_t capacity);
+    size_t formatGeojson(const Record& r, char* out, size_t capacity);
+}
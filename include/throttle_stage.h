@@ -0,0 +1,52 @@
+#pragma once
+
+#include "display_stage.h"
+#include "geodesy.h"
+
+// Вывод только при изменении ("report-on-change").
+// Точка передается дальше, если относительно последней переданной точки
+// смещение, изменение курса или скорости превысили свой порог, либо
+// с момента последней переданной точки прошло heartbeat секунд.
+// Порог 0 отключает соответствующий критерий. Решение принимается за O(1)
+// без выделения памяти. После потери фикса первая точка передается всегда.
+class ThrottleStage : public DisplayStage {
+public:
+    ThrottleStage(std::unique_ptr<IDisplay> next, double distanceMeters = 10.0,
+                  double courseDegrees = 15.0, double speedKmh = 5.0,
+                  double heartbeatSeconds = 60.0);
+    
+    void showPoint(const GpsPoint& point) override;
+    void showInvalidFix(unsigned long long timestamp) override;
+    void clear() override;
+    
+    void setDistance(double meters);
+    double getDistance() const;
+    void setCourse(double degrees);
+    double getCourse() const;
+    void setSpeed(double kmh);
+    double getSpeed() const;
+    void setHeartbeat(double seconds);
+    double getHeartbeat() const;
+    
+    // Статистика: сколько точек получено и сколько передано
+    size_t getInputCount() const;
+    size_t getOutputCount() const;
+    
+private:
+    bool changed(const GpsPoint& point) const;
+    
+    double distanceMeters_;
+    double courseDegrees_;
+    double speedKmh_;
+    unsigned long long heartbeatMs_;
+    
+    // Последняя переданная точка
+    bool hasLast_ = false;
+    geo::DistanceReference lastPosition_;
+    unsigned long long lastTimestamp_ = 0;
+    double lastSpeed_ = 0.0;
+    double lastCourse_ = 0.0;
+    
+    size_t inputCount_ = 0;
+    size_t outputCount_ = 0;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "gps_point.h"
+
+// Двоичный формат трека (.gtk): заголовок файла, затем блоки фиксированного
+// размера. Блок - запись синхронизации и до blockRecords точек PackedGpsPoint.
+// Все записи по 32 байта, поэтому точка i находится по прямому смещению,
+// а по записям синхронизации можно искать по времени и проверять целостность.
+// Порядок байт - родной для платформы (little-endian на x86/ARM).
+namespace track_format {
+    constexpr std::uint16_t VERSION = 1;
+    constexpr std::uint32_t DEFAULT_BLOCK_RECORDS = 256;
+    constexpr size_t RECORD_SIZE = sizeof(PackedGpsPoint);
+    
+    constexpr char FILE_MAGIC[8] = {'G', 'P', 'S', 'T', 'R', 'A', 'C', 'K'};
+    constexpr char SYNC_MAGIC[8] = {'G', 'P', 'S', 'S', 'Y', 'N', 'C', '1'};
+    
+    struct FileHeader {
+        char magic[8];
+        std::uint16_t version = VERSION;
+        std::uint16_t recordSize = RECORD_SIZE;
+        std::uint32_t blockRecords = DEFAULT_BLOCK_RECORDS;   // точек в полном блоке
+        std::uint8_t reserved[16] = {};
+        
+        FileHeader() { std::memcpy(magic, FILE_MAGIC, sizeof(magic)); }
+        bool isValid() const {
+            return std::memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0 && version == VERSION &&
+                   recordSize == RECORD_SIZE && blockRecords > 0;
+        }
+    };
+    
+    // Первая запись каждого блока
+    struct SyncRecord {
+        char magic[8];
+        std::uint64_t firstRecord = 0;     // номер первой точки блока в файле
+        std::int64_t firstTimestamp = 0;   // время первой точки блока
+        std::uint32_t blockIndex = 0;
+        std::uint32_t reserved = 0;
+        
+        SyncRecord() { std::memcpy(magic, SYNC_MAGIC, sizeof(magic)); }
+        bool isValid(std::uint32_t block) const {
+            return std::memcmp(magic, SYNC_MAGIC, sizeof(magic)) == 0 && blockIndex == block;
+        }
+    };
+    
+    static_assert(sizeof(FileHeader) == RECORD_SIZE, "FileHeader must be one record");
+    static_assert(sizeof(SyncRecord) == RECORD_SIZE, "SyncRecord must be one record");
+}
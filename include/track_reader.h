@@ -0,0 +1,95 @@
+#pragma once
+
+#include "track_format.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+// Чтение двоичного трека (см. track_format, BinaryTrackDisplay).
+// Файл отображается в память; точки возвращаются ссылками прямо на
+// отображение, без разбора и копирования. Ссылки действительны до close().
+// Чтение заканчивается на первом блоке с испорченной синхронизацией и на
+// неполной последней записи, так что файл, который еще пишется, читается
+// по уже записанным точкам.
+class TrackReader {
+public:
+    TrackReader();
+    explicit TrackReader(const std::string& filename);
+    ~TrackReader();
+    
+    TrackReader(const TrackReader&) = delete;
+    TrackReader& operator=(const TrackReader&) = delete;
+    
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+    
+    // Количество точек
+    size_t size() const;
+    bool empty() const;
+    std::uint32_t getBlockRecords() const;
+    size_t getBlockCount() const;
+    
+    // Точка по номеру в файле (0 - первая), без проверки границ
+    const PackedGpsPoint& operator[](size_t index) const;
+    
+    // Номер первой точки со временем >= timestamp (size(), если таких нет).
+    // Двоичный поиск сначала по записям синхронизации, затем внутри блока;
+    // требует неубывающих меток времени - их пишет BinaryTrackDisplay
+    // (мс от эпохи или от полуночи первых суток, см. gps_time::TrackClock).
+    size_t lowerBound(std::int64_t timestamp) const;
+    
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = PackedGpsPoint;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const PackedGpsPoint*;
+        using reference = const PackedGpsPoint&;
+        
+        const_iterator() = default;
+        const_iterator(const TrackReader* reader, size_t index) : reader_(reader), index_(index) {}
+        
+        reference operator*() const { return (*reader_)[index_]; }
+        pointer operator->() const { return &(*reader_)[index_]; }
+        reference operator[](difference_type n) const { return (*reader_)[index_ + n]; }
+        
+        const_iterator& operator++() { index_++; return *this; }
+        const_iterator operator++(int) { const_iterator it = *this; index_++; return it; }
+        const_iterator& operator--() { index_--; return *this; }
+        const_iterator operator--(int) { const_iterator it = *this; index_--; return it; }
+        const_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(reader_, index_ + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(reader_, index_ - n); }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+        }
+        
+        bool operator==(const const_iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+        bool operator<(const const_iterator& other) const { return index_ < other.index_; }
+        
+        size_t index() const { return index_; }
+        
+    private:
+        const TrackReader* reader_ = nullptr;
+        size_t index_ = 0;
+    };
+    
+    const_iterator begin() const;
+    const_iterator end() const;
+    // Итератор на первую точку со временем >= timestamp
+    const_iterator seek(std::int64_t timestamp) const;
+    
+private:
+    const track_format::SyncRecord& sync(size_t block) const;
+    
+    void* mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    const PackedGpsPoint* records_ = nullptr;   // записи после заголовка
+    std::uint32_t blockRecords_ = 0;
+    size_t blockCount_ = 0;
+    size_t size_ = 0;
+};
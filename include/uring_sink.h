@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Запись в файл через io_uring (Linux, системные вызовы без liburing).
+// Записи копируются в один из queueDepth буферов, зарегистрированных в
+// ядре; заполненный буфер отправляется в кольцо как запись по явному
+// смещению, и поток пайплайна не ждет ее завершения. Если в полете нет ни
+// одной записи, буфер отправляется, не дожидаясь заполнения (не чаще раза в
+// миллисекунду): при малом потоке задержка мала, при большом записи сами
+// собираются в крупные блоки. Ждать приходится только когда все буферы в полете.
+// Интерфейс повторяет FileSink; объект создается через create(), который
+// возвращает nullptr, если io_uring недоступен (ядро, seccomp, песочница).
+// Используется из одного потока. Ротация дожидается всех записей в полете.
+class UringSink {
+public:
+    static std::unique_ptr<UringSink> create(const std::string& filename, bool rotate = false,
+                                             size_t maxSize = 1024 * 1024, unsigned queueDepth = 8,
+                                             size_t bufferSize = 64 * 1024);
+    ~UringSink();
+    
+    UringSink(const UringSink&) = delete;
+    UringSink& operator=(const UringSink&) = delete;
+    
+    // Доступен ли io_uring в этом процессе
+    static bool isSupported();
+    
+    bool isOpen() const;
+    
+    void setHeader(const std::string& header);
+    void setRotationCallback(std::function<void(const std::string&)> callback);
+    
+    void append(const char* data, size_t size);
+    void append(const std::string& record);
+    
+    // Отправить накопленное и дождаться завершения всех записей
+    void flush();
+    void truncate();
+    
+    // Статистика: завершенные записи, записанные байты, ожидания свободного буфера
+    size_t getWriteCount() const;
+    size_t getBytesWritten() const;
+    size_t getStallCount() const;
+    // Буферы зарегистрированы в ядре (IORING_OP_WRITE_FIXED)
+    bool isFixedBuffers() const;
+    
+private:
+    UringSink(const std::string& filename, bool rotate, size_t maxSize, size_t bufferSize);
+    
+    bool setupRing(unsigned queueDepth);
+    void teardownRing();
+    bool openFile();
+    void rotateFile();
+    
+    // Отправить текущий буфер; false, если буфер пуст
+    bool submitCurrent();
+    void submitWrite(unsigned index);
+    // Обработать завершения; wait - ждать хотя бы одно
+    void reap(bool wait);
+    void drain();
+    unsigned acquireBuffer();
+    
+    struct Buffer {
+        char* data = nullptr;
+        size_t length = 0;          // заполнено байт
+        size_t written = 0;         // подтверждено ядром
+        std::uint64_t offset = 0;   // смещение в файле
+        bool inFlight = false;
+    };
+    
+    // Блокирующая запись остатка буфера, если кольцо вернуло ошибку
+    bool writeFallback(Buffer& buffer);
+    
+    std::string filename_;
+    bool rotate_;
+    size_t maxSize_;
+    size_t bufferSize_;
+    std::string header_;
+    std::function<void(const std::string&)> onRotate_;
+    
+    int fd_ = -1;
+    std::uint64_t fileSize_ = 0;        // с учетом отправленных и накопленных данных
+    std::uint64_t submittedSize_ = 0;   // конец последней отправленной записи
+    
+    // Кольцо io_uring
+    int ringFd_ = -1;
+    void* sqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    void* cqRing_ = nullptr;
+    size_t cqRingSize_ = 0;
+    void* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqMask_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned* cqMask_ = nullptr;
+    void* cqes_ = nullptr;
+    bool fixed_ = false;
+    
+    std::vector<Buffer> buffers_;
+    std::vector<unsigned> free_;
+    unsigned current_ = 0;
+    bool hasCurrent_ = false;
+    unsigned inFlight_ = 0;
+    std::chrono::steady_clock::time_point lastSubmit_;
+    
+    size_t writeCount_ = 0;
+    size_t bytesWritten_ = 0;
+    size_t stallCount_ = 0;
+};
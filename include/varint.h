@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Кодирование целых чисел переменной длины (LEB128) и zigzag-отображение
+// знаковых значений в беззнаковые: малые по модулю дельты занимают 1-2 байта.
+namespace varint {
+    inline std::uint64_t zigzagEncode(std::int64_t value) {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+    
+    inline std::int64_t zigzagDecode(std::uint64_t value) {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+    
+    inline void put(std::vector<std::uint8_t>& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+    
+    inline void putSigned(std::vector<std::uint8_t>& out, std::int64_t value) {
+        put(out, zigzagEncode(value));
+    }
+    
+    // Чтение с проверкой границ; false, если данные обрываются
+    inline bool get(const std::uint8_t*& pos, const std::uint8_t* end, std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+            std::uint8_t byte = *pos++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+    
+    inline bool getSigned(const std::uint8_t*& pos, const std::uint8_t* end, std::int64_t& value) {
+        std::uint64_t raw;
+        if (!get(pos, end, raw)) return false;
+        value = zigzagDecode(raw);
+        return true;
+    }
+}
@@ -52,6 +52,8 @@ int main(int argc, char* argv[]) {
         
         pipeline.process(line);
     }
+    
+    pipeline.flush();
 
     return 0;
 }
\ No newline at end of file
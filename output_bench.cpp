@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "file_display.h"
+
+namespace {
+    struct Result {
+        double seconds = 0.0;
+        double p50 = 0.0;   // мкс на вызов showPoint
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+    
+    GpsPoint makePoint(size_t i) {
+        GpsPoint p;
+        p.latitude = 55.75 + static_cast<double>(i % 1000) * 1e-5;
+        p.longitude = 37.61 + static_cast<double>(i % 777) * 1e-5;
+        p.speed = static_cast<double>(i % 120);
+        p.course = static_cast<double>(i % 360);
+        p.altitude = 150.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = 36000000ULL + i * 100;
+        p.isValid = true;
+        return p;
+    }
+    
+    Result run(FileDisplay& display, size_t count) {
+        using Clock = std::chrono::steady_clock;
+        std::vector<double> latency(count);
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; i++) {
+            GpsPoint point = makePoint(i);
+            auto before = Clock::now();
+            display.showPoint(point);
+            latency[i] = std::chrono::duration<double, std::micro>(Clock::now() - before).count();
+        }
+        // Время включает запись хвоста на диск
+        display.flush();
+        Result result;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        
+        std::sort(latency.begin(), latency.end());
+        result.p50 = latency[count / 2];
+        result.p99 = latency[count * 99 / 100];
+        result.max = latency.back();
+        return result;
+    }
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Использование: " << programName << " <каталог> [--points <N>] [--depth <N>] [--segment <байт>]" << std::endl;
+    std::cout << "Пример: " << programName << " /tmp/bench --points 1000000" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    size_t count = 200000;
+    unsigned depth = 8;
+    size_t segment = 8 * 1024 * 1024;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--points" && i + 1 < argc) {
+            count = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            depth = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--segment" && i + 1 < argc) {
+            segment = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (count == 0) count = 1;
+    
+    std::error_code ec;
+    std::filesystem::create_directories(argv[1], ec);
+    const std::string dir = argv[1];
+    
+    std::printf("%-8s %10s %12s %10s %10s %10s\n", "backend", "sec", "points/s", "p50 us", "p99 us", "max us");
+    for (const std::string backend : {"sync", "async", "uring", "mmap"}) {
+        const std::string filename = dir + "/bench_" + backend + ".log";
+        std::filesystem::remove(filename, ec);
+        
+        // Все бэкенды пишут с ротацией по segment байт
+        auto display = std::make_unique<FileDisplay>(filename, true, segment, backend == "async");
+        if ((backend == "uring" && !display->enableUring(depth)) ||
+            (backend == "mmap" && !display->enableMmap())) {
+            std::printf("%-8s %10s\n", backend.c_str(), "n/a");
+            continue;
+        }
+        Result result = run(*display, count);
+        std::printf("%-8s %10.3f %12.0f %10.2f %10.2f %10.2f\n", backend.c_str(), result.seconds,
+                    static_cast<double>(count) / result.seconds, result.p50, result.p99, result.max);
+        display.reset();
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (entry.path().filename().string().rfind("bench_" + backend + ".log", 0) == 0) {
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "archive_display.h"
+#include "column_codec.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    std::int64_t columnValue(const PackedGpsPoint& row, unsigned column) {
+        switch (column) {
+            case archive_format::TIMESTAMP: return row.timestamp;
+            case archive_format::LATITUDE: return row.latitudeE7;
+            case archive_format::LONGITUDE: return row.longitudeE7;
+            case archive_format::ALTITUDE: return row.altitudeCm;
+            case archive_format::SPEED: return row.speedCentiKmh;
+            case archive_format::COURSE: return row.courseCentiDeg;
+            case archive_format::HDOP: return row.hdopCenti;
+            case archive_format::SATELLITES: return row.satellites;
+            case archive_format::VALID: return row.isValid() ? 1 : 0;
+        }
+        return 0;
+    }
+}
+
+ArchiveDisplay::ArchiveDisplay(const std::string& filename, std::uint32_t rowGroupSize,
+                               bool rotate, size_t maxSize, bool async,
+                               unsigned flushIntervalMs, size_t flushBytes)
+    : rowGroupSize_(rowGroupSize > 0 ? rowGroupSize : 1) {
+    clock_.resume(dropIncompleteGroup(filename));
+    sink_ = std::make_unique<FileSink>(filename, rotate, maxSize, async, flushIntervalMs, flushBytes);
+    
+    // Заголовок файла пишет FileSink: в новый файл, после ротации и clear()
+    archive_format::FileHeader header;
+    header.rowGroupSize = rowGroupSize_;
+    sink_->setHeader(std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+    
+    rows_.reserve(rowGroupSize_);
+    column_.resize(rowGroupSize_);
+}
+
+ArchiveDisplay::~ArchiveDisplay() {
+    if (!rows_.empty()) {
+        writeGroup();
+    }
+}
+
+std::int64_t ArchiveDisplay::dropIncompleteGroup(const std::string& filename) {
+    struct stat st;
+    if (::stat(filename.c_str(), &st) != 0 || st.st_size == 0) return -1;
+    const size_t size = static_cast<size_t>(st.st_size);
+    
+    std::ifstream file(filename, std::ios::binary);
+    archive_format::FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !header.isValid()) {
+        std::cerr << "Warning: " << filename << " is not a point archive, overwriting\n";
+        file.close();
+        if (::truncate(filename.c_str(), 0) != 0) {
+            std::cerr << "Warning: Cannot truncate " << filename << "\n";
+        }
+        return -1;
+    }
+    
+    // Проходим по заголовкам групп до первой оборванной или испорченной
+    size_t end = sizeof(header);
+    std::int64_t lastTimestamp = -1;
+    archive_format::RowGroupHeader group;
+    while (end + sizeof(group) <= size) {
+        file.seekg(static_cast<std::streamoff>(end));
+        if (!file.read(reinterpret_cast<char*>(&group), sizeof(group)) || !group.isValid() ||
+            end + sizeof(group) + group.dataSize > size) {
+            break;
+        }
+        end += sizeof(group) + group.dataSize;
+        lastTimestamp = std::max(lastTimestamp, group.maxTimestamp);
+    }
+    file.close();
+    
+    if (end != size && ::truncate(filename.c_str(), static_cast<off_t>(end)) != 0) {
+        std::cerr << "Warning: Cannot truncate incomplete row group in " << filename << "\n";
+    }
+    return lastTimestamp;
+}
+
+void ArchiveDisplay::addRow(const PackedGpsPoint& row) {
+    rows_.push_back(row);
+    if (rows_.size() >= rowGroupSize_) {
+        writeGroup();
+    }
+}
+
+void ArchiveDisplay::writeGroup() {
+    archive_format::RowGroupHeader header;
+    header.rowCount = static_cast<std::uint32_t>(rows_.size());
+    
+    // Статистика для пропуска групп при чтении
+    header.minTimestamp = header.maxTimestamp = rows_.front().timestamp;
+    bool first = true;
+    for (const auto& row : rows_) {
+        header.minTimestamp = std::min(header.minTimestamp, row.timestamp);
+        header.maxTimestamp = std::max(header.maxTimestamp, row.timestamp);
+        if (!row.isValid()) continue;
+        header.validCount++;
+        if (first) {
+            header.minLatitudeE7 = header.maxLatitudeE7 = row.latitudeE7;
+            header.minLongitudeE7 = header.maxLongitudeE7 = row.longitudeE7;
+            header.minSpeed = header.maxSpeed = row.speedCentiKmh;
+            first = false;
+        }
+        header.minLatitudeE7 = std::min(header.minLatitudeE7, row.latitudeE7);
+        header.maxLatitudeE7 = std::max(header.maxLatitudeE7, row.latitudeE7);
+        header.minLongitudeE7 = std::min(header.minLongitudeE7, row.longitudeE7);
+        header.maxLongitudeE7 = std::max(header.maxLongitudeE7, row.longitudeE7);
+        header.minSpeed = std::min(header.minSpeed, row.speedCentiKmh);
+        header.maxSpeed = std::max(header.maxSpeed, row.speedCentiKmh);
+    }
+    
+    // Место под заголовок резервируется, колонки дописываются за ним
+    group_.assign(sizeof(header), 0);
+    for (unsigned c = 0; c < archive_format::COLUMN_COUNT; c++) {
+        for (size_t i = 0; i < rows_.size(); i++) {
+            column_[i] = columnValue(rows_[i], c);
+        }
+        size_t before = group_.size();
+        column_codec::encode(column_.data(), rows_.size(), group_);
+        header.columnSize[c] = static_cast<std::uint32_t>(group_.size() - before);
+    }
+    // Следующая группа начинается с выровненного адреса: заголовки читаются из mmap напрямую
+    group_.resize((group_.size() + 7) & ~size_t(7), 0);
+    header.dataSize = static_cast<std::uint32_t>(group_.size() - sizeof(header));
+    std::memcpy(group_.data(), &header, sizeof(header));
+    
+    sink_->append(reinterpret_cast<const char*>(group_.data()), group_.size());
+    groupCount_++;
+    rowCount_ += rows_.size();
+    rows_.clear();
+}
+
+void ArchiveDisplay::showPoint(const GpsPoint& point) {
+    PackedGpsPoint row = PackedGpsPoint::fromPoint(point);
+    row.timestamp = clock_.toMonotonic(point.timestamp, point.dateMs());
+    addRow(row);
+}
+
+void ArchiveDisplay::showInvalidFix(unsigned long long timestamp) {
+    PackedGpsPoint row;
+    row.timestamp = clock_.toMonotonic(timestamp);
+    addRow(row);
+}
+
+void ArchiveDisplay::showParseError(const std::string&) {}
+
+void ArchiveDisplay::showRejected(const std::string&) {}
+
+void ArchiveDisplay::showEvent(const GpsEvent&) {}
+
+void ArchiveDisplay::clear() {
+    rows_.clear();
+    sink_->truncate();
+    clock_.reset();
+    groupCount_ = 0;
+    rowCount_ = 0;
+}
+
+void ArchiveDisplay::flush() {
+    if (!rows_.empty()) {
+        writeGroup();
+    }
+    sink_->flush();
+}
+
+std::uint32_t ArchiveDisplay::getRowGroupSize() const {
+    return rowGroupSize_;
+}
+
+size_t ArchiveDisplay::getRowGroupCount() const {
+    return groupCount_;
+}
+
+size_t ArchiveDisplay::getRowCount() const {
+    return rowCount_;
+}
+
+const FileSink& ArchiveDisplay::getSink() const {
+    return *sink_;
+}
@@ -0,0 +1,219 @@
+#include "archive_reader.h"
+#include "column_codec.h"
+#include <cmath>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using archive_format::Column;
+using archive_format::RowGroupHeader;
+
+namespace {
+    std::int64_t toE7(double degrees) {
+        return std::llround(degrees * 1e7);
+    }
+}
+
+void ArchiveReader::Predicate::setTimeRange(std::int64_t from, std::int64_t to) {
+    fromTimestamp = from;
+    toTimestamp = to;
+}
+
+void ArchiveReader::Predicate::setBox(double minLat, double minLon, double maxLat, double maxLon) {
+    hasBox = true;
+    minLatitude = minLat;
+    minLongitude = minLon;
+    maxLatitude = maxLat;
+    maxLongitude = maxLon;
+}
+
+ArchiveReader::ArchiveReader() = default;
+
+ArchiveReader::ArchiveReader(const std::string& filename) {
+    open(filename);
+}
+
+ArchiveReader::~ArchiveReader() {
+    close();
+}
+
+bool ArchiveReader::open(const std::string& filename) {
+    close();
+    
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(archive_format::FileHeader)) {
+        data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    
+    const auto* header = static_cast<const archive_format::FileHeader*>(data);
+    if (!header->isValid()) {
+        ::munmap(data, static_cast<size_t>(st.st_size));
+        std::cerr << "Warning: invalid point archive " << filename << "\n";
+        return false;
+    }
+    mapped_ = data;
+    mappedSize_ = static_cast<size_t>(st.st_size);
+    
+    // Оглавление строится по заголовкам групп; чтение заканчивается на
+    // оборванной или испорченной группе (файл может еще дописываться)
+    const auto* bytes = static_cast<const std::uint8_t*>(mapped_);
+    size_t offset = sizeof(*header);
+    while (offset + sizeof(RowGroupHeader) <= mappedSize_) {
+        const auto* group = reinterpret_cast<const RowGroupHeader*>(bytes + offset);
+        if (!group->isValid() || offset + sizeof(RowGroupHeader) + group->dataSize > mappedSize_) {
+            break;
+        }
+        groups_.push_back(group);
+        rowCount_ += group->rowCount;
+        offset += sizeof(RowGroupHeader) + group->dataSize;
+    }
+    return true;
+}
+
+void ArchiveReader::close() {
+    if (mapped_) {
+        ::munmap(mapped_, mappedSize_);
+    }
+    mapped_ = nullptr;
+    mappedSize_ = 0;
+    groups_.clear();
+    rowCount_ = 0;
+}
+
+bool ArchiveReader::isOpen() const {
+    return mapped_ != nullptr;
+}
+
+size_t ArchiveReader::getRowGroupCount() const {
+    return groups_.size();
+}
+
+size_t ArchiveReader::getRowCount() const {
+    return rowCount_;
+}
+
+const RowGroupHeader& ArchiveReader::getRowGroup(size_t group) const {
+    return *groups_[group];
+}
+
+bool ArchiveReader::readColumn(size_t group, Column column, std::vector<std::int64_t>& out) const {
+    const RowGroupHeader& header = *groups_[group];
+    const auto* data = reinterpret_cast<const std::uint8_t*>(&header + 1);
+    size_t offset = 0;
+    for (unsigned c = 0; c < column; c++) {
+        offset += header.columnSize[c];
+    }
+    if (offset + header.columnSize[column] > header.dataSize) return false;
+    
+    out.resize(header.rowCount);
+    return column_codec::decode(data + offset, header.columnSize[column], header.rowCount, out.data());
+}
+
+bool ArchiveReader::mayMatch(const RowGroupHeader& group, const Predicate& predicate) {
+    if (group.maxTimestamp < predicate.fromTimestamp || group.minTimestamp > predicate.toTimestamp) {
+        return false;
+    }
+    if ((predicate.validOnly || predicate.hasBox) && group.validCount == 0) {
+        return false;
+    }
+    if (predicate.hasBox) {
+        if (group.maxLatitudeE7 < toE7(predicate.minLatitude) || group.minLatitudeE7 > toE7(predicate.maxLatitude) ||
+            group.maxLongitudeE7 < toE7(predicate.minLongitude) || group.minLongitudeE7 > toE7(predicate.maxLongitude)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ArchiveReader::ScanStats ArchiveReader::scan(const Predicate& predicate, unsigned columns,
+                                             const std::function<void(const Batch&)>& visitor) const {
+    ScanStats stats;
+    stats.groupsTotal = groups_.size();
+    
+    const bool filterTime = predicate.fromTimestamp != std::numeric_limits<std::int64_t>::min() ||
+                            predicate.toTimestamp != std::numeric_limits<std::int64_t>::max();
+    const bool filterValid = predicate.validOnly || predicate.hasBox;
+    
+    // Колонки для условия читаются, даже если не запрошены
+    unsigned needed = columns & archive_format::ALL_COLUMNS;
+    if (filterTime) needed |= archive_format::columnBit(archive_format::TIMESTAMP);
+    if (filterValid) needed |= archive_format::columnBit(archive_format::VALID);
+    if (predicate.hasBox) {
+        needed |= archive_format::columnBit(archive_format::LATITUDE) |
+                  archive_format::columnBit(archive_format::LONGITUDE);
+    }
+    
+    const std::int64_t minLat = toE7(predicate.minLatitude);
+    const std::int64_t maxLat = toE7(predicate.maxLatitude);
+    const std::int64_t minLon = toE7(predicate.minLongitude);
+    const std::int64_t maxLon = toE7(predicate.maxLongitude);
+    
+    Batch batch;
+    std::vector<std::uint32_t> selected;
+    for (size_t g = 0; g < groups_.size(); g++) {
+        const RowGroupHeader& header = *groups_[g];
+        if (!mayMatch(header, predicate)) {
+            stats.groupsSkipped++;
+            continue;
+        }
+        stats.rowsScanned += header.rowCount;
+        
+        bool ok = true;
+        for (unsigned c = 0; c < archive_format::COLUMN_COUNT && ok; c++) {
+            if (needed & (1u << c)) {
+                ok = readColumn(g, static_cast<Column>(c), batch.columns[c]);
+            } else {
+                batch.columns[c].clear();
+            }
+        }
+        if (!ok) {
+            std::cerr << "Warning: corrupt row group " << g << " skipped\n";
+            continue;
+        }
+        
+        // Отбор строк; если вся группа подходит, колонки не уплотняются
+        selected.clear();
+        const std::int64_t* ts = batch.column(archive_format::TIMESTAMP);
+        const std::int64_t* valid = batch.column(archive_format::VALID);
+        const std::int64_t* lat = batch.column(archive_format::LATITUDE);
+        const std::int64_t* lon = batch.column(archive_format::LONGITUDE);
+        for (std::uint32_t i = 0; i < header.rowCount; i++) {
+            if (filterTime && (ts[i] < predicate.fromTimestamp || ts[i] > predicate.toTimestamp)) continue;
+            if (filterValid && !valid[i]) continue;
+            if (predicate.hasBox && (lat[i] < minLat || lat[i] > maxLat || lon[i] < minLon || lon[i] > maxLon)) continue;
+            selected.push_back(i);
+        }
+        if (selected.empty()) continue;
+        
+        if (selected.size() < header.rowCount) {
+            for (unsigned c = 0; c < archive_format::COLUMN_COUNT; c++) {
+                auto& values = batch.columns[c];
+                if (values.empty()) continue;
+                for (size_t k = 0; k < selected.size(); k++) {
+                    values[k] = values[selected[k]];
+                }
+                values.resize(selected.size());
+            }
+        }
+        // Колонки, нужные только для условия, не передаются
+        for (unsigned c = 0; c < archive_format::COLUMN_COUNT; c++) {
+            if (!(columns & (1u << c))) {
+                batch.columns[c].clear();
+            }
+        }
+        
+        batch.group = g;
+        batch.count = selected.size();
+        stats.rowsMatched += selected.size();
+        visitor(batch);
+    }
+    return stats;
+}
@@ -0,0 +1,128 @@
+#include "binary_track_display.h"
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+BinaryTrackDisplay::BinaryTrackDisplay(const std::string& filename, std::uint32_t blockRecords,
+                                       bool async, unsigned flushIntervalMs, size_t flushBytes)
+    : blockRecords_(blockRecords > 0 ? blockRecords : 1) {
+    // Файл проверяется до открытия на запись: хвост может потребоваться обрезать
+    size_t existing = resume(filename);
+    sink_ = std::make_unique<FileSink>(filename, false, 0, async, flushIntervalMs, flushBytes);
+    if (existing == 0) {
+        writeHeader();
+    }
+}
+
+BinaryTrackDisplay::~BinaryTrackDisplay() = default;
+
+size_t BinaryTrackDisplay::resume(const std::string& filename) {
+    struct stat st;
+    if (::stat(filename.c_str(), &st) != 0 || st.st_size == 0) {
+        return 0;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    
+    track_format::FileHeader header;
+    std::ifstream file(filename, std::ios::binary);
+    bool valid = file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.isValid();
+    
+    if (!valid) {
+        std::cerr << "Warning: " << filename << " is not a binary track, overwriting\n";
+        return ::truncate(filename.c_str(), 0) == 0 ? 0 : size;
+    }
+    
+    blockRecords_ = header.blockRecords;
+    size_t blockSlots = blockRecords_ + 1;
+    size_t slots = (size - sizeof(header)) / track_format::RECORD_SIZE;
+    size_t inBlock = slots % blockSlots;
+    // Синхронизация без единой точки: следующая точка запишет ее заново
+    if (inBlock == 1) {
+        slots--;
+        inBlock = 0;
+    }
+    recordCount_ = (slots / blockSlots) * blockRecords_ + (inBlock > 0 ? inBlock - 1 : 0);
+    
+    // Время продолжается от последней точки: после нее идут только неполные записи
+    if (recordCount_ > 0) {
+        PackedGpsPoint last;
+        file.seekg(static_cast<std::streamoff>(sizeof(header) + (slots - 1) * track_format::RECORD_SIZE));
+        if (file.read(reinterpret_cast<char*>(&last), sizeof(last))) {
+            clock_.resume(last.timestamp);
+        }
+    }
+    file.close();
+    
+    // Неполная запись в конце - след аварийного завершения
+    size_t used = sizeof(header) + slots * track_format::RECORD_SIZE;
+    if (used != size && ::truncate(filename.c_str(), static_cast<off_t>(used)) != 0) {
+        std::cerr << "Warning: Cannot truncate partial record in " << filename << "\n";
+    }
+    return used;
+}
+
+void BinaryTrackDisplay::writeHeader() {
+    track_format::FileHeader header;
+    header.blockRecords = blockRecords_;
+    sink_->append(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void BinaryTrackDisplay::writeRecord(const PackedGpsPoint& record) {
+    // Синхронизация и первая точка блока уходят одной записью
+    char buffer[2 * track_format::RECORD_SIZE];
+    size_t size = 0;
+    if (recordCount_ % blockRecords_ == 0) {
+        track_format::SyncRecord sync;
+        sync.firstRecord = recordCount_;
+        sync.firstTimestamp = record.timestamp;
+        sync.blockIndex = static_cast<std::uint32_t>(recordCount_ / blockRecords_);
+        std::memcpy(buffer, &sync, sizeof(sync));
+        size = sizeof(sync);
+    }
+    std::memcpy(buffer + size, &record, sizeof(record));
+    size += sizeof(record);
+    sink_->append(buffer, size);
+    recordCount_++;
+}
+
+void BinaryTrackDisplay::showPoint(const GpsPoint& point) {
+    PackedGpsPoint record = PackedGpsPoint::fromPoint(point);
+    record.timestamp = clock_.toMonotonic(point.timestamp, point.dateMs());
+    writeRecord(record);
+}
+
+void BinaryTrackDisplay::showInvalidFix(unsigned long long timestamp) {
+    PackedGpsPoint record;
+    record.timestamp = clock_.toMonotonic(timestamp);
+    writeRecord(record);
+}
+
+void BinaryTrackDisplay::showParseError(const std::string&) {}
+
+void BinaryTrackDisplay::showRejected(const std::string&) {}
+
+void BinaryTrackDisplay::showEvent(const GpsEvent&) {}
+
+void BinaryTrackDisplay::clear() {
+    sink_->truncate();
+    recordCount_ = 0;
+    clock_.reset();
+    writeHeader();
+}
+
+void BinaryTrackDisplay::flush() {
+    sink_->flush();
+}
+
+size_t BinaryTrackDisplay::getRecordCount() const {
+    return recordCount_;
+}
+
+std::uint32_t BinaryTrackDisplay::getBlockRecords() const {
+    return blockRecords_;
+}
+
+const FileSink& BinaryTrackDisplay::getSink() const {
+    return *sink_;
+}
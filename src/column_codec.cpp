@@ -0,0 +1,175 @@
+#include "column_codec.h"
+#include "varint.h"
+#include <cstring>
+
+namespace {
+    const std::uint8_t MODE_VALUES = 0;
+    const std::uint8_t MODE_DELTAS = 1;
+    
+    unsigned bitWidth(std::uint64_t value) {
+        unsigned width = 0;
+        while (value != 0) {
+            width++;
+            value >>= 1;
+        }
+        return width;
+    }
+    
+    // Смещения от минимума не зависят от переполнения: считаются и
+    // восстанавливаются по модулю 2^64
+    std::int64_t minimum(const std::int64_t* values, size_t count) {
+        std::int64_t result = values[0];
+        for (size_t i = 1; i < count; i++) {
+            if (values[i] < result) result = values[i];
+        }
+        return result;
+    }
+    
+    unsigned spanWidth(const std::int64_t* values, size_t count, std::int64_t reference) {
+        std::uint64_t bits = 0;
+        for (size_t i = 0; i < count; i++) {
+            bits |= static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(reference);
+        }
+        return bitWidth(bits);
+    }
+    
+    // Битовый поток, младшие биты первыми
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<std::uint8_t>& out) : out_(out) {}
+        
+        void put(std::uint64_t value, unsigned width) {
+            while (width > 0) {
+                unsigned take = width < 32 ? width : 32;
+                acc_ |= (value & ((1ULL << take) - 1)) << bits_;
+                bits_ += take;
+                value = take < 64 ? value >> take : 0;
+                width -= take;
+                while (bits_ >= 8) {
+                    out_.push_back(static_cast<std::uint8_t>(acc_));
+                    acc_ >>= 8;
+                    bits_ -= 8;
+                }
+            }
+        }
+        
+        void finish() {
+            if (bits_ > 0) {
+                out_.push_back(static_cast<std::uint8_t>(acc_));
+            }
+            acc_ = 0;
+            bits_ = 0;
+        }
+        
+    private:
+        std::vector<std::uint8_t>& out_;
+        std::uint64_t acc_ = 0;
+        unsigned bits_ = 0;
+    };
+    
+    std::uint64_t readBits(const std::uint8_t* data, size_t size, size_t bit, unsigned width) {
+        size_t byte = bit >> 3;
+        unsigned offset = bit & 7;
+        // Основной путь: одно невыровненное чтение 8 байт
+        if (width <= 56 && byte + 8 <= size) {
+            std::uint64_t word;
+            std::memcpy(&word, data + byte, sizeof(word));
+            return (word >> offset) & ((1ULL << width) - 1);
+        }
+        std::uint64_t result = 0;
+        unsigned got = 0;
+        while (got < width) {
+            byte = bit >> 3;
+            offset = bit & 7;
+            unsigned take = 8 - offset < width - got ? 8 - offset : width - got;
+            std::uint64_t part = (data[byte] >> offset) & ((1u << take) - 1);
+            result |= part << got;
+            got += take;
+            bit += take;
+        }
+        return result;
+    }
+}
+
+namespace column_codec {
+
+void encode(const std::int64_t* values, size_t count, std::vector<std::uint8_t>& out) {
+    if (count == 0) return;
+    
+    std::int64_t minValue = minimum(values, count);
+    unsigned valueWidth = spanWidth(values, count, minValue);
+    
+    std::int64_t minDelta = 0;
+    unsigned deltaWidth = 64;
+    if (count > 1) {
+        minDelta = static_cast<std::int64_t>(static_cast<std::uint64_t>(values[1]) - static_cast<std::uint64_t>(values[0]));
+        for (size_t i = 2; i < count; i++) {
+            std::int64_t delta = static_cast<std::int64_t>(static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(values[i - 1]));
+            if (delta < minDelta) minDelta = delta;
+        }
+        std::uint64_t bits = 0;
+        for (size_t i = 1; i < count; i++) {
+            std::uint64_t delta = static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(values[i - 1]);
+            bits |= delta - static_cast<std::uint64_t>(minDelta);
+        }
+        deltaWidth = bitWidth(bits);
+    }
+    
+    BitWriter writer(out);
+    if (deltaWidth < valueWidth) {
+        out.push_back(MODE_DELTAS);
+        out.push_back(static_cast<std::uint8_t>(deltaWidth));
+        varint::putSigned(out, values[0]);
+        varint::putSigned(out, minDelta);
+        for (size_t i = 1; i < count; i++) {
+            std::uint64_t delta = static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(values[i - 1]);
+            writer.put(delta - static_cast<std::uint64_t>(minDelta), deltaWidth);
+        }
+    } else {
+        out.push_back(MODE_VALUES);
+        out.push_back(static_cast<std::uint8_t>(valueWidth));
+        varint::putSigned(out, minValue);
+        for (size_t i = 0; i < count; i++) {
+            writer.put(static_cast<std::uint64_t>(values[i]) - static_cast<std::uint64_t>(minValue), valueWidth);
+        }
+    }
+    writer.finish();
+}
+
+bool decode(const std::uint8_t* data, size_t size, size_t count, std::int64_t* out) {
+    if (count == 0) return true;
+    if (size < 2) return false;
+    
+    const std::uint8_t mode = data[0];
+    const unsigned width = data[1];
+    if (mode > MODE_DELTAS || width > 64) return false;
+    
+    const std::uint8_t* pos = data + 2;
+    const std::uint8_t* end = data + size;
+    std::int64_t first = 0;
+    std::int64_t reference = 0;
+    if (mode == MODE_DELTAS && !varint::getSigned(pos, end, first)) return false;
+    if (!varint::getSigned(pos, end, reference)) return false;
+    
+    const size_t packed = mode == MODE_DELTAS ? count - 1 : count;
+    const size_t bytes = static_cast<size_t>(end - pos);
+    if ((packed * width + 7) / 8 > bytes) return false;
+    
+    const std::uint64_t base = static_cast<std::uint64_t>(reference);
+    if (mode == MODE_VALUES) {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = static_cast<std::int64_t>(base + readBits(pos, bytes, i * width, width));
+        }
+        return true;
+    }
+    
+    std::uint64_t value = static_cast<std::uint64_t>(first);
+    out[0] = first;
+    for (size_t i = 1; i < count; i++) {
+        value += base + readBits(pos, bytes, (i - 1) * width, width);
+        out[i] = static_cast<std::int64_t>(value);
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,302 @@
+#include "columnar_history.h"
+#include "geodesy.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Число независимых аккумуляторов: позволяет компилятору векторизовать
+    // редукции без -ffast-math (порядок сложения внутри дорожки сохраняется)
+    constexpr size_t LANES = 4;
+}
+
+ColumnarHistory::ColumnarHistory(size_t maxSize) : maxSize_(maxSize) {
+    reallocate(maxSize_);
+}
+
+ColumnarHistory::~ColumnarHistory() = default;
+
+void ColumnarHistory::reallocate(size_t capacity) {
+    const size_t n = capacity * 2;
+    latitude_.assign(n, 0.0);
+    longitude_.assign(n, 0.0);
+    speed_.assign(n, 0.0);
+    course_.assign(n, 0.0);
+    altitude_.assign(n, 0.0);
+    satellites_.assign(n, 0);
+    hdop_.assign(n, 0.0f);
+    timestamp_.assign(n, 0);
+    valid_.assign(n, 0);
+    weight_.assign(n, 0.0);
+    segment_.assign(n, 0.0);
+    head_ = 0;
+    count_ = 0;
+    lastValid_ = NO_SLOT;
+}
+
+void ColumnarHistory::store(size_t slot, const GpsPoint& point, double segment) {
+    // Пишем в обе половины зеркального буфера
+    for (size_t i : {slot, slot + maxSize_}) {
+        latitude_[i] = point.latitude;
+        longitude_[i] = point.longitude;
+        speed_[i] = point.speed;
+        course_[i] = point.course;
+        altitude_[i] = point.altitude;
+        satellites_[i] = point.satellites;
+        hdop_[i] = point.hdop;
+        timestamp_[i] = point.timestamp;
+        valid_[i] = point.isValid ? 1 : 0;
+        weight_[i] = point.isValid ? 1.0 : 0.0;
+        segment_[i] = segment;
+    }
+}
+
+void ColumnarHistory::addPoint(const GpsPoint& point) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    append(point);
+}
+
+void ColumnarHistory::append(const GpsPoint& point) {
+    if (maxSize_ == 0) return;
+
+    // Отрезок от предыдущей валидной точки, как в GpsHistory::getStats
+    double segment = 0.0;
+    if (point.isValid && lastValid_ != NO_SLOT) {
+        segment = geo::haversineDistance(latitude_[lastValid_], longitude_[lastValid_],
+                                         point.latitude, point.longitude);
+    }
+
+    // При заполненной истории перезаписываем самую старую точку
+    const size_t slot = count_ < maxSize_ ? (head_ + count_) % maxSize_ : head_;
+    if (slot == lastValid_) {
+        lastValid_ = NO_SLOT;
+    }
+    store(slot, point, segment);
+    if (point.isValid) {
+        lastValid_ = slot;
+    }
+
+    if (count_ < maxSize_) {
+        count_++;
+    } else {
+        head_ = (head_ + 1) % maxSize_;
+    }
+}
+
+GpsPoint ColumnarHistory::load(size_t slot) const {
+    GpsPoint p;
+    p.latitude = latitude_[slot];
+    p.longitude = longitude_[slot];
+    p.speed = speed_[slot];
+    p.course = course_[slot];
+    p.altitude = altitude_[slot];
+    p.satellites = satellites_[slot];
+    p.hdop = hdop_[slot];
+    p.timestamp = timestamp_[slot];
+    p.isValid = valid_[slot] != 0;
+    return p;
+}
+
+GpsPoint ColumnarHistory::getPoint(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index >= count_) return GpsPoint();
+    return load(head_ + index);
+}
+
+std::optional<GpsPoint> ColumnarHistory::getLastValid() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lastValid_ == NO_SLOT) return std::nullopt;
+    return load(lastValid_);
+}
+
+void ColumnarHistory::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    head_ = 0;
+    count_ = 0;
+    lastValid_ = NO_SLOT;
+}
+
+size_t ColumnarHistory::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+bool ColumnarHistory::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_ == 0;
+}
+
+void ColumnarHistory::setMaxSize(size_t maxSize) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Сохраняем самые свежие точки, которые помещаются в новый размер
+    const size_t keep = std::min(count_, maxSize);
+    std::vector<GpsPoint> kept;
+    kept.reserve(keep);
+    for (size_t k = count_ - keep; k < count_; k++) {
+        kept.push_back(load(head_ + k));
+    }
+
+    maxSize_ = maxSize;
+    reallocate(maxSize_);
+    for (const auto& p : kept) {
+        append(p);
+    }
+}
+
+size_t ColumnarHistory::getMaxSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxSize_;
+}
+
+const double* ColumnarHistory::latitudes() const { return column(latitude_); }
+const double* ColumnarHistory::longitudes() const { return column(longitude_); }
+const double* ColumnarHistory::speeds() const { return column(speed_); }
+const double* ColumnarHistory::courses() const { return column(course_); }
+const double* ColumnarHistory::altitudes() const { return column(altitude_); }
+const int* ColumnarHistory::satellites() const { return column(satellites_); }
+const float* ColumnarHistory::hdops() const { return column(hdop_); }
+const unsigned long long* ColumnarHistory::timestamps() const { return column(timestamp_); }
+const std::uint8_t* ColumnarHistory::validFlags() const { return column(valid_); }
+
+size_t ColumnarHistory::windowStart(size_t window, size_t& count) const {
+    count = (window == 0 || window > count_) ? count_ : window;
+    return head_ + count_ - count;
+}
+
+SpeedStats ColumnarHistory::speedStats(size_t window) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SpeedStats stats;
+    size_t n = 0;
+    const size_t start = windowStart(window, n);
+    const double* s = speed_.data() + start;
+    const double* w = weight_.data() + start;
+
+    // Первый проход: сумма и количество
+    double sum[LANES] = {};
+    double cnt[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t l = 0; l < LANES; l++) {
+            sum[l] += w[i + l] * s[i + l];
+            cnt[l] += w[i + l];
+        }
+    }
+    for (; i < n; i++) {
+        sum[0] += w[i] * s[i];
+        cnt[0] += w[i];
+    }
+
+    double total = 0.0;
+    double valid = 0.0;
+    for (size_t l = 0; l < LANES; l++) {
+        total += sum[l];
+        valid += cnt[l];
+    }
+    if (valid == 0.0) return stats;
+
+    stats.count = static_cast<size_t>(valid);
+    stats.mean = total / valid;
+
+    // Второй проход: дисперсия относительно среднего (численно устойчивее,
+    // чем E[x^2] - E[x]^2)
+    double sq[LANES] = {};
+    i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t l = 0; l < LANES; l++) {
+            const double d = s[i + l] - stats.mean;
+            sq[l] += w[i + l] * d * d;
+        }
+    }
+    for (; i < n; i++) {
+        const double d = s[i] - stats.mean;
+        sq[0] += w[i] * d * d;
+    }
+
+    double sumSq = 0.0;
+    for (size_t l = 0; l < LANES; l++) {
+        sumSq += sq[l];
+    }
+    stats.variance = sumSq / valid;
+    return stats;
+}
+
+double ColumnarHistory::pathLength(size_t window) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    const size_t start = windowStart(window, n);
+
+    const std::uint8_t* v = valid_.data() + start;
+    const double* seg = segment_.data() + start;
+
+    // Отрезок первой валидной точки окна начинается вне окна
+    size_t first = 0;
+    while (first < n && !v[first]) {
+        first++;
+    }
+    if (first >= n) return 0.0;
+
+    // У невалидных точек отрезок нулевой, поэтому сумма без ветвлений
+    double acc[LANES] = {};
+    size_t i = first + 1;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t l = 0; l < LANES; l++) {
+            acc[l] += seg[i + l];
+        }
+    }
+    for (; i < n; i++) {
+        acc[0] += seg[i];
+    }
+
+    double total = 0.0;
+    for (size_t l = 0; l < LANES; l++) {
+        total += acc[l];
+    }
+    return total;
+}
+
+BoundingBox ColumnarHistory::boundingBox(size_t window) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BoundingBox box;
+    size_t n = 0;
+    const size_t start = windowStart(window, n);
+
+    const double* lat = latitude_.data() + start;
+    const double* lon = longitude_.data() + start;
+    const std::uint8_t* v = valid_.data() + start;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    double minLat[LANES], maxLat[LANES], minLon[LANES], maxLon[LANES];
+    std::fill(minLat, minLat + LANES, inf);
+    std::fill(minLon, minLon + LANES, inf);
+    std::fill(maxLat, maxLat + LANES, -inf);
+    std::fill(maxLon, maxLon + LANES, -inf);
+
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (size_t l = 0; l < LANES; l++) {
+            const bool ok = v[i + l] != 0;
+            minLat[l] = std::min(minLat[l], ok ? lat[i + l] : inf);
+            maxLat[l] = std::max(maxLat[l], ok ? lat[i + l] : -inf);
+            minLon[l] = std::min(minLon[l], ok ? lon[i + l] : inf);
+            maxLon[l] = std::max(maxLon[l], ok ? lon[i + l] : -inf);
+        }
+    }
+    for (; i < n; i++) {
+        const bool ok = v[i] != 0;
+        minLat[0] = std::min(minLat[0], ok ? lat[i] : inf);
+        maxLat[0] = std::max(maxLat[0], ok ? lat[i] : -inf);
+        minLon[0] = std::min(minLon[0], ok ? lon[i] : inf);
+        maxLon[0] = std::max(maxLon[0], ok ? lon[i] : -inf);
+    }
+
+    box.minLatitude = *std::min_element(minLat, minLat + LANES);
+    box.maxLatitude = *std::max_element(maxLat, maxLat + LANES);
+    box.minLongitude = *std::min_element(minLon, minLon + LANES);
+    box.maxLongitude = *std::max_element(maxLon, maxLon + LANES);
+    box.empty = box.minLatitude > box.maxLatitude;
+    if (box.empty) {
+        box = BoundingBox();
+    }
+    return box;
+}
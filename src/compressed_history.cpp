@@ -0,0 +1,236 @@
+#include "compressed_history.h"
+#include "varint.h"
+
+namespace {
+    // Поля точки в фиксированной точке; порядок определяет формат блока
+    constexpr size_t FIELD_COUNT = 8;
+    // Время и координаты при равномерном движении меняются почти линейно,
+    // поэтому для первых полей кодируется разность дельт (1 байт вместо 2-3)
+    constexpr size_t SECOND_ORDER_FIELDS = 3;
+
+    // Квантование совпадает с PackedGpsPoint
+    void quantize(const GpsPoint& p, std::int64_t (&fields)[FIELD_COUNT]) {
+        PackedGpsPoint packed = PackedGpsPoint::fromPoint(p);
+        fields[0] = packed.timestamp;
+        fields[1] = packed.latitudeE7;
+        fields[2] = packed.longitudeE7;
+        fields[3] = packed.speedCentiKmh;
+        fields[4] = packed.courseCentiDeg;
+        fields[5] = packed.altitudeCm;
+        fields[6] = packed.hdopCenti;
+        // Спутники и два младших флага (FLAG_VALID, FLAG_EPOCH)
+        fields[7] = static_cast<std::int64_t>(packed.satellites) * 4 + (packed.flags & 3);
+    }
+
+    GpsPoint dequantize(const std::int64_t (&fields)[FIELD_COUNT]) {
+        PackedGpsPoint packed;
+        packed.timestamp = fields[0];
+        packed.latitudeE7 = static_cast<std::int32_t>(fields[1]);
+        packed.longitudeE7 = static_cast<std::int32_t>(fields[2]);
+        packed.speedCentiKmh = static_cast<std::uint16_t>(fields[3]);
+        packed.courseCentiDeg = static_cast<std::uint16_t>(fields[4]);
+        packed.altitudeCm = static_cast<std::int32_t>(fields[5]);
+        packed.hdopCenti = static_cast<std::uint16_t>(fields[6]);
+        packed.satellites = static_cast<std::uint8_t>(fields[7] >> 2);
+        packed.flags = static_cast<std::uint8_t>(fields[7] & 3);
+        return packed.toPoint();
+    }
+}
+
+CompressedHistory::CompressedHistory(size_t maxSize, size_t blockSize)
+    : maxSize_(maxSize)
+    , blockSize_(blockSize > 0 ? blockSize : 1) {
+    tail_.reserve(blockSize_);
+}
+
+CompressedHistory::~CompressedHistory() = default;
+
+CompressedHistory::Block CompressedHistory::encodeBlock(const std::vector<GpsPoint>& points) {
+    Block block;
+    block.count = points.size();
+    block.data.reserve(points.size() * 12);
+
+    std::int64_t prev[FIELD_COUNT] = {};
+    std::int64_t prevDelta[SECOND_ORDER_FIELDS] = {};
+    for (const auto& point : points) {
+        std::int64_t fields[FIELD_COUNT];
+        quantize(point, fields);
+        for (size_t f = 0; f < FIELD_COUNT; f++) {
+            std::int64_t delta = fields[f] - prev[f];
+            if (f < SECOND_ORDER_FIELDS) {
+                varint::putSigned(block.data, delta - prevDelta[f]);
+                prevDelta[f] = delta;
+            } else {
+                varint::putSigned(block.data, delta);
+            }
+            prev[f] = fields[f];
+        }
+    }
+
+    block.data.shrink_to_fit();
+    return block;
+}
+
+void CompressedHistory::decodeBlock(const Block& block, std::vector<GpsPoint>& out) {
+    out.clear();
+    out.reserve(block.count);
+
+    const std::uint8_t* pos = block.data.data();
+    const std::uint8_t* end = pos + block.data.size();
+    std::int64_t fields[FIELD_COUNT] = {};
+    std::int64_t prevDelta[SECOND_ORDER_FIELDS] = {};
+    for (size_t i = 0; i < block.count; i++) {
+        for (size_t f = 0; f < FIELD_COUNT; f++) {
+            std::int64_t delta = 0;
+            varint::getSigned(pos, end, delta);
+            if (f < SECOND_ORDER_FIELDS) {
+                delta += prevDelta[f];
+                prevDelta[f] = delta;
+            }
+            fields[f] += delta;
+        }
+        out.push_back(dequantize(fields));
+    }
+}
+
+void CompressedHistory::sealTail() {
+    blocks_.push_back(encodeBlock(tail_));
+    tail_.clear();
+}
+
+void CompressedHistory::trim() {
+    size_t excess = sizeLocked() > maxSize_ ? sizeLocked() - maxSize_ : 0;
+
+    // Сначала вытесняем точки из сжатых блоков, целые блоки освобождаем
+    while (excess > 0 && !blocks_.empty()) {
+        size_t available = blocks_.front().count - frontOffset_;
+        if (excess < available) {
+            frontOffset_ += excess;
+            excess = 0;
+        } else {
+            excess -= available;
+            blocks_.pop_front();
+            frontOffset_ = 0;
+            droppedBlocks_++;
+        }
+    }
+    if (excess > 0) {
+        tail_.erase(tail_.begin(), tail_.begin() + excess);
+    }
+}
+
+void CompressedHistory::addPoint(const GpsPoint& point) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tail_.push_back(point);
+    if (tail_.size() >= blockSize_) {
+        sealTail();
+    }
+    trim();
+}
+
+size_t CompressedHistory::sizeLocked() const {
+    return blocks_.size() * blockSize_ + tail_.size() - frontOffset_;
+}
+
+const std::vector<GpsPoint>& CompressedHistory::decoded(size_t blockIndex) const {
+    size_t key = droppedBlocks_ + blockIndex;
+    if (cachedBlock_ != key) {
+        decodeBlock(blocks_[blockIndex], cache_);
+        cachedBlock_ = key;
+    }
+    return cache_;
+}
+
+GpsPoint CompressedHistory::pointAt(size_t index) const {
+    // Все сжатые блоки полные, поэтому номер блока вычисляется делением
+    size_t absolute = index + frontOffset_;
+    size_t compressed = blocks_.size() * blockSize_;
+    if (absolute >= compressed) {
+        return tail_[absolute - compressed];
+    }
+    return decoded(absolute / blockSize_)[absolute % blockSize_];
+}
+
+GpsPoint CompressedHistory::getPoint(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index >= sizeLocked()) return GpsPoint();
+    return pointAt(index);
+}
+
+std::optional<GpsPoint> CompressedHistory::getLastValid() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Обычно ответ находится в несжатом хвосте
+    for (auto it = tail_.rbegin(); it != tail_.rend(); ++it) {
+        if (it->isValid) {
+            return *it;
+        }
+    }
+    for (size_t b = blocks_.size(); b > 0; b--) {
+        const auto& points = decoded(b - 1);
+        size_t first = (b == 1) ? frontOffset_ : 0;
+        for (size_t i = points.size(); i > first; i--) {
+            if (points[i - 1].isValid) {
+                return points[i - 1];
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void CompressedHistory::forEach(const std::function<void(const GpsPoint&)>& visitor) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<GpsPoint> points;
+    for (size_t b = 0; b < blocks_.size(); b++) {
+        decodeBlock(blocks_[b], points);
+        for (size_t i = (b == 0) ? frontOffset_ : 0; i < points.size(); i++) {
+            visitor(points[i]);
+        }
+    }
+    for (const auto& point : tail_) {
+        visitor(point);
+    }
+}
+
+void CompressedHistory::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    droppedBlocks_ += blocks_.size();
+    blocks_.clear();
+    frontOffset_ = 0;
+    tail_.clear();
+    cachedBlock_ = SIZE_MAX;
+    cache_.clear();
+}
+
+size_t CompressedHistory::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sizeLocked();
+}
+
+bool CompressedHistory::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sizeLocked() == 0;
+}
+
+void CompressedHistory::setMaxSize(size_t maxSize) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxSize_ = maxSize;
+    trim();
+}
+
+size_t CompressedHistory::getMaxSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxSize_;
+}
+
+size_t CompressedHistory::getBlockSize() const {
+    return blockSize_;
+}
+
+size_t CompressedHistory::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = sizeof(*this) + (tail_.capacity() + cache_.capacity()) * sizeof(GpsPoint);
+    for (const auto& block : blocks_) {
+        bytes += sizeof(Block) + block.data.capacity();
+    }
+    return bytes;
+}
@@ -0,0 +1,36 @@
+#include "display_stage.h"
+
+DisplayStage::DisplayStage(std::unique_ptr<IDisplay> next)
+    : next_(std::move(next)) {}
+
+void DisplayStage::showPoint(const GpsPoint& point) {
+    next_->showPoint(point);
+}
+
+void DisplayStage::showInvalidFix(unsigned long long timestamp) {
+    next_->showInvalidFix(timestamp);
+}
+
+void DisplayStage::showParseError(const std::string& error) {
+    next_->showParseError(error);
+}
+
+void DisplayStage::showRejected(const std::string& reason) {
+    next_->showRejected(reason);
+}
+
+void DisplayStage::showEvent(const GpsEvent& event) {
+    next_->showEvent(event);
+}
+
+void DisplayStage::clear() {
+    next_->clear();
+}
+
+void DisplayStage::flush() {
+    next_->flush();
+}
+
+IDisplay* DisplayStage::getNext() const {
+    return next_.get();
+}
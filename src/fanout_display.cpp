@@ -0,0 +1,224 @@
+#include "fanout_display.h"
+#include <sstream>
+
+FanoutDisplay::~FanoutDisplay() {
+    // Очереди дорабатываются до конца: потоки выходят, когда очередь пуста
+    for (auto& sink : sinks_) {
+        {
+            std::lock_guard<std::mutex> lock(sink->mutex);
+            sink->stop = true;
+        }
+        sink->wake.notify_one();
+    }
+    for (auto& sink : sinks_) {
+        if (sink->thread.joinable()) {
+            sink->thread.join();
+        }
+    }
+}
+
+bool FanoutDisplay::parseMask(const std::string& names, unsigned& mask) {
+    unsigned result = 0;
+    std::stringstream ss(names);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        size_t begin = name.find_first_not_of(" \t");
+        size_t end = name.find_last_not_of(" \t");
+        if (begin == std::string::npos) continue;
+        name = name.substr(begin, end - begin + 1);
+        
+        if (name == "points") {
+            result |= POINTS;
+        } else if (name == "nofix") {
+            result |= INVALID_FIX;
+        } else if (name == "rejected") {
+            result |= REJECTED;
+        } else if (name == "errors") {
+            result |= PARSE_ERRORS;
+        } else if (name == "events") {
+            result |= EVENTS;
+        } else if (name == "all") {
+            result |= ALL;
+        } else {
+            return false;
+        }
+    }
+    mask = result;
+    return true;
+}
+
+void FanoutDisplay::addSink(std::unique_ptr<IDisplay> display, unsigned mask, size_t queueSize) {
+    auto sink = std::make_unique<Sink>();
+    sink->display = std::move(display);
+    sink->mask = mask;
+    sink->capacity = queueSize > 0 ? queueSize : 1;
+    sink->queue.reserve(sink->capacity);
+    Sink* raw = sink.get();
+    sink->thread = std::thread([this, raw] { run(*raw); });
+    sinks_.push_back(std::move(sink));
+}
+
+template <typename Fill>
+void FanoutDisplay::publish(unsigned record, Fill fill) {
+    for (auto& sink : sinks_) {
+        if (!(sink->mask & record)) continue;
+        
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(sink->mutex);
+            if (sink->queue.size() + sink->taken >= sink->capacity) {
+                // Пайплайн не ждет медленный дисплей
+                sink->dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            wasEmpty = sink->queue.empty();
+            sink->queue.emplace_back();
+            fill(sink->queue.back());
+        }
+        // Поток ждет только на пустой очереди
+        if (wasEmpty) {
+            sink->wake.notify_one();
+        }
+    }
+}
+
+void FanoutDisplay::enqueueControl(Sink& sink, Message::Type type) {
+    {
+        std::lock_guard<std::mutex> lock(sink.mutex);
+        sink.queue.emplace_back();
+        sink.queue.back().type = type;
+        if (type == Message::Type::FLUSH) {
+            sink.flushRequested++;
+        }
+    }
+    sink.wake.notify_one();
+}
+
+void FanoutDisplay::showPoint(const GpsPoint& point) {
+    publish(POINTS, [&](Message& message) {
+        message.type = Message::Type::POINT;
+        message.point = point;
+    });
+}
+
+void FanoutDisplay::showInvalidFix(unsigned long long timestamp) {
+    publish(INVALID_FIX, [&](Message& message) {
+        message.type = Message::Type::INVALID_FIX;
+        message.timestamp = timestamp;
+    });
+}
+
+void FanoutDisplay::showParseError(const std::string& error) {
+    publish(PARSE_ERRORS, [&](Message& message) {
+        message.type = Message::Type::PARSE_ERROR;
+        message.text = error;
+    });
+}
+
+void FanoutDisplay::showRejected(const std::string& reason) {
+    publish(REJECTED, [&](Message& message) {
+        message.type = Message::Type::REJECTED;
+        message.text = reason;
+    });
+}
+
+void FanoutDisplay::showEvent(const GpsEvent& event) {
+    publish(EVENTS, [&](Message& message) {
+        message.type = Message::Type::EVENT;
+        message.event = event;
+    });
+}
+
+void FanoutDisplay::clear() {
+    for (auto& sink : sinks_) {
+        enqueueControl(*sink, Message::Type::CLEAR);
+    }
+}
+
+void FanoutDisplay::flush() {
+    // Сначала запрос всем, потом ожидание: дисплеи сбрасываются параллельно
+    for (auto& sink : sinks_) {
+        enqueueControl(*sink, Message::Type::FLUSH);
+    }
+    for (auto& sink : sinks_) {
+        std::unique_lock<std::mutex> lock(sink->mutex);
+        sink->flushed.wait(lock, [&] { return sink->flushDone >= sink->flushRequested; });
+    }
+}
+
+void FanoutDisplay::deliver(IDisplay& display, const Message& message) {
+    switch (message.type) {
+        case Message::Type::POINT:
+            display.showPoint(message.point);
+            break;
+        case Message::Type::INVALID_FIX:
+            display.showInvalidFix(message.timestamp);
+            break;
+        case Message::Type::PARSE_ERROR:
+            display.showParseError(message.text);
+            break;
+        case Message::Type::REJECTED:
+            display.showRejected(message.text);
+            break;
+        case Message::Type::EVENT:
+            display.showEvent(message.event);
+            break;
+        case Message::Type::CLEAR:
+            display.clear();
+            break;
+        case Message::Type::FLUSH:
+            display.flush();
+            break;
+    }
+}
+
+void FanoutDisplay::run(Sink& sink) {
+    // Очередь забирается целиком: пайплайн держит мьютекс только на время вставки
+    std::vector<Message> batch;
+    batch.reserve(sink.capacity);
+    
+    std::unique_lock<std::mutex> lock(sink.mutex);
+    while (true) {
+        sink.wake.wait(lock, [&] { return !sink.queue.empty() || sink.stop; });
+        if (sink.queue.empty()) break;
+        batch.swap(sink.queue);
+        sink.taken = batch.size();
+        lock.unlock();
+        
+        for (const auto& message : batch) {
+            deliver(*sink.display, message);
+            if (message.type == Message::Type::FLUSH) {
+                // Ожидающий flush() видит все записи, поставленные до него
+                std::lock_guard<std::mutex> flushLock(sink.mutex);
+                sink.flushDone++;
+                sink.flushed.notify_all();
+            } else if (message.type != Message::Type::CLEAR) {
+                sink.delivered.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        batch.clear();
+        
+        lock.lock();
+        sink.taken = 0;
+    }
+}
+
+size_t FanoutDisplay::getSinkCount() const {
+    return sinks_.size();
+}
+
+IDisplay* FanoutDisplay::getSink(size_t index) const {
+    return index < sinks_.size() ? sinks_[index]->display.get() : nullptr;
+}
+
+unsigned FanoutDisplay::getMask(size_t index) const {
+    return index < sinks_.size() ? sinks_[index]->mask : 0;
+}
+
+size_t FanoutDisplay::getDroppedCount(size_t index) const {
+    return index < sinks_.size() ? sinks_[index]->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+size_t FanoutDisplay::getDeliveredCount(size_t index) const {
+    return index < sinks_.size() ? sinks_[index]->delivered.load(std::memory_order_relaxed) : 0;
+}
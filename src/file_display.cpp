@@ -1,139 +1,154 @@
 #include "file_display.h"
-#include <sstream>
-#include <filesystem>
+#include "record_format.h"
 #include <iostream>
 
-FileDisplay::FileDisplay(const std::string& filename, bool rotate, size_t maxSize)
+FileDisplay::FileDisplay(const std::string& filename, bool rotate, size_t maxSize,
+                         bool async, unsigned flushIntervalMs, size_t flushBytes)
     : filename_(filename)
     , rotate_(rotate)
     , maxSize_(maxSize)
-    , currentSize_(0) {
-    
-    file_.open(filename, std::ios::app);
-    if (!file_.is_open()) {
-        std::cerr << "Warning: Cannot open file " << filename << " for writing\n";
-    }
+    , async_(async)
+    , flushIntervalMs_(flushIntervalMs)
+    , flushBytes_(flushBytes)
+    , sink_(std::make_unique<FileSink>(filename, rotate, maxSize, async, flushIntervalMs, flushBytes))
+    , buffer_(record_format::TYPICAL_CAPACITY) {}
+
+FileDisplay::~FileDisplay() = default;
+
+bool FileDisplay::isOpen() const {
+    if (uring_) return uring_->isOpen();
+    if (mmap_) return mmap_->isOpen();
+    return sink_->isOpen();
 }
 
-FileDisplay::~FileDisplay() {
-    if (file_.is_open()) {
-        file_.close();
+void FileDisplay::write(size_t length) {
+    if (uring_) {
+        uring_->append(buffer_.data(), length);
+    } else if (mmap_) {
+        mmap_->append(buffer_.data(), length);
+    } else {
+        sink_->append(buffer_.data(), length);
     }
 }
 
-std::string FileDisplay::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+void FileDisplay::showPoint(const GpsPoint& point) {
+    if (!isOpen()) return;
     
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&now_time_t), "%Y%m%d_%H%M%S");
-    ss << "_" << std::setfill('0') << std::setw(3) << now_ms.count();
-    return ss.str();
+    size_t length = record_format::render(buffer_, [&](char* out, size_t capacity) {
+        return record_format::formatPoint(point, out, capacity);
+    });
+    write(length);
 }
 
-void FileDisplay::rotateFile() {
-    if (!rotate_) return;
+void FileDisplay::showInvalidFix(unsigned long long timestamp) {
+    if (!isOpen()) return;
     
-    if (file_.is_open()) {
-        file_.close();
-    }
+    size_t length = record_format::render(buffer_, [&](char* out, size_t capacity) {
+        return record_format::formatInvalidFix(timestamp, out, capacity);
+    });
+    write(length);
+}
+
+void FileDisplay::showParseError(const std::string& error) {
+    if (!isOpen()) return;
     
-    // Создаем новый файл с временной меткой
-    std::string newFilename = filename_ + "." + getCurrentTimestamp();
-    std::filesystem::rename(filename_, newFilename);
+    size_t length = record_format::render(buffer_, [&](char* out, size_t capacity) {
+        return record_format::formatParseError(error, out, capacity);
+    });
+    write(length);
+}
+
+void FileDisplay::showRejected(const std::string& reason) {
+    if (!isOpen()) return;
     
-    // Открываем новый файл
-    file_.open(filename_, std::ios::app);
-    currentSize_ = 0;
+    size_t length = record_format::render(buffer_, [&](char* out, size_t capacity) {
+        return record_format::formatRejected(reason, out, capacity);
+    });
+    write(length);
 }
 
-void FileDisplay::checkRotation() {
-    if (!rotate_ || !file_.is_open()) return;
+void FileDisplay::showEvent(const GpsEvent& event) {
+    if (!isOpen()) return;
     
-    currentSize_ = file_.tellp();
-    if (currentSize_ >= maxSize_) {
-        rotateFile();
+    size_t length = record_format::render(buffer_, [&](char* out, size_t capacity) {
+        return record_format::formatEvent(event, out, capacity);
+    });
+    write(length);
+}
+
+void FileDisplay::clear() {
+    if (uring_) {
+        uring_->truncate();
+    } else if (mmap_) {
+        mmap_->truncate();
+    } else {
+        sink_->truncate();
     }
 }
 
-std::string FileDisplay::formatTime(unsigned long long timestampMs) const {
-    unsigned long long seconds = timestampMs / 1000;
-    int hours = seconds / 3600;
-    int minutes = (seconds % 3600) / 60;
-    int secs = seconds % 60;
-    
-    std::ostringstream oss;
-    oss << std::setfill('0') << std::setw(2) << hours << ":"
-        << std::setw(2) << minutes << ":"
-        << std::setw(2) << secs;
-    return oss.str();
+void FileDisplay::flush() {
+    if (uring_) {
+        uring_->flush();
+    } else if (mmap_) {
+        mmap_->flush();
+    } else {
+        sink_->flush();
+    }
 }
 
-std::string FileDisplay::formatLatitude(double lat) const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(5) << std::fabs(lat);
-    oss << (lat >= 0 ? "°N" : "°S");
-    return oss.str();
+bool FileDisplay::enableUring(unsigned queueDepth) {
+    // Размер буфера кольца - тот же порог, что у асинхронного FileSink
+    auto uring = UringSink::create(filename_, rotate_, maxSize_, queueDepth, flushBytes_);
+    if (!uring) {
+        std::cerr << "Warning: io_uring is not available, using write(2) for " << filename_ << "\n";
+        return false;
+    }
+    // Старый sink закрывается до первой записи через кольцо
+    sink_.reset();
+    uring_ = std::move(uring);
+    return true;
 }
 
-std::string FileDisplay::formatLongitude(double lon) const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(5) << std::fabs(lon);
-    oss << (lon >= 0 ? "°E" : "°W");
-    return oss.str();
+bool FileDisplay::enableMmap() {
+    // Файл открыт FileSink: закрываем до отображения, чтобы не было двух писателей
+    sink_.reset();
+    mmap_ = std::make_unique<MmapSink>(filename_, rotate_, maxSize_);
+    if (mmap_->isOpen()) {
+        return true;
+    }
+    std::cerr << "Warning: cannot map " << filename_ << ", using write(2)\n";
+    mmap_.reset();
+    sink_ = std::make_unique<FileSink>(filename_, rotate_, maxSize_, async_, flushIntervalMs_, flushBytes_);
+    return false;
 }
 
-void FileDisplay::showPoint(const GpsPoint& point) {
-    if (!file_.is_open()) return;
-    
-    checkRotation();
-    
-    file_ << "[" << formatTime(point.timestamp) << "] "
-          << "Coordinates: " << formatLatitude(point.latitude) << ", " << formatLongitude(point.longitude) << "\n"
-          << "               Speed: " << std::fixed << std::setprecision(1) << point.speed << " km/h";
-    
-    if (point.speed < 0.1) {
-        file_ << " (stopped)";
+void FileDisplay::enableCompression(int level, size_t retainFiles, size_t retainBytes) {
+    compressor_ = std::make_unique<SegmentCompressor>(filename_, level, 8, retainFiles, retainBytes);
+    SegmentCompressor* compressor = compressor_.get();
+    auto callback = [compressor](const std::string& segment) {
+        compressor->submit(segment);
+    };
+    if (uring_) {
+        uring_->setRotationCallback(callback);
+    } else if (mmap_) {
+        mmap_->setRotationCallback(callback);
+    } else {
+        sink_->setRotationCallback(callback);
     }
-    
-    file_ << ", Course: " << std::fixed << std::setprecision(1) << point.course << "°\n"
-          << "               Altitude: " << std::fixed << std::setprecision(0) << point.altitude << "m"
-          << ", Satellites: " << point.satellites
-          << ", HDOP: " << std::fixed << std::setprecision(1) << point.hdop << "\n";
-    
-    file_.flush();
 }
 
-void FileDisplay::showInvalidFix(unsigned long long timestamp) {
-    if (!file_.is_open()) return;
-    
-    checkRotation();
-    file_ << "[" << formatTime(timestamp) << "] No valid GPS fix\n";
-    file_.flush();
+const FileSink& FileDisplay::getSink() const {
+    return *sink_;
 }
 
-void FileDisplay::showParseError(const std::string& error) {
-    if (!file_.is_open()) return;
-    
-    checkRotation();
-    file_ << "Parse error: " << error << "\n";
-    file_.flush();
+const UringSink* FileDisplay::getUringSink() const {
+    return uring_.get();
 }
 
-void FileDisplay::showRejected(const std::string& reason) {
-    if (!file_.is_open()) return;
-    
-    checkRotation();
-    file_ << "Point rejected: " << reason << "\n";
-    file_.flush();
+const MmapSink* FileDisplay::getMmapSink() const {
+    return mmap_.get();
 }
 
-void FileDisplay::clear() {
-    if (file_.is_open()) {
-        file_.close();
-        file_.open(filename_, std::ios::trunc);
-        currentSize_ = 0;
-    }
-}
\ No newline at end of file
+const SegmentCompressor* FileDisplay::getCompressor() const {
+    return compressor_.get();
+}
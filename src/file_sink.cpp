@@ -0,0 +1,263 @@
+#include "file_sink.h"
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Предел буфера асинхронного режима в единицах flushBytes
+    const size_t MAX_BUFFERED_FLUSHES = 4;
+}
+
+FileSink::FileSink(const std::string& filename, bool rotate, size_t maxSize,
+                   bool async, unsigned flushIntervalMs, size_t flushBytes)
+    : filename_(filename)
+    , rotate_(rotate)
+    , maxSize_(maxSize)
+    , async_(async)
+    , flushIntervalMs_(flushIntervalMs > 0 ? flushIntervalMs : 1)
+    , flushBytes_(flushBytes > 0 ? flushBytes : 1) {
+    
+    openFile();
+    if (fd_ < 0) {
+        std::cerr << "Warning: Cannot open file " << filename << " for writing\n";
+        return;
+    }
+    open_ = true;
+    pendingSize_ = fileSize_;
+    
+    if (async_) {
+        front_.reserve(flushBytes_ * 2);
+        back_.reserve(flushBytes_ * 2);
+        thread_ = std::thread(&FileSink::run, this);
+    }
+}
+
+FileSink::~FileSink() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void FileSink::openFile() {
+    fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    fileSize_ = 0;
+    struct stat st;
+    if (fd_ >= 0 && ::fstat(fd_, &st) == 0) {
+        fileSize_ = static_cast<size_t>(st.st_size);
+    }
+}
+
+std::string FileSink::getCurrentTimestamp() {
+    auto now = std::chrono::system_clock::now();
+    auto now_time_t = std::chrono::system_clock::to_time_t(now);
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()) % 1000;
+    
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&now_time_t), "%Y%m%d_%H%M%S");
+    ss << "_" << std::setfill('0') << std::setw(3) << now_ms.count();
+    return ss.str();
+}
+
+std::string FileSink::rotatedName(const std::string& filename) {
+    std::string name = filename + "." + getCurrentTimestamp();
+    // Несколько ротаций из одного буфера попадают в одну миллисекунду;
+    // отложенный файл мог быть уже сжат (SegmentCompressor)
+    std::error_code ec;
+    for (int n = 1; std::filesystem::exists(name, ec) || std::filesystem::exists(name + ".gz", ec); n++) {
+        name = filename + "." + getCurrentTimestamp() + "." + std::to_string(n);
+    }
+    return name;
+}
+
+void FileSink::rotateFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    
+    // Создаем новый файл с временной меткой
+    std::string newFilename = rotatedName(filename_);
+    std::error_code ec;
+    std::filesystem::rename(filename_, newFilename, ec);
+    
+    openFile();
+    if (fileSize_ == 0) {
+        writeAll(header_.data(), header_.size());
+    }
+    if (!ec && onRotate_) {
+        onRotate_(newFilename);
+    }
+}
+
+void FileSink::writeAll(const char* data, size_t size) {
+    while (size > 0 && fd_ >= 0) {
+        ssize_t n = ::write(fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Warning: write to " << filename_ << " failed\n";
+            return;
+        }
+        writeCount_++;
+        bytesWritten_ += static_cast<size_t>(n);
+        fileSize_ += static_cast<size_t>(n);
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+void FileSink::writeBuffer(const std::string& buffer, const std::vector<size_t>& rotations) {
+    size_t start = 0;
+    for (size_t offset : rotations) {
+        writeAll(buffer.data() + start, offset - start);
+        rotateFile();
+        start = offset;
+    }
+    writeAll(buffer.data() + start, buffer.size() - start);
+}
+
+void FileSink::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait_for(lock, std::chrono::milliseconds(flushIntervalMs_), [this] {
+            return stop_ || flushRequested_ || front_.size() >= flushBytes_;
+        });
+        
+        // Меняем буферы: пайплайн продолжает писать в пустой, пока этот уходит в файл
+        front_.swap(back_);
+        frontRotations_.swap(backRotations_);
+        space_.notify_all();
+        const unsigned long long target = appendedBytes_;
+        const bool last = stop_;
+        flushRequested_ = false;
+        lock.unlock();
+        
+        writeBuffer(back_, backRotations_);
+        back_.clear();
+        backRotations_.clear();
+        
+        lock.lock();
+        writtenBytes_ = target;
+        written_.notify_all();
+        if (last) break;
+    }
+}
+
+bool FileSink::isOpen() const {
+    return open_;
+}
+
+bool FileSink::isAsync() const {
+    return async_;
+}
+
+void FileSink::setHeader(const std::string& header) {
+    header_ = header;
+    if (!open_) return;
+    
+    bool empty;
+    if (async_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        empty = pendingSize_ == 0;
+    } else {
+        empty = fileSize_ == 0;
+    }
+    if (empty) {
+        append(header_);
+    }
+}
+
+void FileSink::setRotationCallback(std::function<void(const std::string&)> callback) {
+    onRotate_ = std::move(callback);
+}
+
+void FileSink::append(const char* data, size_t size) {
+    if (!open_) return;
+    
+    if (!async_) {
+        if (rotate_ && fileSize_ >= maxSize_) {
+            rotateFile();
+        }
+        writeAll(data, size);
+        return;
+    }
+    
+    bool full = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Запись больше предела целиком проходит в пустой буфер
+        const size_t limit = flushBytes_ * MAX_BUFFERED_FLUSHES;
+        if (!front_.empty() && front_.size() + size > limit) {
+            blockedCount_++;
+            wake_.notify_one();
+            space_.wait(lock, [this, size, limit] {
+                return front_.empty() || front_.size() + size <= limit;
+            });
+        }
+        if (rotate_ && pendingSize_ >= maxSize_) {
+            frontRotations_.push_back(front_.size());
+            pendingSize_ = header_.size();   // заголовок пишет rotateFile()
+        }
+        front_.append(data, size);
+        pendingSize_ += size;
+        appendedBytes_ += size;
+        full = front_.size() >= flushBytes_;
+    }
+    if (full) {
+        wake_.notify_one();
+    }
+}
+
+void FileSink::append(const std::string& record) {
+    append(record.data(), record.size());
+}
+
+void FileSink::flush() {
+    if (!async_ || !open_) return;
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    const unsigned long long target = appendedBytes_;
+    if (writtenBytes_ >= target) return;
+    flushRequested_ = true;
+    wake_.notify_one();
+    written_.wait(lock, [this, target] { return writtenBytes_ >= target; });
+}
+
+void FileSink::truncate() {
+    if (!open_) return;
+    
+    // После flush() фоновый поток простаивает: новых данных нет
+    flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (::ftruncate(fd_, 0) == 0) {
+        fileSize_ = 0;
+        writeAll(header_.data(), header_.size());
+        pendingSize_ = fileSize_;
+    }
+}
+
+size_t FileSink::getWriteCount() const {
+    return writeCount_;
+}
+
+size_t FileSink::getBytesWritten() const {
+    return bytesWritten_;
+}
+
+size_t FileSink::getBlockedCount() const {
+    return blockedCount_;
+}
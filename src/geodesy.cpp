@@ -0,0 +1,82 @@
+#include "geodesy.h"
+
+namespace geo {
+
+double haversineDistance(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * M_PI / 180.0;
+    double phi2 = lat2 * M_PI / 180.0;
+    double lambda1 = lon1 * M_PI / 180.0;
+    double lambda2 = lon2 * M_PI / 180.0;
+    
+    double dlat = phi2 - phi1;
+    double dlon = lambda2 - lambda1;
+    
+    double a = std::sin(dlat/2) * std::sin(dlat/2) +
+               std::cos(phi1) * std::cos(phi2) *
+               std::sin(dlon/2) * std::sin(dlon/2);
+    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
+    
+    return EARTH_RADIUS * c;
+}
+
+double initialBearing(double lat1, double lon1, double lat2, double lon2) {
+    double phi1 = lat1 * M_PI / 180.0;
+    double phi2 = lat2 * M_PI / 180.0;
+    double dlon = lon2 * M_PI / 180.0 - lon1 * M_PI / 180.0;
+    
+    double y = std::sin(dlon) * std::cos(phi2);
+    double x = std::cos(phi1) * std::sin(phi2) -
+               std::sin(phi1) * std::cos(phi2) * std::cos(dlon);
+    double bearing = std::atan2(y, x) * 180.0 / M_PI;
+    
+    if (bearing < 0.0) bearing += 360.0;
+    return bearing >= 360.0 ? 0.0 : bearing;
+}
+
+void DistanceReference::set(double lat, double lon) {
+    latitude_ = lat;
+    longitude_ = lon;
+    cosLat_ = std::cos(lat * DEG_TO_RAD);
+    absSinLat_ = std::fabs(std::sin(lat * DEG_TO_RAD));
+    set_ = true;
+}
+
+bool DistanceReference::exceeds(double lat, double lon, double thresholdMeters) const {
+    if (set_ && thresholdMeters > 0.0) {
+        // Разности в радианах; долгота приводится к [-pi, pi], что не меняет
+        // гаверсинус (sin^2 периодичен с периодом pi по половинному углу)
+        double dlonDeg = lon - longitude_;
+        if (dlonDeg > 180.0) dlonDeg -= 360.0;
+        else if (dlonDeg < -180.0) dlonDeg += 360.0;
+        const double a = (lat - latitude_) * DEG_TO_RAD;
+        const double b = dlonDeg * DEG_TO_RAD;
+        const double a2 = a * a;
+        const double b2 = b * b;
+        
+        // Квадрат центрального угла в плоском приближении
+        const double planar = a2 + cosLat_ * cosLat_ * b2;
+        
+        // Граница |theta^2 - planar|:
+        //  - cos(lat1)cos(lat2) заменен на cos^2(lat1): |cos2 - cos1| <= |a|(|sin1| + |a|/2);
+        //  - x^2 - x^4/12 <= 4 hav(x) <= x^2 для a, b и самого угла theta,
+        //    причем theta^2 <= (pi^2/4) (a^2 + b^2).
+        // Суммарные члены четвертого порядка не превышают (a^2 + b^2)^2.
+        const double s = a2 + b2;
+        double bound = b2 * std::fabs(a) * (absSinLat_ + std::fabs(a)) + s * s;
+        
+        // Запас на округление в самой формуле гаверсинуса: относительный
+        // (sin, cos, atan2) и абсолютный - она вычитает широты и долготы,
+        // уже переведенные в радианы, с ошибкой порядка 1e-15 радиана
+        const double t = thresholdMeters / EARTH_RADIUS;
+        const double t2 = t * t;
+        const double absError = 4e-15;
+        bound += 1e-8 * t2 + 2.0 * absError * (std::fabs(a) + std::fabs(b)) + 4.0 * absError * absError;
+        
+        if (planar - bound > t2) return true;
+        if (planar + bound < t2) return false;
+    }
+    // Порог внутри границы погрешности (или вырожденный случай) - точный расчет
+    return haversineDistance(latitude_, longitude_, lat, lon) > thresholdMeters;
+}
+
+}
@@ -0,0 +1,13 @@
+// Собирается с -mavx2 -mfma; вызывается только после проверки процессора
+#include "geodesy_simd.h"
+
+namespace geo {
+namespace simd {
+
+const BatchKernels& avx2Kernels() {
+    static const BatchKernels kernels = Kernels<Avx2Ops>::table();
+    return kernels;
+}
+
+}
+}
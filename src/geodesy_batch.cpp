@@ -0,0 +1,145 @@
+#include "geodesy_batch.h"
+#include "geodesy.h"
+#include "geodesy_simd.h"
+
+namespace geo {
+
+namespace {
+    // Скалярный уровень: стандартная библиотека, результат совпадает
+    // с geo::haversineDistance и geo::initialBearing
+    void scalarHaversine(const double* lat1, const double* lon1,
+                         const double* lat2, const double* lon2, double* out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = haversineDistance(lat1[i], lon1[i], lat2[i], lon2[i]);
+        }
+    }
+    
+    void scalarBearing(const double* lat1, const double* lon1,
+                       const double* lat2, const double* lon2, double* out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = initialBearing(lat1[i], lon1[i], lat2[i], lon2[i]);
+        }
+    }
+    
+    void scalarSinCos(const double* x, double* sinOut, double* cosOut, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            sinOut[i] = std::sin(x[i]);
+            cosOut[i] = std::cos(x[i]);
+        }
+    }
+    
+    void scalarAtan2(const double* y, const double* x, double* out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = std::atan2(y[i], x[i]);
+        }
+    }
+    
+    const simd::BatchKernels SCALAR_KERNELS{scalarHaversine, scalarBearing, scalarSinCos, scalarAtan2};
+    
+    const simd::BatchKernels& kernelsFor(SimdLevel level) {
+        switch (level) {
+#if defined(GEO_HAVE_AVX2)
+            case SimdLevel::AVX2:
+                return simd::avx2Kernels();
+#endif
+#if defined(__SSE2__)
+            case SimdLevel::SSE2: {
+                static const simd::BatchKernels kernels = simd::Kernels<simd::Sse2Ops>::table();
+                return kernels;
+            }
+#endif
+            default:
+                return SCALAR_KERNELS;
+        }
+    }
+    
+    SimdLevel& currentLevel() {
+        static SimdLevel level = detectSimdLevel();
+        return level;
+    }
+    
+    const simd::BatchKernels*& activePtr() {
+        static const simd::BatchKernels* kernels = &kernelsFor(currentLevel());
+        return kernels;
+    }
+    
+    // Размер промежуточного буфера для trackLength (на стеке)
+    constexpr size_t CHUNK = 256;
+}
+
+SimdLevel detectSimdLevel() {
+#if defined(GEO_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+#if defined(__SSE2__)
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel getSimdLevel() {
+    return currentLevel();
+}
+
+void setSimdLevel(SimdLevel level) {
+    SimdLevel best = detectSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(best)) {
+        level = best;
+    }
+    currentLevel() = level;
+    activePtr() = &kernelsFor(level);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE2: return "SSE2";
+        default: return "scalar";
+    }
+}
+
+void haversineBatch(const double* lat1, const double* lon1,
+                    const double* lat2, const double* lon2,
+                    double* out, size_t n) {
+    activePtr()->haversine(lat1, lon1, lat2, lon2, out, n);
+}
+
+void bearingBatch(const double* lat1, const double* lon1,
+                  const double* lat2, const double* lon2,
+                  double* out, size_t n) {
+    activePtr()->bearing(lat1, lon1, lat2, lon2, out, n);
+}
+
+void consecutiveDistances(const double* lat, const double* lon, double* out, size_t n) {
+    if (n < 2) return;
+    // Пары (i, i + 1) - это те же массивы, сдвинутые на один элемент
+    activePtr()->haversine(lat, lon, lat + 1, lon + 1, out, n - 1);
+}
+
+double trackLength(const double* lat, const double* lon, size_t n) {
+    if (n < 2) return 0.0;
+    double buffer[CHUNK];
+    double total = 0.0;
+    for (size_t start = 0; start + 1 < n; start += CHUNK) {
+        size_t count = n - 1 - start < CHUNK ? n - 1 - start : CHUNK;
+        activePtr()->haversine(lat + start, lon + start, lat + start + 1, lon + start + 1, buffer, count);
+        for (size_t i = 0; i < count; i++) {
+            total += buffer[i];
+        }
+    }
+    return total;
+}
+
+void sinCosBatch(const double* x, double* sinOut, double* cosOut, size_t n) {
+    activePtr()->sinCos(x, sinOut, cosOut, n);
+}
+
+void atan2Batch(const double* y, const double* x, double* out, size_t n) {
+    activePtr()->atan2(y, x, out, n);
+}
+
+}
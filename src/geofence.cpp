@@ -0,0 +1,242 @@
+#include "geofence.h"
+#include "geo_util.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+    // Зона, покрывающая больше ячеек, не раскладывается по сетке
+    const long long MAX_CELLS_PER_ZONE = 4096;
+}
+
+bool GeofenceZone::contains(double lat, double lon) const {
+    if (lat < minLatitude || lat > maxLatitude || lon < minLongitude || lon > maxLongitude) {
+        return false;
+    }
+    
+    bool inside = false;
+    size_t start = 0;
+    for (size_t end : ringEnds) {
+        for (size_t i = start, j = end - 1; i < end; j = i++) {
+            double yi = latitudes[i];
+            double yj = latitudes[j];
+            if ((yi > lat) != (yj > lat)) {
+                double x = longitudes[i] + (lat - yi) * (longitudes[j] - longitudes[i]) / (yj - yi);
+                if (lon < x) {
+                    inside = !inside;
+                }
+            }
+        }
+        start = end;
+    }
+    return inside;
+}
+
+double GeofenceZone::edgeDistance(double lat, double lon, double lonScale) const {
+    double best = std::numeric_limits<double>::infinity();
+    const double px = lon * lonScale;
+    size_t start = 0;
+    for (size_t end : ringEnds) {
+        for (size_t i = start, j = end - 1; i < end; j = i++) {
+            double d2 = geo::segmentDistance2(px, lat,
+                                         longitudes[j] * lonScale, latitudes[j],
+                                         longitudes[i] * lonScale, latitudes[i]);
+            best = std::min(best, d2);
+        }
+        start = end;
+    }
+    return std::sqrt(best);
+}
+
+double GeofenceZone::boxDistance(double lat, double lon, double lonScale) const {
+    double dy = std::max({0.0, minLatitude - lat, lat - maxLatitude});
+    double dx = std::max({0.0, minLongitude - lon, lon - maxLongitude}) * lonScale;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+GeofenceIndex::GeofenceIndex(double cellSizeDegrees)
+    : cellSize_(cellSizeDegrees > 0.0 ? cellSizeDegrees : 0.01) {}
+
+bool GeofenceIndex::parseWkt(const std::string& wkt, GeofenceZone& zone) {
+    size_t pos = 0;
+    while (pos < wkt.size() && std::isspace(static_cast<unsigned char>(wkt[pos]))) pos++;
+    size_t wordEnd = pos;
+    while (wordEnd < wkt.size() && std::isalpha(static_cast<unsigned char>(wkt[wordEnd]))) wordEnd++;
+    std::string keyword = wkt.substr(pos, wordEnd - pos);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                   [](unsigned char c) { return std::toupper(c); });
+    if (keyword != "POLYGON" && keyword != "MULTIPOLYGON") {
+        return false;
+    }
+    
+    zone.longitudes.clear();
+    zone.latitudes.clear();
+    zone.ringEnds.clear();
+    
+    // Вершины читаются парами "x y"; закрывающая скобка завершает кольцо
+    const char* p = wkt.c_str() + wordEnd;
+    const char* end = wkt.c_str() + wkt.size();
+    size_t ringStart = 0;
+    int depth = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '(') {
+            depth++;
+            p++;
+        } else if (c == ')') {
+            if (zone.longitudes.size() > ringStart) {
+                // Повтор первой вершины в конце кольца не нужен
+                size_t last = zone.longitudes.size() - 1;
+                if (last > ringStart &&
+                    zone.longitudes[last] == zone.longitudes[ringStart] &&
+                    zone.latitudes[last] == zone.latitudes[ringStart]) {
+                    zone.longitudes.pop_back();
+                    zone.latitudes.pop_back();
+                }
+                if (zone.longitudes.size() - ringStart < 3) {
+                    return false;
+                }
+                zone.ringEnds.push_back(zone.longitudes.size());
+                ringStart = zone.longitudes.size();
+            }
+            depth--;
+            p++;
+        } else if (c == ',' || std::isspace(static_cast<unsigned char>(c))) {
+            p++;
+        } else {
+            if (depth <= 0) return false;
+            char* next = nullptr;
+            double x = std::strtod(p, &next);
+            if (next == p) return false;
+            p = next;
+            double y = std::strtod(p, &next);
+            if (next == p) return false;
+            p = next;
+            zone.longitudes.push_back(x);
+            zone.latitudes.push_back(y);
+        }
+    }
+    
+    if (depth != 0 || zone.ringEnds.empty() || zone.longitudes.size() != ringStart) {
+        return false;
+    }
+    
+    auto lat = std::minmax_element(zone.latitudes.begin(), zone.latitudes.end());
+    auto lon = std::minmax_element(zone.longitudes.begin(), zone.longitudes.end());
+    zone.minLatitude = *lat.first;
+    zone.maxLatitude = *lat.second;
+    zone.minLongitude = *lon.first;
+    zone.maxLongitude = *lon.second;
+    return true;
+}
+
+std::uint64_t GeofenceIndex::cellKey(long long ix, long long iy) const {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(ix)) << 32) |
+           static_cast<std::uint32_t>(iy);
+}
+
+bool GeofenceIndex::addZone(const std::string& name, const std::string& wkt) {
+    GeofenceZone zone;
+    if (!parseWkt(wkt, zone)) {
+        return false;
+    }
+    zone.name = name;
+    addZone(std::move(zone));
+    return true;
+}
+
+void GeofenceIndex::addZone(GeofenceZone zone) {
+    const auto id = static_cast<std::uint32_t>(zones_.size());
+    long long x0 = static_cast<long long>(std::floor(zone.minLongitude / cellSize_));
+    long long x1 = static_cast<long long>(std::floor(zone.maxLongitude / cellSize_));
+    long long y0 = static_cast<long long>(std::floor(zone.minLatitude / cellSize_));
+    long long y1 = static_cast<long long>(std::floor(zone.maxLatitude / cellSize_));
+    
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_ZONE) {
+        largeZones_.push_back(id);
+    } else {
+        for (long long ix = x0; ix <= x1; ix++) {
+            for (long long iy = y0; iy <= y1; iy++) {
+                cells_[cellKey(ix, iy)].push_back(id);
+            }
+        }
+    }
+    zones_.push_back(std::move(zone));
+}
+
+bool GeofenceIndex::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        
+        size_t sep = line.find('\t');
+        if (sep == std::string::npos) sep = line.find(';');
+        if (sep == std::string::npos || !addZone(line.substr(first, sep - first), line.substr(sep + 1))) {
+            skippedLines_++;
+        }
+    }
+    
+    if (skippedLines_ > 0) {
+        std::cerr << "Warning: " << skippedLines_ << " invalid zone(s) skipped in " << filename << "\n";
+    }
+    return true;
+}
+
+void GeofenceIndex::clear() {
+    zones_.clear();
+    cells_.clear();
+    largeZones_.clear();
+    skippedLines_ = 0;
+}
+
+size_t GeofenceIndex::size() const {
+    return zones_.size();
+}
+
+const GeofenceZone& GeofenceIndex::getZone(size_t index) const {
+    return zones_[index];
+}
+
+double GeofenceIndex::getCellSize() const {
+    return cellSize_;
+}
+
+size_t GeofenceIndex::getSkippedLines() const {
+    return skippedLines_;
+}
+
+GeofenceIndex::Cell GeofenceIndex::cellAt(double lat, double lon) const {
+    long long ix = static_cast<long long>(std::floor(lon / cellSize_));
+    long long iy = static_cast<long long>(std::floor(lat / cellSize_));
+    
+    Cell cell;
+    cell.minLongitude = ix * cellSize_;
+    cell.maxLongitude = (ix + 1) * cellSize_;
+    cell.minLatitude = iy * cellSize_;
+    cell.maxLatitude = (iy + 1) * cellSize_;
+    
+    auto it = cells_.find(cellKey(ix, iy));
+    if (it != cells_.end()) {
+        cell.zones = &it->second;
+    }
+    return cell;
+}
+
+const std::vector<std::uint32_t>& GeofenceIndex::largeZones() const {
+    return largeZones_;
+}
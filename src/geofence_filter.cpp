@@ -0,0 +1,173 @@
+#include "geofence_filter.h"
+#include "display_interface.h"
+#include "geodesy.h"
+#include "gps_time.h"
+#include <algorithm>
+
+using gps_time::elapsedMs;
+
+GeofenceFilter::GeofenceFilter(double cellSizeDegrees, double dwellSeconds)
+    : enabled_(true)
+    , dwellMs_(static_cast<unsigned long long>(dwellSeconds * 1000.0))
+    , index_(cellSizeDegrees) {}
+
+bool GeofenceFilter::loadZones(const std::string& filename) {
+    reset();
+    return index_.loadFromFile(filename);
+}
+
+GeofenceIndex& GeofenceFilter::getIndex() {
+    // Индекс может измениться - кэш больше недействителен
+    cacheValid_ = false;
+    return index_;
+}
+
+void GeofenceFilter::reset() {
+    inside_.clear();
+    cacheValid_ = false;
+}
+
+void GeofenceFilter::testZones(const std::vector<std::uint32_t>& zones, double lat, double lon,
+                               double lonScale, double& radius) {
+    for (std::uint32_t id : zones) {
+        const GeofenceZone& zone = index_.getZone(id);
+        // Ребра зоны не ближе ее прямоугольника: дальние зоны не влияют на радиус.
+        // Строгое сравнение: при нулевом радиусе (точка на границе ячейки)
+        // зоны, содержащие точку, все равно проверяются
+        if (zone.boxDistance(lat, lon, lonScale) > radius) {
+            continue;
+        }
+        if (zone.contains(lat, lon)) {
+            scratch_.push_back(id);
+        }
+        radius = std::min(radius, zone.edgeDistance(lat, lon, lonScale));
+    }
+}
+
+void GeofenceFilter::evaluate(const GpsPoint& point) {
+    evaluations_++;
+    const double lat = point.latitude;
+    const double lon = point.longitude;
+    const double lonScale = std::cos(lat * geo::DEG_TO_RAD);
+    
+    // Радиус не выходит за ячейку: за ее пределами другие кандидаты
+    GeofenceIndex::Cell cell = index_.cellAt(lat, lon);
+    double radius = std::min({lat - cell.minLatitude, cell.maxLatitude - lat,
+                              (lon - cell.minLongitude) * lonScale,
+                              (cell.maxLongitude - lon) * lonScale});
+    radius = std::max(radius, 0.0);
+    
+    scratch_.clear();
+    if (cell.zones) {
+        testZones(*cell.zones, lat, lon, lonScale, radius);
+    }
+    testZones(index_.largeZones(), lat, lon, lonScale, radius);
+    std::sort(scratch_.begin(), scratch_.end());
+    
+    // Слияние старого и нового наборов: выходы, входы, сохранившиеся зоны
+    std::vector<Membership>& next = merged_;
+    next.clear();
+    size_t i = 0;
+    size_t j = 0;
+    while (i < inside_.size() || j < scratch_.size()) {
+        if (j == scratch_.size() || (i < inside_.size() && inside_[i].zone < scratch_[j])) {
+            emit(GpsEvent::Type::ZONE_EXIT, index_.getZone(inside_[i].zone), point,
+                 elapsedMs(inside_[i].enteredAt, point.timestamp));
+            i++;
+        } else if (i == inside_.size() || scratch_[j] < inside_[i].zone) {
+            emit(GpsEvent::Type::ZONE_ENTER, index_.getZone(scratch_[j]), point, 0);
+            next.push_back({scratch_[j], point.timestamp, false});
+            j++;
+        } else {
+            next.push_back(inside_[i]);
+            i++;
+            j++;
+        }
+    }
+    inside_.swap(next);
+    
+    cacheValid_ = true;
+    cacheLatitude_ = lat;
+    cacheLongitude_ = lon;
+    cacheLonScale_ = lonScale;
+    safeRadius2_ = radius * radius;
+}
+
+FilterResult GeofenceFilter::process(GpsPoint& point, const GpsHistory& /*history*/) {
+    if (!enabled_ || !point.isValid) return FilterResult::PASS;
+    
+    // Внутри безопасного радиуса ни одно ребро не пересечено - набор зон прежний
+    bool unchanged = false;
+    if (cacheValid_) {
+        double dy = point.latitude - cacheLatitude_;
+        double dx = (point.longitude - cacheLongitude_) * cacheLonScale_;
+        unchanged = dx * dx + dy * dy < safeRadius2_;
+    }
+    if (!unchanged) {
+        evaluate(point);
+    }
+    
+    if (dwellMs_ > 0) {
+        for (auto& member : inside_) {
+            if (!member.dwellReported && elapsedMs(member.enteredAt, point.timestamp) >= dwellMs_) {
+                member.dwellReported = true;
+                emit(GpsEvent::Type::ZONE_DWELL, index_.getZone(member.zone), point,
+                     elapsedMs(member.enteredAt, point.timestamp));
+            }
+        }
+    }
+    
+    return FilterResult::PASS;
+}
+
+void GeofenceFilter::emit(GpsEvent::Type type, const GeofenceZone& zone, const GpsPoint& point,
+                          unsigned long long durationMs) {
+    if (!display_) return;
+    
+    GpsEvent event;
+    event.type = type;
+    event.source = getName();
+    event.subject = zone.name;
+    event.timestamp = point.timestamp;
+    event.latitude = point.latitude;
+    event.longitude = point.longitude;
+    event.durationMs = durationMs;
+    display_->showEvent(event);
+}
+
+void GeofenceFilter::setEnabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+bool GeofenceFilter::isEnabled() const {
+    return enabled_;
+}
+
+std::string GeofenceFilter::getName() const {
+    return "GeofenceFilter";
+}
+
+void GeofenceFilter::setDisplay(IDisplay* display) {
+    display_ = display;
+}
+
+void GeofenceFilter::setDwellTime(double seconds) {
+    dwellMs_ = static_cast<unsigned long long>(seconds * 1000.0);
+}
+
+double GeofenceFilter::getDwellTime() const {
+    return dwellMs_ / 1000.0;
+}
+
+std::vector<std::string> GeofenceFilter::getCurrentZones() const {
+    std::vector<std::string> names;
+    names.reserve(inside_.size());
+    for (const auto& member : inside_) {
+        names.push_back(index_.getZone(member.zone).name);
+    }
+    return names;
+}
+
+size_t GeofenceFilter::getEvaluationCount() const {
+    return evaluations_;
+}
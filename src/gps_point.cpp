@@ -1,6 +1,9 @@
 #include "gps_point.h"
+#include "gps_time.h"
 #include <cmath>
 #include <cstdio>
+#include <mutex>
+#include <unordered_set>
 
 std::string GpsPoint::toString() const {
     char buffer[256];
@@ -21,4 +24,74 @@ bool GpsPoint::operator==(const GpsPoint& other) const {
            std::fabs(hdop - other.hdop) < 0.1f &&
            timestamp == other.timestamp &&
            isValid == other.isValid;
-}
\ No newline at end of file
+}
+
+using gps_time::MS_PER_DAY;
+
+const char* internLabel(const char* text) {
+    if (!text || !*text) return nullptr;
+    static std::mutex mutex;
+    // Не освобождается при выходе: точки в статических объектах могут
+    // обращаться к подписям до самого конца. Узлы unordered_set не
+    // перемещаются при росте таблицы, указатели стабильны
+    static auto* labels = new std::unordered_set<std::string>();
+    std::lock_guard<std::mutex> lock(mutex);
+    return labels->emplace(text).first->c_str();
+}
+
+std::int64_t GpsPoint::dateMs() const {
+    return dateDay < 0 ? -1 : static_cast<std::int64_t>(dateDay) * static_cast<std::int64_t>(MS_PER_DAY);
+}
+
+void GpsPoint::setDateMs(std::int64_t dayStart) {
+    dateDay = dayStart < 0 ? -1 : static_cast<std::int32_t>(dayStart / static_cast<std::int64_t>(MS_PER_DAY));
+}
+
+namespace {
+    template <typename T>
+    T saturate(double value) {
+        long long rounded = std::llround(value);
+        if (rounded < 0) return 0;
+        if (rounded > 0xFFFF) return 0xFFFF;
+        return static_cast<T>(rounded);
+    }
+}
+
+PackedGpsPoint PackedGpsPoint::fromPoint(const GpsPoint& point) {
+    PackedGpsPoint packed;
+    packed.timestamp = static_cast<std::int64_t>(point.timestamp);
+    if (point.dateDay >= 0) {
+        packed.timestamp += point.dateMs();
+        packed.flags |= FLAG_EPOCH;
+    }
+    packed.latitudeE7 = static_cast<std::int32_t>(std::llround(point.latitude * 1e7));
+    packed.longitudeE7 = static_cast<std::int32_t>(std::llround(point.longitude * 1e7));
+    packed.altitudeCm = static_cast<std::int32_t>(std::llround(point.altitude * 100.0));
+    packed.speedCentiKmh = saturate<std::uint16_t>(point.speed * 100.0);
+    packed.courseCentiDeg = saturate<std::uint16_t>(point.course * 100.0);
+    packed.hdopCenti = saturate<std::uint16_t>(point.hdop * 100.0);
+    packed.satellites = static_cast<std::uint8_t>(point.satellites < 0 ? 0 :
+                                                  (point.satellites > 0xFF ? 0xFF : point.satellites));
+    if (point.isValid) {
+        packed.flags |= FLAG_VALID;
+    }
+    return packed;
+}
+
+GpsPoint PackedGpsPoint::toPoint() const {
+    GpsPoint point;
+    // GpsPoint хранит время от полуночи и отдельно дату
+    point.timestamp = static_cast<unsigned long long>(timestamp) % MS_PER_DAY;
+    if (hasEpochTime()) {
+        point.setDateMs(timestamp - static_cast<std::int64_t>(point.timestamp));
+    }
+    point.latitude = latitudeE7 / 1e7;
+    point.longitude = longitudeE7 / 1e7;
+    point.altitude = altitudeCm / 100.0;
+    point.speed = speedCentiKmh / 100.0;
+    point.course = courseCentiDeg / 100.0;
+    point.hdop = static_cast<float>(hdopCenti / 100.0);
+    point.satellites = satellites;
+    point.isValid = isValid();
+    return point;
+}
@@ -1,4 +1,22 @@
 #include "history.h"
+#include "geodesy.h"
+#include "gps_time.h"
+#include <algorithm>
+
+using gps_time::elapsedMs;
+
+namespace {
+    // Монотонная очередь: удаляем с конца значения, которые уже не могут
+    // стать экстремумом окна
+    template <typename Better>
+    void pushExtremum(std::deque<std::pair<unsigned long long, double>>& queue,
+                      unsigned long long seq, double value, Better better) {
+        while (!queue.empty() && !better(queue.back().second, value)) {
+            queue.pop_back();
+        }
+        queue.emplace_back(seq, value);
+    }
+}
 
 GpsHistory::GpsHistory(size_t maxSize) : maxSize_(maxSize) {}
 
@@ -6,30 +24,147 @@ GpsHistory::~GpsHistory() = default;
 
 void GpsHistory::addPoint(const GpsPoint& point) {
     std::lock_guard<std::mutex> lock(mutex_);
+    const unsigned long long seq = frontSeq_ + points_.size();
     points_.push_back(point);
-    if (points_.size() > maxSize_) {
-        points_.pop_front();
+    if (statsEnabled_) {
+        addStats(seq, lastValid_, lastValidSeq_);
+    }
+    if (point.isValid) {
+        lastValid_ = &points_.back();
+        lastValidSeq_ = seq;
     }
+    
+    trim(point.timestamp);
 }
 
-std::optional<GpsPoint> GpsHistory::getLastValid() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto it = points_.rbegin(); it != points_.rend(); ++it) {
-        if (it->isValid) {
-            return *it;
+void GpsHistory::addStats(unsigned long long seq, const GpsPoint* previous,
+                          unsigned long long previousSeq) const {
+    const GpsPoint& point = points_[seq - frontSeq_];
+    segmentOut_.push_back(0.0);
+    if (!point.isValid) return;
+    
+    if (previous) {
+        double segment = geo::haversineDistance(previous->latitude, previous->longitude,
+                                                point.latitude, point.longitude);
+        segmentOut_[previousSeq - frontSeq_] = segment;
+        distanceSum_ += segment;
+    }
+    validCount_++;
+    speedSum_ += point.speed;
+    pushExtremum(maxSpeed_, seq, point.speed, [](double a, double b) { return a > b; });
+    pushExtremum(maxAltitude_, seq, point.altitude, [](double a, double b) { return a > b; });
+    pushExtremum(minAltitude_, seq, point.altitude, [](double a, double b) { return a < b; });
+}
+
+void GpsHistory::rebuildStats() const {
+    resetStats();
+    const GpsPoint* previous = nullptr;
+    unsigned long long previousSeq = 0;
+    for (size_t i = 0; i < points_.size(); i++) {
+        addStats(frontSeq_ + i, previous, previousSeq);
+        if (points_[i].isValid) {
+            previous = &points_[i];
+            previousSeq = frontSeq_ + i;
+        }
+    }
+    statsEnabled_ = true;
+}
+
+void GpsHistory::resetStats() const {
+    segmentOut_.clear();
+    validCount_ = 0;
+    speedSum_ = 0.0;
+    distanceSum_ = 0.0;
+    maxSpeed_.clear();
+    maxAltitude_.clear();
+    minAltitude_.clear();
+}
+
+size_t GpsHistory::capacity() const {
+    return maxDurationMs_ > 0 ? std::max(maxSize_, MAX_WINDOW_POINTS) : maxSize_;
+}
+
+void GpsHistory::trim(unsigned long long newestTimestamp) {
+    while (points_.size() > capacity()) {
+        popFront();
+    }
+    if (maxDurationMs_ > 0) {
+        // Самую свежую точку не вытесняем
+        while (points_.size() > 1 &&
+               elapsedMs(points_.front().timestamp, newestTimestamp) > maxDurationMs_) {
+            popFront();
+        }
+    }
+}
+
+void GpsHistory::popFront() {
+    const GpsPoint& front = points_.front();
+    if (statsEnabled_ && front.isValid) {
+        validCount_--;
+        speedSum_ -= front.speed;
+        distanceSum_ -= segmentOut_.front();
+        for (auto* queue : {&maxSpeed_, &maxAltitude_, &minAltitude_}) {
+            if (!queue->empty() && queue->front().first == frontSeq_) {
+                queue->pop_front();
+            }
+        }
+        if (validCount_ == 0) {
+            // Сбрасываем накопленную ошибку округления
+            speedSum_ = 0.0;
+            distanceSum_ = 0.0;
         }
     }
+    if (lastValid_ == &front) {
+        lastValid_ = nullptr;
+    }
+    points_.pop_front();
+    if (statsEnabled_) {
+        segmentOut_.pop_front();
+    }
+    frontSeq_++;
+}
+
+std::optional<GpsPoint> GpsHistory::getLastValid() const {
+    const GpsPoint* last = getLastValidPtr();
+    if (last) {
+        return *last;
+    }
     return std::nullopt;
 }
 
+const GpsPoint* GpsHistory::getLastValidPtr() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastValid_;
+}
+
 std::deque<GpsPoint> GpsHistory::getAllPoints() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return points_;
 }
 
+HistoryStats GpsHistory::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!statsEnabled_) {
+        rebuildStats();
+    }
+    HistoryStats stats;
+    if (validCount_ == 0) return stats;
+    
+    stats.count = validCount_;
+    stats.distance = distanceSum_ > 0.0 ? distanceSum_ : 0.0;
+    stats.meanSpeed = speedSum_ / validCount_;
+    stats.maxSpeed = maxSpeed_.front().second;
+    stats.minAltitude = minAltitude_.front().second;
+    stats.maxAltitude = maxAltitude_.front().second;
+    return stats;
+}
+
 void GpsHistory::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
+    frontSeq_ += points_.size();
     points_.clear();
+    lastValid_ = nullptr;
+    resetStats();
 }
 
 size_t GpsHistory::size() const {
@@ -46,12 +181,25 @@ void GpsHistory::setMaxSize(size_t maxSize) {
     std::lock_guard<std::mutex> lock(mutex_);
     maxSize_ = maxSize;
     // Если текущий размер превышает новый максимум, удаляем лишние точки
-    while (points_.size() > maxSize_) {
-        points_.pop_front();
+    while (points_.size() > capacity()) {
+        popFront();
     }
 }
 
 size_t GpsHistory::getMaxSize() const {
     std::lock_guard<std::mutex> lock(mutex_);
     return maxSize_;
-}
\ No newline at end of file
+}
+
+void GpsHistory::setMaxDuration(unsigned long long durationMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxDurationMs_ = durationMs;
+    if (!points_.empty()) {
+        trim(points_.back().timestamp);
+    }
+}
+
+unsigned long long GpsHistory::getMaxDuration() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxDurationMs_;
+}
@@ -153,6 +153,37 @@ std::vector<std::string> JsonConfig::extractArray(const std::string& json, const
     return result;
 }
 
+void JsonConfig::parseParams(const std::string& json, std::map<std::string, double>& params,
+                             std::map<std::string, std::string>& stringParams) const {
+    for (const auto& [key, value] : extractObject(json)) {
+        if (!value.empty() && value[0] == '"') {
+            stringParams[key] = trim(value);
+            continue;
+        }
+        try {
+            params[key] = std::stod(trim(value));
+        } catch (...) {}
+    }
+}
+
+void JsonConfig::writeParams(std::ostream& out, const std::map<std::string, double>& params,
+                             const std::map<std::string, std::string>& stringParams) const {
+    size_t j = 0;
+    const size_t paramCount = params.size() + stringParams.size();
+    for (const auto& [key, value] : params) {
+        out << "        \"" << key << "\": " << value;
+        if (j < paramCount - 1) out << ",";
+        out << "\n";
+        j++;
+    }
+    for (const auto& [key, value] : stringParams) {
+        out << "        \"" << key << "\": \"" << value << "\"";
+        if (j < paramCount - 1) out << ",";
+        out << "\n";
+        j++;
+    }
+}
+
 bool JsonConfig::loadFromFile(const std::string& filename) {
     std::string json = readFile(filename);
     if (json.empty()) {
@@ -166,6 +197,9 @@ bool JsonConfig::loadFromFile(const std::string& filename) {
     auto it = root.find("historySize");
     if (it != root.end()) historySize_ = std::stoi(trim(it->second));
     
+    it = root.find("historyDuration");
+    if (it != root.end()) historyDuration_ = std::stod(trim(it->second));
+    
     it = root.find("displayType");
     if (it != root.end()) displayType_ = trim(it->second);
     
@@ -178,6 +212,45 @@ bool JsonConfig::loadFromFile(const std::string& filename) {
     it = root.find("maxFileSize");
     if (it != root.end()) maxFileSize_ = std::stoul(trim(it->second));
     
+    it = root.find("asyncOutput");
+    if (it != root.end()) asyncOutput_ = (trim(it->second) == "true");
+    
+    it = root.find("flushInterval");
+    if (it != root.end()) flushInterval_ = static_cast<unsigned>(std::stoul(trim(it->second)));
+    
+    it = root.find("flushBytes");
+    if (it != root.end()) flushBytes_ = std::stoul(trim(it->second));
+    
+    it = root.find("compressRotated");
+    if (it != root.end()) compressRotated_ = (trim(it->second) == "true");
+    
+    it = root.find("compressionLevel");
+    if (it != root.end()) compressionLevel_ = std::stoi(trim(it->second));
+    
+    it = root.find("retainFiles");
+    if (it != root.end()) retainFiles_ = std::stoul(trim(it->second));
+    
+    it = root.find("retainBytes");
+    if (it != root.end()) retainBytes_ = std::stoul(trim(it->second));
+    
+    it = root.find("ioBackend");
+    if (it != root.end()) ioBackend_ = trim(it->second);
+    
+    it = root.find("endpoint");
+    if (it != root.end()) endpoint_ = trim(it->second);
+    
+    it = root.find("networkFormat");
+    if (it != root.end()) networkFormat_ = trim(it->second);
+    
+    it = root.find("batchRecords");
+    if (it != root.end()) batchRecords_ = std::stoul(trim(it->second));
+    
+    it = root.find("lingerUs");
+    if (it != root.end()) lingerUs_ = static_cast<unsigned>(std::stoul(trim(it->second)));
+    
+    it = root.find("sendBufferBytes");
+    if (it != root.end()) sendBufferBytes_ = std::stoul(trim(it->second));
+    
     // Парсим фильтры
     filters_.clear();
     auto filterStrings = extractArray(json, "filters");
@@ -198,17 +271,53 @@ bool JsonConfig::loadFromFile(const std::string& filename) {
         // Парсим параметры
         fit = filterObj.find("params");
         if (fit != filterObj.end()) {
-            auto paramsObj = extractObject(fit->second);
-            for (const auto& [pkey, pvalue] : paramsObj) {
-                try {
-                    filter.params[pkey] = std::stod(trim(pvalue));
-                } catch (...) {}
-            }
+            parseParams(fit->second, filter.params, filter.stringParams);
         }
         
         filters_.push_back(filter);
     }
     
+    // Парсим стадии вывода
+    outputStages_.clear();
+    for (const auto& stageStr : extractArray(json, "outputStages")) {
+        auto stageObj = extractObject(stageStr);
+        StageConfig stage;
+        
+        auto sit = stageObj.find("type");
+        if (sit != stageObj.end()) stage.type = trim(sit->second);
+        
+        sit = stageObj.find("params");
+        if (sit != stageObj.end()) {
+            parseParams(sit->second, stage.params, stage.stringParams);
+        }
+        
+        outputStages_.push_back(stage);
+    }
+    
+    // Парсим дочерние выводы
+    sinks_.clear();
+    for (const auto& sinkStr : extractArray(json, "sinks")) {
+        auto sinkObj = extractObject(sinkStr);
+        SinkConfig sink;
+        
+        auto sit = sinkObj.find("type");
+        if (sit != sinkObj.end()) sink.type = trim(sit->second);
+        
+        sit = sinkObj.find("outputFile");
+        if (sit != sinkObj.end()) sink.outputFile = trim(sit->second);
+        
+        sit = sinkObj.find("events");
+        if (sit != sinkObj.end()) sink.events = trim(sit->second);
+        
+        sit = sinkObj.find("queueSize");
+        if (sit != sinkObj.end()) sink.queueSize = std::stoul(trim(sit->second));
+        
+        sit = sinkObj.find("endpoint");
+        if (sit != sinkObj.end()) sink.endpoint = trim(sit->second);
+        
+        sinks_.push_back(sink);
+    }
+    
     valid_ = true;
     return true;
 }
@@ -219,10 +328,24 @@ bool JsonConfig::saveToFile(const std::string& filename) const {
     
     file << "{\n";
     file << "  \"historySize\": " << historySize_ << ",\n";
+    file << "  \"historyDuration\": " << historyDuration_ << ",\n";
     file << "  \"displayType\": \"" << displayType_ << "\",\n";
     file << "  \"outputFile\": \"" << outputFile_ << "\",\n";
     file << "  \"fileRotation\": " << (fileRotation_ ? "true" : "false") << ",\n";
     file << "  \"maxFileSize\": " << maxFileSize_ << ",\n";
+    file << "  \"asyncOutput\": " << (asyncOutput_ ? "true" : "false") << ",\n";
+    file << "  \"flushInterval\": " << flushInterval_ << ",\n";
+    file << "  \"flushBytes\": " << flushBytes_ << ",\n";
+    file << "  \"compressRotated\": " << (compressRotated_ ? "true" : "false") << ",\n";
+    file << "  \"compressionLevel\": " << compressionLevel_ << ",\n";
+    file << "  \"retainFiles\": " << retainFiles_ << ",\n";
+    file << "  \"retainBytes\": " << retainBytes_ << ",\n";
+    file << "  \"ioBackend\": \"" << ioBackend_ << "\",\n";
+    file << "  \"endpoint\": \"" << endpoint_ << "\",\n";
+    file << "  \"networkFormat\": \"" << networkFormat_ << "\",\n";
+    file << "  \"batchRecords\": " << batchRecords_ << ",\n";
+    file << "  \"lingerUs\": " << lingerUs_ << ",\n";
+    file << "  \"sendBufferBytes\": " << sendBufferBytes_ << ",\n";
     file << "  \"filters\": [\n";
     
     for (size_t i = 0; i < filters_.size(); i++) {
@@ -233,13 +356,7 @@ bool JsonConfig::saveToFile(const std::string& filename) const {
         file << "      \"priority\": " << filter.priority << ",\n";
         file << "      \"params\": {\n";
         
-        size_t j = 0;
-        for (const auto& [key, value] : filter.params) {
-            file << "        \"" << key << "\": " << value;
-            if (j < filter.params.size() - 1) file << ",";
-            file << "\n";
-            j++;
-        }
+        writeParams(file, filter.params, filter.stringParams);
         
         file << "      }\n";
         file << "    }";
@@ -247,8 +364,45 @@ bool JsonConfig::saveToFile(const std::string& filename) const {
         file << "\n";
     }
     
-    file << "  ]\n";
-    file << "}\n";
+    file << "  ]";
+    
+    if (!outputStages_.empty()) {
+        file << ",\n  \"outputStages\": [\n";
+        for (size_t i = 0; i < outputStages_.size(); i++) {
+            const auto& stage = outputStages_[i];
+            file << "    {\n";
+            file << "      \"type\": \"" << stage.type << "\",\n";
+            file << "      \"params\": {\n";
+            writeParams(file, stage.params, stage.stringParams);
+            file << "      }\n";
+            file << "    }";
+            if (i < outputStages_.size() - 1) file << ",";
+            file << "\n";
+        }
+        file << "  ]";
+    }
+    
+    if (!sinks_.empty()) {
+        file << ",\n  \"sinks\": [\n";
+        for (size_t i = 0; i < sinks_.size(); i++) {
+            const auto& sink = sinks_[i];
+            file << "    {\n";
+            file << "      \"type\": \"" << sink.type << "\",\n";
+            file << "      \"outputFile\": \"" << sink.outputFile << "\",\n";
+            file << "      \"events\": \"" << sink.events << "\",\n";
+            file << "      \"queueSize\": " << sink.queueSize;
+            if (!sink.endpoint.empty()) {
+                file << ",\n      \"endpoint\": \"" << sink.endpoint << "\"";
+            }
+            file << "\n";
+            file << "    }";
+            if (i < sinks_.size() - 1) file << ",";
+            file << "\n";
+        }
+        file << "  ]";
+    }
+    
+    file << "\n}\n";
     
     return true;
 }
\ No newline at end of file
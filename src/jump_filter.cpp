@@ -1,29 +1,8 @@
 #include "jump_filter.h"
-#include <cmath>
 
 JumpFilter::JumpFilter(double maxJumpMeters) 
     : enabled_(true), maxJumpMeters_(maxJumpMeters) {}
 
-double JumpFilter::calculateDistance(const GpsPoint& p1, const GpsPoint& p2) const {
-    // Приблизительное расстояние по формуле гаверсинуса
-    const double R = 6371000; // Радиус Земли в метрах
-    
-    double lat1 = p1.latitude * M_PI / 180.0;
-    double lat2 = p2.latitude * M_PI / 180.0;
-    double lon1 = p1.longitude * M_PI / 180.0;
-    double lon2 = p2.longitude * M_PI / 180.0;
-    
-    double dlat = lat2 - lat1;
-    double dlon = lon2 - lon1;
-    
-    double a = std::sin(dlat/2) * std::sin(dlat/2) +
-               std::cos(lat1) * std::cos(lat2) *
-               std::sin(dlon/2) * std::sin(dlon/2);
-    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
-    
-    return R * c;
-}
-
 FilterResult JumpFilter::process(GpsPoint& point, const GpsHistory& history) {
     if (!enabled_) return FilterResult::PASS;
     
@@ -31,15 +10,17 @@ FilterResult JumpFilter::process(GpsPoint& point, const GpsHistory& history) {
         return FilterResult::REJECT;
     }
     
-    auto lastValid = history.getLastValid();
-    if (!lastValid.has_value()) {
+    const GpsPoint* lastValid = history.getLastValidPtr();
+    if (!lastValid) {
         return FilterResult::PASS; // Нет предыдущей точки для сравнения
     }
     
-    double distance = calculateDistance(*lastValid, point);
+    if (!reference_.matches(lastValid->latitude, lastValid->longitude)) {
+        reference_.set(lastValid->latitude, lastValid->longitude);
+    }
     
     // Проверяем, не слишком ли большой скачок
-    if (distance > maxJumpMeters_) {
+    if (reference_.exceeds(point.latitude, point.longitude, maxJumpMeters_)) {
         return FilterResult::REJECT;
     }
     
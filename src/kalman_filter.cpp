@@ -0,0 +1,236 @@
+#include "kalman_filter.h"
+#include "geodesy.h"
+#include "gps_time.h"
+#include <cmath>
+
+namespace {
+    const double INITIAL_SPEED_SIGMA = 30.0;   // м/с, неизвестная начальная скорость
+    const double REANCHOR_DISTANCE = 5000.0;   // метры от начала координат
+    const int MAX_CONSECUTIVE_REJECTS = 3;
+    const int GOOD_SATELLITES = 6;
+    
+    // Долгота или разность долгот в диапазоне [-180, 180): через линию
+    // перемены дат соседние точки отличаются на ~360 градусов
+    double wrapLongitude(double degrees) {
+        double wrapped = std::fmod(degrees + 180.0, 360.0);
+        if (wrapped < 0.0) wrapped += 360.0;
+        return wrapped - 180.0;
+    }
+}
+
+KalmanFilter::KalmanFilter(double measurementNoise, double processNoise)
+    : enabled_(true)
+    , measurementNoise_(measurementNoise)
+    , processNoise_(processNoise) {}
+
+void KalmanFilter::reset() {
+    initialized_ = false;
+    consecutiveRejects_ = 0;
+}
+
+double KalmanFilter::measurementVariance(const GpsPoint& point) const {
+    double hdop = point.hdop > 0.0f ? point.hdop : 1.0;
+    double sigma = measurementNoise_ * hdop;
+    // Мало спутников - геометрия хуже, чем показывает HDOP
+    if (point.satellites > 0 && point.satellites < GOOD_SATELLITES) {
+        sigma *= 1.0 + 0.25 * (GOOD_SATELLITES - point.satellites);
+    }
+    if (sigma < 1.0) sigma = 1.0;
+    return sigma * sigma;
+}
+
+void KalmanFilter::initialize(const GpsPoint& point, double variance) {
+    anchorLat_ = point.latitude;
+    anchorLon_ = point.longitude;
+    metersPerDegLat_ = geo::EARTH_RADIUS * geo::DEG_TO_RAD;
+    metersPerDegLon_ = metersPerDegLat_ * std::cos(anchorLat_ * geo::DEG_TO_RAD);
+    
+    for (int i = 0; i < 4; i++) {
+        x_[i] = 0.0;
+        for (int j = 0; j < 4; j++) {
+            P_[i][j] = 0.0;
+        }
+    }
+    P_[0][0] = variance;
+    P_[1][1] = variance;
+    P_[2][2] = INITIAL_SPEED_SIGMA * INITIAL_SPEED_SIGMA;
+    P_[3][3] = INITIAL_SPEED_SIGMA * INITIAL_SPEED_SIGMA;
+    
+    lastTimestamp_ = point.timestamp;
+    consecutiveRejects_ = 0;
+    initialized_ = true;
+}
+
+void KalmanFilter::reanchor() {
+    // Переносим начало координат в текущую оценку, чтобы плоское
+    // приближение оставалось точным; скорость и ковариация не меняются
+    double lat = anchorLat_ + x_[1] / metersPerDegLat_;
+    double lon = wrapLongitude(anchorLon_ + x_[0] / metersPerDegLon_);
+    anchorLat_ = lat;
+    anchorLon_ = lon;
+    metersPerDegLon_ = metersPerDegLat_ * std::cos(anchorLat_ * geo::DEG_TO_RAD);
+    x_[0] = 0.0;
+    x_[1] = 0.0;
+}
+
+void KalmanFilter::predict(double dt) {
+    // x = F x, F = [I dt*I; 0 I]
+    x_[0] += dt * x_[2];
+    x_[1] += dt * x_[3];
+    
+    // P = F P F^T (блочная форма без полного умножения 4x4)
+    for (int i = 0; i < 4; i++) {
+        P_[0][i] += dt * P_[2][i];
+        P_[1][i] += dt * P_[3][i];
+    }
+    for (int i = 0; i < 4; i++) {
+        P_[i][0] += dt * P_[i][2];
+        P_[i][1] += dt * P_[i][3];
+    }
+    
+    // + Q для белого шума ускорения по каждой оси
+    double q = processNoise_ * processNoise_;
+    double dt2 = dt * dt;
+    double q11 = q * dt2 * dt2 / 4.0;
+    double q13 = q * dt2 * dt / 2.0;
+    double q33 = q * dt2;
+    P_[0][0] += q11;
+    P_[1][1] += q11;
+    P_[0][2] += q13;
+    P_[2][0] += q13;
+    P_[1][3] += q13;
+    P_[3][1] += q13;
+    P_[2][2] += q33;
+    P_[3][3] += q33;
+}
+
+FilterResult KalmanFilter::process(GpsPoint& point, const GpsHistory& /*history*/) {
+    if (!enabled_) return FilterResult::PASS;
+    
+    if (!point.isValid) {
+        return FilterResult::REJECT;
+    }
+    
+    double r = measurementVariance(point);
+    
+    if (!initialized_) {
+        initialize(point, r);
+        return FilterResult::PASS;
+    }
+    
+    unsigned long long elapsed = gps_time::elapsedMs(lastTimestamp_, point.timestamp);
+    double dt = elapsed / 1000.0;
+    if (dt > maxGapSeconds_) {
+        initialize(point, r);
+        return FilterResult::PASS;
+    }
+    
+    predict(dt);
+    
+    // Измерение в локальной плоскости; H = [I 0]
+    double ze = wrapLongitude(point.longitude - anchorLon_) * metersPerDegLon_;
+    double zn = (point.latitude - anchorLat_) * metersPerDegLat_;
+    double ye = ze - x_[0];
+    double yn = zn - x_[1];
+    
+    // S = H P H^T + R (2x2) и его обратная
+    double s00 = P_[0][0] + r;
+    double s01 = P_[0][1];
+    double s11 = P_[1][1] + r;
+    double det = s00 * s11 - s01 * s01;
+    double i00 = s11 / det;
+    double i01 = -s01 / det;
+    double i11 = s00 / det;
+    
+    if (gateSigma_ > 0.0) {
+        double d2 = ye * (i00 * ye + i01 * yn) + yn * (i01 * ye + i11 * yn);
+        if (d2 > gateSigma_ * gateSigma_) {
+            // Повторные выбросы подряд - скорее всего, фильтр разошелся
+            if (++consecutiveRejects_ >= MAX_CONSECUTIVE_REJECTS) {
+                initialize(point, r);
+                return FilterResult::PASS;
+            }
+            lastTimestamp_ = point.timestamp;
+            return FilterResult::REJECT;
+        }
+    }
+    consecutiveRejects_ = 0;
+    
+    // K = P H^T S^-1 (4x2)
+    double K[4][2];
+    for (int i = 0; i < 4; i++) {
+        K[i][0] = P_[i][0] * i00 + P_[i][1] * i01;
+        K[i][1] = P_[i][0] * i01 + P_[i][1] * i11;
+    }
+    
+    for (int i = 0; i < 4; i++) {
+        x_[i] += K[i][0] * ye + K[i][1] * yn;
+    }
+    
+    // P = (I - K H) P
+    double top[2][4];
+    for (int j = 0; j < 4; j++) {
+        top[0][j] = P_[0][j];
+        top[1][j] = P_[1][j];
+    }
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            P_[i][j] -= K[i][0] * top[0][j] + K[i][1] * top[1][j];
+        }
+    }
+    
+    lastTimestamp_ = point.timestamp;
+    
+    if (std::fabs(x_[0]) > REANCHOR_DISTANCE || std::fabs(x_[1]) > REANCHOR_DISTANCE) {
+        reanchor();
+    }
+    
+    point.latitude = anchorLat_ + x_[1] / metersPerDegLat_;
+    point.longitude = wrapLongitude(anchorLon_ + x_[0] / metersPerDegLon_);
+    
+    return FilterResult::PASS;
+}
+
+void KalmanFilter::setEnabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+bool KalmanFilter::isEnabled() const {
+    return enabled_;
+}
+
+std::string KalmanFilter::getName() const {
+    return "KalmanFilter";
+}
+
+void KalmanFilter::setMeasurementNoise(double sigmaMeters) {
+    measurementNoise_ = sigmaMeters;
+}
+
+double KalmanFilter::getMeasurementNoise() const {
+    return measurementNoise_;
+}
+
+void KalmanFilter::setProcessNoise(double sigmaAccel) {
+    processNoise_ = sigmaAccel;
+}
+
+double KalmanFilter::getProcessNoise() const {
+    return processNoise_;
+}
+
+void KalmanFilter::setGateSigma(double gate) {
+    gateSigma_ = gate;
+}
+
+double KalmanFilter::getGateSigma() const {
+    return gateSigma_;
+}
+
+void KalmanFilter::setMaxGap(double seconds) {
+    maxGapSeconds_ = seconds;
+}
+
+double KalmanFilter::getMaxGap() const {
+    return maxGapSeconds_;
+}
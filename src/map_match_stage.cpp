@@ -0,0 +1,261 @@
+#include "map_match_stage.h"
+#include "geodesy.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    const double NEG_INF = -std::numeric_limits<double>::infinity();
+}
+
+MapMatchStage::MapMatchStage(std::unique_ptr<IDisplay> next, double sigmaMeters, double betaMeters,
+                             size_t lag)
+    : DisplayStage(std::move(next))
+    , routes_(graph_)
+    , sigma_(sigmaMeters > 0.0 ? sigmaMeters : 10.0)
+    , beta_(betaMeters > 0.0 ? betaMeters : 50.0)
+    , lag_(lag) {}
+
+MapMatchStage::~MapMatchStage() {
+    // Выведенные точки ссылаются на имена ребер графа
+    next_.reset();
+}
+
+void MapMatchStage::findCandidates(const GpsPoint& point, std::vector<Candidate>& out) {
+    out.clear();
+    graph_.getIndex().candidates(point.latitude, point.longitude, searchRadius_, maxCandidates_, matches_);
+    
+    const double lonScale = std::cos(point.latitude * geo::DEG_TO_RAD);
+    for (const auto& match : matches_) {
+        const auto& edge = graph_.getEdge(match.segment);
+        const auto& a = graph_.getNode(edge.from);
+        const auto& b = graph_.getNode(edge.to);
+        
+        // Проекция на ребро в плоскости (долгота * cos(широты), широта)
+        const double ex = (b.longitude - a.longitude) * lonScale;
+        const double ey = b.latitude - a.latitude;
+        const double px = (point.longitude - a.longitude) * lonScale;
+        const double py = point.latitude - a.latitude;
+        const double len2 = ex * ex + ey * ey;
+        double t = len2 > 0.0 ? (px * ex + py * ey) / len2 : 0.0;
+        t = std::max(0.0, std::min(1.0, t));
+        
+        Candidate c;
+        c.edge = match.segment;
+        c.fraction = t;
+        c.latitude = a.latitude + t * (b.latitude - a.latitude);
+        c.longitude = a.longitude + t * (b.longitude - a.longitude);
+        c.distance = match.distance;
+        c.score = NEG_INF;
+        c.previous = -1;
+        out.push_back(c);
+    }
+}
+
+double MapMatchStage::routeDistance(const Candidate& a, const Candidate& b) {
+    const auto& ea = graph_.getEdge(a.edge);
+    const auto& eb = graph_.getEdge(b.edge);
+    if (a.edge == b.edge) {
+        return std::fabs(b.fraction - a.fraction) * ea.length;
+    }
+    
+    // Выезд с ребра a через один из концов, въезд на ребро b через один из концов
+    const std::uint32_t fromNodes[2] = {ea.from, ea.to};
+    const double fromCost[2] = {a.fraction * ea.length, (1.0 - a.fraction) * ea.length};
+    const std::uint32_t toNodes[2] = {eb.from, eb.to};
+    const double toCost[2] = {b.fraction * eb.length, (1.0 - b.fraction) * eb.length};
+    
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            best = std::min(best, fromCost[i] + routes_.distance(fromNodes[i], toNodes[j]) + toCost[j]);
+        }
+    }
+    return best;
+}
+
+int MapMatchStage::bestCandidate(const Step& step) const {
+    int best = 0;
+    for (size_t i = 1; i < step.candidates.size(); i++) {
+        if (step.candidates[i].score > step.candidates[best].score) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
+void MapMatchStage::emit(const Step& step, int candidate) {
+    const Candidate& c = step.candidates[candidate];
+    GpsPoint snapped = step.point;
+    snapped.latitude = c.latitude;
+    snapped.longitude = c.longitude;
+    // Имя ребра копируется в пул подписей один раз на ребро
+    if (!hasLabel_ || c.edge != labelEdge_) {
+        hasLabel_ = true;
+        labelEdge_ = c.edge;
+        label_ = internLabel(graph_.getEdgeName(c.edge));
+    }
+    snapped.label = label_;
+    matchedCount_++;
+    next_->showPoint(snapped);
+}
+
+void MapMatchStage::emitOldest() {
+    // Обратный проход от лучшего кандидата последнего шага до первого шага окна
+    int candidate = bestCandidate(window_.back());
+    for (size_t i = window_.size() - 1; i > 0; i--) {
+        candidate = window_[i].candidates[candidate].previous;
+    }
+    emit(window_.front(), candidate);
+    window_.pop_front();
+}
+
+void MapMatchStage::emitAll() {
+    if (window_.empty()) return;
+    
+    std::vector<int> path(window_.size());
+    path.back() = bestCandidate(window_.back());
+    for (size_t i = window_.size() - 1; i > 0; i--) {
+        path[i - 1] = window_[i].candidates[path[i]].previous;
+    }
+    for (size_t i = 0; i < window_.size(); i++) {
+        emit(window_[i], path[i]);
+    }
+    window_.clear();
+}
+
+void MapMatchStage::showPoint(const GpsPoint& point) {
+    Step step;
+    step.point = point;
+    findCandidates(point, step.candidates);
+    
+    if (step.candidates.empty()) {
+        // Вне дорожной сети: выводим как есть, модель начинается заново
+        emitAll();
+        unmatchedCount_++;
+        next_->showPoint(point);
+        return;
+    }
+    
+    const double inv2Sigma2 = 0.5 / (sigma_ * sigma_);
+    bool connected = false;
+    if (!window_.empty()) {
+        const Step& prev = window_.back();
+        const double straight = geo::haversineDistance(prev.point.latitude, prev.point.longitude,
+                                                       point.latitude, point.longitude);
+        for (auto& c : step.candidates) {
+            const double emission = -c.distance * c.distance * inv2Sigma2;
+            for (size_t j = 0; j < prev.candidates.size(); j++) {
+                const double route = routeDistance(prev.candidates[j], c);
+                if (!std::isfinite(route)) continue;
+                const double score = prev.candidates[j].score - std::fabs(route - straight) / beta_ + emission;
+                if (score > c.score) {
+                    c.score = score;
+                    c.previous = static_cast<int>(j);
+                }
+            }
+            connected = connected || c.previous >= 0;
+        }
+    }
+    
+    if (!connected) {
+        // Нет пути ни от одного кандидата: разрыв модели
+        if (!window_.empty()) {
+            breakCount_++;
+            emitAll();
+        }
+        for (auto& c : step.candidates) {
+            c.score = -c.distance * c.distance * inv2Sigma2;
+            c.previous = -1;
+        }
+    }
+    
+    // Нормировка, чтобы логарифмы не уходили в минус бесконечность на длинном треке
+    const double top = step.candidates[bestCandidate(step)].score;
+    for (auto& c : step.candidates) {
+        c.score -= top;
+    }
+    
+    window_.push_back(std::move(step));
+    if (window_.size() > lag_) {
+        emitOldest();
+    }
+}
+
+void MapMatchStage::showInvalidFix(unsigned long long timestamp) {
+    emitAll();
+    next_->showInvalidFix(timestamp);
+}
+
+void MapMatchStage::showEvent(const GpsEvent& event) {
+    emitAll();
+    next_->showEvent(event);
+}
+
+void MapMatchStage::clear() {
+    window_.clear();
+    next_->clear();
+}
+
+void MapMatchStage::flush() {
+    emitAll();
+    next_->flush();
+}
+
+RoadGraph& MapMatchStage::getGraph() {
+    routes_.clear();
+    hasLabel_ = false;
+    return graph_;
+}
+
+const RoadGraph& MapMatchStage::getGraph() const {
+    return graph_;
+}
+
+void MapMatchStage::setSearchRadius(double meters) {
+    searchRadius_ = meters;
+}
+
+double MapMatchStage::getSearchRadius() const {
+    return searchRadius_;
+}
+
+void MapMatchStage::setMaxCandidates(size_t count) {
+    maxCandidates_ = count > 0 ? count : 1;
+}
+
+size_t MapMatchStage::getMaxCandidates() const {
+    return maxCandidates_;
+}
+
+void MapMatchStage::setRouteCache(double limitMeters, size_t capacity) {
+    routes_.setLimits(limitMeters, capacity);
+}
+
+const RouteCache& MapMatchStage::getRouteCache() const {
+    return routes_;
+}
+
+double MapMatchStage::getSigma() const {
+    return sigma_;
+}
+
+double MapMatchStage::getBeta() const {
+    return beta_;
+}
+
+size_t MapMatchStage::getLag() const {
+    return lag_;
+}
+
+size_t MapMatchStage::getMatchedCount() const {
+    return matchedCount_;
+}
+
+size_t MapMatchStage::getUnmatchedCount() const {
+    return unmatchedCount_;
+}
+
+size_t MapMatchStage::getBreakCount() const {
+    return breakCount_;
+}
@@ -0,0 +1,374 @@
+#include "mmap_sink.h"
+#include "file_sink.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+namespace {
+    size_t pageSize() {
+        static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+    
+    size_t roundUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    
+    // Выделить место под файл заранее. Разреженное расширение - только если
+    // файловая система не умеет fallocate: при нехватке места запись в
+    // невыделенную страницу отображения завершила бы процесс по SIGBUS
+    bool reserve(int fd, size_t size) {
+        int error = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+        if (error == 0) {
+            return true;
+        }
+        if (error != EOPNOTSUPP && error != EINVAL) {
+            return false;
+        }
+        return ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+    }
+    
+    // Подготовить страницы отображения к записи. Ядро без MADV_POPULATE_WRITE
+    // (до 5.14) отвечает EINVAL - страницы подготовятся при первой записи;
+    // другая ошибка означает, что страницу нельзя выделить (нет места)
+    bool populate(void* data, size_t size) {
+        return ::madvise(data, size, MADV_POPULATE_WRITE) == 0 || errno == EINVAL;
+    }
+    
+    // Длина данных: незаписанный хвост заполнен нулями
+    size_t dataLength(const char* data, size_t size) {
+        while (size > 0 && data[size - 1] == '\0') {
+            size--;
+        }
+        return size;
+    }
+    
+    // Обрезать нулевой хвост файла, оставшийся после аварийного завершения;
+    // возвращает длину данных (0, если файла нет)
+    size_t trimFile(const std::string& name) {
+        int fd = ::open(name.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) return 0;
+        size_t length = 0;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED) {
+                length = dataLength(static_cast<const char*>(data), size);
+                ::munmap(data, size);
+                if (length < size && ::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+                    length = size;
+                }
+            } else {
+                length = size;
+            }
+        }
+        ::close(fd);
+        return length;
+    }
+}
+
+MmapSink::MmapSink(const std::string& filename, bool rotate, size_t segmentSize, unsigned syncIntervalMs)
+    : filename_(filename)
+    , nextName_(nextSegmentName(filename))
+    , rotate_(rotate)
+    , segmentSize_(roundUp(segmentSize > 0 ? segmentSize : 1, pageSize()))
+    , syncIntervalMs_(syncIntervalMs > 0 ? syncIntervalMs : 1) {
+    
+    // Следующий сегмент от прошлого запуска: с данными - откладываем, пустой удаляем
+    if (trimFile(nextName_) > 0) {
+        std::error_code ec;
+        std::filesystem::rename(nextName_, FileSink::rotatedName(filename_), ec);
+    } else {
+        std::error_code ec;
+        std::filesystem::remove(nextName_, ec);
+    }
+    
+    if (!openActive()) {
+        std::cerr << "Warning: Cannot open file " << filename << " for writing\n";
+        return;
+    }
+    thread_ = std::thread(&MmapSink::run, this);
+}
+
+MmapSink::~MmapSink() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+    retire(active_);
+    if (next_.fd >= 0 || next_.data) {
+        next_.used = 0;
+        retire(next_);
+        std::error_code ec;
+        std::filesystem::remove(nextName_, ec);
+    }
+}
+
+std::string MmapSink::nextSegmentName(const std::string& filename) {
+    std::filesystem::path path(filename);
+    return (path.parent_path() / ("." + path.filename().string() + ".next")).string();
+}
+
+bool MmapSink::openActive() {
+    active_.fd = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (active_.fd < 0) return false;
+    
+    struct stat st;
+    size_t size = 0;
+    if (::fstat(active_.fd, &st) == 0) {
+        size = static_cast<size_t>(st.st_size);
+    }
+    // Существующий файл дописывается; больший сегмента отображается целиком
+    size_t capacity = std::max(roundUp(size, pageSize()), segmentSize_);
+    if (size < capacity && !reserve(active_.fd, capacity)) {
+        ::close(active_.fd);
+        active_.fd = -1;
+        return false;
+    }
+    void* data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, active_.fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(active_.fd);
+        active_.fd = -1;
+        return false;
+    }
+    if (!populate(data, capacity)) {
+        ::munmap(data, capacity);
+        ::close(active_.fd);
+        active_.fd = -1;
+        return false;
+    }
+    active_.data = static_cast<char*>(data);
+    active_.capacity = capacity;
+    // После аварийного завершения файл остается расширенным: данные - до нулей
+    active_.used = dataLength(active_.data, size);
+    activeUsed_.store(active_.used, std::memory_order_release);
+    synced_ = active_.used;
+    return true;
+}
+
+bool MmapSink::prepareSegment(Segment& segment) {
+    segment.fd = ::open(nextName_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (segment.fd < 0 || !reserve(segment.fd, segmentSize_)) return false;
+    void* data = ::mmap(nullptr, segmentSize_, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+    if (data == MAP_FAILED) return false;
+    segment.data = static_cast<char*>(data);
+    segment.capacity = segmentSize_;
+    segment.used = 0;
+    // Страницы подготавливаются к записи здесь, в фоновом потоке, а не
+    // ошибкой страницы при первой записи пайплайна
+    return populate(data, segmentSize_);
+}
+
+void MmapSink::retire(Segment& segment) {
+    if (segment.data) {
+        ::msync(segment.data, segment.capacity, MS_SYNC);
+        ::munmap(segment.data, segment.capacity);
+    }
+    if (segment.fd >= 0) {
+        // Убираем нулевой хвост: закрытый файл содержит только данные
+        if (::ftruncate(segment.fd, static_cast<off_t>(segment.used)) != 0) {
+            std::cerr << "Warning: cannot trim " << filename_ << "\n";
+        }
+        ::close(segment.fd);
+    }
+    segment = Segment();
+}
+
+bool MmapSink::isOpen() const {
+    return active_.data != nullptr;
+}
+
+void MmapSink::setRotationCallback(std::function<void(const std::string&)> callback) {
+    onRotate_ = std::move(callback);
+}
+
+void MmapSink::append(const char* data, size_t size) {
+    if (!active_.data) return;
+    
+    // Граница сегмента проходит между записями
+    if (active_.used + size > active_.capacity) {
+        if (rotate_ && active_.used > 0) {
+            roll();
+        }
+        // Запись больше сегмента или без ротации - расширяем текущий
+        if (active_.used + size > active_.capacity) {
+            grow(active_.used + size);
+            if (active_.used + size > active_.capacity) {
+                // Места нет (диск, лимит размера файла): запись теряется
+                droppedCount_++;
+                return;
+            }
+        }
+    }
+    
+    std::memcpy(active_.data + active_.used, data, size);
+    active_.used += size;
+    activeUsed_.store(active_.used, std::memory_order_release);
+    bytesWritten_ += size;
+}
+
+void MmapSink::append(const std::string& record) {
+    append(record.data(), record.size());
+}
+
+void MmapSink::roll() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!nextReady_ && !nextFailed_) {
+        stallCount_++;
+        ready_.wait(lock, [this] { return nextReady_ || nextFailed_; });
+    }
+    if (!nextReady_) {
+        // Сегмент создать не удалось - текущий расширится, следующий
+        // фоновый поток попробует подготовить еще раз
+        nextFailed_ = false;
+        lock.unlock();
+        wake_.notify_one();
+        return;
+    }
+    
+    retired_ = active_;
+    hasRetired_ = true;
+    active_ = next_;
+    next_ = Segment();
+    nextReady_ = false;
+    activeUsed_.store(active_.used, std::memory_order_release);
+    synced_ = 0;
+    rotationCount_++;
+    lock.unlock();
+    wake_.notify_one();
+}
+
+void MmapSink::grow(size_t required) {
+    size_t capacity = roundUp(std::max(required, active_.capacity + segmentSize_), pageSize());
+    if (!reserve(active_.fd, capacity)) {
+        std::cerr << "Warning: cannot extend " << filename_ << "\n";
+        return;
+    }
+    // Фоновый поток обращается к отображению только под mutex_
+    std::lock_guard<std::mutex> lock(mutex_);
+    void* data = ::mremap(active_.data, active_.capacity, capacity, MREMAP_MAYMOVE);
+    if (data == MAP_FAILED) {
+        std::cerr << "Warning: cannot remap " << filename_ << "\n";
+        return;
+    }
+    if (!populate(static_cast<char*>(data) + active_.capacity, capacity - active_.capacity)) {
+        // Уменьшение на месте не перемещает отображение
+        ::mremap(data, capacity, active_.capacity, 0);
+        active_.data = static_cast<char*>(data);
+        std::cerr << "Warning: cannot extend " << filename_ << "\n";
+        return;
+    }
+    active_.data = static_cast<char*>(data);
+    active_.capacity = capacity;
+}
+
+void MmapSink::flush() {
+    if (!active_.data) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t start = synced_ / pageSize() * pageSize();
+        if (active_.used > start) {
+            ::msync(active_.data + start, active_.used - start, MS_ASYNC);
+        }
+        synced_ = active_.used;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return !hasRetired_; });
+}
+
+void MmapSink::truncate() {
+    if (!active_.data) return;
+    // Читатели ищут конец данных по нулям
+    std::memset(active_.data, 0, active_.used);
+    active_.used = 0;
+    activeUsed_.store(0, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex_);
+    synced_ = 0;
+}
+
+void MmapSink::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        if (hasRetired_) {
+            Segment segment = retired_;
+            lock.unlock();
+            
+            retire(segment);
+            std::string rotated = FileSink::rotatedName(filename_);
+            std::error_code ec;
+            std::filesystem::rename(filename_, rotated, ec);
+            std::error_code nextEc;
+            std::filesystem::rename(nextName_, filename_, nextEc);
+            if (!ec && onRotate_) {
+                onRotate_(rotated);
+            }
+            
+            lock.lock();
+            retired_ = Segment();
+            hasRetired_ = false;
+            ready_.notify_all();
+            continue;
+        }
+        if (rotate_ && !nextReady_ && !nextFailed_ && !stop_) {
+            lock.unlock();
+            Segment segment;
+            bool ok = prepareSegment(segment);
+            if (!ok) {
+                std::cerr << "Warning: cannot prepare segment " << nextName_ << "\n";
+                retire(segment);
+            }
+            lock.lock();
+            if (ok) {
+                next_ = segment;
+                nextReady_ = true;
+            } else {
+                nextFailed_ = true;
+            }
+            ready_.notify_all();
+            continue;
+        }
+        if (stop_) break;
+        
+        wake_.wait_for(lock, std::chrono::milliseconds(syncIntervalMs_));
+        
+        // Запуск записи новых данных на диск, не дожидаясь ее завершения
+        size_t used = activeUsed_.load(std::memory_order_acquire);
+        size_t start = synced_ / pageSize() * pageSize();
+        if (active_.data && used > start) {
+            ::msync(active_.data + start, used - start, MS_ASYNC);
+            synced_ = used;
+        }
+    }
+}
+
+size_t MmapSink::getRotationCount() const {
+    return rotationCount_;
+}
+
+size_t MmapSink::getStallCount() const {
+    return stallCount_;
+}
+
+size_t MmapSink::getBytesWritten() const {
+    return bytesWritten_;
+}
+
+size_t MmapSink::getDroppedCount() const {
+    return droppedCount_;
+}
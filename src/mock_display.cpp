@@ -29,6 +29,15 @@ void MockDisplay::showRejected(const std::string& reason) {
     calls_.push_back(call);
 }
 
+void MockDisplay::showEvent(const GpsEvent& event) {
+    DisplayCall call;
+    call.type = DisplayCall::Type::EVENT;
+    call.timestamp = event.timestamp;
+    call.message = event.subject;
+    call.event = event;
+    calls_.push_back(call);
+}
+
 void MockDisplay::clear() {
     calls_.clear();
 }
@@ -79,4 +88,14 @@ int MockDisplay::getErrorCount() const {
         }
     }
     return count;
+}
+
+int MockDisplay::getEventCount() const {
+    int count = 0;
+    for (const auto& call : calls_) {
+        if (call.type == DisplayCall::Type::EVENT) {
+            count++;
+        }
+    }
+    return count;
 }
\ No newline at end of file
@@ -0,0 +1,444 @@
+#include "network_display.h"
+#include "record_format.h"
+#include "structured_format.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+    const auto CONNECT_TIMEOUT = std::chrono::milliseconds(1000);
+    const auto MIN_BACKOFF = std::chrono::milliseconds(50);
+    const auto MAX_BACKOFF = std::chrono::milliseconds(2000);
+    // Шаг ожидания готовности сокета: между шагами проверяется остановка
+    const int POLL_STEP_MS = 100;
+    
+    network_format::FrameHeader makeHeader(size_t count) {
+        network_format::FrameHeader header{};
+        std::memcpy(header.magic, network_format::MAGIC, sizeof(header.magic));
+        header.version = network_format::VERSION;
+        header.recordSize = sizeof(PackedGpsPoint);
+        header.recordCount = static_cast<std::uint32_t>(count);
+        return header;
+    }
+}
+
+constexpr std::chrono::milliseconds NetworkDisplay::FLUSH_TIMEOUT;
+
+NetworkDisplay::NetworkDisplay(Protocol protocol, Format format, const std::string& host, unsigned short port,
+                               size_t batchRecords, unsigned lingerUs, size_t bufferBytes)
+    : protocol_(protocol)
+    , format_(format)
+    , host_(host)
+    , port_(port)
+    , batchRecords_(batchRecords > 0 ? batchRecords : 1)
+    , linger_(lingerUs)
+    , bufferBytes_(bufferBytes > 0 ? bufferBytes : 1)
+    , record_(record_format::TYPICAL_CAPACITY) {
+    front_.reserve(std::min<size_t>(bufferBytes_, 64 * 1024));
+    back_.reserve(front_.capacity());
+    thread_ = std::thread(&NetworkDisplay::run, this);
+}
+
+NetworkDisplay::~NetworkDisplay() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+    closeSocket();
+}
+
+bool NetworkDisplay::parseProtocol(const std::string& name, Protocol& protocol) {
+    if (name == "tcp") {
+        protocol = Protocol::TCP;
+    } else if (name == "udp") {
+        protocol = Protocol::UDP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool NetworkDisplay::parseFormat(const std::string& name, Format& format) {
+    if (name == "ndjson") {
+        format = Format::NDJSON;
+    } else if (name == "binary") {
+        format = Format::BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool NetworkDisplay::parseEndpoint(const std::string& endpoint, std::string& host, unsigned short& port) {
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == endpoint.size()) return false;
+    
+    std::string name = endpoint.substr(0, colon);
+    if (name.front() == '[') {
+        if (name.back() != ']' || name.size() < 3) return false;
+        name = name.substr(1, name.size() - 2);
+    }
+    unsigned long value = 0;
+    for (size_t i = colon + 1; i < endpoint.size(); i++) {
+        if (endpoint[i] < '0' || endpoint[i] > '9') return false;
+        value = value * 10 + static_cast<unsigned long>(endpoint[i] - '0');
+        if (value > 65535) return false;
+    }
+    if (value == 0) return false;
+    host = name;
+    port = static_cast<unsigned short>(value);
+    return true;
+}
+
+void NetworkDisplay::enqueue(const char* data, size_t size) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Пайплайн не ждет сеть: при заполненном буфере запись отбрасывается
+        if (front_.size() + inFlightBytes_ + size > bufferBytes_) {
+            droppedCount_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (frontEnds_.empty()) {
+            firstRecord_ = std::chrono::steady_clock::now();
+        }
+        front_.insert(front_.end(), data, data + size);
+        frontEnds_.push_back(static_cast<std::uint32_t>(front_.size()));
+        // Поток будится дважды за пакет: первая запись запускает ожидание, полный пакет его прерывает
+        wake = frontEnds_.size() == 1 || frontEnds_.size() == batchRecords_;
+    }
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+template <typename Render>
+void NetworkDisplay::enqueueText(Render render) {
+    if (format_ != Format::NDJSON) return;
+    size_t length = record_format::render(record_, render);
+    enqueue(record_.data(), length);
+}
+
+void NetworkDisplay::showPoint(const GpsPoint& point) {
+    if (format_ == Format::BINARY) {
+        PackedGpsPoint record = PackedGpsPoint::fromPoint(point);
+        enqueue(reinterpret_cast<const char*>(&record), sizeof(record));
+        return;
+    }
+    enqueueText([&](char* out, size_t capacity) {
+        return structured_format::formatNdjson(structured_format::pointRecord(point), out, capacity);
+    });
+}
+
+void NetworkDisplay::showInvalidFix(unsigned long long timestamp) {
+    if (format_ == Format::BINARY) {
+        PackedGpsPoint record;
+        record.timestamp = static_cast<std::int64_t>(timestamp);
+        enqueue(reinterpret_cast<const char*>(&record), sizeof(record));
+        return;
+    }
+    enqueueText([&](char* out, size_t capacity) {
+        return structured_format::formatNdjson(structured_format::invalidFixRecord(timestamp), out, capacity);
+    });
+}
+
+void NetworkDisplay::showParseError(const std::string& error) {
+    enqueueText([&](char* out, size_t capacity) {
+        return structured_format::formatNdjson(structured_format::parseErrorRecord(error), out, capacity);
+    });
+}
+
+void NetworkDisplay::showRejected(const std::string& reason) {
+    enqueueText([&](char* out, size_t capacity) {
+        return structured_format::formatNdjson(structured_format::rejectedRecord(reason), out, capacity);
+    });
+}
+
+void NetworkDisplay::showEvent(const GpsEvent& event) {
+    enqueueText([&](char* out, size_t capacity) {
+        return structured_format::formatNdjson(structured_format::eventRecord(event), out, capacity);
+    });
+}
+
+void NetworkDisplay::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    front_.clear();
+    frontEnds_.clear();
+}
+
+void NetworkDisplay::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    unsigned long long target = ++flushRequested_;
+    wake_.notify_one();
+    sent_.wait_for(lock, FLUSH_TIMEOUT, [&] { return flushDone_ >= target; });
+}
+
+void NetworkDisplay::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [&] { return !frontEnds_.empty() || stop_ || flushRequested_ != flushDone_; });
+        if (frontEnds_.empty()) {
+            if (stop_) break;
+            flushDone_ = flushRequested_;
+            sent_.notify_all();
+            continue;
+        }
+        // Пакет собирается до batchRecords записей или до истечения linger
+        wake_.wait_until(lock, firstRecord_ + linger_, [&] {
+            return frontEnds_.size() >= batchRecords_ || stop_ || flushRequested_ != flushDone_;
+        });
+        
+        const unsigned long long flushTarget = flushRequested_;
+        back_.swap(front_);
+        backEnds_.swap(frontEnds_);
+        front_.clear();
+        frontEnds_.clear();
+        inFlightBytes_ = back_.size();
+        lock.unlock();
+        
+        bool delivered = sendBatch();
+        while (!delivered) {
+            // Неудачная попытка завершает ожидающий flush()
+            lock.lock();
+            flushDone_ = std::max(flushDone_, flushRequested_);
+            sent_.notify_all();
+            wake_.wait_until(lock, retryAt_, [&] { return stop_ || flushRequested_ != flushDone_; });
+            bool stopping = stop_;
+            lock.unlock();
+            if (stopping) break;
+            delivered = sendBatch();
+        }
+        if (!delivered) {
+            droppedCount_.fetch_add(backEnds_.size(), std::memory_order_relaxed);
+        }
+        back_.clear();
+        backEnds_.clear();
+        
+        lock.lock();
+        inFlightBytes_ = 0;
+        flushDone_ = std::max(flushDone_, flushTarget);
+        sent_.notify_all();
+    }
+}
+
+bool NetworkDisplay::connectSocket() {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = protocol_ == Protocol::TCP ? SOCK_STREAM : SOCK_DGRAM;
+    addrinfo* addresses = nullptr;
+    const std::string service = std::to_string(port_);
+    
+    bool ok = false;
+    if (::getaddrinfo(host_.c_str(), service.c_str(), &hints, &addresses) == 0) {
+        for (addrinfo* a = addresses; a && !ok; a = a->ai_next) {
+            int fd = ::socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+            if (fd < 0) continue;
+            
+            int result = ::connect(fd, a->ai_addr, a->ai_addrlen);
+            if (result != 0 && errno == EINPROGRESS) {
+                pollfd pfd{fd, POLLOUT, 0};
+                int error = ETIMEDOUT;
+                socklen_t length = sizeof(error);
+                if (::poll(&pfd, 1, static_cast<int>(CONNECT_TIMEOUT.count())) == 1) {
+                    ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                }
+                result = error == 0 ? 0 : -1;
+            }
+            if (result != 0) {
+                ::close(fd);
+                continue;
+            }
+            if (protocol_ == Protocol::TCP) {
+                // Записи уже собраны в пакеты - задержка Нейгла не нужна
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            socket_ = fd;
+            ok = true;
+        }
+        ::freeaddrinfo(addresses);
+    }
+    
+    if (!ok) {
+        backoff_ = std::min(std::max(backoff_ * 2, MIN_BACKOFF), MAX_BACKOFF);
+        retryAt_ = std::chrono::steady_clock::now() + backoff_;
+        return false;
+    }
+    if (everConnected_) {
+        reconnectCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    everConnected_ = true;
+    backoff_ = std::chrono::milliseconds(0);
+    connected_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void NetworkDisplay::closeSocket() {
+    if (socket_ >= 0) {
+        ::close(socket_);
+        socket_ = -1;
+    }
+    connected_.store(false, std::memory_order_relaxed);
+}
+
+bool NetworkDisplay::waitWritable() {
+    while (true) {
+        pollfd pfd{socket_, POLLOUT, 0};
+        int ready = ::poll(&pfd, 1, POLL_STEP_MS);
+        if (ready > 0) return true;
+        if (ready < 0 && errno != EINTR) return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return false;
+    }
+}
+
+bool NetworkDisplay::sendBatch() {
+    if (socket_ < 0) {
+        if (std::chrono::steady_clock::now() < retryAt_ || !connectSocket()) {
+            return false;
+        }
+    }
+    return protocol_ == Protocol::TCP ? sendStream() : sendDatagrams();
+}
+
+bool NetworkDisplay::sendStream() {
+    network_format::FrameHeader header = makeHeader(backEnds_.size());
+    iovec iov[2];
+    int count = 0;
+    if (format_ == Format::BINARY) {
+        iov[count++] = {&header, sizeof(header)};
+    }
+    iov[count++] = {back_.data(), back_.size()};
+    
+    // Весь пакет - один вызов, если сокет принимает его целиком
+    int first = 0;
+    while (first < count) {
+        msghdr message{};
+        message.msg_iov = iov + first;
+        message.msg_iovlen = static_cast<size_t>(count - first);
+        ssize_t n = ::sendmsg(socket_, &message, MSG_NOSIGNAL);
+        sendCalls_.fetch_add(1, std::memory_order_relaxed);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (waitWritable()) continue;
+            }
+            closeSocket();
+            retryAt_ = std::chrono::steady_clock::now();
+            return false;
+        }
+        size_t left = static_cast<size_t>(n);
+        while (first < count && left >= iov[first].iov_len) {
+            left -= iov[first].iov_len;
+            first++;
+        }
+        if (first < count) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+        }
+    }
+    
+    sentCount_.fetch_add(backEnds_.size(), std::memory_order_relaxed);
+    batchCount_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool NetworkDisplay::sendDatagrams() {
+    const size_t headerSize = format_ == Format::BINARY ? sizeof(network_format::FrameHeader) : 0;
+    const size_t limit = network_format::MAX_DATAGRAM - headerSize;
+    
+    // Датаграммы из целых записей; запись больше лимита идет отдельно
+    std::vector<network_format::FrameHeader> headers;
+    std::vector<iovec> iov;
+    std::vector<size_t> records;
+    size_t start = 0;
+    size_t first = 0;
+    for (size_t i = 0; i < backEnds_.size(); i++) {
+        size_t end = backEnds_[i];
+        bool last = i + 1 == backEnds_.size();
+        if (!last && backEnds_[i + 1] - start <= limit) continue;
+        headers.push_back(makeHeader(i + 1 - first));
+        iov.push_back({back_.data() + start, end - start});
+        records.push_back(i + 1 - first);
+        start = end;
+        first = i + 1;
+    }
+    
+    std::vector<mmsghdr> messages(records.size());
+    std::vector<iovec> parts(records.size() * 2);
+    for (size_t m = 0; m < records.size(); m++) {
+        size_t n = 0;
+        if (headerSize > 0) {
+            parts[m * 2 + n++] = {&headers[m], headerSize};
+        }
+        parts[m * 2 + n++] = iov[m];
+        messages[m].msg_hdr.msg_iov = &parts[m * 2];
+        messages[m].msg_hdr.msg_iovlen = n;
+    }
+    
+    size_t next = 0;
+    while (next < messages.size()) {
+        unsigned count = static_cast<unsigned>(std::min<size_t>(messages.size() - next, 1024));
+        int sent = ::sendmmsg(socket_, &messages[next], count, MSG_NOSIGNAL);
+        sendCalls_.fetch_add(1, std::memory_order_relaxed);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable()) continue;
+            // Датаграмма не ушла (получателя нет, слишком велика) - она теряется,
+            // как и любая датаграмма в сети
+            droppedCount_.fetch_add(records[next], std::memory_order_relaxed);
+            next++;
+            continue;
+        }
+        for (int k = 0; k < sent; k++) {
+            sentCount_.fetch_add(records[next + k], std::memory_order_relaxed);
+        }
+        batchCount_.fetch_add(static_cast<size_t>(sent), std::memory_order_relaxed);
+        next += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+NetworkDisplay::Protocol NetworkDisplay::getProtocol() const {
+    return protocol_;
+}
+
+NetworkDisplay::Format NetworkDisplay::getFormat() const {
+    return format_;
+}
+
+bool NetworkDisplay::isConnected() const {
+    return connected_.load(std::memory_order_relaxed);
+}
+
+size_t NetworkDisplay::getSentCount() const {
+    return sentCount_.load(std::memory_order_relaxed);
+}
+
+size_t NetworkDisplay::getBatchCount() const {
+    return batchCount_.load(std::memory_order_relaxed);
+}
+
+size_t NetworkDisplay::getSendCallCount() const {
+    return sendCalls_.load(std::memory_order_relaxed);
+}
+
+size_t NetworkDisplay::getDroppedCount() const {
+    return droppedCount_.load(std::memory_order_relaxed);
+}
+
+size_t NetworkDisplay::getReconnectCount() const {
+    return reconnectCount_.load(std::memory_order_relaxed);
+}
@@ -1,9 +1,19 @@
 #include "parser.h"
+#include "gps_time.h"
 #include <cstring>
 #include <cctype>
 #include <iomanip>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+
+namespace {
+    const long long MS_PER_DAY = static_cast<long long>(gps_time::MS_PER_DAY);
+    
+    std::uint16_t clampU16(std::int64_t value) {
+        return static_cast<std::uint16_t>(std::min<std::int64_t>(std::max<std::int64_t>(value, 0), 0xFFFF));
+    }
+}
 
 NmeaParser::NmeaParser() = default;
 NmeaParser::~NmeaParser() = default;
@@ -12,6 +22,10 @@ void NmeaParser::reset() {
     lastRMC_.reset();
     lastGGA_.reset();
     lastGSV_.reset();
+    lastPackedRMC_.reset();
+    lastPackedGGA_.reset();
+    lastDateMs_ = -1;
+    lastDateTime_ = 0;
 }
 
 bool NmeaParser::validateChecksum(const std::string& line) {
@@ -70,6 +84,94 @@ unsigned long long NmeaParser::parseTimeToMs(const std::string& timeStr) {
     return static_cast<unsigned long long>(hours * 3600 + minutes * 60 + seconds) * 1000 + milliseconds;
 }
 
+bool NmeaParser::parseFixed(const std::string& field, int decimals, std::int64_t& value) {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < field.size() && (field[pos] == '-' || field[pos] == '+')) {
+        negative = field[pos] == '-';
+        pos++;
+    }
+    
+    // Значащие цифры результата с учетом decimals знаков дробной части:
+    // больше MAX_FIXED_DIGITS переполнили бы int64
+    if (decimals < 0 || decimals > MAX_FIXED_DIGITS) return false;
+    int digits = decimals;
+    
+    std::int64_t result = 0;
+    bool hasDigits = false;
+    for (; pos < field.size() && std::isdigit(static_cast<unsigned char>(field[pos])); pos++) {
+        if (result != 0 || field[pos] != '0') {
+            if (++digits > MAX_FIXED_DIGITS) return false;
+        }
+        result = result * 10 + (field[pos] - '0');
+        hasDigits = true;
+    }
+    
+    int fracDigits = 0;
+    bool roundUp = false;
+    if (pos < field.size() && field[pos] == '.') {
+        for (pos++; pos < field.size() && std::isdigit(static_cast<unsigned char>(field[pos])); pos++) {
+            if (fracDigits < decimals) {
+                result = result * 10 + (field[pos] - '0');
+                fracDigits++;
+            } else if (fracDigits == decimals) {
+                roundUp = field[pos] >= '5';
+                fracDigits++;
+            }
+            hasDigits = true;
+        }
+    }
+    if (!hasDigits || pos != field.size()) return false;
+    
+    for (int i = std::min(fracDigits, decimals); i < decimals; i++) {
+        result *= 10;
+    }
+    if (roundUp) result++;
+    
+    value = negative ? -result : result;
+    return true;
+}
+
+std::int32_t NmeaParser::nmeaCoordinateToE7(const std::string& field, char hemisphere) {
+    // Минуты в единицах 1e-8 минуты; 1e-7 градуса = 600 таких единиц
+    std::int64_t scaledMinutes = 0;
+    if (!parseFixed(field, 8, scaledMinutes) || scaledMinutes < 0) return 0;
+    
+    const std::int64_t perDegree = 100LL * 100000000LL;  // DDMM: 100 единиц DD на градус
+    std::int64_t degrees = scaledMinutes / perDegree;
+    std::int64_t minutes = scaledMinutes % perDegree;
+    std::int64_t result = degrees * 10000000LL + (minutes + 300) / 600;
+    
+    if (hemisphere == 'S' || hemisphere == 'W') {
+        result = -result;
+    }
+    return static_cast<std::int32_t>(result);
+}
+
+long long NmeaParser::parseDateToEpochMs(const std::string& dateStr) {
+    if (dateStr.length() != 6) return -1;
+    for (char c : dateStr) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) return -1;
+    }
+    
+    int day = (dateStr[0] - '0') * 10 + (dateStr[1] - '0');
+    int month = (dateStr[2] - '0') * 10 + (dateStr[3] - '0');
+    int year = (dateStr[4] - '0') * 10 + (dateStr[5] - '0');
+    if (day < 1 || day > 31 || month < 1 || month > 12) return -1;
+    // Двузначный год NMEA: 80-99 -> 19xx, иначе 20xx
+    year += (year >= 80) ? 1900 : 2000;
+    
+    // Число дней от 1970-01-01 (алгоритм days_from_civil)
+    year -= month <= 2;
+    long long era = year / 400;
+    long long yoe = year - era * 400;
+    long long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long long days = era * 146097 + doe - 719468;
+    
+    return days * 24LL * 3600 * 1000;
+}
+
 std::vector<std::string> NmeaParser::splitFields(const std::string& line) const {
     std::vector<std::string> fields;
     size_t start = 0;
@@ -245,6 +347,7 @@ std::optional<GpsPoint> NmeaParser::parseLine(const std::string& line) {
             auto rmc = parseRMC(fields);
             if (rmc.has_value()) {
                 lastRMC_ = rmc;
+                rememberDate(rmc->date, rmc->timestamp);
                 // Пытаемся создать точку только из RMC данных
                 point.timestamp = rmc->timestamp;
                 point.latitude = convertNmeaCoordinate(rmc->latitude, rmc->latHemisphere);
@@ -292,12 +395,155 @@ std::optional<GpsPoint> NmeaParser::parseLine(const std::string& line) {
     }
     
     if (parsed) {
+        point.setDateMs(dayStartFor(point.timestamp));
         return point;
     }
     
     return std::nullopt;
 }
 
+void NmeaParser::rememberDate(const std::string& date, unsigned long long timeOfDay) {
+    long long dateMs = parseDateToEpochMs(date);
+    if (dateMs >= 0) {
+        lastDateMs_ = dateMs;
+        lastDateTime_ = timeOfDay;
+    }
+}
+
+long long NmeaParser::dayStartFor(unsigned long long timeOfDay) const {
+    if (lastDateMs_ < 0) return -1;
+    // Разница больше половины суток - переход через полночь
+    const long long delta = static_cast<long long>(timeOfDay) - static_cast<long long>(lastDateTime_);
+    if (delta < -MS_PER_DAY / 2) return lastDateMs_ + MS_PER_DAY;
+    if (delta > MS_PER_DAY / 2) return lastDateMs_ - MS_PER_DAY;
+    return lastDateMs_;
+}
+
+std::optional<nmea::PackedRMCData> NmeaParser::parseRMCPacked(const std::vector<std::string>& fields) {
+    if (fields.size() < 12) return std::nullopt;
+    
+    nmea::PackedRMCData data;
+    data.timestamp = parseTimeToMs(fields[1]);
+    data.valid = (fields[2] == "A");
+    if (!fields[3].empty() && !fields[4].empty()) {
+        data.latitudeE7 = nmeaCoordinateToE7(fields[3], fields[4][0]);
+    }
+    if (!fields[5].empty() && !fields[6].empty()) {
+        data.longitudeE7 = nmeaCoordinateToE7(fields[5], fields[6][0]);
+    }
+    if (!fields[7].empty()) {
+        parseFixed(fields[7], 3, data.speedMilliKnots);
+    }
+    if (!fields[8].empty()) {
+        parseFixed(fields[8], 2, data.courseCentiDeg);
+    }
+    rememberDate(fields[9], data.timestamp);
+    return data;
+}
+
+std::optional<nmea::PackedGGAData> NmeaParser::parseGGAPacked(const std::vector<std::string>& fields) {
+    if (fields.size() < 14) return std::nullopt;
+    
+    nmea::PackedGGAData data;
+    data.timestamp = parseTimeToMs(fields[1]);
+    if (!fields[2].empty() && !fields[3].empty()) {
+        data.latitudeE7 = nmeaCoordinateToE7(fields[2], fields[3][0]);
+    }
+    if (!fields[4].empty() && !fields[5].empty()) {
+        data.longitudeE7 = nmeaCoordinateToE7(fields[4], fields[5][0]);
+    }
+    if (!fields[6].empty()) {
+        parseFixed(fields[6], 0, data.quality);
+    }
+    if (!fields[7].empty()) {
+        parseFixed(fields[7], 0, data.satellites);
+    }
+    if (!fields[8].empty()) {
+        parseFixed(fields[8], 2, data.hdopCenti);
+    }
+    if (!fields[9].empty()) {
+        parseFixed(fields[9], 2, data.altitudeCm);
+    }
+    return data;
+}
+
+std::optional<PackedGpsPoint> NmeaParser::parseLinePacked(const std::string& line) {
+    if (!validateChecksum(line)) {
+        return std::nullopt;
+    }
+    
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.empty() || fields[0].length() < 6) return std::nullopt;
+    
+    // Та же логика, что у parseLine: точка из одного предложения или из пары
+    // RMC и GGA с одинаковым временем
+    const nmea::PackedRMCData* rmc = nullptr;
+    const nmea::PackedGGAData* gga = nullptr;
+    const std::string msgType = fields[0].substr(3, 3);
+    // Ошибка разбора не стирает сохраненное предложение, как в parseLine
+    if (msgType == "RMC") {
+        auto parsed = parseRMCPacked(fields);
+        if (parsed) {
+            lastPackedRMC_ = parsed;
+            rmc = &*lastPackedRMC_;
+        }
+    } else if (msgType == "GGA") {
+        auto parsed = parseGGAPacked(fields);
+        if (parsed) {
+            lastPackedGGA_ = parsed;
+            gga = &*lastPackedGGA_;
+        }
+    }
+    
+    bool combined = lastPackedRMC_ && lastPackedGGA_ &&
+                    lastPackedRMC_->timestamp == lastPackedGGA_->timestamp;
+    if (combined) {
+        rmc = &*lastPackedRMC_;
+        gga = &*lastPackedGGA_;
+    }
+    if (!rmc && !gga) {
+        return std::nullopt;
+    }
+    
+    PackedGpsPoint packed;
+    unsigned long long timeOfDay = rmc ? rmc->timestamp : gga->timestamp;
+    packed.timestamp = static_cast<std::int64_t>(timeOfDay);
+    long long dayStart = dayStartFor(timeOfDay);
+    if (dayStart >= 0) {
+        packed.timestamp += dayStart;
+        packed.flags |= PackedGpsPoint::FLAG_EPOCH;
+    }
+    
+    // Координаты берем из RMC, как и combineData
+    packed.latitudeE7 = rmc ? rmc->latitudeE7 : gga->latitudeE7;
+    packed.longitudeE7 = rmc ? rmc->longitudeE7 : gga->longitudeE7;
+    
+    bool valid = true;
+    if (rmc) {
+        // узлы -> 0.01 км/ч: mkn * 1.852 * 100 / 1000
+        std::int64_t speed = (rmc->speedMilliKnots * 1852 + 5000) / 10000;
+        packed.speedCentiKmh = clampU16(speed);
+        packed.courseCentiDeg = clampU16(rmc->courseCentiDeg);
+        valid = valid && rmc->valid;
+    }
+    if (gga) {
+        packed.altitudeCm = static_cast<std::int32_t>(gga->altitudeCm);
+        packed.hdopCenti = clampU16(gga->hdopCenti);
+        packed.satellites = static_cast<std::uint8_t>(std::min<std::int64_t>(std::max<std::int64_t>(gga->satellites, 0), 0xFF));
+        valid = valid && (gga->quality > 0);
+    }
+    if (valid) {
+        packed.flags |= PackedGpsPoint::FLAG_VALID;
+    }
+    
+    if (combined) {
+        lastPackedRMC_.reset();
+        lastPackedGGA_.reset();
+    }
+    
+    return packed;
+}
+
 std::optional<nmea::GSVData> NmeaParser::getLastGSV() const {
     return lastGSV_;
 }
\ No newline at end of file
@@ -1,11 +1,23 @@
 #include "pipeline.h"
 #include "console_display.h"
 #include "file_display.h"
+#include "binary_track_display.h"
+#include "archive_display.h"
+#include "structured_display.h"
+#include "fanout_display.h"
+#include "network_display.h"
+#include "simplify_stage.h"
+#include "throttle_stage.h"
+#include "reverse_geocode_stage.h"
+#include "map_match_stage.h"
 #include "satellite_filter.h"
 #include "speed_filter.h"
 #include "jump_filter.h"
 #include "stop_filter.h"
 #include "smoothing_filter.h"
+#include "kalman_filter.h"
+#include "geofence_filter.h"
+#include "stay_point_filter.h"
 #include <algorithm>
 #include <iostream>
 
@@ -14,6 +26,10 @@ GpsPipeline::GpsPipeline(const JsonConfig& config)
     : config_(config)
     , history_(config.getHistorySize()) {
     
+    if (config.getHistoryDuration() > 0) {
+        setHistoryDuration(config.getHistoryDuration());
+    }
+    
     // Создание дисплея согласно конфигурации
     display_ = createDisplay(config);
     
@@ -30,17 +46,256 @@ GpsPipeline::GpsPipeline(std::unique_ptr<IDisplay> display)
     config_.setDisplayType("console");
 }
 
-GpsPipeline::~GpsPipeline() = default;
+GpsPipeline::~GpsPipeline() {
+    flush();
+}
 
 std::unique_ptr<IDisplay> GpsPipeline::createDisplay(const JsonConfig& config) {
-    if (config.getDisplayType() == "file" && !config.getOutputFile().empty()) {
-        return std::make_unique<FileDisplay>(
+    std::unique_ptr<IDisplay> display;
+    StructuredDisplay::Format format;
+    NetworkDisplay::Protocol protocol;
+    if (config.getDisplayType() == "fanout") {
+        // Каждый дочерний вывод создается как самостоятельный displayType
+        // с общими параметрами; стадии вывода применяются до размножения
+        auto fanout = std::make_unique<FanoutDisplay>();
+        for (const auto& sink : config.getSinks()) {
+            unsigned mask = FanoutDisplay::ALL;
+            if (!FanoutDisplay::parseMask(sink.events, mask)) {
+                std::cerr << "Warning: unknown events \"" << sink.events << "\" for sink " << sink.type << "\n";
+                mask = FanoutDisplay::ALL;
+            }
+            JsonConfig child = config;
+            child.setDisplayType(sink.type);
+            child.setOutputFile(sink.outputFile);
+            if (!sink.endpoint.empty()) {
+                child.setEndpoint(sink.endpoint);
+            }
+            child.clearOutputStages();
+            child.clearSinks();
+            fanout->addSink(createDisplay(child), mask, sink.queueSize);
+        }
+        display = std::move(fanout);
+    } else if (NetworkDisplay::parseProtocol(config.getDisplayType(), protocol)) {
+        NetworkDisplay::Format networkFormat = NetworkDisplay::Format::NDJSON;
+        if (!NetworkDisplay::parseFormat(config.getNetworkFormat(), networkFormat)) {
+            std::cerr << "Warning: unknown networkFormat \"" << config.getNetworkFormat() << "\", using ndjson\n";
+        }
+        std::string host;
+        unsigned short port = 0;
+        if (NetworkDisplay::parseEndpoint(config.getEndpoint(), host, port)) {
+            display = std::make_unique<NetworkDisplay>(
+                protocol,
+                networkFormat,
+                host,
+                port,
+                config.getBatchRecords(),
+                config.getLingerUs(),
+                config.getSendBufferBytes()
+            );
+        } else {
+            std::cerr << "Warning: invalid endpoint \"" << config.getEndpoint() << "\", using console\n";
+            display = std::make_unique<ConsoleDisplay>();
+        }
+    } else if (StructuredDisplay::parseFormat(config.getDisplayType(), format) && !config.getOutputFile().empty()) {
+        display = std::make_unique<StructuredDisplay>(
+            format,
+            config.getOutputFile(),
+            config.isFileRotation(),
+            config.getMaxFileSize(),
+            config.isAsyncOutput(),
+            config.getFlushInterval(),
+            config.getFlushBytes()
+        );
+    } else if (config.getDisplayType() == "file" && !config.getOutputFile().empty()) {
+        auto fileDisplay = std::make_unique<FileDisplay>(
             config.getOutputFile(),
             config.isFileRotation(),
-            config.getMaxFileSize()
+            config.getMaxFileSize(),
+            config.isAsyncOutput(),
+            config.getFlushInterval(),
+            config.getFlushBytes()
         );
+        if (config.getIoBackend() == "uring") {
+            fileDisplay->enableUring();
+        } else if (config.getIoBackend() == "mmap") {
+            fileDisplay->enableMmap();
+        }
+        if (config.isCompressRotated()) {
+            if (!config.isFileRotation()) {
+                std::cerr << "Warning: compressRotated requires fileRotation, output stays uncompressed\n";
+            } else if (!SegmentCompressor::isAvailable()) {
+                std::cerr << "Warning: built without zlib, compressRotated is ignored\n";
+            }
+        }
+        if (config.isFileRotation() &&
+            (config.isCompressRotated() || config.getRetainFiles() > 0 || config.getRetainBytes() > 0)) {
+            fileDisplay->enableCompression(config.isCompressRotated() ? config.getCompressionLevel() : 0,
+                                           config.getRetainFiles(), config.getRetainBytes());
+        }
+        display = std::move(fileDisplay);
+    } else if (config.getDisplayType() == "binary" && !config.getOutputFile().empty()) {
+        display = std::make_unique<BinaryTrackDisplay>(
+            config.getOutputFile(),
+            track_format::DEFAULT_BLOCK_RECORDS,
+            config.isAsyncOutput(),
+            config.getFlushInterval(),
+            config.getFlushBytes()
+        );
+    } else if (config.getDisplayType() == "archive" && !config.getOutputFile().empty()) {
+        display = std::make_unique<ArchiveDisplay>(
+            config.getOutputFile(),
+            archive_format::DEFAULT_ROW_GROUP,
+            config.isFileRotation(),
+            config.getMaxFileSize(),
+            config.isAsyncOutput(),
+            config.getFlushInterval(),
+            config.getFlushBytes()
+        );
+    } else {
+        display = std::make_unique<ConsoleDisplay>();
     }
-    return std::make_unique<ConsoleDisplay>();
+    
+    // Стадии оборачиваются с конца: первая в списке получает точки первой
+    const auto& stages = config.getOutputStages();
+    for (auto it = stages.rbegin(); it != stages.rend(); ++it) {
+        display = createStage(*it, std::move(display));
+    }
+    return display;
+}
+
+std::unique_ptr<IDisplay> GpsPipeline::createStage(const StageConfig& config, std::unique_ptr<IDisplay> next) {
+    if (config.type == "SimplifyStage") {
+        double tolerance = 5.0;
+        size_t maxLookahead = 100;
+        
+        auto it = config.params.find("tolerance");
+        if (it != config.params.end()) {
+            tolerance = it->second;
+        }
+        
+        it = config.params.find("maxLookahead");
+        if (it != config.params.end()) {
+            maxLookahead = static_cast<size_t>(it->second);
+        }
+        
+        return std::make_unique<SimplifyStage>(std::move(next), tolerance, maxLookahead);
+    }
+    if (config.type == "ThrottleStage") {
+        auto stage = std::make_unique<ThrottleStage>(std::move(next));
+        
+        auto it = config.params.find("distance");
+        if (it != config.params.end()) {
+            stage->setDistance(it->second);
+        }
+        
+        it = config.params.find("course");
+        if (it != config.params.end()) {
+            stage->setCourse(it->second);
+        }
+        
+        it = config.params.find("speed");
+        if (it != config.params.end()) {
+            stage->setSpeed(it->second);
+        }
+        
+        it = config.params.find("heartbeat");
+        if (it != config.params.end()) {
+            stage->setHeartbeat(it->second);
+        }
+        
+        return stage;
+    }
+    if (config.type == "ReverseGeocodeStage") {
+        double maxDistance = 50.0;
+        double cellSize = 0.005;
+        
+        auto it = config.params.find("maxDistance");
+        if (it != config.params.end()) {
+            maxDistance = it->second;
+        }
+        
+        it = config.params.find("cellSize");
+        if (it != config.params.end()) {
+            cellSize = it->second;
+        }
+        
+        auto stage = std::make_unique<ReverseGeocodeStage>(std::move(next), maxDistance, cellSize);
+        
+        // Готовый индекс отображается в память; иначе строится из сегментов
+        // и, если задан indexFile, сохраняется для следующих запусков
+        std::string indexFile;
+        auto sit = config.stringParams.find("indexFile");
+        if (sit != config.stringParams.end()) {
+            indexFile = sit->second;
+        }
+        
+        if (indexFile.empty() || !stage->getIndex().loadIndex(indexFile)) {
+            sit = config.stringParams.find("segmentsFile");
+            if (sit != config.stringParams.end()) {
+                if (!stage->getIndex().loadSegments(sit->second)) {
+                    std::cerr << "Warning: Cannot open segments file '" << sit->second << "'\n";
+                } else if (!indexFile.empty() && !stage->getIndex().saveIndex(indexFile)) {
+                    std::cerr << "Warning: Cannot write road index '" << indexFile << "'\n";
+                }
+            }
+        }
+        
+        return stage;
+    }
+    if (config.type == "MapMatchStage") {
+        double sigma = 10.0;
+        double beta = 50.0;
+        size_t lag = 5;
+        
+        auto it = config.params.find("sigma");
+        if (it != config.params.end()) {
+            sigma = it->second;
+        }
+        
+        it = config.params.find("beta");
+        if (it != config.params.end()) {
+            beta = it->second;
+        }
+        
+        it = config.params.find("lag");
+        if (it != config.params.end()) {
+            lag = static_cast<size_t>(it->second);
+        }
+        
+        auto stage = std::make_unique<MapMatchStage>(std::move(next), sigma, beta, lag);
+        
+        it = config.params.find("searchRadius");
+        if (it != config.params.end()) {
+            stage->setSearchRadius(it->second);
+        }
+        
+        it = config.params.find("maxCandidates");
+        if (it != config.params.end()) {
+            stage->setMaxCandidates(static_cast<size_t>(it->second));
+        }
+        
+        double routeLimit = stage->getRouteCache().getLimit();
+        size_t cacheSize = 256;
+        it = config.params.find("routeLimit");
+        if (it != config.params.end()) {
+            routeLimit = it->second;
+        }
+        it = config.params.find("cacheSize");
+        if (it != config.params.end()) {
+            cacheSize = static_cast<size_t>(it->second);
+        }
+        stage->setRouteCache(routeLimit, cacheSize);
+        
+        auto sit = config.stringParams.find("graphFile");
+        if (sit == config.stringParams.end() || !stage->getGraph().loadFromFile(sit->second)) {
+            std::cerr << "Warning: MapMatchStage has no road graph, points pass unmatched\n";
+        }
+        
+        return stage;
+    }
+    
+    std::cerr << "Warning: Unknown output stage '" << config.type << "'\n";
+    return next;
 }
 
 std::unique_ptr<IGpsFilter> GpsPipeline::createFilter(const FilterConfig& config) {
@@ -94,6 +349,85 @@ std::unique_ptr<IGpsFilter> GpsPipeline::createFilter(const FilterConfig& config
         
         filter = std::make_unique<SmoothingFilter>(cutoff, sampleRate);
     }
+    else if (config.type == "KalmanFilter") {
+        double measurementNoise = 5.0;
+        double processNoise = 1.0;
+        
+        auto it = config.params.find("measurementNoise");
+        if (it != config.params.end()) {
+            measurementNoise = it->second;
+        }
+        
+        it = config.params.find("processNoise");
+        if (it != config.params.end()) {
+            processNoise = it->second;
+        }
+        
+        auto kalman = std::make_unique<KalmanFilter>(measurementNoise, processNoise);
+        
+        it = config.params.find("gateSigma");
+        if (it != config.params.end()) {
+            kalman->setGateSigma(it->second);
+        }
+        
+        it = config.params.find("maxGap");
+        if (it != config.params.end()) {
+            kalman->setMaxGap(it->second);
+        }
+        
+        filter = std::move(kalman);
+    }
+    else if (config.type == "GeofenceFilter") {
+        double cellSize = 0.01;
+        double dwellTime = 0.0;
+        
+        auto it = config.params.find("cellSize");
+        if (it != config.params.end()) {
+            cellSize = it->second;
+        }
+        
+        it = config.params.find("dwellTime");
+        if (it != config.params.end()) {
+            dwellTime = it->second;
+        }
+        
+        auto geofence = std::make_unique<GeofenceFilter>(cellSize, dwellTime);
+        
+        auto zones = config.stringParams.find("zonesFile");
+        if (zones != config.stringParams.end() && !geofence->loadZones(zones->second)) {
+            std::cerr << "Warning: Cannot open zones file " << zones->second << "\n";
+        }
+        
+        filter = std::move(geofence);
+    }
+    else if (config.type == "StayPointFilter") {
+        double radius = 30.0;
+        double minDuration = 120.0;
+        
+        auto it = config.params.find("radius");
+        if (it != config.params.end()) {
+            radius = it->second;
+        }
+        
+        it = config.params.find("minDuration");
+        if (it != config.params.end()) {
+            minDuration = it->second;
+        }
+        
+        auto stay = std::make_unique<StayPointFilter>(radius, minDuration);
+        
+        it = config.params.find("speedThreshold");
+        if (it != config.params.end()) {
+            stay->setSpeedThreshold(it->second);
+        }
+        
+        it = config.params.find("heartbeat");
+        if (it != config.params.end()) {
+            stay->setHeartbeat(it->second);
+        }
+        
+        filter = std::move(stay);
+    }
     else {
         std::cerr << "Warning: Unknown filter type '" << config.type << "'\n";
         return nullptr;
@@ -109,6 +443,7 @@ void GpsPipeline::setupFilters(const JsonConfig& config) {
     for (const auto& filterConfig : config.getFilters()) {
         auto filter = createFilter(filterConfig);
         if (filter) {
+            filter->setDisplay(display_.get());
             filters_.emplace_back(filterConfig.priority, std::move(filter));
         }
     }
@@ -121,6 +456,7 @@ void GpsPipeline::setupFilters(const JsonConfig& config) {
 }
 
 void GpsPipeline::addFilter(std::unique_ptr<IGpsFilter> filter, int priority) {
+    filter->setDisplay(display_.get());
     filters_.emplace_back(priority, std::move(filter));
     // Сортировка по приоритету (меньший приоритет = выполняется раньше)
     std::sort(filters_.begin(), filters_.end(),
@@ -144,6 +480,11 @@ void GpsPipeline::applyFilters(GpsPoint& point) {
             // Точка обработана фильтром остановки
             break;
         }
+        else if (result == FilterResult::SUPPRESS) {
+            // Точка учтена фильтром (например, стоянкой) и дальше не идет
+            suppressedCount_++;
+            return;
+        }
         // PASS - продолжаем
     }
     
@@ -164,7 +505,7 @@ void GpsPipeline::process(const std::string& nmeaLine) {
         return;
     }
     
-    GpsPoint point = *pointOpt;
+    GpsPoint& point = *pointOpt;
     
     if (!point.isValid) {
         display_->showInvalidFix(point.timestamp);
@@ -174,10 +515,25 @@ void GpsPipeline::process(const std::string& nmeaLine) {
     applyFilters(point);
 }
 
+void GpsPipeline::flush() {
+    for (auto& [priority, filter] : filters_) {
+        if (filter->isEnabled()) {
+            filter->flush();
+        }
+    }
+    if (display_) {
+        display_->flush();
+    }
+}
+
 void GpsPipeline::setHistorySize(size_t size) {
     history_.setMaxSize(size);
 }
 
+void GpsPipeline::setHistoryDuration(double seconds) {
+    history_.setMaxDuration(static_cast<unsigned long long>(seconds * 1000.0));
+}
+
 GpsHistory& GpsPipeline::getHistory() {
     return history_;
 }
@@ -198,6 +554,14 @@ int GpsPipeline::getRejectedCount() const {
     return rejectedCount_;
 }
 
+IDisplay* GpsPipeline::getDisplay() const {
+    return display_.get();
+}
+
+int GpsPipeline::getSuppressedCount() const {
+    return suppressedCount_;
+}
+
 int GpsPipeline::getErrorCount() const {
     return errorCount_;
 }
@@ -0,0 +1,86 @@
+#include "record_format.h"
+#include "record_writer.h"
+#include <cstring>
+
+namespace record_format {
+
+size_t formatPoint(const GpsPoint& point, char* out, size_t capacity) {
+    Writer w(out, capacity);
+    w.putTime(point.timestamp);
+    w.put(" Coordinates: ");
+    w.putLatitude(point.latitude);
+    w.put(", ");
+    w.putLongitude(point.longitude);
+    w.put("\n               Speed: ");
+    w.putFixed(point.speed, 1);
+    w.put(" km/h");
+    if (point.speed < 0.1) {
+        w.put(" (stopped)");
+    }
+    w.put(", Course: ");
+    w.putFixed(point.course, 1);
+    w.put("°\n               Altitude: ");
+    w.putFixed(point.altitude, 0);
+    w.put("m, Satellites: ");
+    w.putInt(point.satellites);
+    w.put(", HDOP: ");
+    w.putFixed(point.hdop, 1);
+    w.putChar('\n');
+    if (point.label) {
+        w.put("               Road: ");
+        w.put(point.label, std::strlen(point.label));
+        w.putChar('\n');
+    }
+    return w.length();
+}
+
+size_t formatInvalidFix(unsigned long long timestamp, char* out, size_t capacity) {
+    Writer w(out, capacity);
+    w.putTime(timestamp);
+    w.put(" No valid GPS fix\n");
+    return w.length();
+}
+
+size_t formatParseError(const std::string& error, char* out, size_t capacity) {
+    Writer w(out, capacity);
+    w.put("Parse error: ");
+    w.put(error);
+    w.putChar('\n');
+    return w.length();
+}
+
+size_t formatRejected(const std::string& reason, char* out, size_t capacity) {
+    Writer w(out, capacity);
+    w.put("Point rejected: ");
+    w.put(reason);
+    w.putChar('\n');
+    return w.length();
+}
+
+size_t formatEvent(const GpsEvent& event, char* out, size_t capacity) {
+    Writer w(out, capacity);
+    w.putTime(event.timestamp);
+    w.put(" Event: ");
+    w.put(event.source);
+    w.putChar(' ');
+    const char* type = eventTypeName(event.type);
+    w.put(type, std::strlen(type));
+    if (!event.subject.empty()) {
+        w.put(" '");
+        w.put(event.subject);
+        w.putChar('\'');
+    }
+    w.put(" at ");
+    w.putLatitude(event.latitude);
+    w.put(", ");
+    w.putLongitude(event.longitude);
+    if (event.durationMs > 0) {
+        w.put(", duration: ");
+        w.putInt(event.durationMs / 1000);
+        w.putChar('s');
+    }
+    w.putChar('\n');
+    return w.length();
+}
+
+}
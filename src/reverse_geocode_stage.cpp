@@ -0,0 +1,87 @@
+#include "reverse_geocode_stage.h"
+
+ReverseGeocodeStage::ReverseGeocodeStage(std::unique_ptr<IDisplay> next, double maxDistanceMeters,
+                                         double cellSizeDegrees)
+    : DisplayStage(std::move(next))
+    , index_(cellSizeDegrees)
+    , maxDistanceMeters_(maxDistanceMeters) {}
+
+ReverseGeocodeStage::~ReverseGeocodeStage() = default;
+
+void ReverseGeocodeStage::resetCache() {
+    hasLast_ = false;
+    lastMatch_ = RoadIndex::Match();
+    labelSegment_ = RoadIndex::NO_SEGMENT;
+    label_ = nullptr;
+}
+
+void ReverseGeocodeStage::showPoint(const GpsPoint& point) {
+    queryCount_++;
+    
+    if (hasLast_ && point.latitude == lastLatitude_ && point.longitude == lastLongitude_) {
+        cacheHitCount_++;
+    } else {
+        index_.nearest(point.latitude, point.longitude, maxDistanceMeters_, lastMatch_, lastMatch_.segment);
+        hasLast_ = true;
+        lastLatitude_ = point.latitude;
+        lastLongitude_ = point.longitude;
+    }
+    
+    if (!lastMatch_.name) {
+        next_->showPoint(point);
+        return;
+    }
+    
+    // Имя из индекса (возможно, отображенного в память) копируется в пул
+    // подписей один раз на сегмент
+    if (lastMatch_.segment != labelSegment_) {
+        labelSegment_ = lastMatch_.segment;
+        label_ = internLabel(lastMatch_.name);
+    }
+    
+    matchCount_++;
+    GpsPoint labeled = point;
+    labeled.label = label_;
+    next_->showPoint(labeled);
+}
+
+void ReverseGeocodeStage::showInvalidFix(unsigned long long timestamp) {
+    resetCache();
+    next_->showInvalidFix(timestamp);
+}
+
+void ReverseGeocodeStage::clear() {
+    resetCache();
+    next_->clear();
+}
+
+RoadIndex& ReverseGeocodeStage::getIndex() {
+    // Индекс может быть перестроен: прежние ответы недействительны
+    resetCache();
+    return index_;
+}
+
+const RoadIndex& ReverseGeocodeStage::getIndex() const {
+    return index_;
+}
+
+void ReverseGeocodeStage::setMaxDistance(double meters) {
+    maxDistanceMeters_ = meters;
+    resetCache();
+}
+
+double ReverseGeocodeStage::getMaxDistance() const {
+    return maxDistanceMeters_;
+}
+
+size_t ReverseGeocodeStage::getQueryCount() const {
+    return queryCount_;
+}
+
+size_t ReverseGeocodeStage::getCacheHitCount() const {
+    return cacheHitCount_;
+}
+
+size_t ReverseGeocodeStage::getMatchCount() const {
+    return matchCount_;
+}
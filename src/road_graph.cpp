@@ -0,0 +1,229 @@
+#include "road_graph.h"
+#include "geodesy.h"
+#include "geo_util.h"
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <sstream>
+
+namespace {
+    bool parseId(const std::string& text, long long& value) {
+        const char* begin = text.c_str();
+        char* end = nullptr;
+        value = std::strtoll(begin, &end, 10);
+        return end != begin && *end == '\0';
+    }
+}
+
+RoadGraph::RoadGraph(double cellSizeDegrees) : index_(cellSizeDegrees) {}
+
+bool RoadGraph::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    // Идентификаторы файла -> номера узлов
+    std::unordered_map<long long, std::uint32_t> ids;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        
+        std::vector<std::string> fields;
+        std::istringstream ss(line.substr(first));
+        std::string field;
+        while (std::getline(ss, field, ';')) {
+            fields.push_back(field);
+        }
+        
+        bool ok = false;
+        if (fields.size() == 4 && fields[0] == "N") {
+            long long id = 0;
+            double lat = 0.0, lon = 0.0;
+            ok = parseId(fields[1], id) && geo::parseNumber(fields[2], lat) && geo::parseNumber(fields[3], lon) &&
+                 ids.find(id) == ids.end();
+            if (ok) {
+                ids[id] = addNode(lat, lon);
+            }
+        } else if ((fields.size() == 3 || fields.size() == 4) && fields[0] == "E") {
+            long long a = 0, b = 0;
+            ok = parseId(fields[1], a) && parseId(fields[2], b) &&
+                 ids.find(a) != ids.end() && ids.find(b) != ids.end();
+            if (ok) {
+                addEdge(ids[a], ids[b], fields.size() == 4 ? fields[3] : std::string());
+            }
+        }
+        if (!ok) {
+            skippedLines_++;
+        }
+    }
+    
+    if (skippedLines_ > 0) {
+        std::cerr << "Warning: " << skippedLines_ << " invalid graph line(s) skipped in " << filename << "\n";
+    }
+    build();
+    return true;
+}
+
+std::uint32_t RoadGraph::addNode(double lat, double lon) {
+    nodes_.push_back({lat, lon});
+    return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+void RoadGraph::addEdge(std::uint32_t from, std::uint32_t to, const std::string& name) {
+    const Node& a = nodes_[from];
+    const Node& b = nodes_[to];
+    edges_.push_back({from, to, geo::haversineDistance(a.latitude, a.longitude, b.latitude, b.longitude)});
+    index_.addSegment(name, a.latitude, a.longitude, b.latitude, b.longitude);
+}
+
+void RoadGraph::build() {
+    // Списки смежности в плоском виде (CSR), ребро видно с обоих концов
+    arcOffsets_.assign(nodes_.size() + 1, 0);
+    for (const auto& edge : edges_) {
+        arcOffsets_[edge.from + 1]++;
+        arcOffsets_[edge.to + 1]++;
+    }
+    for (size_t i = 1; i < arcOffsets_.size(); i++) {
+        arcOffsets_[i] += arcOffsets_[i - 1];
+    }
+    arcs_.resize(arcOffsets_.back());
+    std::vector<std::uint32_t> fill(arcOffsets_.begin(), arcOffsets_.end() - 1);
+    for (std::uint32_t e = 0; e < edges_.size(); e++) {
+        arcs_[fill[edges_[e].from]++] = {edges_[e].to, e};
+        arcs_[fill[edges_[e].to]++] = {edges_[e].from, e};
+    }
+    index_.build();
+}
+
+void RoadGraph::clear() {
+    nodes_.clear();
+    edges_.clear();
+    arcOffsets_.clear();
+    arcs_.clear();
+    index_.clear();
+    skippedLines_ = 0;
+}
+
+size_t RoadGraph::nodeCount() const {
+    return nodes_.size();
+}
+
+size_t RoadGraph::edgeCount() const {
+    return edges_.size();
+}
+
+const RoadGraph::Node& RoadGraph::getNode(std::uint32_t node) const {
+    return nodes_[node];
+}
+
+const RoadGraph::Edge& RoadGraph::getEdge(std::uint32_t edge) const {
+    return edges_[edge];
+}
+
+const char* RoadGraph::getEdgeName(std::uint32_t edge) const {
+    return index_.getName(edge);
+}
+
+const RoadIndex& RoadGraph::getIndex() const {
+    return index_;
+}
+
+size_t RoadGraph::getSkippedLines() const {
+    return skippedLines_;
+}
+
+const RoadGraph::Arc* RoadGraph::arcsBegin(std::uint32_t node) const {
+    return arcs_.data() + arcOffsets_[node];
+}
+
+const RoadGraph::Arc* RoadGraph::arcsEnd(std::uint32_t node) const {
+    return arcs_.data() + arcOffsets_[node + 1];
+}
+
+RouteCache::RouteCache(const RoadGraph& graph, double limitMeters, size_t capacity)
+    : graph_(graph)
+    , limitMeters_(limitMeters)
+    , capacity_(capacity > 0 ? capacity : 1) {}
+
+const RouteCache::Tree& RouteCache::tree(std::uint32_t source) {
+    auto it = trees_.find(source);
+    if (it != trees_.end()) {
+        hitCount_++;
+        lru_.splice(lru_.begin(), lru_, it->second.position);
+        return it->second;
+    }
+    
+    missCount_++;
+    if (trees_.size() >= capacity_) {
+        trees_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(source);
+    Tree& tree = trees_[source];
+    tree.position = lru_.begin();
+    
+    // Дейкстра от источника до границы limitMeters
+    using Entry = std::pair<double, std::uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    tree.distances[source] = 0.0;
+    queue.push({0.0, source});
+    while (!queue.empty()) {
+        auto [dist, node] = queue.top();
+        queue.pop();
+        if (dist > tree.distances[node]) continue;
+        for (const auto* arc = graph_.arcsBegin(node); arc != graph_.arcsEnd(node); ++arc) {
+            double next = dist + graph_.getEdge(arc->edge).length;
+            if (next > limitMeters_) continue;
+            auto found = tree.distances.find(arc->node);
+            if (found == tree.distances.end() || next < found->second) {
+                tree.distances[arc->node] = next;
+                queue.push({next, arc->node});
+            }
+        }
+    }
+    return tree;
+}
+
+double RouteCache::distance(std::uint32_t from, std::uint32_t to) {
+    if (from == to) return 0.0;
+    const Tree& t = tree(from);
+    auto it = t.distances.find(to);
+    return it != t.distances.end() ? it->second : std::numeric_limits<double>::infinity();
+}
+
+void RouteCache::setLimits(double limitMeters, size_t capacity) {
+    limitMeters_ = limitMeters;
+    capacity_ = capacity > 0 ? capacity : 1;
+    clear();
+}
+
+void RouteCache::clear() {
+    trees_.clear();
+    lru_.clear();
+}
+
+size_t RouteCache::size() const {
+    return trees_.size();
+}
+
+size_t RouteCache::getHitCount() const {
+    return hitCount_;
+}
+
+size_t RouteCache::getMissCount() const {
+    return missCount_;
+}
+
+double RouteCache::getLimit() const {
+    return limitMeters_;
+}
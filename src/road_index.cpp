@@ -0,0 +1,473 @@
+#include "road_index.h"
+#include "geodesy.h"
+#include "geo_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char MAGIC[8] = {'G', 'P', 'S', 'R', 'O', 'A', 'D', '1'};
+    // Смещение номера ячейки, чтобы ключ был неотрицательным
+    const long long CELL_BIAS = 1LL << 31;
+    // Ограничение числа колец сетки при поиске (у полюсов ячейки очень узкие)
+    const long long MAX_RINGS = 256;
+    
+    size_t align8(size_t value) {
+        return (value + 7) & ~static_cast<size_t>(7);
+    }
+    
+    // Арифметика размеров с проверкой переполнения: заголовок файла индекса
+    // не доверенный, а смещения из него используются для указателей
+    bool checkedAdd(size_t a, size_t b, size_t& out) {
+        return !__builtin_add_overflow(a, b, &out);
+    }
+    
+    bool checkedMul(std::uint64_t count, size_t item, size_t& out) {
+        return !__builtin_mul_overflow(count, item, &out);
+    }
+    
+    bool checkedAlign8(size_t value, size_t& out) {
+        if (!checkedAdd(value, 7, out)) return false;
+        out &= ~static_cast<size_t>(7);
+        return true;
+    }
+}
+
+RoadIndex::RoadIndex(double cellSizeDegrees)
+    : cellSize_(cellSizeDegrees > 0.0 ? cellSizeDegrees : 0.005) {}
+
+RoadIndex::~RoadIndex() {
+    unmap();
+}
+
+std::uint64_t RoadIndex::cellKey(long long ix, long long iy) const {
+    return (static_cast<std::uint64_t>(iy + CELL_BIAS) << 32) |
+           static_cast<std::uint32_t>(ix + CELL_BIAS);
+}
+
+long long RoadIndex::cellIndex(double degrees) const {
+    return static_cast<long long>(std::floor(degrees / cellSize_));
+}
+
+void RoadIndex::addSegment(const std::string& name, double lat1, double lon1, double lat2, double lon2) {
+    pending_.push_back({name, lat1, lon1, lat2, lon2});
+}
+
+bool RoadIndex::loadSegments(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        
+        const char sep = line.find('\t') != std::string::npos ? '\t' : ';';
+        std::vector<std::string> fields;
+        std::istringstream ss(line.substr(first));
+        std::string field;
+        while (std::getline(ss, field, sep)) {
+            fields.push_back(field);
+        }
+        
+        double coords[4];
+        bool ok = fields.size() == 5 && !fields[0].empty();
+        for (size_t i = 0; ok && i < 4; i++) {
+            ok = geo::parseNumber(fields[i + 1], coords[i]);
+        }
+        if (!ok) {
+            skippedLines_++;
+            continue;
+        }
+        addSegment(fields[0], coords[0], coords[1], coords[2], coords[3]);
+    }
+    
+    if (skippedLines_ > 0) {
+        std::cerr << "Warning: " << skippedLines_ << " invalid segment(s) skipped in " << filename << "\n";
+    }
+    build();
+    return true;
+}
+
+void RoadIndex::build() {
+    // Сегменты уже построенного индекса сохраняются
+    std::vector<PendingSegment> all;
+    all.reserve(segmentCount_ + pending_.size());
+    for (size_t i = 0; i < segmentCount_; i++) {
+        const Segment& s = segments_[i];
+        all.push_back({names_ + s.nameOffset, s.lat1, s.lon1, s.lat2, s.lon2});
+    }
+    for (auto& s : pending_) {
+        all.push_back(std::move(s));
+    }
+    pending_.clear();
+    
+    // Пары (ячейка, сегмент), отсортированные по ячейке
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> pairs;
+    size_t namesSize = 0;
+    for (size_t i = 0; i < all.size(); i++) {
+        const auto& s = all[i];
+        // Только ячейки, через которые проходит отрезок: в каждом столбце
+        // сетки берется диапазон широт его части внутри столбца. Длинный
+        // диагональный сегмент занимает O(длины) ячеек, а не весь прямоугольник
+        const bool forward = s.lon1 <= s.lon2;
+        const double lonA = forward ? s.lon1 : s.lon2;
+        const double latA = forward ? s.lat1 : s.lat2;
+        const double lonB = forward ? s.lon2 : s.lon1;
+        const double latB = forward ? s.lat2 : s.lat1;
+        const long long x0 = cellIndex(lonA);
+        const long long x1 = cellIndex(lonB);
+        auto latAt = [&](double lon) {
+            return latA + (latB - latA) * (lon - lonA) / (lonB - lonA);
+        };
+        for (long long ix = x0; ix <= x1; ix++) {
+            const double latFrom = ix == x0 ? latA : latAt(static_cast<double>(ix) * cellSize_);
+            const double latTo = ix == x1 ? latB : latAt(static_cast<double>(ix + 1) * cellSize_);
+            const long long y0 = cellIndex(std::min(latFrom, latTo));
+            const long long y1 = cellIndex(std::max(latFrom, latTo));
+            for (long long iy = y0; iy <= y1; iy++) {
+                pairs.emplace_back(cellKey(ix, iy), static_cast<std::uint32_t>(i));
+            }
+        }
+        namesSize += s.name.size() + 1;
+    }
+    std::sort(pairs.begin(), pairs.end());
+    
+    size_t cellCount = 0;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (i == 0 || pairs[i].first != pairs[i - 1].first) cellCount++;
+    }
+    
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.cellSize = cellSize_;
+    header.segmentCount = all.size();
+    header.cellCount = cellCount;
+    header.entryCount = pairs.size();
+    header.namesSize = namesSize;
+    
+    Layout parts;
+    layout(header, parts);
+    const size_t total = align8(parts.end);
+    std::vector<std::uint64_t> storage(total / sizeof(std::uint64_t), 0);
+    std::uint8_t* base = reinterpret_cast<std::uint8_t*>(storage.data());
+    std::memcpy(base, &header, sizeof(header));
+    
+    Segment* segments = reinterpret_cast<Segment*>(base + parts.segments);
+    char* names = reinterpret_cast<char*>(base + parts.names);
+    size_t nameOffset = 0;
+    for (size_t i = 0; i < all.size(); i++) {
+        const auto& s = all[i];
+        segments[i] = {s.lat1, s.lon1, s.lat2, s.lon2, nameOffset};
+        std::memcpy(names + nameOffset, s.name.c_str(), s.name.size() + 1);
+        nameOffset += s.name.size() + 1;
+    }
+    
+    std::uint64_t* keys = reinterpret_cast<std::uint64_t*>(base + parts.keys);
+    std::uint32_t* offsets = reinterpret_cast<std::uint32_t*>(base + parts.offsets);
+    std::uint32_t* entries = reinterpret_cast<std::uint32_t*>(base + parts.entries);
+    size_t cell = 0;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+            keys[cell] = pairs[i].first;
+            offsets[cell] = static_cast<std::uint32_t>(i);
+            cell++;
+        }
+        entries[i] = pairs[i].second;
+    }
+    offsets[cellCount] = static_cast<std::uint32_t>(pairs.size());
+    
+    unmap();
+    storage_ = std::move(storage);
+    attach(reinterpret_cast<const std::uint8_t*>(storage_.data()), total);
+}
+
+bool RoadIndex::layout(const Header& header, Layout& out) {
+    // Заголовок, сегменты, ключи, смещения (cellCount + 1), номера, имена
+    size_t bytes = 0;
+    out.segments = align8(sizeof(Header));
+    return checkedMul(header.segmentCount, sizeof(Segment), bytes) &&
+           checkedAdd(out.segments, bytes, out.keys) &&
+           checkedMul(header.cellCount, sizeof(std::uint64_t), bytes) &&
+           checkedAdd(out.keys, bytes, out.offsets) &&
+           header.cellCount < SIZE_MAX &&
+           checkedMul(header.cellCount + 1, sizeof(std::uint32_t), bytes) &&
+           checkedAdd(out.offsets, bytes, bytes) &&
+           checkedAlign8(bytes, out.entries) &&
+           checkedMul(header.entryCount, sizeof(std::uint32_t), bytes) &&
+           checkedAdd(out.entries, bytes, bytes) &&
+           checkedAlign8(bytes, out.names) &&
+           checkedAdd(out.names, header.namesSize, out.end);
+}
+
+bool RoadIndex::attach(const std::uint8_t* data, size_t size) {
+    Header header;
+    if (size < sizeof(Header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || !(header.cellSize > 0.0)) {
+        return false;
+    }
+    // Номера сегментов и смещения записей хранятся в uint32
+    if (header.segmentCount >= NO_SEGMENT || header.entryCount > 0xFFFFFFFFu) {
+        return false;
+    }
+    
+    Layout parts;
+    if (!layout(header, parts) || parts.end > size) {
+        return false;
+    }
+    
+    // Один проход по образу при загрузке, чтобы поиск не проверял границы:
+    // ключи ячеек возрастают, смещения не убывают и не выходят за номера,
+    // номера ссылаются на существующие сегменты, имена внутри блока имен
+    const auto* segments = reinterpret_cast<const Segment*>(data + parts.segments);
+    const auto* keys = reinterpret_cast<const std::uint64_t*>(data + parts.keys);
+    const auto* offsets = reinterpret_cast<const std::uint32_t*>(data + parts.offsets);
+    const auto* entries = reinterpret_cast<const std::uint32_t*>(data + parts.entries);
+    const auto* names = reinterpret_cast<const char*>(data + parts.names);
+    
+    if (header.namesSize > 0 && names[header.namesSize - 1] != '\0') return false;
+    for (size_t i = 0; i < header.segmentCount; i++) {
+        if (segments[i].nameOffset >= header.namesSize) return false;
+    }
+    if (offsets[0] != 0 || offsets[header.cellCount] > header.entryCount) return false;
+    for (size_t c = 0; c < header.cellCount; c++) {
+        if (offsets[c] > offsets[c + 1]) return false;
+        if (c > 0 && keys[c - 1] >= keys[c]) return false;
+    }
+    for (size_t e = 0; e < header.entryCount; e++) {
+        if (entries[e] >= header.segmentCount) return false;
+    }
+    
+    image_ = data;
+    imageSize_ = std::min(align8(parts.end), size);
+    cellSize_ = header.cellSize;
+    segments_ = segments;
+    segmentCount_ = header.segmentCount;
+    cellKeys_ = keys;
+    cellOffsets_ = offsets;
+    cellCount_ = header.cellCount;
+    entries_ = entries;
+    names_ = names;
+    namesSize_ = header.namesSize;
+    return true;
+}
+
+bool RoadIndex::saveIndex(const std::string& filename) const {
+    if (!image_) return false;
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char*>(image_), static_cast<std::streamsize>(imageSize_));
+    return static_cast<bool>(file);
+}
+
+bool RoadIndex::loadIndex(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    
+    const double cellSize = cellSize_;
+    clear();
+    if (!attach(static_cast<const std::uint8_t*>(data), static_cast<size_t>(st.st_size))) {
+        ::munmap(data, static_cast<size_t>(st.st_size));
+        cellSize_ = cellSize;
+        std::cerr << "Warning: invalid road index file " << filename << "\n";
+        return false;
+    }
+    mapped_ = data;
+    mappedSize_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void RoadIndex::unmap() {
+    if (mapped_) {
+        ::munmap(mapped_, mappedSize_);
+        mapped_ = nullptr;
+        mappedSize_ = 0;
+    }
+    storage_.clear();
+    image_ = nullptr;
+    imageSize_ = 0;
+    segments_ = nullptr;
+    segmentCount_ = 0;
+    cellKeys_ = nullptr;
+    cellOffsets_ = nullptr;
+    cellCount_ = 0;
+    entries_ = nullptr;
+    names_ = nullptr;
+    namesSize_ = 0;
+}
+
+double RoadIndex::distance2(std::uint32_t segment, double lat, double lon, double lonScale) const {
+    const Segment& s = segments_[segment];
+    return geo::segmentDistance2(lon * lonScale, lat,
+                            s.lon1 * lonScale, s.lat1, s.lon2 * lonScale, s.lat2);
+}
+
+template <typename Visit, typename Bound>
+void RoadIndex::forEachRing(double lat, double lon, double lonScale, long long maxRings,
+                            Visit visit, Bound bound) const {
+    // Кольцо r не ближе (r - 1) ячеек по узкой стороне ячейки
+    const double cellWidth = cellSize_ * std::max(lonScale, 1e-6);
+    const long long cx = cellIndex(lon);
+    const long long cy = cellIndex(lat);
+    
+    auto visitCell = [&](long long ix, long long iy) {
+        const std::uint64_t key = cellKey(ix, iy);
+        const std::uint64_t* it = std::lower_bound(cellKeys_, cellKeys_ + cellCount_, key);
+        if (it == cellKeys_ + cellCount_ || *it != key) return;
+        const size_t cell = static_cast<size_t>(it - cellKeys_);
+        for (std::uint32_t e = cellOffsets_[cell]; e < cellOffsets_[cell + 1]; e++) {
+            visit(entries_[e]);
+        }
+    };
+    
+    visitCell(cx, cy);
+    for (long long r = 1; r <= maxRings; r++) {
+        const double ringDistance = (r - 1) * cellWidth;
+        if (ringDistance * ringDistance > bound()) break;
+        for (long long ix = cx - r; ix <= cx + r; ix++) {
+            visitCell(ix, cy - r);
+            visitCell(ix, cy + r);
+        }
+        for (long long iy = cy - r + 1; iy <= cy + r - 1; iy++) {
+            visitCell(cx - r, iy);
+            visitCell(cx + r, iy);
+        }
+    }
+}
+
+bool RoadIndex::nearest(double lat, double lon, double maxDistanceMeters, Match& match,
+                        std::uint32_t hint) const {
+    match = Match();
+    if (segmentCount_ == 0) return false;
+    
+    // Расстояния считаются в плоскости (долгота * cos(широты), широта), градусы
+    const double metersPerDeg = geo::EARTH_RADIUS * geo::DEG_TO_RAD;
+    const double lonScale = std::cos(lat * geo::DEG_TO_RAD);
+    const double maxDeg = maxDistanceMeters / metersPerDeg;
+    double best2 = maxDeg * maxDeg;
+    std::uint32_t best = NO_SEGMENT;
+    
+    if (hint < segmentCount_) {
+        double d2 = distance2(hint, lat, lon, lonScale);
+        if (d2 <= best2) {
+            best2 = d2;
+            best = hint;
+        }
+    }
+    
+    const double cellWidth = cellSize_ * std::max(lonScale, 1e-6);
+    const long long maxRings = std::min(MAX_RINGS, static_cast<long long>(maxDeg / cellWidth) + 1);
+    forEachRing(lat, lon, lonScale, maxRings,
+                [&](std::uint32_t segment) {
+                    double d2 = distance2(segment, lat, lon, lonScale);
+                    if (d2 < best2 || (d2 == best2 && segment < best)) {
+                        best2 = d2;
+                        best = segment;
+                    }
+                },
+                [&]() { return best2; });
+    
+    if (best == NO_SEGMENT) return false;
+    match.segment = best;
+    match.distance = std::sqrt(best2) * metersPerDeg;
+    match.name = getName(best);
+    return true;
+}
+
+size_t RoadIndex::candidates(double lat, double lon, double radiusMeters, size_t maxCount,
+                             std::vector<Match>& out) const {
+    out.clear();
+    if (segmentCount_ == 0 || maxCount == 0) return 0;
+    
+    const double metersPerDeg = geo::EARTH_RADIUS * geo::DEG_TO_RAD;
+    const double lonScale = std::cos(lat * geo::DEG_TO_RAD);
+    const double maxDeg = radiusMeters / metersPerDeg;
+    const double max2 = maxDeg * maxDeg;
+    const double cellWidth = cellSize_ * std::max(lonScale, 1e-6);
+    const long long maxRings = std::min(MAX_RINGS, static_cast<long long>(maxDeg / cellWidth) + 1);
+    
+    forEachRing(lat, lon, lonScale, maxRings,
+                [&](std::uint32_t segment) {
+                    double d2 = distance2(segment, lat, lon, lonScale);
+                    if (d2 <= max2) {
+                        Match match;
+                        match.segment = segment;
+                        match.distance = d2;
+                        out.push_back(match);
+                    }
+                },
+                [&]() { return max2; });
+    
+    // Длинный сегмент встречается в нескольких ячейках
+    std::sort(out.begin(), out.end(), [](const Match& a, const Match& b) {
+        return a.segment < b.segment;
+    });
+    out.erase(std::unique(out.begin(), out.end(), [](const Match& a, const Match& b) {
+        return a.segment == b.segment;
+    }), out.end());
+    std::sort(out.begin(), out.end(), [](const Match& a, const Match& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.segment < b.segment);
+    });
+    if (out.size() > maxCount) {
+        out.resize(maxCount);
+    }
+    for (auto& match : out) {
+        match.distance = std::sqrt(match.distance) * metersPerDeg;
+        match.name = getName(match.segment);
+    }
+    return out.size();
+}
+
+void RoadIndex::clear() {
+    unmap();
+    pending_.clear();
+    skippedLines_ = 0;
+}
+
+size_t RoadIndex::size() const {
+    return segmentCount_;
+}
+
+size_t RoadIndex::getEntryCount() const {
+    return cellCount_ > 0 ? cellOffsets_[cellCount_] : 0;
+}
+
+const char* RoadIndex::getName(std::uint32_t segment) const {
+    if (segment >= segmentCount_) return nullptr;
+    return names_ + segments_[segment].nameOffset;
+}
+
+double RoadIndex::getCellSize() const {
+    return cellSize_;
+}
+
+bool RoadIndex::isMapped() const {
+    return mapped_ != nullptr;
+}
+
+size_t RoadIndex::getSkippedLines() const {
+    return skippedLines_;
+}
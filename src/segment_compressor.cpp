@@ -0,0 +1,320 @@
+#include "segment_compressor.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef GPS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char COMPRESSED_SUFFIX[] = ".gz";
+    const char TEMP_SUFFIX[] = ".gz.tmp";
+    const size_t CHUNK = 256 * 1024;
+    
+    bool endsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() &&
+               text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+    
+    bool isDigits(const std::string& text, size_t pos, size_t count) {
+        if (pos + count > text.size()) return false;
+        for (size_t i = pos; i < pos + count; i++) {
+            if (text[i] < '0' || text[i] > '9') return false;
+        }
+        return true;
+    }
+    
+    // Суффикс имени, которое дает FileSink::rotatedName: YYYYMMDD_HHMMSS_mmm[.N].
+    // Чужие файлы рядом (out.log.bak) не сжимаются и не удаляются
+    bool isRotatedSuffix(const std::string& suffix) {
+        const size_t STAMP = 19;
+        if (suffix.size() < STAMP) return false;
+        if (!isDigits(suffix, 0, 8) || suffix[8] != '_' || !isDigits(suffix, 9, 6) ||
+            suffix[15] != '_' || !isDigits(suffix, 16, 3)) {
+            return false;
+        }
+        if (suffix.size() == STAMP) return true;
+        return suffix[STAMP] == '.' && suffix.size() > STAMP + 1 &&
+               isDigits(suffix, STAMP + 1, suffix.size() - STAMP - 1);
+    }
+    
+    // Отложенный сегмент: filename.<время>[.gz]
+    bool isSegmentName(const std::string& name, const std::string& prefix) {
+        if (name.compare(0, prefix.size(), prefix) != 0) return false;
+        std::string suffix = name.substr(prefix.size());
+        if (endsWith(suffix, COMPRESSED_SUFFIX)) {
+            suffix.resize(suffix.size() - (sizeof(COMPRESSED_SUFFIX) - 1));
+        }
+        return isRotatedSuffix(suffix);
+    }
+    
+    // Имя сегмента без .gz: по нему сегменты упорядочены по времени ротации
+    std::string segmentKey(const std::string& path) {
+        return endsWith(path, COMPRESSED_SUFFIX) ? path.substr(0, path.size() - (sizeof(COMPRESSED_SUFFIX) - 1)) : path;
+    }
+    
+#ifdef GPS_HAVE_ZLIB
+    bool writeAll(int fd, const unsigned char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+#endif
+}
+
+SegmentCompressor::SegmentCompressor(const std::string& filename, int level, size_t queueCapacity,
+                                     size_t retainFiles, size_t retainBytes)
+    : filename_(filename)
+    , level_(std::clamp(level, 0, 9))
+    , queueCapacity_(queueCapacity > 0 ? queueCapacity : 1)
+    , retainFiles_(retainFiles)
+    , retainBytes_(retainBytes) {
+    thread_ = std::thread(&SegmentCompressor::run, this);
+}
+
+SegmentCompressor::~SegmentCompressor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+bool SegmentCompressor::isAvailable() {
+#ifdef GPS_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SegmentCompressor::isCompressing() const {
+    return level_ > 0 && isAvailable();
+}
+
+bool SegmentCompressor::submit(const std::string& segment) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= queueCapacity_) {
+            rescan_ = true;
+            overflow_++;
+            return false;
+        }
+        queue_.push_back(segment);
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void SegmentCompressor::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return queue_.empty() && !busy_ && !rescan_; });
+}
+
+void SegmentCompressor::run() {
+    recover();
+    applyRetention();
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        busy_ = false;
+        idle_.notify_all();
+        wake_.wait(lock, [this] { return stop_ || !queue_.empty() || rescan_; });
+        // При остановке очередь дорабатывается: сегменты не должны остаться несжатыми
+        if (queue_.empty() && !rescan_) break;
+        busy_ = true;
+        
+        if (!queue_.empty()) {
+            std::string segment = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            
+            std::error_code ec;
+            if (isCompressing() && fs::exists(segment, ec)) {
+                if (compressFile(segment, segment + COMPRESSED_SUFFIX)) {
+                    compressed_++;
+                } else {
+                    failed_++;
+                }
+            }
+            applyRetention();
+            lock.lock();
+        } else {
+            rescan_ = false;
+            lock.unlock();
+            rescan();
+            lock.lock();
+        }
+    }
+}
+
+std::vector<std::string> SegmentCompressor::listSegments() const {
+    std::vector<std::string> segments;
+    fs::path base(filename_);
+    fs::path dir = base.has_parent_path() ? base.parent_path() : fs::path(".");
+    const std::string prefix = base.filename().string() + ".";
+    
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (!isSegmentName(name, prefix)) continue;
+        if (!entry.is_regular_file(ec)) continue;
+        segments.push_back(entry.path().string());
+    }
+    std::sort(segments.begin(), segments.end(), [](const std::string& a, const std::string& b) {
+        return segmentKey(a) < segmentKey(b);
+    });
+    return segments;
+}
+
+void SegmentCompressor::recover() {
+    std::error_code ec;
+    fs::path base(filename_);
+    fs::path dir = base.has_parent_path() ? base.parent_path() : fs::path(".");
+    const std::string prefix = base.filename().string() + ".";
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        const size_t tempLength = sizeof(TEMP_SUFFIX) - 1;
+        if (endsWith(name, TEMP_SUFFIX) && isSegmentName(name.substr(0, name.size() - tempLength), prefix)) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+    rescan();
+}
+
+void SegmentCompressor::rescan() {
+    if (!isCompressing()) {
+        applyRetention();
+        return;
+    }
+    
+    for (const auto& segment : listSegments()) {
+        if (endsWith(segment, COMPRESSED_SUFFIX)) continue;
+        std::error_code ec;
+        // Сжатый файл переименовывается только целиком: исходный просто не успели удалить
+        if (fs::exists(segment + COMPRESSED_SUFFIX, ec)) {
+            fs::remove(segment, ec);
+            continue;
+        }
+        if (compressFile(segment, segment + COMPRESSED_SUFFIX)) {
+            compressed_++;
+        } else {
+            failed_++;
+        }
+    }
+    applyRetention();
+}
+
+void SegmentCompressor::applyRetention() {
+    if (retainFiles_ == 0 && retainBytes_ == 0) return;
+    
+    std::vector<std::string> segments = listSegments();
+    std::vector<size_t> sizes;
+    size_t total = 0;
+    for (const auto& segment : segments) {
+        std::error_code ec;
+        size_t size = static_cast<size_t>(fs::file_size(segment, ec));
+        sizes.push_back(ec ? 0 : size);
+        total += sizes.back();
+    }
+    
+    size_t count = segments.size();
+    for (size_t i = 0; i < segments.size(); i++) {
+        bool overCount = retainFiles_ > 0 && count > retainFiles_;
+        bool overBytes = retainBytes_ > 0 && total > retainBytes_;
+        if (!overCount && !overBytes) break;
+        std::error_code ec;
+        if (fs::remove(segments[i], ec)) {
+            removed_++;
+        }
+        count--;
+        total -= sizes[i];
+    }
+}
+
+bool SegmentCompressor::compressFile(const std::string& source, const std::string& target) {
+#ifdef GPS_HAVE_ZLIB
+    const std::string temp = source + TEMP_SUFFIX;
+    int in = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+    int out = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+    
+    z_stream stream{};
+    // 15 + 16: окно 32 КБ и обертка gzip
+    bool ok = deflateInit2(&stream, level_, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    std::vector<unsigned char> input(CHUNK);
+    std::vector<unsigned char> output(CHUNK);
+    int flush = Z_NO_FLUSH;
+    while (ok && flush != Z_FINISH) {
+        ssize_t n = ::read(in, input.data(), input.size());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        flush = n == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = input.data();
+        stream.avail_in = static_cast<uInt>(n);
+        do {
+            stream.next_out = output.data();
+            stream.avail_out = static_cast<uInt>(output.size());
+            deflate(&stream, flush);
+            ok = writeAll(out, output.data(), output.size() - stream.avail_out);
+        } while (ok && stream.avail_out == 0);
+    }
+    deflateEnd(&stream);
+    ::close(in);
+    
+    ok = ok && ::fsync(out) == 0;
+    ok = ::close(out) == 0 && ok;
+    std::error_code ec;
+    if (ok) {
+        fs::rename(temp, target, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        fs::remove(temp, ec);
+        std::cerr << "Warning: Cannot compress " << source << "\n";
+        return false;
+    }
+    fs::remove(source, ec);
+    return true;
+#else
+    (void)source;
+    (void)target;
+    return false;
+#endif
+}
+
+size_t SegmentCompressor::getCompressedCount() const {
+    return compressed_;
+}
+
+size_t SegmentCompressor::getOverflowCount() const {
+    return overflow_;
+}
+
+size_t SegmentCompressor::getRemovedCount() const {
+    return removed_;
+}
+
+size_t SegmentCompressor::getFailedCount() const {
+    return failed_;
+}
@@ -0,0 +1,115 @@
+#include "simplify_stage.h"
+#include "geodesy.h"
+#include <cmath>
+
+SimplifyStage::SimplifyStage(std::unique_ptr<IDisplay> next, double toleranceMeters,
+                             size_t maxLookahead)
+    : DisplayStage(std::move(next))
+    , tolerance_(toleranceMeters)
+    , maxLookahead_(maxLookahead > 0 ? maxLookahead : 1) {
+    pending_.reserve(maxLookahead_);
+}
+
+bool SimplifyStage::fitsSegment(const GpsPoint& end) const {
+    // Локальная плоскость с началом в опорной точке, метры
+    const double metersPerDeg = geo::EARTH_RADIUS * geo::DEG_TO_RAD;
+    const double lonScale = metersPerDeg * std::cos(anchor_.latitude * geo::DEG_TO_RAD);
+    const double ex = (end.longitude - anchor_.longitude) * lonScale;
+    const double ey = (end.latitude - anchor_.latitude) * metersPerDeg;
+    const double len2 = ex * ex + ey * ey;
+    const double tol2 = tolerance_ * tolerance_;
+    
+    for (const auto& p : pending_) {
+        const double px = (p.longitude - anchor_.longitude) * lonScale;
+        const double py = (p.latitude - anchor_.latitude) * metersPerDeg;
+        // Расстояние до отрезка, а не до прямой: возврат назад тоже учитывается
+        double t = len2 > 0.0 ? (px * ex + py * ey) / len2 : 0.0;
+        t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+        const double dx = px - t * ex;
+        const double dy = py - t * ey;
+        if (dx * dx + dy * dy > tol2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SimplifyStage::emit(const GpsPoint& point) {
+    outputCount_++;
+    next_->showPoint(point);
+}
+
+void SimplifyStage::showPoint(const GpsPoint& point) {
+    inputCount_++;
+    
+    if (!hasAnchor_) {
+        anchor_ = point;
+        hasAnchor_ = true;
+        emit(point);
+        return;
+    }
+    
+    // Окно заполнено или новая точка не укладывается в допуск: последняя
+    // ожидающая точка становится вершиной и новой опорной
+    if (!pending_.empty() && (pending_.size() >= maxLookahead_ || !fitsSegment(point))) {
+        anchor_ = pending_.back();
+        pending_.clear();
+        emit(anchor_);
+    }
+    pending_.push_back(point);
+}
+
+void SimplifyStage::emitPending() {
+    if (pending_.empty()) return;
+    anchor_ = pending_.back();
+    pending_.clear();
+    emit(anchor_);
+}
+
+void SimplifyStage::showInvalidFix(unsigned long long timestamp) {
+    // Потеря фикса - разрыв трека: новый отрезок начнется с нуля
+    emitPending();
+    hasAnchor_ = false;
+    next_->showInvalidFix(timestamp);
+}
+
+void SimplifyStage::showEvent(const GpsEvent& event) {
+    emitPending();
+    next_->showEvent(event);
+}
+
+void SimplifyStage::clear() {
+    pending_.clear();
+    hasAnchor_ = false;
+    next_->clear();
+}
+
+void SimplifyStage::flush() {
+    emitPending();
+    next_->flush();
+}
+
+void SimplifyStage::setTolerance(double meters) {
+    tolerance_ = meters;
+}
+
+double SimplifyStage::getTolerance() const {
+    return tolerance_;
+}
+
+void SimplifyStage::setMaxLookahead(size_t points) {
+    maxLookahead_ = points > 0 ? points : 1;
+    pending_.reserve(maxLookahead_);
+}
+
+size_t SimplifyStage::getMaxLookahead() const {
+    return maxLookahead_;
+}
+
+size_t SimplifyStage::getInputCount() const {
+    return inputCount_;
+}
+
+size_t SimplifyStage::getOutputCount() const {
+    return outputCount_;
+}
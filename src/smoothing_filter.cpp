@@ -1,54 +1,87 @@
 #include "smoothing_filter.h"
-#include <algorithm>
+#include "gps_time.h"
 
 SmoothingFilter::SmoothingFilter(double cutoffFrequency, double sampleRate)
     : enabled_(true)
     , cutoffFrequency_(cutoffFrequency)
-    , sampleRate_(sampleRate) {}
+    , sampleRate_(sampleRate) {
+    updateCoefficients();
+}
 
-double SmoothingFilter::calculateAlpha() const {
-    // RC = 1 / (2 * pi * fc)
+double SmoothingFilter::calculateAlpha(double dt) const {
     // alpha = dt / (RC + dt)
-    double dt = 1.0 / sampleRate_;
-    double rc = 1.0 / (2.0 * M_PI * cutoffFrequency_);
-    return dt / (rc + dt);
+    return dt / (rc_ + dt);
+}
+
+void SmoothingFilter::updateCoefficients() {
+    // RC = 1 / (2 * pi * fc)
+    rc_ = 1.0 / (2.0 * M_PI * cutoffFrequency_);
+    nominalAlpha_ = calculateAlpha(1.0 / sampleRate_);
+    lastDtMs_ = 0;
+}
+
+double SmoothingFilter::alphaFor(const GpsPoint& point) {
+    // dt берем из меток времени с учетом перехода через полночь; если
+    // интервал нулевой (нет времени, повтор, точка не по порядку) -
+    // используем номинальную частоту
+    unsigned long long dtMs = gps_time::elapsedMs(prevTimestamp_, point.timestamp);
+    if (dtMs == 0) {
+        return nominalAlpha_;
+    }
+    
+    if (dtMs != lastDtMs_) {
+        lastDtMs_ = dtMs;
+        lastAlpha_ = calculateAlpha(dtMs / 1000.0);
+    }
+    return lastAlpha_;
 }
 
 double SmoothingFilter::lowPassFilter(double current, double previous, double alpha) {
     return previous + alpha * (current - previous);
 }
 
-FilterResult SmoothingFilter::process(GpsPoint& point, const GpsHistory& history) {
+FilterResult SmoothingFilter::process(GpsPoint& point, const GpsHistory& /*history*/) {
     if (!enabled_ || !point.isValid) {
         return FilterResult::PASS;
     }
     
-    double alpha = calculateAlpha();
-    
-    // Сохраняем предыдущие точки для сглаживания
-    previousPoints_.push_back(point);
-    if (previousPoints_.size() > MAX_PREVIOUS) {
-        previousPoints_.pop_front();
+    if (!hasPrevious_) {
+        // Недостаточно данных для сглаживания
+        hasPrevious_ = true;
+        prevLatitude_ = point.latitude;
+        prevLongitude_ = point.longitude;
+        prevSpeed_ = point.speed;
+        prevAltitude_ = point.altitude;
+        prevTimestamp_ = point.timestamp;
+        return FilterResult::PASS;
     }
     
-    if (previousPoints_.size() < 2) {
-        return FilterResult::PASS; // Недостаточно данных для сглаживания
-    }
+    double alpha = alphaFor(point);
     
-    // Сглаживаем координаты
-    const GpsPoint& prev = previousPoints_[previousPoints_.size() - 2];
+    // Запоминаем несглаженные значения для следующей точки
+    const double latitude = point.latitude;
+    const double longitude = point.longitude;
+    const double speed = point.speed;
+    const double altitude = point.altitude;
     
-    point.latitude = lowPassFilter(point.latitude, prev.latitude, alpha);
-    point.longitude = lowPassFilter(point.longitude, prev.longitude, alpha);
+    // Сглаживаем координаты
+    point.latitude = lowPassFilter(latitude, prevLatitude_, alpha);
+    point.longitude = lowPassFilter(longitude, prevLongitude_, alpha);
     
-    if (point.speed > 0) {
-        point.speed = lowPassFilter(point.speed, prev.speed, alpha);
+    if (speed > 0) {
+        point.speed = lowPassFilter(speed, prevSpeed_, alpha);
     }
     
-    if (point.altitude > 0) {
-        point.altitude = lowPassFilter(point.altitude, prev.altitude, alpha);
+    if (altitude > 0) {
+        point.altitude = lowPassFilter(altitude, prevAltitude_, alpha);
     }
     
+    prevLatitude_ = latitude;
+    prevLongitude_ = longitude;
+    prevSpeed_ = speed;
+    prevAltitude_ = altitude;
+    prevTimestamp_ = point.timestamp;
+    
     return FilterResult::PASS;
 }
 
@@ -66,6 +99,7 @@ std::string SmoothingFilter::getName() const {
 
 void SmoothingFilter::setCutoffFrequency(double freq) {
     cutoffFrequency_ = freq;
+    updateCoefficients();
 }
 
 double SmoothingFilter::getCutoffFrequency() const {
@@ -74,6 +108,7 @@ double SmoothingFilter::getCutoffFrequency() const {
 
 void SmoothingFilter::setSampleRate(double rate) {
     sampleRate_ = rate;
+    updateCoefficients();
 }
 
 double SmoothingFilter::getSampleRate() const {
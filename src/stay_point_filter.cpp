@@ -0,0 +1,152 @@
+#include "stay_point_filter.h"
+#include "display_interface.h"
+#include "geodesy.h"
+#include "gps_time.h"
+
+using gps_time::elapsedMs;
+
+StayPointFilter::StayPointFilter(double radiusMeters, double minDurationSeconds)
+    : enabled_(true)
+    , radiusMeters_(radiusMeters)
+    , minDurationMs_(static_cast<unsigned long long>(minDurationSeconds * 1000.0)) {}
+
+void StayPointFilter::startCluster(const GpsPoint& point) {
+    cluster_ = Cluster();
+    cluster_.active = true;
+    cluster_.start = point.timestamp;
+    addToCluster(point);
+}
+
+void StayPointFilter::addToCluster(const GpsPoint& point) {
+    cluster_.sumLatitude += point.latitude;
+    cluster_.sumLongitude += point.longitude;
+    cluster_.count++;
+    cluster_.last = point.timestamp;
+}
+
+bool StayPointFilter::withinRadius(const GpsPoint& point) const {
+    return geo::haversineDistance(cluster_.latitude(), cluster_.longitude(),
+                                  point.latitude, point.longitude) <= radiusMeters_;
+}
+
+void StayPointFilter::endStay() {
+    emit(GpsEvent::Type::STAY_END, cluster_.last, elapsedMs(cluster_.start, cluster_.last));
+    staying_ = false;
+    cluster_.active = false;
+}
+
+FilterResult StayPointFilter::process(GpsPoint& point, const GpsHistory& /*history*/) {
+    if (!enabled_) return FilterResult::PASS;
+    
+    if (!point.isValid) {
+        return FilterResult::REJECT;
+    }
+    
+    if (staying_) {
+        // На стоянке учитывается только радиус: скорость от дрейфа приемника шумит
+        if (withinRadius(point)) {
+            addToCluster(point);
+            if (heartbeatMs_ > 0 && elapsedMs(lastHeartbeat_, point.timestamp) >= heartbeatMs_) {
+                lastHeartbeat_ = point.timestamp;
+                point.latitude = cluster_.latitude();
+                point.longitude = cluster_.longitude();
+                point.speed = 0.0;
+                return FilterResult::PASS;
+            }
+            return FilterResult::SUPPRESS;
+        }
+        endStay();
+    }
+    
+    const bool slow = point.speed < speedThresholdKmh_;
+    if (cluster_.active && slow && withinRadius(point)) {
+        addToCluster(point);
+        if (elapsedMs(cluster_.start, point.timestamp) >= minDurationMs_) {
+            staying_ = true;
+            lastHeartbeat_ = point.timestamp;
+            emit(GpsEvent::Type::STAY_START, cluster_.start, 0);
+            return FilterResult::SUPPRESS;
+        }
+        return FilterResult::PASS;
+    }
+    
+    // Движение или выход за радиус кандидата: начинаем новый кластер с этой точки
+    if (slow) {
+        startCluster(point);
+    } else {
+        cluster_.active = false;
+    }
+    return FilterResult::PASS;
+}
+
+void StayPointFilter::flush() {
+    if (staying_) {
+        endStay();
+    }
+}
+
+void StayPointFilter::emit(GpsEvent::Type type, unsigned long long timestamp,
+                           unsigned long long durationMs) {
+    if (!display_) return;
+    
+    GpsEvent event;
+    event.type = type;
+    event.source = getName();
+    event.timestamp = timestamp;
+    event.latitude = cluster_.latitude();
+    event.longitude = cluster_.longitude();
+    event.durationMs = durationMs;
+    display_->showEvent(event);
+}
+
+void StayPointFilter::setEnabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+bool StayPointFilter::isEnabled() const {
+    return enabled_;
+}
+
+std::string StayPointFilter::getName() const {
+    return "StayPointFilter";
+}
+
+void StayPointFilter::setDisplay(IDisplay* display) {
+    display_ = display;
+}
+
+void StayPointFilter::setRadius(double meters) {
+    radiusMeters_ = meters;
+}
+
+double StayPointFilter::getRadius() const {
+    return radiusMeters_;
+}
+
+void StayPointFilter::setMinDuration(double seconds) {
+    minDurationMs_ = static_cast<unsigned long long>(seconds * 1000.0);
+}
+
+double StayPointFilter::getMinDuration() const {
+    return minDurationMs_ / 1000.0;
+}
+
+void StayPointFilter::setSpeedThreshold(double kmh) {
+    speedThresholdKmh_ = kmh;
+}
+
+double StayPointFilter::getSpeedThreshold() const {
+    return speedThresholdKmh_;
+}
+
+void StayPointFilter::setHeartbeat(double seconds) {
+    heartbeatMs_ = static_cast<unsigned long long>(seconds * 1000.0);
+}
+
+double StayPointFilter::getHeartbeat() const {
+    return heartbeatMs_ / 1000.0;
+}
+
+bool StayPointFilter::isStaying() const {
+    return staying_;
+}
@@ -12,8 +12,8 @@ FilterResult StopFilter::process(GpsPoint& point, const GpsHistory& history) {
     
     // Если скорость ниже порога, считаем что объект остановился
     if (point.speed < speedThresholdKmh_) {
-        auto lastValid = history.getLastValid();
-        if (lastValid.has_value()) {
+        const GpsPoint* lastValid = history.getLastValidPtr();
+        if (lastValid) {
             // Заменяем координаты на последние валидные и обнуляем скорость
             point.latitude = lastValid->latitude;
             point.longitude = lastValid->longitude;
@@ -0,0 +1,78 @@
+#include "structured_display.h"
+#include "record_format.h"
+
+StructuredDisplay::StructuredDisplay(Format format, const std::string& filename, bool rotate,
+                                     size_t maxSize, bool async, unsigned flushIntervalMs,
+                                     size_t flushBytes)
+    : format_(format)
+    , sink_(std::make_unique<FileSink>(filename, rotate, maxSize, async, flushIntervalMs, flushBytes))
+    , buffer_(record_format::TYPICAL_CAPACITY) {
+    if (format_ == Format::CSV) {
+        sink_->setHeader(std::string(CSV_COLUMNS) + "\n");
+    }
+}
+
+StructuredDisplay::~StructuredDisplay() = default;
+
+bool StructuredDisplay::parseFormat(const std::string& name, Format& format) {
+    if (name == "csv") {
+        format = Format::CSV;
+    } else if (name == "ndjson") {
+        format = Format::NDJSON;
+    } else if (name == "geojson") {
+        format = Format::GEOJSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void StructuredDisplay::write(const structured_format::Record& record) {
+    if (!sink_->isOpen()) return;
+    
+    size_t length = record_format::render(buffer_, [&](char* out, size_t capacity) {
+        switch (format_) {
+            case Format::CSV: return structured_format::formatCsv(record, out, capacity);
+            case Format::NDJSON: return structured_format::formatNdjson(record, out, capacity);
+            case Format::GEOJSON: return structured_format::formatGeojson(record, out, capacity);
+        }
+        return size_t(0);
+    });
+    sink_->append(buffer_.data(), length);
+}
+
+void StructuredDisplay::showPoint(const GpsPoint& point) {
+    write(structured_format::pointRecord(point));
+}
+
+void StructuredDisplay::showInvalidFix(unsigned long long timestamp) {
+    write(structured_format::invalidFixRecord(timestamp));
+}
+
+void StructuredDisplay::showParseError(const std::string& error) {
+    write(structured_format::parseErrorRecord(error));
+}
+
+void StructuredDisplay::showRejected(const std::string& reason) {
+    write(structured_format::rejectedRecord(reason));
+}
+
+void StructuredDisplay::showEvent(const GpsEvent& event) {
+    write(structured_format::eventRecord(event));
+}
+
+void StructuredDisplay::clear() {
+    sink_->truncate();
+}
+
+void StructuredDisplay::flush() {
+    sink_->flush();
+}
+
+StructuredDisplay::Format StructuredDisplay::getFormat() const {
+    return format_;
+}
+
+const FileSink& StructuredDisplay::getSink() const {
+    return *sink_;
+}
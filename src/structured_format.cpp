@@ -0,0 +1,192 @@
+#include "structured_format.h"
+#include "record_writer.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    void putCsvNumber(record_format::Writer& w, double value) {
+        if (std::isfinite(value)) {
+            w.putShortest(value);
+        }
+    }
+    
+    void putJsonNumber(record_format::Writer& w, double value) {
+        if (std::isfinite(value)) {
+            w.putShortest(value);
+        } else {
+            w.put("null");
+        }
+    }
+    
+    // Свойства записи в JSON без фигурных скобок; координаты - только
+    // если withPosition (в GeoJSON они уходят в geometry)
+    void putJsonProperties(record_format::Writer& w, const structured_format::Record& r, bool withPosition) {
+        w.put("\"type\":\"");
+        w.put(r.type, std::strlen(r.type));
+        w.putChar('"');
+        if (r.hasTimestamp) {
+            w.put(",\"timestamp\":");
+            w.putInt(r.timestamp);
+        }
+        if (r.hasPosition && withPosition) {
+            w.put(",\"latitude\":");
+            putJsonNumber(w, r.latitude);
+            w.put(",\"longitude\":");
+            putJsonNumber(w, r.longitude);
+        }
+        if (r.point) {
+            w.put(",\"speed\":");
+            putJsonNumber(w, r.point->speed);
+            w.put(",\"course\":");
+            putJsonNumber(w, r.point->course);
+            w.put(",\"altitude\":");
+            putJsonNumber(w, r.point->altitude);
+            w.put(",\"satellites\":");
+            w.putInt(r.point->satellites);
+            w.put(",\"hdop\":");
+            if (std::isfinite(r.point->hdop)) w.putShortest(r.point->hdop); else w.put("null");
+            if (r.point->label) {
+                w.put(",\"label\":");
+                w.putJsonString(r.point->label, std::strlen(r.point->label));
+            }
+        }
+        if (r.event) {
+            w.put(",\"event\":\"");
+            const char* type = eventTypeName(r.event->type);
+            w.put(type, std::strlen(type));
+            w.put("\",\"source\":");
+            w.putJsonString(r.event->source.data(), r.event->source.size());
+            w.put(",\"subject\":");
+            w.putJsonString(r.event->subject.data(), r.event->subject.size());
+            w.put(",\"durationMs\":");
+            w.putInt(r.event->durationMs);
+        }
+        if (r.message) {
+            w.put(",\"message\":");
+            w.putJsonString(r.message->data(), r.message->size());
+        }
+    }
+}
+
+namespace structured_format {
+    size_t formatCsv(const Record& r, char* out, size_t capacity) {
+        record_format::Writer w(out, capacity);
+        w.put(r.type, std::strlen(r.type));
+        w.putChar(',');
+        if (r.hasTimestamp) w.putInt(r.timestamp);
+        w.putChar(',');
+        if (r.hasPosition) putCsvNumber(w, r.latitude);
+        w.putChar(',');
+        if (r.hasPosition) putCsvNumber(w, r.longitude);
+        w.putChar(',');
+        if (r.point) {
+            putCsvNumber(w, r.point->speed);
+            w.putChar(',');
+            putCsvNumber(w, r.point->course);
+            w.putChar(',');
+            putCsvNumber(w, r.point->altitude);
+            w.putChar(',');
+            w.putInt(r.point->satellites);
+            w.putChar(',');
+            if (std::isfinite(r.point->hdop)) w.putShortest(r.point->hdop);
+            w.putChar(',');
+            if (r.point->label) w.putCsvField(r.point->label, std::strlen(r.point->label));
+        } else {
+            w.put(",,,,,");
+        }
+        w.putChar(',');
+        if (r.event) {
+            const char* type = eventTypeName(r.event->type);
+            w.put(type, std::strlen(type));
+            w.putChar(',');
+            w.putCsvField(r.event->source.data(), r.event->source.size());
+            w.putChar(',');
+            w.putCsvField(r.event->subject.data(), r.event->subject.size());
+            w.putChar(',');
+            w.putInt(r.event->durationMs);
+        } else {
+            w.put(",,,");
+        }
+        w.putChar(',');
+        if (r.message) w.putCsvField(r.message->data(), r.message->size());
+        w.putChar('\n');
+        return w.length();
+    }
+    
+    size_t formatNdjson(const Record& r, char* out, size_t capacity) {
+        record_format::Writer w(out, capacity);
+        w.putChar('{');
+        putJsonProperties(w, r, true);
+        w.put("}\n");
+        return w.length();
+    }
+    
+    size_t formatGeojson(const Record& r, char* out, size_t capacity) {
+        record_format::Writer w(out, capacity);
+        w.put("\x1e{\"type\":\"Feature\",\"geometry\":");
+        if (r.hasPosition) {
+            // Порядок координат GeoJSON: долгота, широта, высота
+            w.put("{\"type\":\"Point\",\"coordinates\":[");
+            putJsonNumber(w, r.longitude);
+            w.putChar(',');
+            putJsonNumber(w, r.latitude);
+            if (r.point) {
+                w.putChar(',');
+                putJsonNumber(w, r.point->altitude);
+            }
+            w.put("]}");
+        } else {
+            w.put("null");
+        }
+        w.put(",\"properties\":{");
+        putJsonProperties(w, r, false);
+        w.put("}}\n");
+        return w.length();
+    }
+    
+    Record pointRecord(const GpsPoint& point) {
+        Record r;
+        r.type = "point";
+        r.hasTimestamp = true;
+        r.timestamp = point.timestamp;
+        r.hasPosition = true;
+        r.latitude = point.latitude;
+        r.longitude = point.longitude;
+        r.point = &point;
+        return r;
+    }
+    
+    Record invalidFixRecord(unsigned long long timestamp) {
+        Record r;
+        r.type = "nofix";
+        r.hasTimestamp = true;
+        r.timestamp = timestamp;
+        return r;
+    }
+    
+    Record parseErrorRecord(const std::string& error) {
+        Record r;
+        r.type = "error";
+        r.message = &error;
+        return r;
+    }
+    
+    Record rejectedRecord(const std::string& reason) {
+        Record r;
+        r.type = "rejected";
+        r.message = &reason;
+        return r;
+    }
+    
+    Record eventRecord(const GpsEvent& event) {
+        Record r;
+        r.type = "event";
+        r.hasTimestamp = true;
+        r.timestamp = event.timestamp;
+        r.hasPosition = true;
+        r.latitude = event.latitude;
+        r.longitude = event.longitude;
+        r.event = &event;
+        return r;
+    }
+}
@@ -0,0 +1,104 @@
+#include "throttle_stage.h"
+#include "gps_time.h"
+#include <cmath>
+
+using gps_time::elapsedMs;
+
+namespace {
+    // Ниже этой скорости курс от приемника - шум, его изменение не учитывается
+    const double MIN_COURSE_SPEED = 3.0;   // км/ч
+}
+
+ThrottleStage::ThrottleStage(std::unique_ptr<IDisplay> next, double distanceMeters,
+                             double courseDegrees, double speedKmh, double heartbeatSeconds)
+    : DisplayStage(std::move(next))
+    , distanceMeters_(distanceMeters)
+    , courseDegrees_(courseDegrees)
+    , speedKmh_(speedKmh)
+    , heartbeatMs_(static_cast<unsigned long long>(heartbeatSeconds * 1000.0)) {}
+
+bool ThrottleStage::changed(const GpsPoint& point) const {
+    if (heartbeatMs_ > 0 && elapsedMs(lastTimestamp_, point.timestamp) >= heartbeatMs_) {
+        return true;
+    }
+    if (speedKmh_ > 0.0 && std::fabs(point.speed - lastSpeed_) > speedKmh_) {
+        return true;
+    }
+    if (courseDegrees_ > 0.0 && point.speed >= MIN_COURSE_SPEED) {
+        // Разность курсов с учетом перехода через 0/360, результат в [0, 180]
+        double delta = std::fabs(point.course - lastCourse_);
+        if (delta > 180.0) {
+            delta = 360.0 - delta;
+        }
+        if (delta > courseDegrees_) {
+            return true;
+        }
+    }
+    return distanceMeters_ > 0.0 &&
+           lastPosition_.exceeds(point.latitude, point.longitude, distanceMeters_);
+}
+
+void ThrottleStage::showPoint(const GpsPoint& point) {
+    inputCount_++;
+    if (hasLast_ && !changed(point)) {
+        return;
+    }
+    
+    hasLast_ = true;
+    lastPosition_.set(point.latitude, point.longitude);
+    lastTimestamp_ = point.timestamp;
+    lastSpeed_ = point.speed;
+    lastCourse_ = point.course;
+    outputCount_++;
+    next_->showPoint(point);
+}
+
+void ThrottleStage::showInvalidFix(unsigned long long timestamp) {
+    hasLast_ = false;
+    next_->showInvalidFix(timestamp);
+}
+
+void ThrottleStage::clear() {
+    hasLast_ = false;
+    next_->clear();
+}
+
+void ThrottleStage::setDistance(double meters) {
+    distanceMeters_ = meters;
+}
+
+double ThrottleStage::getDistance() const {
+    return distanceMeters_;
+}
+
+void ThrottleStage::setCourse(double degrees) {
+    courseDegrees_ = degrees;
+}
+
+double ThrottleStage::getCourse() const {
+    return courseDegrees_;
+}
+
+void ThrottleStage::setSpeed(double kmh) {
+    speedKmh_ = kmh;
+}
+
+double ThrottleStage::getSpeed() const {
+    return speedKmh_;
+}
+
+void ThrottleStage::setHeartbeat(double seconds) {
+    heartbeatMs_ = static_cast<unsigned long long>(seconds * 1000.0);
+}
+
+double ThrottleStage::getHeartbeat() const {
+    return heartbeatMs_ / 1000.0;
+}
+
+size_t ThrottleStage::getInputCount() const {
+    return inputCount_;
+}
+
+size_t ThrottleStage::getOutputCount() const {
+    return outputCount_;
+}
@@ -0,0 +1,142 @@
+#include "track_reader.h"
+#include <algorithm>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TrackReader::TrackReader() = default;
+
+TrackReader::TrackReader(const std::string& filename) {
+    open(filename);
+}
+
+TrackReader::~TrackReader() {
+    close();
+}
+
+bool TrackReader::open(const std::string& filename) {
+    close();
+    
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(track_format::FileHeader)) {
+        data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    
+    const auto* header = static_cast<const track_format::FileHeader*>(data);
+    if (!header->isValid()) {
+        ::munmap(data, static_cast<size_t>(st.st_size));
+        std::cerr << "Warning: invalid binary track file " << filename << "\n";
+        return false;
+    }
+    
+    mapped_ = data;
+    mappedSize_ = static_cast<size_t>(st.st_size);
+    records_ = reinterpret_cast<const PackedGpsPoint*>(header + 1);
+    blockRecords_ = header->blockRecords;
+    // Последовательное чтение: ядро читает отображение с упреждением
+    ::madvise(mapped_, mappedSize_, MADV_SEQUENTIAL);
+    
+    // Блоки проверяются по синхронизации до первого испорченного
+    const size_t slots = (mappedSize_ - sizeof(*header)) / track_format::RECORD_SIZE;
+    const size_t blockSlots = static_cast<size_t>(blockRecords_) + 1;
+    for (size_t first = 0; first < slots; first += blockSlots) {
+        const size_t points = std::min(slots - first - 1, static_cast<size_t>(blockRecords_));
+        if (points == 0 || !sync(blockCount_).isValid(static_cast<std::uint32_t>(blockCount_))) {
+            break;
+        }
+        blockCount_++;
+        size_ += points;
+    }
+    return true;
+}
+
+void TrackReader::close() {
+    if (mapped_) {
+        ::munmap(mapped_, mappedSize_);
+    }
+    mapped_ = nullptr;
+    mappedSize_ = 0;
+    records_ = nullptr;
+    blockRecords_ = 0;
+    blockCount_ = 0;
+    size_ = 0;
+}
+
+bool TrackReader::isOpen() const {
+    return mapped_ != nullptr;
+}
+
+size_t TrackReader::size() const {
+    return size_;
+}
+
+bool TrackReader::empty() const {
+    return size_ == 0;
+}
+
+std::uint32_t TrackReader::getBlockRecords() const {
+    return blockRecords_;
+}
+
+size_t TrackReader::getBlockCount() const {
+    return blockCount_;
+}
+
+const track_format::SyncRecord& TrackReader::sync(size_t block) const {
+    return *reinterpret_cast<const track_format::SyncRecord*>(records_ + block * (blockRecords_ + 1));
+}
+
+const PackedGpsPoint& TrackReader::operator[](size_t index) const {
+    // Каждый блок начинается с записи синхронизации
+    return records_[index + index / blockRecords_ + 1];
+}
+
+size_t TrackReader::lowerBound(std::int64_t timestamp) const {
+    if (size_ == 0) return 0;
+    
+    // Последний блок, первая точка которого раньше timestamp
+    size_t lo = 0;
+    size_t hi = blockCount_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (sync(mid).firstTimestamp < timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) return 0;
+    
+    // Ответ внутри блока lo - 1 или первая точка блока lo
+    size_t first = (lo - 1) * blockRecords_;
+    size_t last = std::min(first + blockRecords_, size_);
+    while (first < last) {
+        size_t mid = first + (last - first) / 2;
+        if ((*this)[mid].timestamp < timestamp) {
+            first = mid + 1;
+        } else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
+TrackReader::const_iterator TrackReader::begin() const {
+    return const_iterator(this, 0);
+}
+
+TrackReader::const_iterator TrackReader::end() const {
+    return const_iterator(this, size_);
+}
+
+TrackReader::const_iterator TrackReader::seek(std::int64_t timestamp) const {
+    return const_iterator(this, lowerBound(timestamp));
+}
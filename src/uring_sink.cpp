@@ -0,0 +1,421 @@
+#include "uring_sink.h"
+#include "file_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#ifdef GPS_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace {
+#ifdef GPS_HAVE_IO_URING
+    int ioUringSetup(unsigned entries, io_uring_params* params) {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+    
+    int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+    }
+    
+    int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+        return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+    }
+#endif
+    
+    // Выравнивание буферов под прямой ввод-вывод и страницы
+    const size_t BUFFER_ALIGNMENT = 4096;
+    
+    // Минимальный промежуток между отправками неполного буфера
+    const auto SUBMIT_INTERVAL = std::chrono::milliseconds(1);
+}
+
+std::unique_ptr<UringSink> UringSink::create(const std::string& filename, bool rotate, size_t maxSize,
+                                             unsigned queueDepth, size_t bufferSize) {
+    std::unique_ptr<UringSink> sink(new UringSink(filename, rotate, maxSize, bufferSize));
+    if (!sink->setupRing(queueDepth > 0 ? queueDepth : 1)) {
+        return nullptr;
+    }
+    if (!sink->openFile()) {
+        std::cerr << "Warning: Cannot open file " << filename << " for writing\n";
+    }
+    return sink;
+}
+
+UringSink::UringSink(const std::string& filename, bool rotate, size_t maxSize, size_t bufferSize)
+    : filename_(filename)
+    , rotate_(rotate)
+    , maxSize_(maxSize)
+    , bufferSize_((bufferSize + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT) {
+    if (bufferSize_ == 0) bufferSize_ = BUFFER_ALIGNMENT;
+}
+
+UringSink::~UringSink() {
+    if (ringFd_ >= 0 && fd_ >= 0) {
+        flush();
+    }
+    teardownRing();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool UringSink::isSupported() {
+#ifdef GPS_HAVE_IO_URING
+    io_uring_params params{};
+    int fd = ioUringSetup(1, &params);
+    if (fd < 0) return false;
+    ::close(fd);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool UringSink::setupRing(unsigned queueDepth) {
+#ifdef GPS_HAVE_IO_URING
+    io_uring_params params{};
+    ringFd_ = ioUringSetup(queueDepth, &params);
+    if (ringFd_ < 0) {
+        ringFd_ = -1;
+        return false;
+    }
+    
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+    
+    sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ringFd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED) {
+        sqRing_ = nullptr;
+        teardownRing();
+        return false;
+    }
+    if (single) {
+        cqRing_ = sqRing_;
+    } else {
+        cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            cqRing_ = nullptr;
+            teardownRing();
+            return false;
+        }
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ringFd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+        sqes_ = nullptr;
+        teardownRing();
+        return false;
+    }
+    
+    auto* sq = static_cast<char*>(sqRing_);
+    auto* cq = static_cast<char*>(cqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    
+    // Буферов не больше, чем мест в очереди отправки: запись в полете всегда помещается
+    const unsigned count = params.sq_entries;
+    buffers_.resize(count);
+    std::vector<iovec> iov(count);
+    for (unsigned i = 0; i < count; i++) {
+        buffers_[i].data = static_cast<char*>(std::aligned_alloc(BUFFER_ALIGNMENT, bufferSize_));
+        iov[i].iov_base = buffers_[i].data;
+        iov[i].iov_len = bufferSize_;
+        free_.push_back(count - 1 - i);
+    }
+    // Регистрация может не пройти из-за RLIMIT_MEMLOCK - тогда обычные записи
+    fixed_ = ioUringRegister(ringFd_, IORING_REGISTER_BUFFERS, iov.data(), count) == 0;
+    return true;
+#else
+    (void)queueDepth;
+    return false;
+#endif
+}
+
+void UringSink::teardownRing() {
+#ifdef GPS_HAVE_IO_URING
+    if (fixed_) {
+        ioUringRegister(ringFd_, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        fixed_ = false;
+    }
+#endif
+    if (sqes_) ::munmap(sqes_, sqesSize_);
+    if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+    if (sqRing_) ::munmap(sqRing_, sqRingSize_);
+    sqes_ = cqRing_ = sqRing_ = nullptr;
+    if (ringFd_ >= 0) ::close(ringFd_);
+    ringFd_ = -1;
+    for (auto& buffer : buffers_) {
+        std::free(buffer.data);
+    }
+    buffers_.clear();
+    free_.clear();
+}
+
+bool UringSink::openFile() {
+    // Без O_APPEND: каждая запись идет по своему смещению, и несколько
+    // записей в полете не перемешиваются
+    fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    fileSize_ = 0;
+    struct stat st;
+    if (fd_ >= 0 && ::fstat(fd_, &st) == 0) {
+        fileSize_ = static_cast<std::uint64_t>(st.st_size);
+    }
+    submittedSize_ = fileSize_;
+    return fd_ >= 0;
+}
+
+void UringSink::rotateFile() {
+    submitCurrent();
+    drain();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    
+    std::string newFilename = FileSink::rotatedName(filename_);
+    std::error_code ec;
+    std::filesystem::rename(filename_, newFilename, ec);
+    
+    openFile();
+    if (fileSize_ == 0 && !header_.empty()) {
+        append(header_);
+    }
+    if (!ec && onRotate_) {
+        onRotate_(newFilename);
+    }
+}
+
+bool UringSink::isOpen() const {
+    return fd_ >= 0;
+}
+
+void UringSink::setHeader(const std::string& header) {
+    header_ = header;
+    if (fd_ >= 0 && fileSize_ == 0) {
+        append(header_);
+    }
+}
+
+void UringSink::setRotationCallback(std::function<void(const std::string&)> callback) {
+    onRotate_ = std::move(callback);
+}
+
+unsigned UringSink::acquireBuffer() {
+    while (free_.empty()) {
+        stallCount_++;
+        reap(true);
+    }
+    unsigned index = free_.back();
+    free_.pop_back();
+    buffers_[index].length = 0;
+    buffers_[index].written = 0;
+    return index;
+}
+
+void UringSink::append(const char* data, size_t size) {
+    if (fd_ < 0) return;
+    
+    // Граница ротации проходит между записями, как в FileSink
+    if (rotate_ && fileSize_ >= maxSize_) {
+        rotateFile();
+    }
+    
+    // Неблокирующий просмотр завершений освобождает буферы
+    reap(false);
+    fileSize_ += size;
+    while (size > 0) {
+        if (!hasCurrent_) {
+            current_ = acquireBuffer();
+            hasCurrent_ = true;
+        }
+        Buffer& buffer = buffers_[current_];
+        size_t room = bufferSize_ - buffer.length;
+        size_t chunk = size < room ? size : room;
+        std::memcpy(buffer.data + buffer.length, data, chunk);
+        buffer.length += chunk;
+        data += chunk;
+        size -= chunk;
+        if (buffer.length == bufferSize_) {
+            submitCurrent();
+        }
+    }
+    
+    // Диск простаивает - отправляем, не дожидаясь заполнения, но не чаще
+    // SUBMIT_INTERVAL: запись в кэш страниц завершается почти сразу, и без
+    // паузы каждая запись уходила бы отдельным системным вызовом
+    if (hasCurrent_ && inFlight_ == 0 &&
+        std::chrono::steady_clock::now() - lastSubmit_ >= SUBMIT_INTERVAL) {
+        submitCurrent();
+    }
+}
+
+void UringSink::append(const std::string& record) {
+    append(record.data(), record.size());
+}
+
+bool UringSink::submitCurrent() {
+    if (!hasCurrent_) return false;
+    hasCurrent_ = false;
+    Buffer& buffer = buffers_[current_];
+    if (buffer.length == 0) {
+        free_.push_back(current_);
+        return false;
+    }
+    // Смещение - конец уже отправленных данных
+    lastSubmit_ = std::chrono::steady_clock::now();
+    buffer.offset = submittedSize_;
+    submittedSize_ += buffer.length;
+    submitWrite(current_);
+    return true;
+}
+
+void UringSink::submitWrite(unsigned index) {
+#ifdef GPS_HAVE_IO_URING
+    Buffer& buffer = buffers_[index];
+    const unsigned tail = *sqTail_;
+    const unsigned slot = tail & *sqMask_;
+    auto* sqe = static_cast<io_uring_sqe*>(sqes_) + slot;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = fixed_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = fd_;
+    sqe->addr = reinterpret_cast<std::uint64_t>(buffer.data + buffer.written);
+    sqe->len = static_cast<std::uint32_t>(buffer.length - buffer.written);
+    sqe->off = buffer.offset + buffer.written;
+    sqe->buf_index = static_cast<std::uint16_t>(index);
+    sqe->user_data = index;
+    sqArray_[slot] = slot;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    
+    if (!buffer.inFlight) {
+        buffer.inFlight = true;
+        inFlight_++;
+    }
+    while (ioUringEnter(ringFd_, 1, 0, 0) < 0 && errno == EINTR) {}
+#else
+    (void)index;
+#endif
+}
+
+void UringSink::reap(bool wait) {
+#ifdef GPS_HAVE_IO_URING
+    if (wait && inFlight_ > 0) {
+        while (ioUringEnter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno == EINTR) {}
+    }
+    
+    unsigned head = *cqHead_;
+    const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const auto* cqe = static_cast<const io_uring_cqe*>(cqes_) + (head & *cqMask_);
+        const unsigned index = static_cast<unsigned>(cqe->user_data);
+        const int result = cqe->res;
+        head++;
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        
+        Buffer& buffer = buffers_[index];
+        if (result == -EINTR || result == -EAGAIN) {
+            submitWrite(index);
+            continue;
+        }
+        if (result <= 0 && buffer.written < buffer.length) {
+            // Операция не поддерживается ядром, ошибка кольца или запись без
+            // продвижения (0 байт) - дописываем остаток обычной блокирующей записью
+            if (!writeFallback(buffer)) {
+                std::cerr << "Warning: write to " << filename_ << " failed: "
+                          << (result < 0 ? std::strerror(-result) : "no progress") << "\n";
+            }
+        } else if (result > 0) {
+            writeCount_++;
+            bytesWritten_ += static_cast<size_t>(result);
+            buffer.written += static_cast<size_t>(result);
+            // Короткая запись: дописываем остаток тем же буфером
+            if (buffer.written < buffer.length) {
+                submitWrite(index);
+                continue;
+            }
+        }
+        buffer.inFlight = false;
+        inFlight_--;
+        free_.push_back(index);
+    }
+#else
+    (void)wait;
+#endif
+}
+
+bool UringSink::writeFallback(Buffer& buffer) {
+    while (buffer.written < buffer.length) {
+        ssize_t n = ::pwrite(fd_, buffer.data + buffer.written, buffer.length - buffer.written,
+                             static_cast<off_t>(buffer.offset + buffer.written));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;
+        writeCount_++;
+        bytesWritten_ += static_cast<size_t>(n);
+        buffer.written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void UringSink::drain() {
+    while (inFlight_ > 0) {
+        reap(true);
+    }
+}
+
+void UringSink::flush() {
+    if (fd_ < 0) return;
+    submitCurrent();
+    drain();
+}
+
+void UringSink::truncate() {
+    if (fd_ < 0) return;
+    flush();
+    if (::ftruncate(fd_, 0) == 0) {
+        fileSize_ = 0;
+        submittedSize_ = 0;
+        if (!header_.empty()) {
+            append(header_);
+        }
+    }
+}
+
+size_t UringSink::getWriteCount() const {
+    return writeCount_;
+}
+
+size_t UringSink::getBytesWritten() const {
+    return bytesWritten_;
+}
+
+size_t UringSink::getStallCount() const {
+    return stallCount_;
+}
+
+bool UringSink::isFixedBuffers() const {
+    return fixed_;
+}
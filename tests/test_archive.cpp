@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include "archive_display.h"
+#include "archive_reader.h"
+#include "column_codec.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+
+namespace fs = std::filesystem;
+
+TEST(ColumnCodecTest, RoundTripsVariousColumns) {
+    std::mt19937_64 rng(7);
+    std::vector<std::vector<std::int64_t>> cases = {
+        {42},
+        {5, 5, 5, 5, 5},
+        {0, 1000, 2000, 3000, 4000, 5000},
+        {std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(), 0, -1},
+    };
+    std::vector<std::int64_t> walk(5000), noise(3000);
+    std::int64_t v = 557500000;
+    for (auto& x : walk) { v += static_cast<std::int64_t>(rng() % 201) - 100; x = v; }
+    for (auto& x : noise) x = static_cast<std::int64_t>(rng());
+    cases.push_back(walk);
+    cases.push_back(noise);
+    
+    for (const auto& values : cases) {
+        std::vector<std::uint8_t> encoded;
+        column_codec::encode(values.data(), values.size(), encoded);
+        std::vector<std::int64_t> decoded(values.size());
+        ASSERT_TRUE(column_codec::decode(encoded.data(), encoded.size(), values.size(), decoded.data()));
+        EXPECT_EQ(decoded, values);
+        // Обрезанный кусок не читается за пределами данных
+        if (encoded.size() > 3) {
+            EXPECT_FALSE(column_codec::decode(encoded.data(), encoded.size() - 1, values.size(), decoded.data()));
+        }
+    }
+}
+
+TEST(ColumnCodecTest, RegularColumnsAreSmall) {
+    std::vector<std::int64_t> timestamps(4096);
+    for (size_t i = 0; i < timestamps.size(); i++) timestamps[i] = 36000000 + i * 1000;
+    std::vector<std::uint8_t> encoded;
+    column_codec::encode(timestamps.data(), timestamps.size(), encoded);
+    EXPECT_LT(encoded.size(), 16u);
+}
+
+class ArchiveTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_archive_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "track.gca").string();
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    // Движение на северо-восток с шагом 1 с
+    static GpsPoint createPoint(size_t i) {
+        GpsPoint p;
+        p.latitude = 55.0 + i * 1e-4;
+        p.longitude = 37.0 + i * 2e-4;
+        p.speed = static_cast<double>(i % 100);
+        p.course = 45.0;
+        p.altitude = 150.0 + (i % 7) * 0.25;
+        p.satellites = 8 + i % 3;
+        p.hdop = 0.9f;
+        p.timestamp = 36000000 + i * 1000;
+        p.isValid = true;
+        return p;
+    }
+    
+    void writeTrack(size_t points, std::uint32_t groupSize) {
+        ArchiveDisplay display(path, groupSize);
+        for (size_t i = 0; i < points; i++) {
+            if (i % 50 == 49) {
+                display.showInvalidFix(36000000 + i * 1000);
+            } else {
+                display.showPoint(createPoint(i));
+            }
+        }
+    }
+    
+    fs::path dir;
+    std::string path;
+};
+
+TEST_F(ArchiveTest, WriteRead_AllColumnsRoundTrip) {
+    writeTrack(1000, 256);
+    
+    ArchiveReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_EQ(reader.getRowGroupCount(), 4u);
+    EXPECT_EQ(reader.getRowCount(), 1000u);
+    // Колонки сжаты: заметно меньше 32 байт PackedGpsPoint на точку
+    EXPECT_LT(fs::file_size(path), 1000u * sizeof(PackedGpsPoint) / 2);
+    
+    size_t row = 0;
+    auto stats = reader.scan(ArchiveReader::Predicate(), archive_format::ALL_COLUMNS,
+        [&](const ArchiveReader::Batch& batch) {
+            for (size_t i = 0; i < batch.count; i++, row++) {
+                PackedGpsPoint expected = PackedGpsPoint::fromPoint(createPoint(row));
+                EXPECT_EQ(batch.column(archive_format::TIMESTAMP)[i], expected.timestamp);
+                if (row % 50 == 49) {
+                    EXPECT_EQ(batch.column(archive_format::VALID)[i], 0);
+                    continue;
+                }
+                EXPECT_EQ(batch.column(archive_format::VALID)[i], 1);
+                EXPECT_EQ(batch.column(archive_format::LATITUDE)[i], expected.latitudeE7);
+                EXPECT_EQ(batch.column(archive_format::LONGITUDE)[i], expected.longitudeE7);
+                EXPECT_EQ(batch.column(archive_format::ALTITUDE)[i], expected.altitudeCm);
+                EXPECT_EQ(batch.column(archive_format::SPEED)[i], expected.speedCentiKmh);
+                EXPECT_EQ(batch.column(archive_format::COURSE)[i], expected.courseCentiDeg);
+                EXPECT_EQ(batch.column(archive_format::HDOP)[i], expected.hdopCenti);
+                EXPECT_EQ(batch.column(archive_format::SATELLITES)[i], expected.satellites);
+            }
+        });
+    EXPECT_EQ(row, 1000u);
+    EXPECT_EQ(stats.groupsSkipped, 0u);
+    EXPECT_EQ(stats.rowsMatched, 1000u);
+}
+
+TEST_F(ArchiveTest, TimeRange_SkipsGroupsByStatistics) {
+    writeTrack(4096, 512);
+    ArchiveReader reader(path);
+    
+    ArchiveReader::Predicate predicate;
+    predicate.setTimeRange(36000000 + 1000 * 1000, 36000000 + 1199 * 1000);
+    std::vector<std::int64_t> speeds;
+    auto stats = reader.scan(predicate, archive_format::columnBit(archive_format::SPEED),
+        [&](const ArchiveReader::Batch& batch) {
+            EXPECT_TRUE(batch.columns[archive_format::TIMESTAMP].empty());
+            speeds.insert(speeds.end(), batch.column(archive_format::SPEED),
+                          batch.column(archive_format::SPEED) + batch.count);
+        });
+    
+    // Диапазон попадает в группы 1 и 2 (точки 512..1535)
+    EXPECT_EQ(stats.groupsTotal, 8u);
+    EXPECT_EQ(stats.groupsSkipped, 6u);
+    EXPECT_EQ(stats.rowsScanned, 1024u);
+    EXPECT_EQ(stats.rowsMatched, 200u);
+    ASSERT_EQ(speeds.size(), 200u);
+    EXPECT_EQ(speeds.front(), 0);          // точка 1000: скорость 0
+    EXPECT_EQ(speeds[198], 98 * 100);      // точка 1198: 98 км/ч
+    EXPECT_EQ(speeds[199], 0);             // точка 1199: нет фикса
+}
+
+TEST_F(ArchiveTest, BoundingBox_FiltersRowsAndInvalidFixes) {
+    writeTrack(2000, 256);
+    ArchiveReader reader(path);
+    
+    // Точки 300..399 по широте и долготе
+    ArchiveReader::Predicate predicate;
+    predicate.setBox(55.0 + 300e-4, 37.0 + 300 * 2e-4, 55.0 + 399e-4, 37.0 + 399 * 2e-4);
+    size_t matched = 0;
+    auto stats = reader.scan(predicate, archive_format::columnBit(archive_format::TIMESTAMP),
+        [&](const ArchiveReader::Batch& batch) {
+            for (size_t i = 0; i < batch.count; i++) {
+                std::int64_t index = (batch.column(archive_format::TIMESTAMP)[i] - 36000000) / 1000;
+                EXPECT_GE(index, 300);
+                EXPECT_LE(index, 399);
+                EXPECT_NE(index % 50, 49);
+                matched++;
+            }
+        });
+    EXPECT_EQ(matched, 98u);   // 100 точек без двух отметок "нет фикса"
+    EXPECT_EQ(stats.groupsSkipped, 7u);  // все точки в группе 1 (256..511)
+}
+
+TEST_F(ArchiveTest, Reopen_AppendsAndDropsTornGroup) {
+    writeTrack(300, 128);
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write("GPSGROUP\x40\x00\x00\x00", 12);
+    }
+    {
+        ArchiveDisplay display(path, 128);
+        display.showPoint(createPoint(300));
+    }
+    
+    ArchiveReader reader(path);
+    EXPECT_EQ(reader.getRowCount(), 301u);
+    EXPECT_EQ(reader.getRowGroupCount(), 4u);
+}
+
+TEST_F(ArchiveTest, Rotation_EachFileIsReadable) {
+    {
+        ArchiveDisplay display(path, 64, true, 1024);
+        for (size_t i = 0; i < 2000; i++) {
+            display.showPoint(createPoint(i));
+        }
+    }
+    
+    size_t files = 0;
+    size_t rows = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        ArchiveReader reader(entry.path().string());
+        ASSERT_TRUE(reader.isOpen()) << entry.path();
+        rows += reader.getRowCount();
+        files++;
+    }
+    EXPECT_GT(files, 1u);
+    EXPECT_EQ(rows, 2000u);
+}
+
+TEST_F(ArchiveTest, Pipeline_CreatesArchiveDisplay) {
+    JsonConfig config;
+    config.setDisplayType("archive");
+    config.setOutputFile(path);
+    {
+        GpsPipeline pipeline(config);
+        pipeline.getDisplay()->showPoint(createPoint(0));
+        pipeline.flush();
+    }
+    
+    ArchiveReader reader(path);
+    EXPECT_EQ(reader.getRowCount(), 1u);
+    EXPECT_FALSE(ArchiveReader().open((dir / "missing.gca").string()));
+}
+
+TEST_F(ArchiveTest, TimeRange_AcrossMidnightWithoutDate) {
+    // Двое суток без даты (только GGA): время продолжается после полуночи
+    const unsigned long long start = 86400000ULL - 600 * 1000;
+    {
+        ArchiveDisplay display(path, 100);
+        for (size_t i = 0; i < 2000; i++) {
+            GpsPoint p = createPoint(i);
+            p.timestamp = (start + i * 1000) % 86400000ULL;
+            display.showPoint(p);
+        }
+    }
+    
+    ArchiveReader reader(path);
+    ArchiveReader::Predicate predicate;
+    // Минута после полуночи: строки 600..659
+    predicate.setTimeRange(86400000, 86400000 + 59 * 1000);
+    std::vector<std::int64_t> timestamps;
+    auto stats = reader.scan(predicate, archive_format::columnBit(archive_format::TIMESTAMP),
+        [&](const ArchiveReader::Batch& batch) {
+            timestamps.insert(timestamps.end(), batch.column(archive_format::TIMESTAMP),
+                              batch.column(archive_format::TIMESTAMP) + batch.count);
+        });
+    ASSERT_EQ(timestamps.size(), 60u);
+    EXPECT_EQ(timestamps.front(), 86400000);
+    EXPECT_EQ(stats.groupsSkipped, 19u);
+    
+    for (size_t g = 0; g < reader.getRowGroupCount(); g++) {
+        const auto& group = reader.getRowGroup(g);
+        EXPECT_EQ(group.maxTimestamp - group.minTimestamp, 99 * 1000);
+    }
+}
+
+TEST_F(ArchiveTest, Reopen_ContinuesTimeAfterMidnight) {
+    {
+        ArchiveDisplay display(path, 16);
+        GpsPoint p = createPoint(0);
+        p.timestamp = 86400000ULL - 1000;
+        display.showPoint(p);
+    }
+    {
+        ArchiveDisplay display(path, 16);
+        display.showInvalidFix(1000);
+    }
+    
+    std::vector<std::int64_t> out;
+    ArchiveReader reader(path);
+    ASSERT_EQ(reader.getRowGroupCount(), 2u);
+    ASSERT_TRUE(reader.readColumn(1, archive_format::TIMESTAMP, out));
+    EXPECT_EQ(out[0], 86400000 + 1000);
+}
+
+TEST_F(ArchiveTest, DatedPoints_UseEpochTime) {
+    const std::int64_t day = 764380800000LL;   // 23.03.1994
+    {
+        ArchiveDisplay display(path, 16);
+        GpsPoint p = createPoint(0);
+        p.setDateMs(day);
+        display.showPoint(p);
+        // Отметка без фикса знает только время суток и берет дату предыдущей точки
+        display.showInvalidFix(p.timestamp + 1000);
+    }
+    
+    std::vector<std::int64_t> out;
+    ArchiveReader reader(path);
+    ASSERT_TRUE(reader.readColumn(0, archive_format::TIMESTAMP, out));
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[0], day + 36000000);
+    EXPECT_EQ(out[1], day + 36001000);
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "binary_track_display.h"
+#include "track_reader.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+class BinaryTrackTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_binary_track_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "track.gtk").string();
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    static GpsPoint createPoint(unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75 + timestamp * 1e-8;
+        p.longitude = 37.61 - timestamp * 1e-8;
+        p.speed = 42.5;
+        p.course = 90.25;
+        p.altitude = 150.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    fs::path dir;
+    std::string path;
+};
+
+TEST_F(BinaryTrackTest, WriteRead_RoundTripsPoints) {
+    {
+        BinaryTrackDisplay display(path, 4);
+        for (int i = 0; i < 10; i++) {
+            display.showPoint(createPoint(i * 1000ULL));
+        }
+        display.showInvalidFix(10000);
+        display.showParseError("ignored");
+        display.showRejected("ignored");
+        EXPECT_EQ(display.getRecordCount(), 11u);
+    }
+    
+    // Заголовок + 3 блока (4 + 4 + 3 точки) по одной синхронизации на блок
+    EXPECT_EQ(fs::file_size(path), 32u * (1 + 11 + 3));
+    
+    TrackReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_EQ(reader.getBlockRecords(), 4u);
+    EXPECT_EQ(reader.getBlockCount(), 3u);
+    ASSERT_EQ(reader.size(), 11u);
+    for (size_t i = 0; i < 10; i++) {
+        GpsPoint p = reader[i].toPoint();
+        GpsPoint expected = createPoint(i * 1000ULL);
+        EXPECT_EQ(p.timestamp, expected.timestamp);
+        EXPECT_NEAR(p.latitude, expected.latitude, 1e-7);
+        EXPECT_NEAR(p.longitude, expected.longitude, 1e-7);
+        EXPECT_NEAR(p.speed, 42.5, 0.01);
+        EXPECT_NEAR(p.course, 90.25, 0.01);
+        EXPECT_EQ(p.satellites, 8);
+        EXPECT_TRUE(p.isValid);
+    }
+    EXPECT_FALSE(reader[10].isValid());
+    EXPECT_EQ(reader[10].timestamp, 10000);
+    
+    size_t count = 0;
+    for (const auto& record : reader) {
+        EXPECT_EQ(record.timestamp, static_cast<std::int64_t>(count * 1000));
+        count++;
+    }
+    EXPECT_EQ(count, 11u);
+}
+
+TEST_F(BinaryTrackTest, LowerBound_FindsFirstNotEarlier) {
+    {
+        BinaryTrackDisplay display(path, 8);
+        for (int i = 0; i < 100; i++) {
+            // Повторяющиеся метки времени на границах блоков
+            display.showPoint(createPoint((i / 2) * 1000ULL));
+        }
+    }
+    
+    TrackReader reader(path);
+    ASSERT_EQ(reader.size(), 100u);
+    for (std::int64_t t = -500; t <= 51000; t += 250) {
+        size_t expected = 0;
+        while (expected < reader.size() && reader[expected].timestamp < t) {
+            expected++;
+        }
+        EXPECT_EQ(reader.lowerBound(t), expected) << "t = " << t;
+    }
+    
+    auto it = reader.seek(20000);
+    ASSERT_NE(it, reader.end());
+    EXPECT_EQ(it->timestamp, 20000);
+    EXPECT_EQ(it.index(), 40u);
+    EXPECT_TRUE(std::is_sorted(reader.begin(), reader.end(),
+        [](const PackedGpsPoint& a, const PackedGpsPoint& b) { return a.timestamp < b.timestamp; }));
+}
+
+TEST_F(BinaryTrackTest, Reopen_AppendsAndDropsPartialRecord) {
+    {
+        BinaryTrackDisplay display(path, 4);
+        for (int i = 0; i < 6; i++) {
+            display.showPoint(createPoint(i * 1000ULL));
+        }
+    }
+    // Аварийное завершение посреди записи
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.write("garbage", 7);
+    }
+    {
+        BinaryTrackDisplay display(path, 16);
+        EXPECT_EQ(display.getRecordCount(), 6u);
+        EXPECT_EQ(display.getBlockRecords(), 4u);   // из заголовка файла
+        for (int i = 6; i < 9; i++) {
+            display.showPoint(createPoint(i * 1000ULL));
+        }
+    }
+    
+    TrackReader reader(path);
+    ASSERT_EQ(reader.size(), 9u);
+    EXPECT_EQ(reader.getBlockCount(), 3u);
+    for (size_t i = 0; i < reader.size(); i++) {
+        EXPECT_EQ(reader[i].timestamp, static_cast<std::int64_t>(i * 1000));
+    }
+}
+
+TEST_F(BinaryTrackTest, Reader_StopsAtCorruptBlock) {
+    {
+        BinaryTrackDisplay display(path, 4);
+        for (int i = 0; i < 12; i++) {
+            display.showPoint(createPoint(i * 1000ULL));
+        }
+    }
+    // Портим синхронизацию второго блока
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(32 * (1 + 5));
+        file.write("XXXXXXXX", 8);
+    }
+    
+    TrackReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_EQ(reader.size(), 4u);
+    EXPECT_EQ(reader.getBlockCount(), 1u);
+}
+
+TEST_F(BinaryTrackTest, Reader_RejectsForeignFile) {
+    {
+        std::ofstream file(path);
+        file << "[12:00:00] Coordinates: 55.75000°N, 37.61000°E\n";
+    }
+    TrackReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.isOpen());
+    EXPECT_EQ(reader.size(), 0u);
+    EXPECT_FALSE(reader.open((dir / "missing.gtk").string()));
+}
+
+TEST_F(BinaryTrackTest, Clear_RestartsTrack) {
+    BinaryTrackDisplay display(path, 4, true, 10);
+    for (int i = 0; i < 5; i++) {
+        display.showPoint(createPoint(i * 1000ULL));
+    }
+    display.clear();
+    display.showPoint(createPoint(7000));
+    display.flush();
+    
+    TrackReader reader(path);
+    ASSERT_EQ(reader.size(), 1u);
+    EXPECT_EQ(reader[0].timestamp, 7000);
+}
+
+TEST_F(BinaryTrackTest, Pipeline_CreatesBinaryDisplay) {
+    JsonConfig config;
+    config.setDisplayType("binary");
+    config.setOutputFile(path);
+    {
+        GpsPipeline pipeline(config);
+        pipeline.getDisplay()->showPoint(createPoint(1000));
+        pipeline.getDisplay()->showPoint(createPoint(2000));
+    }
+    
+    TrackReader reader(path);
+    ASSERT_EQ(reader.size(), 2u);
+    EXPECT_EQ(reader[1].timestamp, 2000);
+}
+
+TEST_F(BinaryTrackTest, LowerBound_AcrossMidnightAndReopen) {
+    const unsigned long long day = 86400000ULL;
+    {
+        BinaryTrackDisplay display(path, 8);
+        for (unsigned long long i = 0; i < 100; i++) {
+            display.showPoint(createPoint((day - 50000 + i * 1000) % day));
+        }
+    }
+    {
+        // Дописывание продолжает время вторых суток, а не начинает с полуночи
+        BinaryTrackDisplay display(path, 8);
+        display.showInvalidFix(50000);
+        display.showPoint(createPoint(51000));
+    }
+    
+    TrackReader reader(path);
+    ASSERT_EQ(reader.size(), 102u);
+    EXPECT_TRUE(std::is_sorted(reader.begin(), reader.end(),
+        [](const PackedGpsPoint& a, const PackedGpsPoint& b) { return a.timestamp < b.timestamp; }));
+    EXPECT_EQ(reader.lowerBound(static_cast<std::int64_t>(day)), 50u);
+    EXPECT_EQ(reader.lowerBound(static_cast<std::int64_t>(day - 20000)), 30u);
+    EXPECT_EQ(reader[101].timestamp, static_cast<std::int64_t>(day + 51000));
+    // Время суток восстанавливается при чтении
+    EXPECT_EQ(reader[60].toPoint().timestamp, 10000u);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include "columnar_history.h"
+#include "history.h"
+#include "gps_point.h"
+
+class ColumnarHistoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        history = std::make_unique<ColumnarHistory>(3);
+    }
+    
+    GpsPoint createValidPoint(double lat, double lon, double speed, unsigned long long time) {
+        GpsPoint p;
+        p.latitude = lat;
+        p.longitude = lon;
+        p.speed = speed;
+        p.timestamp = time;
+        p.isValid = true;
+        return p;
+    }
+    
+    GpsPoint createInvalidPoint(unsigned long long time) {
+        GpsPoint p;
+        p.timestamp = time;
+        p.isValid = false;
+        return p;
+    }
+    
+    std::unique_ptr<ColumnarHistory> history;
+};
+
+TEST_F(ColumnarHistoryTest, NewHistory_IsEmpty) {
+    EXPECT_TRUE(history->empty());
+    EXPECT_EQ(history->size(), 0);
+    EXPECT_FALSE(history->getLastValid().has_value());
+}
+
+TEST_F(ColumnarHistoryTest, AddPoint_RespectsMaxSizeAndOrder) {
+    for (int i = 0; i < 5; i++) {
+        history->addPoint(createValidPoint(48.0 + i, 11.0, 10.0 * i, 1000 * i));
+    }
+    
+    ASSERT_EQ(history->size(), 3);
+    EXPECT_EQ(history->getPoint(0).timestamp, 2000);
+    EXPECT_EQ(history->getPoint(2).timestamp, 4000);
+    
+    // Колонки непрерывны и начинаются с самой старой точки
+    const unsigned long long* ts = history->timestamps();
+    EXPECT_EQ(ts[0], 2000);
+    EXPECT_EQ(ts[1], 3000);
+    EXPECT_EQ(ts[2], 4000);
+    EXPECT_DOUBLE_EQ(history->latitudes()[2], 52.0);
+}
+
+TEST_F(ColumnarHistoryTest, GetLastValid_SkipsInvalidPoints) {
+    history->addPoint(createValidPoint(48.1173, 11.5167, 10.0, 1000));
+    history->addPoint(createInvalidPoint(2000));
+    
+    auto last = history->getLastValid();
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(last->timestamp, 1000);
+}
+
+TEST_F(ColumnarHistoryTest, GetLastValid_ForgetsEvictedPoint) {
+    history->addPoint(createValidPoint(48.0, 11.0, 10.0, 1000));
+    history->addPoint(createInvalidPoint(2000));
+    history->addPoint(createInvalidPoint(3000));
+    ASSERT_TRUE(history->getLastValid().has_value());
+    
+    // Валидная точка вытеснена, в окне остались только невалидные
+    history->addPoint(createInvalidPoint(4000));
+    EXPECT_FALSE(history->getLastValid().has_value());
+    
+    history->addPoint(createValidPoint(48.5, 11.0, 10.0, 5000));
+    ASSERT_TRUE(history->getLastValid().has_value());
+    EXPECT_EQ(history->getLastValid()->timestamp, 5000);
+    
+    history->setMaxSize(2);
+    EXPECT_EQ(history->getLastValid()->timestamp, 5000);
+    history->clear();
+    EXPECT_FALSE(history->getLastValid().has_value());
+}
+
+TEST_F(ColumnarHistoryTest, SpeedStats_IgnoresInvalidPoints) {
+    history->setMaxSize(10);
+    history->addPoint(createValidPoint(48.0, 11.0, 10.0, 1000));
+    history->addPoint(createValidPoint(48.0, 11.0, 20.0, 2000));
+    history->addPoint(createInvalidPoint(3000));
+    history->addPoint(createValidPoint(48.0, 11.0, 30.0, 4000));
+    
+    SpeedStats stats = history->speedStats();
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_DOUBLE_EQ(stats.mean, 20.0);
+    EXPECT_NEAR(stats.variance, 200.0 / 3.0, 1e-9);
+    
+    // Окно из двух последних точек: одна невалидная
+    SpeedStats tail = history->speedStats(2);
+    EXPECT_EQ(tail.count, 1);
+    EXPECT_DOUBLE_EQ(tail.mean, 30.0);
+}
+
+TEST_F(ColumnarHistoryTest, PathLength_MatchesMeridianDistance) {
+    history->setMaxSize(1000);
+    // 0.001 градуса по меридиану ~ 111.2 м
+    for (int i = 0; i < 1000; i++) {
+        history->addPoint(createValidPoint(48.0 + i * 0.001, 11.0, 10.0, 1000 * i));
+    }
+    
+    const double segment = 0.001 * M_PI / 180.0 * 6371000.0;
+    EXPECT_NEAR(history->pathLength(), segment * 999, 1e-3);
+    EXPECT_NEAR(history->pathLength(11), segment * 10, 1e-6);
+}
+
+TEST_F(ColumnarHistoryTest, PathLength_AcrossAntimeridian) {
+    history->addPoint(createValidPoint(0.0, 179.9995, 10.0, 1000));
+    history->addPoint(createValidPoint(0.0, -179.9995, 10.0, 2000));
+    
+    const double expected = 0.001 * M_PI / 180.0 * 6371000.0;
+    EXPECT_NEAR(history->pathLength(), expected, 1e-6);
+}
+
+TEST_F(ColumnarHistoryTest, PathLength_MatchesGpsHistoryDistance) {
+    // Невалидные точки пропускаются: отрезок идет между соседними валидными
+    history->setMaxSize(6);
+    GpsHistory reference(6);
+    for (int i = 0; i < 20; i++) {
+        GpsPoint p = i % 3 == 1 ? createInvalidPoint(1000 * i)
+                                : createValidPoint(48.0 + i * 0.01, 11.0 + (i % 4) * 0.02, 10.0, 1000 * i);
+        history->addPoint(p);
+        reference.addPoint(p);
+        EXPECT_NEAR(history->pathLength(), reference.getStats().distance, 1e-6) << i;
+    }
+    
+    // Окно начинается с невалидной точки: отрезок в первую валидную не считается
+    ASSERT_FALSE(history->getPoint(2).isValid);
+    GpsHistory tail(4);
+    for (size_t i = 2; i < 6; i++) {
+        tail.addPoint(history->getPoint(i));
+    }
+    EXPECT_GT(tail.getStats().distance, 0.0);
+    EXPECT_NEAR(history->pathLength(4), tail.getStats().distance, 1e-6);
+}
+
+TEST_F(ColumnarHistoryTest, BoundingBox_CoversValidPoints) {
+    history->setMaxSize(10);
+    history->addPoint(createValidPoint(48.1, 11.5, 10.0, 1000));
+    history->addPoint(createInvalidPoint(2000));
+    history->addPoint(createValidPoint(48.3, 11.2, 10.0, 3000));
+    history->addPoint(createValidPoint(48.2, 11.9, 10.0, 4000));
+    
+    BoundingBox box = history->boundingBox();
+    ASSERT_FALSE(box.empty);
+    EXPECT_DOUBLE_EQ(box.minLatitude, 48.1);
+    EXPECT_DOUBLE_EQ(box.maxLatitude, 48.3);
+    EXPECT_DOUBLE_EQ(box.minLongitude, 11.2);
+    EXPECT_DOUBLE_EQ(box.maxLongitude, 11.9);
+    
+    history->clear();
+    EXPECT_TRUE(history->boundingBox().empty);
+}
+
+TEST_F(ColumnarHistoryTest, SetMaxSize_KeepsNewestPoints) {
+    history->addPoint(createValidPoint(48.0, 11.0, 10.0, 1000));
+    history->addPoint(createValidPoint(48.0, 11.0, 20.0, 2000));
+    history->addPoint(createValidPoint(48.0, 11.0, 30.0, 3000));
+    history->addPoint(createValidPoint(48.0, 11.0, 40.0, 4000));
+    
+    history->setMaxSize(2);
+    ASSERT_EQ(history->size(), 2);
+    EXPECT_EQ(history->getPoint(0).timestamp, 3000);
+    EXPECT_EQ(history->getPoint(1).timestamp, 4000);
+    
+    history->addPoint(createValidPoint(48.0, 11.0, 50.0, 5000));
+    EXPECT_EQ(history->getPoint(0).timestamp, 4000);
+    EXPECT_DOUBLE_EQ(history->speedStats().mean, 45.0);
+}
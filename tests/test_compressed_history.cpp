@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "compressed_history.h"
+#include "gps_point.h"
+
+class CompressedHistoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        history = std::make_unique<CompressedHistory>(100, 8);
+    }
+    
+    // Реалистичный трек 1 Гц: ~20 м/с на северо-восток
+    GpsPoint trackPoint(int i, bool valid = true) {
+        GpsPoint p;
+        p.latitude = 48.1173 + i * 0.00012;
+        p.longitude = 11.5167 + i * 0.00015;
+        p.speed = 72.0 + (i % 7) * 0.3;
+        p.course = 45.0 + (i % 5) * 0.1;
+        p.altitude = 545.4 + (i % 3) * 0.2;
+        p.satellites = 8 + (i % 2);
+        p.hdop = 0.9f;
+        p.timestamp = 12 * 3600 * 1000ULL + i * 1000ULL;
+        p.isValid = valid;
+        return p;
+    }
+    
+    std::unique_ptr<CompressedHistory> history;
+};
+
+TEST_F(CompressedHistoryTest, NewHistory_IsEmpty) {
+    EXPECT_TRUE(history->empty());
+    EXPECT_EQ(history->size(), 0);
+    EXPECT_FALSE(history->getLastValid().has_value());
+}
+
+TEST_F(CompressedHistoryTest, GetPoint_RoundTripsWithinQuantization) {
+    for (int i = 0; i < 30; i++) {
+        history->addPoint(trackPoint(i));
+    }
+    
+    ASSERT_EQ(history->size(), 30);
+    for (int i = 0; i < 30; i++) {
+        GpsPoint expected = trackPoint(i);
+        GpsPoint actual = history->getPoint(i);
+        EXPECT_EQ(actual.timestamp, expected.timestamp);
+        EXPECT_NEAR(actual.latitude, expected.latitude, 1e-7);
+        EXPECT_NEAR(actual.longitude, expected.longitude, 1e-7);
+        EXPECT_NEAR(actual.speed, expected.speed, 0.01);
+        EXPECT_NEAR(actual.course, expected.course, 0.01);
+        EXPECT_NEAR(actual.altitude, expected.altitude, 0.01);
+        EXPECT_NEAR(actual.hdop, expected.hdop, 0.01);
+        EXPECT_EQ(actual.satellites, expected.satellites);
+        EXPECT_TRUE(actual.isValid);
+    }
+}
+
+TEST_F(CompressedHistoryTest, Tail_IsStoredExactly) {
+    for (int i = 0; i < 10; i++) {
+        history->addPoint(trackPoint(i));
+    }
+    
+    // Точки 8 и 9 в несжатом хвосте
+    EXPECT_DOUBLE_EQ(history->getPoint(9).latitude, trackPoint(9).latitude);
+    auto last = history->getLastValid();
+    ASSERT_TRUE(last.has_value());
+    EXPECT_DOUBLE_EQ(last->longitude, trackPoint(9).longitude);
+}
+
+TEST_F(CompressedHistoryTest, GetLastValid_SearchesCompressedBlocks) {
+    history->addPoint(trackPoint(0));
+    for (int i = 1; i < 12; i++) {
+        history->addPoint(trackPoint(i, false));
+    }
+    
+    auto last = history->getLastValid();
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(last->timestamp, trackPoint(0).timestamp);
+}
+
+TEST_F(CompressedHistoryTest, AddPoint_RespectsMaxSize) {
+    history->setMaxSize(20);
+    for (int i = 0; i < 50; i++) {
+        history->addPoint(trackPoint(i));
+    }
+    
+    ASSERT_EQ(history->size(), 20);
+    EXPECT_EQ(history->getPoint(0).timestamp, trackPoint(30).timestamp);
+    EXPECT_EQ(history->getPoint(19).timestamp, trackPoint(49).timestamp);
+    
+    std::vector<unsigned long long> visited;
+    history->forEach([&](const GpsPoint& p) { visited.push_back(p.timestamp); });
+    ASSERT_EQ(visited.size(), 20);
+    for (int i = 0; i < 20; i++) {
+        EXPECT_EQ(visited[i], trackPoint(30 + i).timestamp);
+    }
+}
+
+TEST_F(CompressedHistoryTest, MemoryUsage_IsMuchSmallerThanRawPoints) {
+    CompressedHistory large(3600, 64);
+    for (int i = 0; i < 3600; i++) {
+        large.addPoint(trackPoint(i));
+    }
+    
+    size_t raw = 3600 * sizeof(GpsPoint);
+    EXPECT_LT(large.memoryUsage() * 5, raw);
+}
+
+TEST_F(CompressedHistoryTest, Clear_RemovesAllPoints) {
+    for (int i = 0; i < 20; i++) {
+        history->addPoint(trackPoint(i));
+    }
+    history->getPoint(0);
+    history->clear();
+    
+    EXPECT_TRUE(history->empty());
+    history->addPoint(trackPoint(100));
+    EXPECT_EQ(history->getPoint(0).timestamp, trackPoint(100).timestamp);
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include "fanout_display.h"
+#include "file_display.h"
+#include "mock_display.h"
+#include "structured_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Дисплей, который не принимает записи, пока не открыт шлюз
+    class GatedDisplay : public MockDisplay {
+    public:
+        explicit GatedDisplay(bool open = false) : open_(open) {}
+        
+        void showPoint(const GpsPoint& point) override {
+            std::unique_lock<std::mutex> lock(mutex_);
+            gate_.wait(lock, [this] { return open_; });
+            lock.unlock();
+            MockDisplay::showPoint(point);
+        }
+        
+        void open() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+            gate_.notify_all();
+        }
+        
+    private:
+        std::mutex mutex_;
+        std::condition_variable gate_;
+        bool open_;
+    };
+}
+
+class FanoutDisplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_fanout_display_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    static GpsPoint createPoint(unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75;
+        p.longitude = 37.61;
+        p.speed = 42.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    static std::string readFile(const std::string& name) {
+        std::ifstream file(name);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+    
+    fs::path dir;
+};
+
+TEST_F(FanoutDisplayTest, DeliversSameStreamToEverySink) {
+    FanoutDisplay fanout;
+    auto first = std::make_unique<MockDisplay>();
+    auto second = std::make_unique<MockDisplay>();
+    MockDisplay* a = first.get();
+    MockDisplay* b = second.get();
+    fanout.addSink(std::move(first));
+    fanout.addSink(std::move(second));
+    
+    for (unsigned long long t = 0; t < 500; t++) {
+        fanout.showPoint(createPoint(t));
+    }
+    GpsEvent event;
+    event.subject = "zone";
+    fanout.showEvent(event);
+    fanout.showParseError("bad");
+    fanout.flush();
+    
+    for (MockDisplay* sink : {a, b}) {
+        ASSERT_EQ(sink->getCalls().size(), 502u);
+        EXPECT_EQ(sink->getPointCount(), 500);
+        for (unsigned long long t = 0; t < 500; t++) {
+            EXPECT_EQ(sink->getCalls()[t].point.timestamp, t);
+        }
+        EXPECT_EQ(sink->getCalls()[500].event.subject, "zone");
+        EXPECT_EQ(sink->getCalls()[501].message, "bad");
+    }
+    EXPECT_EQ(fanout.getDeliveredCount(0), 502u);
+    EXPECT_EQ(fanout.getDroppedCount(1), 0u);
+}
+
+TEST_F(FanoutDisplayTest, MaskSelectsRecords) {
+    FanoutDisplay fanout;
+    auto points = std::make_unique<MockDisplay>();
+    auto errors = std::make_unique<MockDisplay>();
+    MockDisplay* p = points.get();
+    MockDisplay* e = errors.get();
+    fanout.addSink(std::move(points), FanoutDisplay::POINTS);
+    fanout.addSink(std::move(errors), FanoutDisplay::PARSE_ERRORS | FanoutDisplay::REJECTED);
+    
+    fanout.showPoint(createPoint(1));
+    fanout.showInvalidFix(2);
+    fanout.showParseError("bad");
+    fanout.showRejected("speed");
+    fanout.showEvent(GpsEvent());
+    fanout.flush();
+    
+    ASSERT_EQ(p->getCalls().size(), 1u);
+    EXPECT_EQ(p->getCalls()[0].type, DisplayCall::Type::POINT);
+    ASSERT_EQ(e->getCalls().size(), 2u);
+    EXPECT_EQ(e->getCalls()[0].type, DisplayCall::Type::PARSE_ERROR);
+    EXPECT_EQ(e->getCalls()[1].type, DisplayCall::Type::REJECTED);
+}
+
+TEST_F(FanoutDisplayTest, ParseMask) {
+    unsigned mask = 0;
+    EXPECT_TRUE(FanoutDisplay::parseMask("points, errors", mask));
+    EXPECT_EQ(mask, FanoutDisplay::POINTS | FanoutDisplay::PARSE_ERRORS);
+    EXPECT_TRUE(FanoutDisplay::parseMask("all", mask));
+    EXPECT_EQ(mask, static_cast<unsigned>(FanoutDisplay::ALL));
+    EXPECT_TRUE(FanoutDisplay::parseMask("nofix,rejected,events", mask));
+    EXPECT_EQ(mask, FanoutDisplay::INVALID_FIX | FanoutDisplay::REJECTED | FanoutDisplay::EVENTS);
+    EXPECT_FALSE(FanoutDisplay::parseMask("points,warnings", mask));
+}
+
+TEST_F(FanoutDisplayTest, SlowSinkDropsWithoutStallingOthers) {
+    FanoutDisplay fanout;
+    auto slow = std::make_unique<GatedDisplay>();
+    auto fast = std::make_unique<MockDisplay>();
+    GatedDisplay* gated = slow.get();
+    MockDisplay* quick = fast.get();
+    fanout.addSink(std::move(slow), FanoutDisplay::ALL, 16);
+    fanout.addSink(std::move(fast), FanoutDisplay::ALL, 100000);
+    
+    // Шлюз закрыт: в очереди и в обработке не больше 16 записей, остальные отбрасываются
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long t = 0; t < 5000; t++) {
+        fanout.showPoint(createPoint(t));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+    EXPECT_GE(fanout.getDroppedCount(0), 5000u - 16u);
+    
+    gated->open();
+    fanout.flush();
+    
+    EXPECT_EQ(quick->getPointCount(), 5000);
+    EXPECT_EQ(fanout.getDroppedCount(1), 0u);
+    EXPECT_EQ(fanout.getDeliveredCount(0) + fanout.getDroppedCount(0), 5000u);
+    EXPECT_EQ(static_cast<size_t>(gated->getPointCount()), fanout.getDeliveredCount(0));
+}
+
+TEST_F(FanoutDisplayTest, ControlRecordsAreNotDropped) {
+    FanoutDisplay fanout;
+    auto slow = std::make_unique<GatedDisplay>();
+    GatedDisplay* gated = slow.get();
+    fanout.addSink(std::move(slow), FanoutDisplay::ALL, 4);
+    
+    for (unsigned long long t = 0; t < 100; t++) {
+        fanout.showPoint(createPoint(t));
+    }
+    // Очередь полна, но clear доходит и идет после уже принятых записей
+    fanout.clear();
+    gated->open();
+    fanout.flush();
+    fanout.showPoint(createPoint(1000));
+    fanout.flush();
+    
+    EXPECT_EQ(gated->getPointCount(), 1);
+    EXPECT_TRUE(gated->hasPointWithTime(1000));
+}
+
+TEST_F(FanoutDisplayTest, Pipeline_CreatesSinksFromConfig) {
+    const std::string logPath = (dir / "track.log").string();
+    const std::string ndjsonPath = (dir / "live.ndjson").string();
+    const std::string configPath = (dir / "config.json").string();
+    {
+        std::ofstream file(configPath);
+        file << "{\n"
+             << "  \"displayType\": \"fanout\",\n"
+             << "  \"filters\": [],\n"
+             << "  \"sinks\": [\n"
+             << "    { \"type\": \"file\", \"outputFile\": \"" << logPath << "\", \"events\": \"points\" },\n"
+             << "    { \"type\": \"ndjson\", \"outputFile\": \"" << ndjsonPath << "\", \"events\": \"errors\", \"queueSize\": 64 }\n"
+             << "  ]\n"
+             << "}\n";
+    }
+    JsonConfig config;
+    ASSERT_TRUE(config.loadFromFile(configPath));
+    ASSERT_EQ(config.getSinks().size(), 2u);
+    EXPECT_EQ(config.getSinks()[1].type, "ndjson");
+    EXPECT_EQ(config.getSinks()[1].events, "errors");
+    EXPECT_EQ(config.getSinks()[1].queueSize, 64u);
+    
+    // Сохранение и повторная загрузка
+    ASSERT_TRUE(config.saveToFile(configPath));
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(configPath));
+    ASSERT_EQ(loaded.getSinks().size(), 2u);
+    EXPECT_EQ(loaded.getSinks()[0].outputFile, logPath);
+    EXPECT_EQ(loaded.getSinks()[0].events, "points");
+    
+    {
+        GpsPipeline pipeline(loaded);
+        auto* fanout = dynamic_cast<FanoutDisplay*>(pipeline.getDisplay());
+        ASSERT_NE(fanout, nullptr);
+        ASSERT_EQ(fanout->getSinkCount(), 2u);
+        EXPECT_NE(dynamic_cast<FileDisplay*>(fanout->getSink(0)), nullptr);
+        EXPECT_NE(dynamic_cast<StructuredDisplay*>(fanout->getSink(1)), nullptr);
+        EXPECT_EQ(fanout->getMask(0), static_cast<unsigned>(FanoutDisplay::POINTS));
+        
+        pipeline.process("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*3D");
+        pipeline.process("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4F");
+        pipeline.process("$GPRMC,bad");
+    }
+    
+    std::string log = readFile(logPath);
+    EXPECT_NE(log.find("Coordinates"), std::string::npos);
+    EXPECT_EQ(log.find("error"), std::string::npos);
+    std::string ndjson = readFile(ndjsonPath);
+    EXPECT_EQ(ndjson.rfind("{\"type\":\"error\"", 0), 0u);
+    EXPECT_EQ(ndjson.find("\"point\""), std::string::npos);
+}
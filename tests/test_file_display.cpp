@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "file_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+class FileDisplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_file_display_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "out.log").string();
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    static GpsPoint createPoint(unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75;
+        p.longitude = 37.61;
+        p.speed = 42.0;
+        p.course = 90.0;
+        p.altitude = 150.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    static std::string readFile(const std::string& name) {
+        std::ifstream file(name);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+    
+    // Записать одинаковую последовательность в дисплей
+    static void writeSample(FileDisplay& display, int points) {
+        for (int i = 0; i < points; i++) {
+            display.showPoint(createPoint(i * 1000ULL));
+            if (i % 10 == 0) display.showRejected("speed");
+        }
+        display.showInvalidFix(points * 1000ULL);
+        display.showParseError("bad checksum");
+    }
+    
+    fs::path dir;
+    std::string path;
+};
+
+TEST_F(FileDisplayTest, Sync_WritesRecordsImmediately) {
+    FileDisplay display(path);
+    display.showPoint(createPoint(3723000));
+    
+    std::string content = readFile(path);
+    EXPECT_EQ(content,
+              "[01:02:03] Coordinates: 55.75000°N, 37.61000°E\n"
+              "               Speed: 42.0 km/h, Course: 90.0°\n"
+              "               Altitude: 150m, Satellites: 8, HDOP: 0.9\n");
+    EXPECT_EQ(display.getSink().getWriteCount(), 1u);
+}
+
+TEST_F(FileDisplayTest, Async_SameContentAsSync) {
+    const std::string syncPath = (dir / "sync.log").string();
+    {
+        FileDisplay sync(syncPath);
+        writeSample(sync, 500);
+    }
+    {
+        FileDisplay async(path, false, 0, true, 1000, 1 << 20);
+        writeSample(async, 500);
+        async.flush();
+        EXPECT_EQ(readFile(path), readFile(syncPath));
+        // Все записи ушли несколькими крупными вызовами write(2)
+        EXPECT_LT(async.getSink().getWriteCount(), 5u);
+    }
+    EXPECT_EQ(readFile(path), readFile(syncPath));
+}
+
+TEST_F(FileDisplayTest, Async_DestructorDrainsBuffer) {
+    {
+        FileDisplay display(path, false, 0, true, 60000, 1 << 20);
+        display.showParseError("pending");
+    }
+    EXPECT_EQ(readFile(path), "Parse error: pending\n");
+}
+
+TEST_F(FileDisplayTest, Async_ByteThresholdWakesWriter) {
+    FileDisplay display(path, false, 0, true, 60000, 256);
+    for (int i = 0; i < 20; i++) {
+        display.showPoint(createPoint(i * 1000ULL));
+    }
+    // Период - минута, но буфер переполнился: запись должна прийти без flush()
+    for (int wait = 0; wait < 200 && display.getSink().getBytesWritten() == 0; wait++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(display.getSink().getBytesWritten(), 0u);
+}
+
+TEST_F(FileDisplayTest, Async_RotationAtRecordBoundaries) {
+    const size_t maxSize = 1000;
+    size_t total = 0;
+    {
+        FileDisplay display(path, true, maxSize, true, 1000, 1 << 20);
+        for (int i = 0; i < 100; i++) {
+            display.showPoint(createPoint(i * 1000ULL));
+        }
+        display.flush();
+        total = display.getSink().getBytesWritten();
+    }
+    
+    size_t files = 0;
+    size_t bytes = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string content = readFile(entry.path().string());
+        files++;
+        bytes += content.size();
+        // Каждый файл начинается с записи и заканчивается целой записью
+        EXPECT_EQ(content.rfind("[", 0), 0u) << entry.path();
+        EXPECT_EQ(content.back(), '\n');
+    }
+    EXPECT_EQ(bytes, total);
+    EXPECT_GT(files, 1u);
+}
+
+TEST_F(FileDisplayTest, Async_BufferIsBoundedWithoutLosingRecords) {
+    std::string expected;
+    size_t blocked = 0;
+    {
+        // Период - минута, предел буфера - 4 * 64 байта: append() ждет фоновый поток
+        FileSink sink(path, false, 0, true, 60000, 64);
+        for (int i = 0; i < 10000; i++) {
+            std::string record = "record " + std::to_string(i) + "\n";
+            expected += record;
+            sink.append(record);
+        }
+        blocked = sink.getBlockedCount();
+    }
+    EXPECT_GT(blocked, 0u);
+    EXPECT_EQ(readFile(path), expected);
+}
+
+TEST_F(FileDisplayTest, Clear_TruncatesFile) {
+    FileDisplay display(path, false, 0, true);
+    writeSample(display, 10);
+    display.clear();
+    display.showParseError("after clear");
+    display.flush();
+    EXPECT_EQ(readFile(path), "Parse error: after clear\n");
+}
+
+TEST_F(FileDisplayTest, JsonConfig_AsyncOutputRoundTrip) {
+    JsonConfig config;
+    config.setAsyncOutput(true);
+    config.setFlushInterval(250);
+    config.setFlushBytes(4096);
+    
+    const std::string configPath = (dir / "config.json").string();
+    ASSERT_TRUE(config.saveToFile(configPath));
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(configPath));
+    EXPECT_TRUE(loaded.isAsyncOutput());
+    EXPECT_EQ(loaded.getFlushInterval(), 250u);
+    EXPECT_EQ(loaded.getFlushBytes(), 4096u);
+    
+    loaded.setDisplayType("file");
+    loaded.setOutputFile(path);
+    GpsPipeline pipeline(loaded);
+    auto* display = dynamic_cast<FileDisplay*>(pipeline.getDisplay());
+    ASSERT_NE(display, nullptr);
+    EXPECT_TRUE(display->getSink().isAsync());
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include "geodesy_batch.h"
+#include "geodesy.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+class GeodesyBatchTest : public ::testing::TestWithParam<geo::SimdLevel> {
+protected:
+    void SetUp() override {
+        saved_ = geo::getSimdLevel();
+        if (static_cast<int>(GetParam()) > static_cast<int>(geo::detectSimdLevel())) {
+            GTEST_SKIP() << geo::simdLevelName(GetParam()) << " is not supported";
+        }
+        geo::setSimdLevel(GetParam());
+    }
+    
+    void TearDown() override {
+        geo::setSimdLevel(saved_);
+    }
+    
+    // Расстояние между значениями в единицах младшего разряда эталона
+    static double ulpError(double value, double reference) {
+        double ulp = std::nextafter(std::fabs(reference), INFINITY) - std::fabs(reference);
+        return std::fabs(value - reference) / ulp;
+    }
+    
+    struct Track {
+        std::vector<double> lat1, lon1, lat2, lon2;
+    };
+    
+    static Track randomPairs(size_t n, unsigned seed) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> latDist(-90.0, 90.0);
+        std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+        std::uniform_real_distribution<double> step(-0.01, 0.01);
+        Track t;
+        for (size_t i = 0; i < n; i++) {
+            double lat = latDist(rng);
+            double lon = lonDist(rng);
+            t.lat1.push_back(lat);
+            t.lon1.push_back(lon);
+            // Половина пар - соседние точки трека, половина - произвольные
+            if (i % 2 == 0) {
+                t.lat2.push_back(std::max(-90.0, std::min(90.0, lat + step(rng))));
+                t.lon2.push_back(lon + step(rng));
+            } else {
+                t.lat2.push_back(latDist(rng));
+                t.lon2.push_back(lonDist(rng));
+            }
+        }
+        return t;
+    }
+    
+    geo::SimdLevel saved_ = geo::SimdLevel::SCALAR;
+};
+
+TEST_P(GeodesyBatchTest, SinCos_WithinTwoUlp) {
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> wide(-1000.0, 1000.0);
+    std::uniform_real_distribution<double> narrow(-4.0, 4.0);
+    std::vector<double> x;
+    for (int i = 0; i < 100000; i++) {
+        x.push_back(i % 2 == 0 ? wide(rng) : narrow(rng));
+    }
+    std::vector<double> s(x.size()), c(x.size());
+    geo::sinCosBatch(x.data(), s.data(), c.data(), x.size());
+    
+    double maxUlp = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        maxUlp = std::max(maxUlp, ulpError(s[i], std::sin(x[i])));
+        maxUlp = std::max(maxUlp, ulpError(c[i], std::cos(x[i])));
+    }
+    EXPECT_LE(maxUlp, 2.0);
+}
+
+TEST_P(GeodesyBatchTest, Atan2_WithinTwoUlp) {
+    std::mt19937_64 rng(2);
+    std::uniform_real_distribution<double> dist(-100.0, 100.0);
+    std::vector<double> y, x;
+    for (int i = 0; i < 100000; i++) {
+        y.push_back(dist(rng));
+        x.push_back(dist(rng));
+    }
+    // Особые случаи: оси и нули
+    for (double sy : {0.0, -0.0, 1.0, -1.0}) {
+        for (double sx : {0.0, -0.0, 1.0, -1.0}) {
+            y.push_back(sy);
+            x.push_back(sx);
+        }
+    }
+    std::vector<double> out(x.size());
+    geo::atan2Batch(y.data(), x.data(), out.data(), x.size());
+    
+    double maxUlp = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        double expected = std::atan2(y[i], x[i]);
+        if (expected == 0.0) {
+            EXPECT_EQ(out[i], 0.0) << y[i] << " " << x[i];
+            EXPECT_EQ(std::signbit(out[i]), std::signbit(expected));
+            continue;
+        }
+        maxUlp = std::max(maxUlp, ulpError(out[i], expected));
+    }
+    EXPECT_LE(maxUlp, 2.0);
+}
+
+TEST_P(GeodesyBatchTest, Haversine_MatchesScalar) {
+    auto t = randomPairs(10001, 3);
+    std::vector<double> out(t.lat1.size());
+    geo::haversineBatch(t.lat1.data(), t.lon1.data(), t.lat2.data(), t.lon2.data(), out.data(), out.size());
+    
+    for (size_t i = 0; i < out.size(); i++) {
+        double expected = geo::haversineDistance(t.lat1[i], t.lon1[i], t.lat2[i], t.lon2[i]);
+        EXPECT_NEAR(out[i], expected, 1e-6 + expected * 1e-13) << i;
+    }
+}
+
+TEST_P(GeodesyBatchTest, Bearing_MatchesScalar) {
+    auto t = randomPairs(10001, 4);
+    std::vector<double> out(t.lat1.size());
+    geo::bearingBatch(t.lat1.data(), t.lon1.data(), t.lat2.data(), t.lon2.data(), out.data(), out.size());
+    
+    for (size_t i = 0; i < out.size(); i++) {
+        double expected = geo::initialBearing(t.lat1[i], t.lon1[i], t.lat2[i], t.lon2[i]);
+        double diff = std::fabs(out[i] - expected);
+        diff = std::min(diff, 360.0 - diff);
+        EXPECT_LT(diff, 1e-9) << i;
+        EXPECT_GE(out[i], 0.0);
+        EXPECT_LT(out[i], 360.0);
+    }
+}
+
+TEST_P(GeodesyBatchTest, Bearing_CardinalDirections) {
+    double lat1[] = {0.0, 0.0, 0.0, 0.0};
+    double lon1[] = {0.0, 0.0, 0.0, 0.0};
+    double lat2[] = {1.0, 0.0, -1.0, 0.0};
+    double lon2[] = {0.0, 1.0, 0.0, -1.0};
+    double out[4];
+    geo::bearingBatch(lat1, lon1, lat2, lon2, out, 4);
+    EXPECT_NEAR(out[0], 0.0, 1e-12);
+    EXPECT_NEAR(out[1], 90.0, 1e-12);
+    EXPECT_NEAR(out[2], 180.0, 1e-12);
+    EXPECT_NEAR(out[3], 270.0, 1e-12);
+}
+
+TEST_P(GeodesyBatchTest, Tail_DoesNotDependOnPosition) {
+    auto t = randomPairs(16, 5);
+    std::vector<double> full(16);
+    geo::haversineBatch(t.lat1.data(), t.lon1.data(), t.lat2.data(), t.lon2.data(), full.data(), 16);
+    
+    for (size_t n = 0; n < 16; n++) {
+        std::vector<double> part(n + 1, -1.0);
+        geo::haversineBatch(t.lat1.data(), t.lon1.data(), t.lat2.data(), t.lon2.data(), part.data(), n);
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_EQ(part[i], full[i]) << n << " " << i;
+        }
+        // За пределы n не пишем
+        EXPECT_EQ(part[n], -1.0);
+    }
+}
+
+TEST_P(GeodesyBatchTest, ConsecutiveDistances_MatchesPairs) {
+    std::vector<double> lat, lon;
+    for (int i = 0; i < 1000; i++) {
+        lat.push_back(55.75 + 0.0001 * i);
+        lon.push_back(37.61 + 0.0002 * std::sin(i * 0.1));
+    }
+    std::vector<double> out(lat.size() - 1);
+    geo::consecutiveDistances(lat.data(), lon.data(), out.data(), lat.size());
+    
+    double sum = 0.0;
+    for (size_t i = 0; i + 1 < lat.size(); i++) {
+        double expected = geo::haversineDistance(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+        EXPECT_NEAR(out[i], expected, 1e-6);
+        sum += expected;
+    }
+    EXPECT_NEAR(geo::trackLength(lat.data(), lon.data(), lat.size()), sum, 1e-6);
+}
+
+TEST_P(GeodesyBatchTest, TrackLength_ShortInputs) {
+    double lat[] = {55.75};
+    double lon[] = {37.61};
+    EXPECT_DOUBLE_EQ(geo::trackLength(lat, lon, 0), 0.0);
+    EXPECT_DOUBLE_EQ(geo::trackLength(lat, lon, 1), 0.0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Levels, GeodesyBatchTest,
+    ::testing::Values(geo::SimdLevel::SCALAR, geo::SimdLevel::SSE2, geo::SimdLevel::AVX2),
+    [](const ::testing::TestParamInfo<geo::SimdLevel>& info) {
+        return std::string(geo::simdLevelName(info.param));
+    });
+
+TEST(GeodesyBatchLevelTest, SetSimdLevel_ClampsToSupported) {
+    auto saved = geo::getSimdLevel();
+    geo::setSimdLevel(geo::SimdLevel::AVX2);
+    EXPECT_LE(static_cast<int>(geo::getSimdLevel()), static_cast<int>(geo::detectSimdLevel()));
+    geo::setSimdLevel(geo::SimdLevel::SCALAR);
+    EXPECT_EQ(geo::getSimdLevel(), geo::SimdLevel::SCALAR);
+    geo::setSimdLevel(saved);
+}
@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include "geofence_filter.h"
+#include "mock_display.h"
+#include "pipeline.h"
+#include "json_config.h"
+#include "history.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+
+namespace {
+    // Квадратная зона со стороной size градусов, левый нижний угол (lat, lon)
+    std::string squareWkt(double lat, double lon, double size) {
+        char buf[256];
+        std::snprintf(buf, sizeof(buf), "POLYGON ((%.7f %.7f, %.7f %.7f, %.7f %.7f, %.7f %.7f, %.7f %.7f))",
+                      lon, lat, lon + size, lat, lon + size, lat + size, lon, lat + size, lon, lat);
+        return buf;
+    }
+}
+
+class GeofenceFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        filter = std::make_unique<GeofenceFilter>(0.01, 0.0);
+        filter->setDisplay(&display);
+        history = std::make_unique<GpsHistory>();
+    }
+    
+    GpsPoint createPoint(double lat, double lon, unsigned long long timestamp = 0) {
+        GpsPoint p;
+        p.latitude = lat;
+        p.longitude = lon;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    std::vector<GpsEvent> events() const {
+        std::vector<GpsEvent> result;
+        for (const auto& call : display.getCalls()) {
+            if (call.type == DisplayCall::Type::EVENT) {
+                result.push_back(call.event);
+            }
+        }
+        return result;
+    }
+    
+    MockDisplay display;
+    std::unique_ptr<GeofenceFilter> filter;
+    std::unique_ptr<GpsHistory> history;
+};
+
+TEST_F(GeofenceFilterTest, ParseWkt_Polygon_ComputesBoundingBox) {
+    GeofenceZone zone;
+    ASSERT_TRUE(GeofenceIndex::parseWkt("POLYGON ((37.0 55.0, 38.0 55.0, 38.0 56.0, 37.0 56.0, 37.0 55.0))", zone));
+    EXPECT_EQ(zone.ringEnds.size(), 1u);
+    EXPECT_EQ(zone.longitudes.size(), 4u);   // замыкающая вершина отброшена
+    EXPECT_DOUBLE_EQ(zone.minLatitude, 55.0);
+    EXPECT_DOUBLE_EQ(zone.maxLongitude, 38.0);
+}
+
+TEST_F(GeofenceFilterTest, ParseWkt_InvalidInput_ReturnsFalse) {
+    GeofenceZone zone;
+    EXPECT_FALSE(GeofenceIndex::parseWkt("POINT (1 2)", zone));
+    EXPECT_FALSE(GeofenceIndex::parseWkt("POLYGON ((1 2, 3 4))", zone));
+    EXPECT_FALSE(GeofenceIndex::parseWkt("POLYGON ((1 2, 3 4, 5 6", zone));
+    EXPECT_FALSE(GeofenceIndex::parseWkt("POLYGON ((1 2, 3 x, 5 6))", zone));
+}
+
+TEST_F(GeofenceFilterTest, Contains_PolygonWithHole) {
+    GeofenceZone zone;
+    ASSERT_TRUE(GeofenceIndex::parseWkt(
+        "POLYGON ((0 0, 10 0, 10 10, 0 10, 0 0), (4 4, 6 4, 6 6, 4 6, 4 4))", zone));
+    EXPECT_TRUE(zone.contains(2.0, 2.0));
+    EXPECT_FALSE(zone.contains(5.0, 5.0));
+    EXPECT_FALSE(zone.contains(11.0, 5.0));
+}
+
+TEST_F(GeofenceFilterTest, Contains_MultiPolygon) {
+    GeofenceZone zone;
+    ASSERT_TRUE(GeofenceIndex::parseWkt(
+        "MULTIPOLYGON (((0 0, 1 0, 1 1, 0 1, 0 0)), ((5 5, 6 5, 6 6, 5 6, 5 5)))", zone));
+    EXPECT_TRUE(zone.contains(0.5, 0.5));
+    EXPECT_TRUE(zone.contains(5.5, 5.5));
+    EXPECT_FALSE(zone.contains(3.0, 3.0));
+}
+
+TEST_F(GeofenceFilterTest, Process_EnterAndExit_EmitsEvents) {
+    ASSERT_TRUE(filter->getIndex().addZone("depot", squareWkt(55.750, 37.610, 0.002)));
+    
+    auto outside = createPoint(55.7490, 37.611, 1000);
+    auto inside = createPoint(55.7510, 37.611, 2000);
+    auto stillInside = createPoint(55.7511, 37.611, 3000);
+    auto left = createPoint(55.7530, 37.611, 12000);
+    
+    EXPECT_EQ(filter->process(outside, *history), FilterResult::PASS);
+    EXPECT_EQ(filter->process(inside, *history), FilterResult::PASS);
+    EXPECT_EQ(filter->process(stillInside, *history), FilterResult::PASS);
+    EXPECT_EQ(filter->getCurrentZones(), std::vector<std::string>{"depot"});
+    EXPECT_EQ(filter->process(left, *history), FilterResult::PASS);
+    EXPECT_TRUE(filter->getCurrentZones().empty());
+    
+    auto ev = events();
+    ASSERT_EQ(ev.size(), 2u);
+    EXPECT_EQ(ev[0].type, GpsEvent::Type::ZONE_ENTER);
+    EXPECT_EQ(ev[0].subject, "depot");
+    EXPECT_EQ(ev[0].source, "GeofenceFilter");
+    EXPECT_EQ(ev[0].timestamp, 2000u);
+    EXPECT_EQ(ev[1].type, GpsEvent::Type::ZONE_EXIT);
+    EXPECT_EQ(ev[1].durationMs, 10000u);
+}
+
+TEST_F(GeofenceFilterTest, Process_Dwell_EmittedOnce) {
+    filter->setDwellTime(60.0);
+    ASSERT_TRUE(filter->getIndex().addZone("site", squareWkt(55.750, 37.610, 0.002)));
+    
+    for (int i = 0; i <= 120; i += 10) {
+        auto point = createPoint(55.751, 37.611, i * 1000ULL);
+        filter->process(point, *history);
+    }
+    
+    auto ev = events();
+    ASSERT_EQ(ev.size(), 2u);
+    EXPECT_EQ(ev[0].type, GpsEvent::Type::ZONE_ENTER);
+    EXPECT_EQ(ev[1].type, GpsEvent::Type::ZONE_DWELL);
+    EXPECT_EQ(ev[1].durationMs, 60000u);
+}
+
+TEST_F(GeofenceFilterTest, Process_PointOnCellBoundary_StaysInside) {
+    // Точка на границе ячейки сетки: безопасный радиус равен нулю
+    ASSERT_TRUE(filter->getIndex().addZone("region", squareWkt(48.0, 11.0, 1.0)));
+    
+    for (int i = 0; i < 10; i++) {
+        auto point = i % 2 == 0 ? createPoint(48.5, 11.5, i * 1000ULL)
+                                : createPoint(48.5123, 11.5234, i * 1000ULL);
+        filter->process(point, *history);
+    }
+    
+    auto ev = events();
+    ASSERT_EQ(ev.size(), 1u);
+    EXPECT_EQ(ev[0].type, GpsEvent::Type::ZONE_ENTER);
+    EXPECT_EQ(ev[0].subject, "region");
+}
+
+TEST_F(GeofenceFilterTest, Process_SmallMovesInsideZone_UseCache) {
+    ASSERT_TRUE(filter->getIndex().addZone("big", squareWkt(55.700, 37.600, 0.009)));
+    
+    for (int i = 0; i < 100; i++) {
+        auto point = createPoint(55.7045 + 0.000001 * i, 37.6045, i * 1000ULL);
+        filter->process(point, *history);
+    }
+    EXPECT_EQ(filter->getEvaluationCount(), 1u);
+    EXPECT_EQ(display.getEventCount(), 1);
+}
+
+TEST_F(GeofenceFilterTest, Process_RandomWalk_MatchesBruteForce) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> latDist(55.70, 55.80);
+    std::uniform_real_distribution<double> lonDist(37.50, 37.70);
+    std::uniform_real_distribution<double> sizeDist(0.0005, 0.01);
+    
+    auto& index = filter->getIndex();
+    for (int i = 0; i < 2000; i++) {
+        ASSERT_TRUE(index.addZone("z" + std::to_string(i), squareWkt(latDist(rng), lonDist(rng), sizeDist(rng))));
+    }
+    // Одна огромная зона, не раскладываемая по сетке
+    ASSERT_TRUE(index.addZone("region", squareWkt(50.0, 30.0, 10.0)));
+    ASSERT_EQ(index.largeZones().size(), 1u);
+    
+    std::normal_distribution<double> step(0.0, 0.0003);
+    double lat = 55.75;
+    double lon = 37.60;
+    for (int i = 0; i < 5000; i++) {
+        lat += step(rng);
+        lon += step(rng);
+        auto point = createPoint(lat, lon, i * 1000ULL);
+        filter->process(point, *history);
+        
+        std::set<std::string> expected;
+        for (size_t z = 0; z < index.size(); z++) {
+            if (index.getZone(z).contains(lat, lon)) {
+                expected.insert(index.getZone(z).name);
+            }
+        }
+        auto current = filter->getCurrentZones();
+        ASSERT_EQ(std::set<std::string>(current.begin(), current.end()), expected) << "step " << i;
+    }
+    // Кэш должен экономить большую часть полных проверок
+    EXPECT_LT(filter->getEvaluationCount(), 5000u);
+}
+
+TEST_F(GeofenceFilterTest, Process_InvalidPoint_Ignored) {
+    ASSERT_TRUE(filter->getIndex().addZone("depot", squareWkt(55.750, 37.610, 0.002)));
+    auto point = createPoint(55.751, 37.611);
+    point.isValid = false;
+    EXPECT_EQ(filter->process(point, *history), FilterResult::PASS);
+    EXPECT_EQ(display.getEventCount(), 0);
+}
+
+TEST_F(GeofenceFilterTest, LoadZones_SkipsCommentsAndInvalidLines) {
+    const std::string path = "test_geofence_zones.wkt";
+    {
+        std::ofstream out(path);
+        out << "# зоны\n";
+        out << "depot;" << squareWkt(55.750, 37.610, 0.002) << "\n";
+        out << "\n";
+        out << "yard\t" << squareWkt(55.760, 37.620, 0.002) << "\n";
+        out << "broken;POLYGON ((1 2, 3 4))\n";
+    }
+    EXPECT_TRUE(filter->loadZones(path));
+    EXPECT_EQ(filter->getIndex().size(), 2u);
+    EXPECT_EQ(filter->getIndex().getSkippedLines(), 1u);
+    EXPECT_EQ(filter->getIndex().getZone(1).name, "yard");
+    std::remove(path.c_str());
+    
+    EXPECT_FALSE(filter->loadZones("missing_zones_file.wkt"));
+}
+
+TEST_F(GeofenceFilterTest, JsonConfig_StringParams_Loaded) {
+    const std::string path = "test_geofence_config.json";
+    {
+        std::ofstream out(path);
+        out << "{\n  \"historySize\": 5,\n  \"filters\": [\n"
+            << "    {\"type\": \"GeofenceFilter\", \"enabled\": true, \"priority\": 1,\n"
+            << "     \"params\": {\"zonesFile\": \"zones.wkt\", \"cellSize\": 0.02}}\n  ]\n}\n";
+    }
+    JsonConfig config;
+    ASSERT_TRUE(config.loadFromFile(path));
+    ASSERT_EQ(config.getFilters().size(), 1u);
+    const auto& fc = config.getFilters()[0];
+    EXPECT_EQ(fc.stringParams.at("zonesFile"), "zones.wkt");
+    EXPECT_DOUBLE_EQ(fc.params.at("cellSize"), 0.02);
+    EXPECT_EQ(fc.params.count("zonesFile"), 0u);
+    std::remove(path.c_str());
+}
+
+TEST_F(GeofenceFilterTest, Pipeline_ForwardsEventsToDisplay) {
+    auto mock = std::make_unique<MockDisplay>();
+    MockDisplay* mockPtr = mock.get();
+    GpsPipeline pipeline(std::move(mock));
+    
+    auto geofence = std::make_unique<GeofenceFilter>();
+    ASSERT_TRUE(geofence->getIndex().addZone("munich", squareWkt(48.11, 11.51, 0.02)));
+    pipeline.addFilter(std::move(geofence), 1);
+    
+    pipeline.process("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*3D");
+    pipeline.process("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4F");
+    
+    ASSERT_EQ(mockPtr->getEventCount(), 1);
+    EXPECT_EQ(mockPtr->getPointCount(), 2);
+}
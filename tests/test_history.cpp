@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "history.h"
 #include "gps_point.h"
+#include "gps_time.h"
 
 class HistoryTest : public ::testing::Test {
 protected:
@@ -93,4 +94,180 @@ TEST_F(HistoryTest, Clear_RemovesAllPoints) {
     
     EXPECT_TRUE(history->empty());
     EXPECT_EQ(history->size(), 0);
-}
\ No newline at end of file
+}
+
+TEST_F(HistoryTest, GetLastValidPtr_ReturnsMostRecentValidPoint) {
+    history->addPoint(createValidPoint(48.1173, 11.5167, 123519000));
+    history->addPoint(createValidPoint(48.1175, 11.5169, 123521000));
+    history->addPoint(createInvalidPoint(123522000));
+    
+    const GpsPoint* last = history->getLastValidPtr();
+    ASSERT_NE(last, nullptr);
+    EXPECT_EQ(last->timestamp, 123521000);
+}
+
+TEST_F(HistoryTest, GetLastValidPtr_ValidPointEvicted_ReturnsNull) {
+    history->addPoint(createValidPoint(48.1173, 11.5167, 123519000));
+    history->addPoint(createInvalidPoint(123520000));
+    history->addPoint(createInvalidPoint(123521000));
+    history->addPoint(createInvalidPoint(123522000));
+    
+    EXPECT_EQ(history->getLastValidPtr(), nullptr);
+    EXPECT_FALSE(history->getLastValid().has_value());
+}
+
+TEST_F(HistoryTest, GetLastValidPtr_AfterClearAndShrink_ReturnsNull) {
+    history->addPoint(createValidPoint(48.1173, 11.5167, 123519000));
+    history->clear();
+    EXPECT_EQ(history->getLastValidPtr(), nullptr);
+    
+    history->addPoint(createValidPoint(48.1173, 11.5167, 123519000));
+    history->addPoint(createInvalidPoint(123520000));
+    history->setMaxSize(1);
+    EXPECT_EQ(history->getLastValidPtr(), nullptr);
+}
+
+TEST_F(HistoryTest, GetStats_TracksAggregatesIncrementally) {
+    auto p1 = createValidPoint(48.0, 11.0, 1000);
+    p1.speed = 10.0;
+    p1.altitude = 500.0;
+    auto p2 = createValidPoint(48.001, 11.0, 2000);
+    p2.speed = 30.0;
+    p2.altitude = 520.0;
+    auto p3 = createValidPoint(48.002, 11.0, 3000);
+    p3.speed = 20.0;
+    p3.altitude = 490.0;
+    
+    history->addPoint(p1);
+    history->addPoint(p2);
+    history->addPoint(p3);
+    
+    const double segment = 0.001 * M_PI / 180.0 * 6371000.0;
+    HistoryStats stats = history->getStats();
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_NEAR(stats.distance, 2 * segment, 1e-3);
+    EXPECT_DOUBLE_EQ(stats.meanSpeed, 20.0);
+    EXPECT_DOUBLE_EQ(stats.maxSpeed, 30.0);
+    EXPECT_DOUBLE_EQ(stats.minAltitude, 490.0);
+    EXPECT_DOUBLE_EQ(stats.maxAltitude, 520.0);
+    
+    // Вытеснение p1 и p2: экстремумы и путь пересчитываются
+    auto p4 = createValidPoint(48.002, 11.0, 4000);
+    p4.speed = 5.0;
+    p4.altitude = 495.0;
+    history->addPoint(p4);
+    history->addPoint(p4);
+    
+    stats = history->getStats();
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_NEAR(stats.distance, 0.0, 1e-6);
+    EXPECT_DOUBLE_EQ(stats.maxSpeed, 20.0);
+    EXPECT_DOUBLE_EQ(stats.minAltitude, 490.0);
+    EXPECT_DOUBLE_EQ(stats.maxAltitude, 495.0);
+}
+
+TEST_F(HistoryTest, GetStats_EmptyHistory_ReturnsZeros) {
+    HistoryStats stats = history->getStats();
+    EXPECT_EQ(stats.count, 0);
+    EXPECT_DOUBLE_EQ(stats.distance, 0.0);
+    
+    history->addPoint(createInvalidPoint(1000));
+    EXPECT_EQ(history->getStats().count, 0);
+}
+
+TEST_F(HistoryTest, SetMaxDuration_EvictsOldPoints) {
+    history->setMaxSize(100);
+    history->setMaxDuration(2000);
+    
+    for (unsigned long long t = 0; t <= 10000; t += 1000) {
+        history->addPoint(createValidPoint(48.0, 11.0, t));
+    }
+    
+    // Окно 2 секунды: 8000, 9000, 10000
+    auto points = history->getAllPoints();
+    ASSERT_EQ(points.size(), 3);
+    EXPECT_EQ(points.front().timestamp, 8000);
+    EXPECT_EQ(history->getStats().count, 3);
+}
+
+TEST_F(HistoryTest, SetMaxDuration_HandlesMidnightRollover) {
+    history->setMaxSize(100);
+    history->setMaxDuration(2000);
+    
+    const unsigned long long day = 24ULL * 3600 * 1000;
+    history->addPoint(createValidPoint(48.0, 11.0, day - 3000));
+    history->addPoint(createValidPoint(48.0, 11.0, day - 1000));
+    history->addPoint(createValidPoint(48.0, 11.0, 500));
+    
+    auto points = history->getAllPoints();
+    ASSERT_EQ(points.size(), 2);
+    EXPECT_EQ(points.front().timestamp, day - 1000);
+}
+
+TEST_F(HistoryTest, GetStats_FirstCallRebuildsWindow) {
+    // До первого getStats агрегаты не ведутся, вытесненные точки не учитываются
+    for (int i = 0; i < 5; i++) {
+        auto p = createValidPoint(48.0 + i * 0.001, 11.0, 1000 + i * 1000);
+        p.speed = 10.0 * i;
+        history->addPoint(p);
+    }
+    
+    const double segment = 0.001 * M_PI / 180.0 * 6371000.0;
+    HistoryStats stats = history->getStats();
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_NEAR(stats.distance, 2 * segment, 1e-3);
+    EXPECT_DOUBLE_EQ(stats.meanSpeed, 30.0);
+    EXPECT_DOUBLE_EQ(stats.maxSpeed, 40.0);
+    
+    history->addPoint(createValidPoint(48.005, 11.0, 6000));
+    stats = history->getStats();
+    EXPECT_EQ(stats.count, 3);
+    EXPECT_NEAR(stats.distance, 2 * segment, 1e-3);
+    EXPECT_DOUBLE_EQ(stats.maxSpeed, 40.0);
+}
+
+TEST_F(HistoryTest, SetMaxDuration_WindowNotLimitedByMaxSize) {
+    history->setMaxDuration(10000);
+    for (unsigned long long t = 0; t <= 20000; t += 1000) {
+        history->addPoint(createValidPoint(48.0, 11.0, t));
+    }
+    
+    // Окно 10 секунд при maxSize 3: 10000..20000
+    EXPECT_EQ(history->size(), 11);
+    EXPECT_EQ(history->getMaxSize(), 3);
+    
+    history->setMaxDuration(0);
+    EXPECT_EQ(history->size(), 3);
+}
+
+TEST_F(HistoryTest, SetMaxDuration_LatePointIsNotDayOld) {
+    history->setMaxDuration(2000);
+    history->addPoint(createValidPoint(48.0, 11.0, 10000));
+    // Точка на полсекунды раньше предыдущей - не переход через полночь
+    history->addPoint(createValidPoint(48.0, 11.0, 9500));
+    
+    EXPECT_EQ(history->size(), 2);
+    EXPECT_EQ(gps_time::elapsedMs(10000, 9500), 0u);
+    EXPECT_EQ(gps_time::elapsedMs(gps_time::MS_PER_DAY - 1000, 500), 1500u);
+}
+
+TEST(TrackClockTest, OutOfOrderPoints_DoNotGoBackwards) {
+    const long long day = static_cast<long long>(gps_time::MS_PER_DAY);
+    gps_time::TrackClock clock;
+    
+    EXPECT_EQ(clock.toMonotonic(day - 2000), day - 2000);
+    EXPECT_EQ(clock.toMonotonic(1000), day + 1000);
+    // Запоздавшая точка до полуночи не уменьшает время
+    EXPECT_EQ(clock.toMonotonic(day - 1000), day + 1000);
+    EXPECT_EQ(clock.toMonotonic(2000), day + 2000);
+    
+    // То же для точек с датой: меньшая дата не откатывает время назад
+    const long long date = 20000 * day;
+    EXPECT_EQ(clock.toMonotonic(5000, date), date + 5000);
+    EXPECT_EQ(clock.toMonotonic(3000, date), date + 5000);
+    EXPECT_EQ(clock.toMonotonic(9000, date - day), date + 5000);
+    EXPECT_EQ(clock.toMonotonic(6000, date), date + 6000);
+    
+    clock.reset();
+    EXPECT_EQ(clock.toMonotonic(3000), 3000);
+}
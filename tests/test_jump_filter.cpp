@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "jump_filter.h"
 #include "history.h"
+#include <cmath>
+#include <random>
 
 class JumpFilterTest : public ::testing::Test {
 protected:
@@ -84,4 +86,99 @@ TEST_F(JumpFilterTest, GetMaxJump_ReturnsCorrectValue) {
 
 TEST_F(JumpFilterTest, GetName_ReturnsCorrectName) {
     EXPECT_EQ(filter->getName(), "JumpFilter");
-}
\ No newline at end of file
+}
+
+namespace {
+    // Исходная реализация JumpFilter::calculateDistance - эталон для сравнения решений
+    double referenceDistance(const GpsPoint& p1, const GpsPoint& p2) {
+        const double R = 6371000;
+        double lat1 = p1.latitude * M_PI / 180.0;
+        double lat2 = p2.latitude * M_PI / 180.0;
+        double lon1 = p1.longitude * M_PI / 180.0;
+        double lon2 = p2.longitude * M_PI / 180.0;
+        double dlat = lat2 - lat1;
+        double dlon = lon2 - lon1;
+        double a = std::sin(dlat/2) * std::sin(dlat/2) +
+                   std::cos(lat1) * std::cos(lat2) *
+                   std::sin(dlon/2) * std::sin(dlon/2);
+        double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
+        return R * c;
+    }
+}
+
+TEST_F(JumpFilterTest, Process_RandomizedCorpus_MatchesHaversineDecision) {
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> latDist(-90.0, 90.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> thresholdDist(5.0, 500.0);
+    
+    int mismatches = 0;
+    for (int i = 0; i < 200000; i++) {
+        auto ref = createPoint(latDist(rng), lonDist(rng));
+        // Часть опорных точек - у полюсов и у линии перемены дат
+        if (i % 50 == 0) ref.latitude = (i % 100 == 0 ? 1.0 : -1.0) * (89.9 + 0.1 * unit(rng));
+        if (i % 70 == 0) ref.longitude = 179.9999;
+        
+        double threshold = thresholdDist(rng);
+        filter->setMaxJump(threshold);
+        
+        // Смещение вокруг порога: от 0 до 2 порогов, со случайным направлением
+        double distance = threshold * 2.0 * unit(rng);
+        double bearing = 2.0 * M_PI * unit(rng);
+        double dLat = distance * std::cos(bearing) / 111195.0;
+        double cosLat = std::max(std::cos(ref.latitude * M_PI / 180.0), 1e-6);
+        double dLon = distance * std::sin(bearing) / (111195.0 * cosLat);
+        auto point = createPoint(std::max(-90.0, std::min(90.0, ref.latitude + dLat)),
+                                 ref.longitude + dLon);
+        if (point.longitude > 180.0) point.longitude -= 360.0;
+        
+        // Порог точно на расстоянии - проверяем полосу неопределенности
+        if (i % 10 == 0) {
+            double exact = referenceDistance(ref, point);
+            threshold = (i % 20 == 0) ? exact : std::nextafter(exact, 0.0);
+            filter->setMaxJump(threshold);
+        }
+        
+        history->clear();
+        history->addPoint(ref);
+        auto expected = referenceDistance(ref, point) > threshold
+            ? FilterResult::REJECT : FilterResult::PASS;
+        if (filter->process(point, *history) != expected) {
+            mismatches++;
+        }
+    }
+    EXPECT_EQ(mismatches, 0);
+}
+
+TEST_F(JumpFilterTest, Process_FarPoints_MatchesHaversineDecision) {
+    std::mt19937_64 rng(777);
+    std::uniform_real_distribution<double> latDist(-90.0, 90.0);
+    std::uniform_real_distribution<double> lonDist(-180.0, 180.0);
+    
+    for (int i = 0; i < 10000; i++) {
+        auto ref = createPoint(latDist(rng), lonDist(rng));
+        auto point = createPoint(latDist(rng), lonDist(rng));
+        double threshold = referenceDistance(ref, point) * (i % 2 == 0 ? 0.999 : 1.001);
+        filter->setMaxJump(threshold);
+        
+        history->clear();
+        history->addPoint(ref);
+        auto expected = referenceDistance(ref, point) > threshold
+            ? FilterResult::REJECT : FilterResult::PASS;
+        EXPECT_EQ(filter->process(point, *history), expected);
+    }
+}
+
+TEST_F(JumpFilterTest, Process_ReferenceUpdatesWithHistory) {
+    history->addPoint(createPoint(48.1173, 11.5167));
+    auto near = createPoint(48.1174, 11.5168);
+    EXPECT_EQ(filter->process(near, *history), FilterResult::PASS);
+    
+    // Новая последняя валидная точка далеко от прежней
+    history->addPoint(createPoint(55.75, 37.61));
+    auto first = createPoint(48.1174, 11.5168);
+    EXPECT_EQ(filter->process(first, *history), FilterResult::REJECT);
+    auto second = createPoint(55.7501, 37.6101);
+    EXPECT_EQ(filter->process(second, *history), FilterResult::PASS);
+}
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include "kalman_filter.h"
+#include "history.h"
+#include <cmath>
+
+class KalmanFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        filter = std::make_unique<KalmanFilter>(5.0, 1.0);
+        history = std::make_unique<GpsHistory>();
+    }
+    
+    GpsPoint createPoint(double lat, double lon, unsigned long long timestamp,
+                         float hdop = 1.0f, int satellites = 8, bool valid = true) {
+        GpsPoint p;
+        p.latitude = lat;
+        p.longitude = lon;
+        p.timestamp = timestamp;
+        p.hdop = hdop;
+        p.satellites = satellites;
+        p.isValid = valid;
+        return p;
+    }
+    
+    // Смещение в метрах на север в градусах широты
+    static double northDegrees(double meters) {
+        return meters / 111194.93;
+    }
+    
+    std::unique_ptr<KalmanFilter> filter;
+    std::unique_ptr<GpsHistory> history;
+};
+
+TEST_F(KalmanFilterTest, Process_FirstPoint_PassesUnchanged) {
+    auto point = createPoint(55.75, 37.61, 1000);
+    EXPECT_EQ(filter->process(point, *history), FilterResult::PASS);
+    EXPECT_DOUBLE_EQ(point.latitude, 55.75);
+    EXPECT_DOUBLE_EQ(point.longitude, 37.61);
+}
+
+TEST_F(KalmanFilterTest, Process_InvalidPoint_ReturnsReject) {
+    auto point = createPoint(55.75, 37.61, 1000, 1.0f, 8, false);
+    EXPECT_EQ(filter->process(point, *history), FilterResult::REJECT);
+}
+
+TEST_F(KalmanFilterTest, Process_Disabled_ReturnsPassWithoutChanges) {
+    filter->setEnabled(false);
+    auto first = createPoint(55.75, 37.61, 1000);
+    filter->process(first, *history);
+    auto point = createPoint(55.76, 37.61, 2000);
+    EXPECT_EQ(filter->process(point, *history), FilterResult::PASS);
+    EXPECT_DOUBLE_EQ(point.latitude, 55.76);
+}
+
+TEST_F(KalmanFilterTest, Process_NoisyStaticPoint_ReducesError) {
+    // Неподвижный приемник с детерминированным шумом +-10 м
+    double sumRaw = 0.0;
+    double sumFiltered = 0.0;
+    for (int i = 0; i < 60; i++) {
+        double noise = (i % 2 == 0 ? 10.0 : -10.0);
+        auto point = createPoint(55.75 + northDegrees(noise), 37.61, 1000 + i * 1000);
+        filter->process(point, *history);
+        if (i >= 10) {
+            sumRaw += std::fabs(noise);
+            sumFiltered += std::fabs(point.latitude - 55.75) * 111194.93;
+        }
+    }
+    EXPECT_LT(sumFiltered, sumRaw * 0.5);
+}
+
+TEST_F(KalmanFilterTest, Process_ConstantVelocity_TracksWithoutLag) {
+    // Движение на север 10 м/с: модель постоянной скорости не отстает
+    GpsPoint point;
+    for (int i = 0; i < 60; i++) {
+        point = createPoint(55.75 + northDegrees(10.0 * i), 37.61, 1000 + i * 1000);
+        filter->process(point, *history);
+    }
+    double expected = 55.75 + northDegrees(590.0);
+    EXPECT_NEAR(point.latitude, expected, northDegrees(0.5));
+}
+
+TEST_F(KalmanFilterTest, Process_HighHdop_HasLessWeight) {
+    KalmanFilter goodFix(5.0, 1.0);
+    KalmanFilter badFix(5.0, 1.0);
+    for (int i = 0; i < 10; i++) {
+        auto a = createPoint(55.75, 37.61, 1000 + i * 1000);
+        auto b = a;
+        goodFix.process(a, *history);
+        badFix.process(b, *history);
+    }
+    // Одинаковый выброс на 50 м, но с разным HDOP
+    auto good = createPoint(55.75 + northDegrees(50.0), 37.61, 11000, 1.0f);
+    auto bad = createPoint(55.75 + northDegrees(50.0), 37.61, 11000, 10.0f);
+    goodFix.process(good, *history);
+    badFix.process(bad, *history);
+    EXPECT_LT(bad.latitude - 55.75, good.latitude - 55.75);
+}
+
+TEST_F(KalmanFilterTest, Process_FewSatellites_HasLessWeight) {
+    KalmanFilter manySats(5.0, 1.0);
+    KalmanFilter fewSats(5.0, 1.0);
+    for (int i = 0; i < 10; i++) {
+        auto a = createPoint(55.75, 37.61, 1000 + i * 1000);
+        auto b = a;
+        manySats.process(a, *history);
+        fewSats.process(b, *history);
+    }
+    auto many = createPoint(55.75 + northDegrees(50.0), 37.61, 11000, 1.0f, 10);
+    auto few = createPoint(55.75 + northDegrees(50.0), 37.61, 11000, 1.0f, 4);
+    manySats.process(many, *history);
+    fewSats.process(few, *history);
+    EXPECT_LT(few.latitude - 55.75, many.latitude - 55.75);
+}
+
+TEST_F(KalmanFilterTest, Process_GateEnabled_RejectsOutlier) {
+    filter->setGateSigma(3.0);
+    for (int i = 0; i < 10; i++) {
+        auto point = createPoint(55.75, 37.61, 1000 + i * 1000);
+        EXPECT_EQ(filter->process(point, *history), FilterResult::PASS);
+    }
+    auto outlier = createPoint(55.75 + northDegrees(500.0), 37.61, 11000);
+    EXPECT_EQ(filter->process(outlier, *history), FilterResult::REJECT);
+    
+    auto next = createPoint(55.75, 37.61, 12000);
+    EXPECT_EQ(filter->process(next, *history), FilterResult::PASS);
+}
+
+TEST_F(KalmanFilterTest, Process_GateEnabled_ReinitializesAfterRepeatedRejects) {
+    filter->setGateSigma(3.0);
+    for (int i = 0; i < 10; i++) {
+        auto point = createPoint(55.75, 37.61, 1000 + i * 1000);
+        filter->process(point, *history);
+    }
+    // Приемник действительно переместился: после нескольких отказов фильтр перезапускается
+    double moved = 55.75 + northDegrees(2000.0);
+    auto a = createPoint(moved, 37.61, 11000);
+    auto b = createPoint(moved, 37.61, 12000);
+    auto c = createPoint(moved, 37.61, 13000);
+    EXPECT_EQ(filter->process(a, *history), FilterResult::REJECT);
+    EXPECT_EQ(filter->process(b, *history), FilterResult::REJECT);
+    EXPECT_EQ(filter->process(c, *history), FilterResult::PASS);
+    EXPECT_DOUBLE_EQ(c.latitude, moved);
+}
+
+TEST_F(KalmanFilterTest, Process_LargeGap_Reinitializes) {
+    filter->setMaxGap(10.0);
+    for (int i = 0; i < 10; i++) {
+        auto point = createPoint(55.75, 37.61, 1000 + i * 1000);
+        filter->process(point, *history);
+    }
+    auto point = createPoint(55.80, 37.70, 60000);
+    EXPECT_EQ(filter->process(point, *history), FilterResult::PASS);
+    EXPECT_DOUBLE_EQ(point.latitude, 55.80);
+    EXPECT_DOUBLE_EQ(point.longitude, 37.70);
+}
+
+TEST_F(KalmanFilterTest, Process_MidnightWrap_KeepsTracking) {
+    const unsigned long long day = 24ULL * 3600 * 1000;
+    GpsPoint point;
+    for (int i = 0; i < 20; i++) {
+        unsigned long long t = (day - 10000 + i * 1000) % day;
+        point = createPoint(55.75 + northDegrees(10.0 * i), 37.61, t);
+        filter->process(point, *history);
+    }
+    EXPECT_NEAR(point.latitude, 55.75 + northDegrees(190.0), northDegrees(1.0));
+}
+
+TEST_F(KalmanFilterTest, Process_LongTrack_ReanchorsWithoutDrift) {
+    // 20 км на восток со скоростью 20 м/с: несколько переносов начала координат
+    double metersPerDegLon = 111194.93 * std::cos(55.75 * M_PI / 180.0);
+    GpsPoint point;
+    for (int i = 0; i <= 1000; i++) {
+        point = createPoint(55.75, 37.61 + 20.0 * i / metersPerDegLon, 1000 + i * 1000);
+        filter->process(point, *history);
+    }
+    EXPECT_NEAR(point.longitude, 37.61 + 20000.0 / metersPerDegLon, 1.0 / metersPerDegLon);
+    EXPECT_NEAR(point.latitude, 55.75, northDegrees(1.0));
+}
+
+TEST_F(KalmanFilterTest, Process_CrossesAntimeridian) {
+    // 1 км на восток через 180-й меридиан по 10 м/с
+    double metersPerDegLon = 111194.93 * std::cos(60.0 * M_PI / 180.0);
+    GpsPoint point;
+    for (int i = 0; i <= 100; i++) {
+        double lon = 179.995 + 10.0 * i / metersPerDegLon;
+        if (lon >= 180.0) lon -= 360.0;
+        point = createPoint(60.0, lon, 1000 + i * 1000);
+        EXPECT_EQ(filter->process(point, *history), FilterResult::PASS) << i;
+        // Оценка не уходит на другую сторону Земли в момент пересечения
+        double error = std::remainder(point.longitude - lon, 360.0) * metersPerDegLon;
+        EXPECT_LT(std::fabs(error), 10.0) << i;
+    }
+    double expected = 179.995 + 1000.0 / metersPerDegLon - 360.0;
+    EXPECT_NEAR(point.longitude, expected, 1.0 / metersPerDegLon);
+}
+
+TEST_F(KalmanFilterTest, Reset_StartsFromNextPoint) {
+    auto first = createPoint(55.75, 37.61, 1000);
+    filter->process(first, *history);
+    filter->reset();
+    auto point = createPoint(10.0, 20.0, 2000);
+    filter->process(point, *history);
+    EXPECT_DOUBLE_EQ(point.latitude, 10.0);
+    EXPECT_DOUBLE_EQ(point.longitude, 20.0);
+}
+
+TEST_F(KalmanFilterTest, Setters_UpdateParameters) {
+    filter->setMeasurementNoise(3.0);
+    filter->setProcessNoise(0.5);
+    filter->setGateSigma(4.0);
+    filter->setMaxGap(30.0);
+    EXPECT_DOUBLE_EQ(filter->getMeasurementNoise(), 3.0);
+    EXPECT_DOUBLE_EQ(filter->getProcessNoise(), 0.5);
+    EXPECT_DOUBLE_EQ(filter->getGateSigma(), 4.0);
+    EXPECT_DOUBLE_EQ(filter->getMaxGap(), 30.0);
+    EXPECT_EQ(filter->getName(), "KalmanFilter");
+}
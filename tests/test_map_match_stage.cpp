@@ -0,0 +1,303 @@
+#include <gtest/gtest.h>
+#include "map_match_stage.h"
+#include "mock_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace {
+    const double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+    const double BASE_LAT = 55.75;
+    const double BASE_LON = 37.60;
+    const double LON_SCALE = std::cos(BASE_LAT * M_PI / 180.0);
+    
+    double toLat(double northMeters) { return BASE_LAT + northMeters / METERS_PER_DEG; }
+    double toLon(double eastMeters) { return BASE_LON + eastMeters / (METERS_PER_DEG * LON_SCALE); }
+    double toNorth(double lat) { return (lat - BASE_LAT) * METERS_PER_DEG; }
+    
+    // Сетка size x size узлов с шагом step метров: улицы с запада на восток
+    // называются "Street <ряд>", с юга на север - "Avenue <столбец>"
+    void buildGrid(RoadGraph& graph, int size, double step) {
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                graph.addNode(toLat(row * step), toLon(col * step));
+            }
+        }
+        for (int row = 0; row < size; row++) {
+            for (int col = 0; col < size; col++) {
+                std::uint32_t node = row * size + col;
+                if (col + 1 < size) graph.addEdge(node, node + 1, "Street " + std::to_string(row));
+                if (row + 1 < size) graph.addEdge(node, node + size, "Avenue " + std::to_string(col));
+            }
+        }
+        graph.build();
+    }
+}
+
+TEST(RoadGraphTest, RouteCache_GridDistances) {
+    RoadGraph graph;
+    buildGrid(graph, 5, 100.0);
+    EXPECT_EQ(graph.nodeCount(), 25u);
+    EXPECT_EQ(graph.edgeCount(), 40u);
+    
+    RouteCache routes(graph, 1000.0, 4);
+    // Манхэттенское расстояние по сетке
+    EXPECT_NEAR(routes.distance(0, 24), 800.0, 1.0);
+    EXPECT_NEAR(routes.distance(0, 6), 200.0, 0.5);
+    EXPECT_DOUBLE_EQ(routes.distance(7, 7), 0.0);
+    EXPECT_EQ(routes.getMissCount(), 1u);
+    EXPECT_EQ(routes.getHitCount(), 1u);
+    
+    RouteCache limited(graph, 250.0, 4);
+    EXPECT_TRUE(std::isinf(limited.distance(0, 24)));
+    EXPECT_NEAR(limited.distance(0, 2), 200.0, 0.5);
+}
+
+TEST(RoadGraphTest, RouteCache_CapacityBounded) {
+    RoadGraph graph;
+    buildGrid(graph, 5, 100.0);
+    RouteCache routes(graph, 1000.0, 3);
+    for (std::uint32_t node = 0; node < 25; node++) {
+        routes.distance(node, 12);
+        EXPECT_LE(routes.size(), 3u);
+    }
+    // Последний источник остается в кеше
+    routes.distance(24, 0);
+    EXPECT_EQ(routes.getHitCount(), 1u);
+}
+
+TEST(RoadGraphTest, Candidates_SortedAndDeduplicated) {
+    RoadGraph graph(0.0005);
+    buildGrid(graph, 3, 100.0);
+    std::vector<RoadIndex::Match> out;
+    // Точка у перекрестка (100, 100) немного к северо-востоку
+    size_t found = graph.getIndex().candidates(toLat(110.0), toLon(105.0), 30.0, 10, out);
+    ASSERT_EQ(found, 4u);
+    for (size_t i = 1; i < out.size(); i++) {
+        EXPECT_LE(out[i - 1].distance, out[i].distance);
+        EXPECT_NE(out[i - 1].segment, out[i].segment);
+    }
+    EXPECT_NEAR(out[0].distance, 5.0, 0.01);
+    EXPECT_EQ(graph.getIndex().candidates(toLat(110.0), toLon(105.0), 30.0, 2, out), 2u);
+}
+
+TEST(RoadGraphTest, LoadFromFile_SkipsBadLines) {
+    const std::string path = "test_road_graph.txt";
+    {
+        std::ofstream file(path);
+        file << "# test graph\n"
+             << "N;10;55.75;37.60\n"
+             << "N;20;55.75;37.61\n"
+             << "N;30;55.76;37.61\n"
+             << "N;40;55.77;37.62 \t\n"
+             << "E;10;20;Tverskaya\n"
+             << "E;20;30;Arbat\r\n"
+             << "E;20;99;Missing node\n"
+             << "N;10;55.0;37.0\n"
+             << "X;garbage\n";
+    }
+    RoadGraph graph;
+    ASSERT_TRUE(graph.loadFromFile(path));
+    // Пробелы после числа допускаются, как в файле сегментов RoadIndex
+    EXPECT_EQ(graph.nodeCount(), 4u);
+    EXPECT_EQ(graph.edgeCount(), 2u);
+    EXPECT_EQ(graph.getSkippedLines(), 3u);
+    EXPECT_STREQ(graph.getEdgeName(1), "Arbat");
+    EXPECT_EQ(graph.arcsEnd(1) - graph.arcsBegin(1), 2);
+    EXPECT_FALSE(graph.loadFromFile("missing_graph.txt"));
+    std::remove(path.c_str());
+}
+
+class MapMatchStageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto mock = std::make_unique<MockDisplay>();
+        display = mock.get();
+        stage = std::make_unique<MapMatchStage>(std::move(mock), 10.0, 50.0, 3);
+        buildGrid(stage->getGraph(), 6, 200.0);
+    }
+    
+    GpsPoint createPoint(double eastMeters, double northMeters, unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = toLat(northMeters);
+        p.longitude = toLon(eastMeters);
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    std::vector<GpsPoint> outputPoints() const {
+        std::vector<GpsPoint> points;
+        for (const auto& call : display->getCalls()) {
+            if (call.type == DisplayCall::Type::POINT) {
+                points.push_back(call.point);
+            }
+        }
+        return points;
+    }
+    
+    MockDisplay* display = nullptr;
+    std::unique_ptr<MapMatchStage> stage;
+};
+
+TEST_F(MapMatchStageTest, NoisyStraightDrive_SnapsToStreet) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 6.0);
+    for (int i = 0; i < 90; i++) {
+        // Едем по Street 1 (север 200 м) на восток, 10 м между точками
+        stage->showPoint(createPoint(20.0 + i * 10.0, 200.0 + noise(rng), i * 1000ULL));
+    }
+    EXPECT_EQ(outputPoints().size(), 87u);   // lag = 3
+    stage->flush();
+    
+    auto out = outputPoints();
+    ASSERT_EQ(out.size(), 90u);
+    for (size_t i = 0; i < out.size(); i++) {
+        const double east = 20.0 + i * 10.0;
+        const double dx = (out[i].longitude - BASE_LON) * METERS_PER_DEG * LON_SCALE - east;
+        const double dy = toNorth(out[i].latitude) - 200.0;
+        // У перекрестка точка может лечь на поперечную улицу, но рядом с истинной позицией
+        EXPECT_LT(std::hypot(dx, dy), 20.0) << "point " << i;
+        ASSERT_NE(out[i].label, nullptr);
+        if (std::fabs(std::remainder(east, 200.0)) > 30.0) {
+            EXPECT_STREQ(out[i].label, "Street 1") << "point " << i;
+            EXPECT_NEAR(dy, 0.0, 0.01) << "point " << i;
+        }
+        EXPECT_EQ(out[i].timestamp, i * 1000ULL);
+    }
+    EXPECT_EQ(stage->getMatchedCount(), 90u);
+}
+
+TEST_F(MapMatchStageTest, OutlierTowardsParallelStreet_StaysOnPath) {
+    // Две параллельные улицы в 60 м, связанные только на концах
+    RoadGraph& graph = stage->getGraph();
+    graph.clear();
+    auto a0 = graph.addNode(toLat(0.0), toLon(0.0));
+    auto a1 = graph.addNode(toLat(0.0), toLon(1000.0));
+    auto b0 = graph.addNode(toLat(60.0), toLon(0.0));
+    auto b1 = graph.addNode(toLat(60.0), toLon(1000.0));
+    graph.addEdge(a0, a1, "Main");
+    graph.addEdge(b0, b1, "Side");
+    graph.addEdge(a0, b0, "Link");
+    graph.addEdge(a1, b1, "Link");
+    graph.build();
+    
+    // Одна точка ближе к Side, но путь туда и обратно через концы намного длиннее прямой
+    for (int i = 0; i < 30; i++) {
+        double north = (i == 15) ? 40.0 : 2.0;
+        stage->showPoint(createPoint(300.0 + i * 10.0, north, i * 1000ULL));
+    }
+    stage->flush();
+    
+    auto out = outputPoints();
+    ASSERT_EQ(out.size(), 30u);
+    for (const auto& p : out) {
+        EXPECT_STREQ(p.label, "Main");
+        EXPECT_NEAR(toNorth(p.latitude), 0.0, 0.01);
+    }
+}
+
+TEST_F(MapMatchStageTest, TurnAtIntersection_FollowsRoute) {
+    // По Street 0 на восток до перекрестка (400, 0), затем по Avenue 2 на север
+    int t = 0;
+    for (double x = 300.0; x <= 400.0; x += 10.0) {
+        stage->showPoint(createPoint(x, 4.0, t * 1000ULL));
+        t++;
+    }
+    for (double y = 10.0; y <= 150.0; y += 10.0) {
+        stage->showPoint(createPoint(396.0, y, t * 1000ULL));
+        t++;
+    }
+    stage->flush();
+    
+    auto out = outputPoints();
+    ASSERT_EQ(out.size(), static_cast<size_t>(t));
+    EXPECT_STREQ(out.front().label, "Street 0");
+    EXPECT_STREQ(out.back().label, "Avenue 2");
+    EXPECT_EQ(stage->getBreakCount(), 0u);
+}
+
+TEST_F(MapMatchStageTest, OffNetwork_PassesUnchanged) {
+    stage->showPoint(createPoint(100.0, 100.0, 0));   // в центре квартала, 100 м до улиц
+    auto out = outputPoints();
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_NEAR(toNorth(out[0].latitude), 100.0, 1e-6);
+    EXPECT_EQ(out[0].label, nullptr);
+    EXPECT_EQ(stage->getUnmatchedCount(), 1u);
+}
+
+TEST_F(MapMatchStageTest, Teleport_BreaksAndEmitsWindow) {
+    stage->setRouteCache(300.0, 16);
+    stage->showPoint(createPoint(10.0, 0.0, 0));
+    stage->showPoint(createPoint(20.0, 0.0, 1000));
+    // Дальше, чем routeLimit по графу
+    stage->showPoint(createPoint(990.0, 1000.0, 2000));
+    EXPECT_EQ(stage->getBreakCount(), 1u);
+    EXPECT_EQ(outputPoints().size(), 2u);
+    stage->flush();
+    EXPECT_EQ(outputPoints().size(), 3u);
+}
+
+TEST_F(MapMatchStageTest, InvalidFixAndEvent_FlushPendingFirst) {
+    stage->showPoint(createPoint(10.0, 0.0, 0));
+    stage->showPoint(createPoint(20.0, 0.0, 1000));
+    stage->showInvalidFix(2000);
+    
+    const auto& calls = display->getCalls();
+    ASSERT_EQ(calls.size(), 3u);
+    EXPECT_EQ(calls[0].type, DisplayCall::Type::POINT);
+    EXPECT_EQ(calls[1].type, DisplayCall::Type::POINT);
+    EXPECT_EQ(calls[2].type, DisplayCall::Type::INVALID_FIX);
+    
+    stage->showPoint(createPoint(30.0, 0.0, 3000));
+    GpsEvent event;
+    stage->showEvent(event);
+    EXPECT_EQ(display->getCalls().back().type, DisplayCall::Type::EVENT);
+    EXPECT_EQ(display->getPointCount(), 3);
+}
+
+TEST_F(MapMatchStageTest, LongDrive_RouteCacheBounded) {
+    stage->setRouteCache(1000.0, 8);
+    int t = 0;
+    for (int lap = 0; lap < 3; lap++) {
+        for (double x = 0.0; x <= 1000.0; x += 15.0) {
+            stage->showPoint(createPoint(x, 400.0 + (t % 3) - 1.0, t * 1000ULL));
+            t++;
+        }
+    }
+    stage->flush();
+    EXPECT_LE(stage->getRouteCache().size(), 8u);
+    EXPECT_EQ(stage->getMatchedCount(), static_cast<size_t>(t));
+}
+
+TEST(MapMatchStageConfigTest, JsonConfig_LoadsGraph) {
+    const std::string path = "test_map_match_graph.txt";
+    {
+        std::ofstream file(path);
+        file << "N;1;55.75;37.60\nN;2;55.75;37.61\nE;1;2;Tverskaya\n";
+    }
+    
+    JsonConfig config;
+    config.setDisplayType("console");
+    StageConfig match;
+    match.type = "MapMatchStage";
+    match.params["lag"] = 2;
+    match.params["sigma"] = 5.0;
+    match.params["searchRadius"] = 40.0;
+    match.params["cacheSize"] = 32;
+    match.stringParams["graphFile"] = path;
+    config.addOutputStage(match);
+    
+    GpsPipeline pipeline(config);
+    auto* stage = dynamic_cast<MapMatchStage*>(pipeline.getDisplay());
+    ASSERT_NE(stage, nullptr);
+    EXPECT_EQ(stage->getLag(), 2u);
+    EXPECT_DOUBLE_EQ(stage->getSigma(), 5.0);
+    EXPECT_DOUBLE_EQ(stage->getSearchRadius(), 40.0);
+    EXPECT_EQ(stage->getGraph().edgeCount(), 1u);
+    std::remove(path.c_str());
+}
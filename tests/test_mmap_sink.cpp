@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "mmap_sink.h"
+#include "file_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <csignal>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+class MmapSinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_mmap_sink_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "out.log").string();
+        segment = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    static std::string readFile(const std::string& name) {
+        std::ifstream file(name, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+    
+    static std::string record(size_t i) {
+        return "record " + std::to_string(i) + " " + std::string(i % 50, 'x') + "\n";
+    }
+    
+    // Отложенные при ротации файлы в порядке имен
+    std::vector<std::string> rotatedFiles() const {
+        std::vector<std::string> files;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("out.log.", 0) == 0) {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+    
+    static GpsPoint createPoint(unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75;
+        p.longitude = 37.61;
+        p.speed = 42.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    fs::path dir;
+    std::string path;
+    size_t segment = 4096;
+};
+
+TEST_F(MmapSinkTest, FileIsPreallocatedAndTrimmedOnClose) {
+    {
+        MmapSink sink(path, true, segment);
+        ASSERT_TRUE(sink.isOpen());
+        sink.append("first\n");
+        // Файл расширен до сегмента, данные видны сразу, хвост - нули
+        EXPECT_EQ(fs::file_size(path), segment);
+        std::string text = readFile(path);
+        EXPECT_EQ(text.substr(0, 6), "first\n");
+        EXPECT_EQ(text.find_first_not_of('\0', 6), std::string::npos);
+    }
+    EXPECT_EQ(readFile(path), "first\n");
+    EXPECT_FALSE(fs::exists(MmapSink::nextSegmentName(path)));
+}
+
+TEST_F(MmapSinkTest, RollsToPreparedSegments) {
+    std::vector<std::string> reported;
+    std::string expected;
+    {
+        MmapSink sink(path, true, segment);
+        sink.setRotationCallback([&](const std::string& name) {
+            reported.push_back(name);
+        });
+        for (size_t i = 0; i < 1000; i++) {
+            std::string line = record(i);
+            expected += line;
+            sink.append(line);
+        }
+        sink.flush();
+        EXPECT_GT(sink.getRotationCount(), 5u);
+        EXPECT_EQ(reported.size(), sink.getRotationCount());
+        EXPECT_EQ(sink.getBytesWritten(), expected.size());
+    }
+    
+    ASSERT_EQ(rotatedFiles().size(), reported.size());
+    // Порядок ротаций - порядок вызовов; имена в одну миллисекунду различаются суффиксом
+    std::string all;
+    for (const auto& name : reported) {
+        // Сегмент не больше заданного размера и без нулевого хвоста
+        EXPECT_LE(fs::file_size(name), segment);
+        all += readFile(name);
+    }
+    all += readFile(path);
+    EXPECT_EQ(all, expected);
+}
+
+TEST_F(MmapSinkTest, GrowsWithoutRotation) {
+    std::string expected;
+    {
+        MmapSink sink(path, false, segment);
+        for (size_t i = 0; i < 1000; i++) {
+            std::string line = record(i);
+            expected += line;
+            sink.append(line);
+        }
+        EXPECT_EQ(sink.getRotationCount(), 0u);
+    }
+    EXPECT_TRUE(rotatedFiles().empty());
+    EXPECT_EQ(readFile(path), expected);
+}
+
+TEST_F(MmapSinkTest, FailedGrowthCountsDroppedRecords) {
+    // Лимит размера файла в две страницы: третья не выделяется
+    struct rlimit saved;
+    ASSERT_EQ(::getrlimit(RLIMIT_FSIZE, &saved), 0);
+    struct rlimit limited = saved;
+    limited.rlim_cur = segment * 2;
+    auto previous = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(::setrlimit(RLIMIT_FSIZE, &limited), 0);
+    
+    std::string kept;
+    size_t dropped = 0;
+    {
+        MmapSink sink(path, false, segment);
+        const std::string line(segment / 4, 'x');
+        for (size_t i = 0; i < 12; i++) {
+            sink.append(line + "\n");
+        }
+        dropped = sink.getDroppedCount();
+        EXPECT_EQ(sink.getBytesWritten() + dropped * (line.size() + 1), 12 * (line.size() + 1));
+    }
+    ::setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, previous);
+    
+    EXPECT_GT(dropped, 0u);
+    EXPECT_LE(fs::file_size(path), segment * 2);
+}
+
+TEST_F(MmapSinkTest, RecordLargerThanSegment) {
+    std::string big(segment * 3 + 17, 'b');
+    {
+        MmapSink sink(path, true, segment);
+        sink.append("head\n");
+        sink.append(big);
+        sink.append("tail\n");
+    }
+    std::string all;
+    for (const auto& name : rotatedFiles()) {
+        all += readFile(name);
+    }
+    all += readFile(path);
+    EXPECT_EQ(all, "head\n" + big + "tail\n");
+}
+
+TEST_F(MmapSinkTest, RecoversPreallocatedFileAfterCrash) {
+    {
+        // Файл после аварийного завершения: данные и нулевой хвост
+        std::ofstream file(path, std::ios::binary);
+        file << "before\n" << std::string(segment - 7, '\0');
+    }
+    {
+        MmapSink sink(path, true, segment);
+        sink.append("after\n");
+    }
+    EXPECT_EQ(readFile(path), "before\nafter\n");
+}
+
+TEST_F(MmapSinkTest, StaleNextSegmentIsKept) {
+    {
+        std::ofstream file(MmapSink::nextSegmentName(path), std::ios::binary);
+        file << "orphan\n" << std::string(100, '\0');
+    }
+    {
+        MmapSink sink(path, true, segment);
+    }
+    auto files = rotatedFiles();
+    ASSERT_EQ(files.size(), 1u);
+    EXPECT_EQ(readFile(files[0]), "orphan\n");
+}
+
+TEST_F(MmapSinkTest, TruncateClearsData) {
+    {
+        MmapSink sink(path, true, segment);
+        sink.append("one\n");
+        sink.truncate();
+        sink.append("two\n");
+    }
+    EXPECT_EQ(readFile(path), "two\n");
+}
+
+TEST_F(MmapSinkTest, FileDisplayMatchesBlockingOutput) {
+    const std::string plainPath = (dir / "plain.log").string();
+    {
+        FileDisplay plain(plainPath);
+        FileDisplay mapped(path);
+        ASSERT_TRUE(mapped.enableMmap());
+        ASSERT_NE(mapped.getMmapSink(), nullptr);
+        for (FileDisplay* display : {&plain, &mapped}) {
+            for (unsigned long long t = 0; t < 1000; t++) {
+                display->showPoint(createPoint(36000000ULL + t * 1000));
+            }
+            display->showInvalidFix(36000000ULL);
+            display->showParseError("bad sentence");
+            display->showRejected("speed");
+            display->flush();
+        }
+    }
+    EXPECT_EQ(readFile(path), readFile(plainPath));
+}
+
+TEST_F(MmapSinkTest, FileDisplayFallbackKeepsAsyncSettings) {
+    // Символьное устройство нельзя отобразить с fallocate - остается write(2)
+    FileDisplay display("/dev/null", false, 1024 * 1024, true, 50, 4096);
+    EXPECT_FALSE(display.enableMmap());
+    EXPECT_EQ(display.getMmapSink(), nullptr);
+    EXPECT_TRUE(display.getSink().isOpen());
+    EXPECT_TRUE(display.getSink().isAsync());
+}
+
+TEST_F(MmapSinkTest, Pipeline_SelectsMmapBackend) {
+    JsonConfig config;
+    config.setIoBackend("mmap");
+    const std::string configPath = (dir / "config.json").string();
+    ASSERT_TRUE(config.saveToFile(configPath));
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(configPath));
+    EXPECT_EQ(loaded.getIoBackend(), "mmap");
+    
+    loaded.setDisplayType("file");
+    loaded.setOutputFile(path);
+    GpsPipeline pipeline(loaded);
+    auto* display = dynamic_cast<FileDisplay*>(pipeline.getDisplay());
+    ASSERT_NE(display, nullptr);
+    EXPECT_NE(display->getMmapSink(), nullptr);
+}
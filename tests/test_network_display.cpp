@@ -0,0 +1,411 @@
+#include <gtest/gtest.h>
+#include "network_display.h"
+#include "console_display.h"
+#include "structured_format.h"
+#include "record_format.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Получатель на 127.0.0.1: TCP принимает одно соединение, UDP - датаграммы
+    class LoopbackListener {
+    public:
+        explicit LoopbackListener(int type, unsigned short port = 0) : type_(type) {
+            fd_ = ::socket(AF_INET, type, 0);
+            int one = 1;
+            ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(port);
+            bound_ = ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+            if (type == SOCK_STREAM) {
+                bound_ = bound_ && ::listen(fd_, 4) == 0;
+            }
+            socklen_t length = sizeof(addr);
+            ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+            port_ = ntohs(addr.sin_port);
+        }
+        
+        ~LoopbackListener() {
+            close();
+        }
+        
+        void close() {
+            if (client_ >= 0) ::close(client_);
+            if (fd_ >= 0) ::close(fd_);
+            client_ = -1;
+            fd_ = -1;
+        }
+        
+        bool isBound() const { return bound_; }
+        unsigned short getPort() const { return port_; }
+        std::string getEndpoint() const { return "127.0.0.1:" + std::to_string(port_); }
+        
+        // Читать поток, пока done(data) не вернет true или не истечет timeout
+        bool receive(std::string& data, const std::function<bool(const std::string&)>& done,
+                     std::chrono::milliseconds timeout = std::chrono::milliseconds(3000)) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            char buffer[64 * 1024];
+            while (!done(data)) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0) return false;
+                int fd = type_ == SOCK_STREAM && client_ < 0 ? fd_ : (type_ == SOCK_STREAM ? client_ : fd_);
+                pollfd pfd{fd, POLLIN, 0};
+                if (::poll(&pfd, 1, static_cast<int>(left)) <= 0) continue;
+                if (type_ == SOCK_STREAM && client_ < 0) {
+                    client_ = ::accept(fd_, nullptr, nullptr);
+                    continue;
+                }
+                ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) return false;
+                data.append(buffer, static_cast<size_t>(n));
+                datagrams_.push_back(static_cast<size_t>(n));
+            }
+            return true;
+        }
+        
+        // Размеры принятых датаграмм (для UDP)
+        const std::vector<size_t>& getDatagrams() const { return datagrams_; }
+    
+    private:
+        int type_;
+        int fd_ = -1;
+        int client_ = -1;
+        bool bound_ = false;
+        unsigned short port_ = 0;
+        std::vector<size_t> datagrams_;
+    };
+    
+    size_t lineCount(const std::string& data) {
+        return static_cast<size_t>(std::count(data.begin(), data.end(), '\n'));
+    }
+    
+    // Разбор двоичных сообщений; false - нарушен формат
+    bool decodeFrames(const std::string& data, std::vector<PackedGpsPoint>& records, size_t& frames) {
+        size_t offset = 0;
+        while (offset < data.size()) {
+            network_format::FrameHeader header;
+            if (data.size() - offset < sizeof(header)) return false;
+            std::memcpy(&header, data.data() + offset, sizeof(header));
+            offset += sizeof(header);
+            if (std::memcmp(header.magic, network_format::MAGIC, sizeof(header.magic)) != 0 ||
+                header.version != network_format::VERSION ||
+                header.recordSize != sizeof(PackedGpsPoint)) {
+                return false;
+            }
+            size_t size = static_cast<size_t>(header.recordCount) * sizeof(PackedGpsPoint);
+            if (data.size() - offset < size) return false;
+            for (size_t i = 0; i < header.recordCount; i++) {
+                PackedGpsPoint record;
+                std::memcpy(&record, data.data() + offset + i * sizeof(record), sizeof(record));
+                records.push_back(record);
+            }
+            offset += size;
+            frames++;
+        }
+        return true;
+    }
+}
+
+class NetworkDisplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_network_display_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    static GpsPoint createPoint(unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75 + timestamp * 1e-6;
+        p.longitude = 37.61;
+        p.speed = 42.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    static std::string ndjsonLine(const structured_format::Record& record) {
+        std::vector<char> buffer(record_format::TYPICAL_CAPACITY);
+        size_t length = record_format::render(buffer, [&](char* out, size_t capacity) {
+            return structured_format::formatNdjson(record, out, capacity);
+        });
+        return std::string(buffer.data(), length);
+    }
+    
+    fs::path dir;
+};
+
+TEST_F(NetworkDisplayTest, TcpNdjson_SendsBatchesNotRecords) {
+    LoopbackListener listener(SOCK_STREAM);
+    ASSERT_TRUE(listener.isBound());
+    
+    const size_t count = 640;
+    std::string expected;
+    {
+        NetworkDisplay display(NetworkDisplay::Protocol::TCP, NetworkDisplay::Format::NDJSON,
+                               "127.0.0.1", listener.getPort(), 64, 100000);
+        for (size_t i = 0; i < count; i++) {
+            GpsPoint point = createPoint(1000 + i);
+            display.showPoint(point);
+            expected += ndjsonLine(structured_format::pointRecord(point));
+        }
+        display.flush();
+        
+        std::string data;
+        ASSERT_TRUE(listener.receive(data, [&](const std::string& d) { return d.size() >= expected.size(); }));
+        EXPECT_EQ(data, expected);
+        EXPECT_TRUE(display.isConnected());
+        EXPECT_EQ(display.getSentCount(), count);
+        EXPECT_EQ(display.getDroppedCount(), 0u);
+        // Не больше пакета на batchRecords записей (плюс остаток при flush)
+        EXPECT_LE(display.getBatchCount(), count / 64 + 1);
+        EXPECT_LE(display.getSendCallCount(), display.getBatchCount() * 2);
+    }
+}
+
+TEST_F(NetworkDisplayTest, TcpBinary_FramesCarryPackedPoints) {
+    LoopbackListener listener(SOCK_STREAM);
+    ASSERT_TRUE(listener.isBound());
+    
+    NetworkDisplay display(NetworkDisplay::Protocol::TCP, NetworkDisplay::Format::BINARY,
+                           "127.0.0.1", listener.getPort(), 16, 200);
+    for (unsigned long long i = 0; i < 100; i++) {
+        display.showPoint(createPoint(1000 + i));
+    }
+    display.showInvalidFix(5000);
+    display.showParseError("Invalid checksum");
+    display.showRejected("speed");
+    display.flush();
+    
+    const size_t expectedRecords = 101;
+    std::vector<PackedGpsPoint> records;
+    size_t frames = 0;
+    std::string data;
+    ASSERT_TRUE(listener.receive(data, [&](const std::string& d) {
+        records.clear();
+        frames = 0;
+        return decodeFrames(d, records, frames) && records.size() >= expectedRecords;
+    }));
+    ASSERT_EQ(records.size(), expectedRecords);
+    EXPECT_EQ(frames, display.getBatchCount());
+    
+    for (size_t i = 0; i < 100; i++) {
+        GpsPoint point = records[i].toPoint();
+        EXPECT_TRUE(point.isValid);
+        EXPECT_EQ(point.timestamp, 1000 + i);
+        EXPECT_NEAR(point.latitude, 55.75 + (1000 + i) * 1e-6, 1e-6);
+    }
+    EXPECT_FALSE(records[100].isValid());
+    EXPECT_EQ(records[100].timestamp, 5000);
+}
+
+TEST_F(NetworkDisplayTest, Linger_SendsPartialBatchWithoutFlush) {
+    LoopbackListener listener(SOCK_STREAM);
+    ASSERT_TRUE(listener.isBound());
+    
+    NetworkDisplay display(NetworkDisplay::Protocol::TCP, NetworkDisplay::Format::NDJSON,
+                           "127.0.0.1", listener.getPort(), 1000, 1000);
+    for (unsigned long long i = 0; i < 5; i++) {
+        display.showPoint(createPoint(1000 + i));
+    }
+    
+    std::string data;
+    ASSERT_TRUE(listener.receive(data, [](const std::string& d) { return lineCount(d) >= 5; }));
+    EXPECT_EQ(lineCount(data), 5u);
+    
+    // Записи ушли по истечении linger; flush() лишь дожидается счетчиков
+    display.flush();
+    EXPECT_EQ(display.getSentCount(), 5u);
+    EXPECT_LE(display.getBatchCount(), 2u);
+}
+
+TEST_F(NetworkDisplayTest, Tcp_ReconnectsAfterListenerRestart) {
+    auto listener = std::make_unique<LoopbackListener>(SOCK_STREAM);
+    ASSERT_TRUE(listener->isBound());
+    const unsigned short port = listener->getPort();
+    
+    NetworkDisplay display(NetworkDisplay::Protocol::TCP, NetworkDisplay::Format::NDJSON,
+                           "127.0.0.1", port, 8, 200);
+    display.showPoint(createPoint(1000));
+    display.flush();
+    std::string data;
+    ASSERT_TRUE(listener->receive(data, [](const std::string& d) { return lineCount(d) >= 1; }));
+    
+    // Получатель перезапускается на том же порту
+    listener.reset();
+    listener = std::make_unique<LoopbackListener>(SOCK_STREAM, port);
+    ASSERT_TRUE(listener->isBound());
+    
+    // Записи, отправленные в закрытое соединение, теряются, пока разрыв не обнаружен
+    data.clear();
+    bool received = false;
+    for (unsigned long long i = 0; i < 50 && !received; i++) {
+        display.showPoint(createPoint(2000 + i));
+        display.flush();
+        received = listener->receive(data, [](const std::string& d) { return lineCount(d) >= 1; },
+                                     std::chrono::milliseconds(100));
+    }
+    EXPECT_TRUE(received);
+    EXPECT_GE(display.getReconnectCount(), 1u);
+    EXPECT_TRUE(display.isConnected());
+}
+
+TEST_F(NetworkDisplayTest, NoListener_BufferIsBoundedAndFlushReturns) {
+    // Порт без получателя: соединение отклоняется
+    unsigned short port;
+    {
+        LoopbackListener closed(SOCK_STREAM);
+        port = closed.getPort();
+    }
+    
+    NetworkDisplay display(NetworkDisplay::Protocol::TCP, NetworkDisplay::Format::NDJSON,
+                           "127.0.0.1", port, 16, 200, 4096);
+    for (unsigned long long i = 0; i < 1000; i++) {
+        display.showPoint(createPoint(1000 + i));
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    display.flush();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    EXPECT_LT(elapsed, NetworkDisplay::FLUSH_TIMEOUT);
+    EXPECT_FALSE(display.isConnected());
+    EXPECT_EQ(display.getSentCount(), 0u);
+    EXPECT_GT(display.getDroppedCount(), 900u);
+}
+
+TEST_F(NetworkDisplayTest, Udp_DatagramsFitMtu) {
+    LoopbackListener listener(SOCK_DGRAM);
+    ASSERT_TRUE(listener.isBound());
+    
+    const size_t count = 500;
+    NetworkDisplay display(NetworkDisplay::Protocol::UDP, NetworkDisplay::Format::BINARY,
+                           "127.0.0.1", listener.getPort(), 256, 1000);
+    for (unsigned long long i = 0; i < count; i++) {
+        display.showPoint(createPoint(1000 + i));
+    }
+    display.flush();
+    
+    std::vector<PackedGpsPoint> records;
+    size_t frames = 0;
+    std::string data;
+    ASSERT_TRUE(listener.receive(data, [&](const std::string& d) {
+        records.clear();
+        frames = 0;
+        return decodeFrames(d, records, frames) && records.size() >= count;
+    }));
+    ASSERT_EQ(records.size(), count);
+    EXPECT_EQ(frames, listener.getDatagrams().size());
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(records[i].timestamp, static_cast<std::int64_t>(1000 + i));
+    }
+    for (size_t size : listener.getDatagrams()) {
+        EXPECT_LE(size, network_format::MAX_DATAGRAM);
+    }
+    EXPECT_EQ(display.getSentCount(), count);
+    // Датаграммы пакета отправляются одним sendmmsg
+    EXPECT_LT(display.getSendCallCount(), listener.getDatagrams().size());
+}
+
+TEST_F(NetworkDisplayTest, ParseEndpoint) {
+    std::string host;
+    unsigned short port = 0;
+    EXPECT_TRUE(NetworkDisplay::parseEndpoint("127.0.0.1:5000", host, port));
+    EXPECT_EQ(host, "127.0.0.1");
+    EXPECT_EQ(port, 5000);
+    EXPECT_TRUE(NetworkDisplay::parseEndpoint("[::1]:9000", host, port));
+    EXPECT_EQ(host, "::1");
+    EXPECT_EQ(port, 9000);
+    EXPECT_TRUE(NetworkDisplay::parseEndpoint("collector.local:80", host, port));
+    EXPECT_EQ(host, "collector.local");
+    
+    EXPECT_FALSE(NetworkDisplay::parseEndpoint("", host, port));
+    EXPECT_FALSE(NetworkDisplay::parseEndpoint("localhost", host, port));
+    EXPECT_FALSE(NetworkDisplay::parseEndpoint(":5000", host, port));
+    EXPECT_FALSE(NetworkDisplay::parseEndpoint("localhost:0", host, port));
+    EXPECT_FALSE(NetworkDisplay::parseEndpoint("localhost:70000", host, port));
+    EXPECT_FALSE(NetworkDisplay::parseEndpoint("localhost:50x", host, port));
+}
+
+TEST_F(NetworkDisplayTest, Pipeline_CreatesFromConfig) {
+    LoopbackListener listener(SOCK_STREAM);
+    ASSERT_TRUE(listener.isBound());
+    
+    const std::string configPath = (dir / "config.json").string();
+    {
+        std::ofstream file(configPath);
+        file << "{\n"
+             << "  \"displayType\": \"tcp\",\n"
+             << "  \"endpoint\": \"" << listener.getEndpoint() << "\",\n"
+             << "  \"networkFormat\": \"binary\",\n"
+             << "  \"batchRecords\": 8,\n"
+             << "  \"lingerUs\": 500,\n"
+             << "  \"sendBufferBytes\": 65536,\n"
+             << "  \"filters\": []\n"
+             << "}\n";
+    }
+    JsonConfig config;
+    ASSERT_TRUE(config.loadFromFile(configPath));
+    EXPECT_EQ(config.getEndpoint(), listener.getEndpoint());
+    EXPECT_EQ(config.getNetworkFormat(), "binary");
+    EXPECT_EQ(config.getBatchRecords(), 8u);
+    EXPECT_EQ(config.getLingerUs(), 500u);
+    EXPECT_EQ(config.getSendBufferBytes(), 65536u);
+    
+    // Сохранение и повторная загрузка
+    ASSERT_TRUE(config.saveToFile(configPath));
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(configPath));
+    EXPECT_EQ(loaded.getEndpoint(), listener.getEndpoint());
+    EXPECT_EQ(loaded.getBatchRecords(), 8u);
+    
+    {
+        GpsPipeline pipeline(loaded);
+        auto* network = dynamic_cast<NetworkDisplay*>(pipeline.getDisplay());
+        ASSERT_NE(network, nullptr);
+        EXPECT_EQ(network->getProtocol(), NetworkDisplay::Protocol::TCP);
+        EXPECT_EQ(network->getFormat(), NetworkDisplay::Format::BINARY);
+        
+        pipeline.process("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*3D");
+        pipeline.process("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4F");
+    }
+    
+    std::vector<PackedGpsPoint> records;
+    size_t frames = 0;
+    std::string data;
+    ASSERT_TRUE(listener.receive(data, [&](const std::string& d) {
+        records.clear();
+        frames = 0;
+        return decodeFrames(d, records, frames) && !records.empty();
+    }));
+    EXPECT_TRUE(records[0].isValid());
+    EXPECT_NEAR(records[0].toPoint().latitude, 48.1173, 1e-3);
+    
+    // Без адреса - вывод в консоль
+    loaded.setEndpoint("");
+    GpsPipeline fallback(loaded);
+    EXPECT_NE(dynamic_cast<ConsoleDisplay*>(fallback.getDisplay()), nullptr);
+}
@@ -89,4 +89,175 @@ TEST_F(ParserTest, ParseLine_DifferentTimestamps_NoPoint) {
     auto point = parser.parseLine("$GPGGA,123520,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4D");
     
     EXPECT_FALSE(point.has_value());
-}
\ No newline at end of file
+}
+
+TEST_F(ParserTest, NmeaCoordinateToE7_ParsesDigitsExactly) {
+    EXPECT_EQ(NmeaParser::nmeaCoordinateToE7("4807.038", 'N'), 481173000);
+    EXPECT_EQ(NmeaParser::nmeaCoordinateToE7("4807.038", 'S'), -481173000);
+    EXPECT_EQ(NmeaParser::nmeaCoordinateToE7("01131.000", 'E'), 115166667);
+    EXPECT_EQ(NmeaParser::nmeaCoordinateToE7("01131.000", 'W'), -115166667);
+    EXPECT_EQ(NmeaParser::nmeaCoordinateToE7("17959.99999", 'E'), 1799999998);
+    EXPECT_EQ(NmeaParser::nmeaCoordinateToE7("abc", 'N'), 0);
+}
+
+TEST_F(ParserTest, ParseFixed_RoundsOnNextDigit) {
+    std::int64_t value = 0;
+    ASSERT_TRUE(NmeaParser::parseFixed("545.4", 2, value));
+    EXPECT_EQ(value, 54540);
+    ASSERT_TRUE(NmeaParser::parseFixed("0.905", 2, value));
+    EXPECT_EQ(value, 91);
+    ASSERT_TRUE(NmeaParser::parseFixed("-12", 2, value));
+    EXPECT_EQ(value, -1200);
+    EXPECT_FALSE(NmeaParser::parseFixed("", 2, value));
+    EXPECT_FALSE(NmeaParser::parseFixed("1.2x", 2, value));
+}
+
+TEST_F(ParserTest, ParseDateToEpochMs_ConvertsNmeaDate) {
+    EXPECT_EQ(NmeaParser::parseDateToEpochMs("010100"), 946684800000LL);
+    EXPECT_EQ(NmeaParser::parseDateToEpochMs("230394"), 764380800000LL);
+    EXPECT_EQ(NmeaParser::parseDateToEpochMs("291224"), 1735430400000LL);
+    EXPECT_EQ(NmeaParser::parseDateToEpochMs("321394"), -1);
+    EXPECT_EQ(NmeaParser::parseDateToEpochMs(""), -1);
+}
+
+TEST_F(ParserTest, ParseLinePacked_CombinesRmcAndGga) {
+    auto rmc = parser.parseLinePacked("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*3D");
+    ASSERT_TRUE(rmc.has_value());
+    EXPECT_EQ(rmc->timestamp, 764380800000LL + 45319000LL);
+    EXPECT_EQ(rmc->speedCentiKmh, 4148);
+    EXPECT_EQ(rmc->courseCentiDeg, 8440);
+    EXPECT_TRUE(rmc->isValid());
+    
+    auto combined = parser.parseLinePacked("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4F");
+    ASSERT_TRUE(combined.has_value());
+    EXPECT_EQ(combined->latitudeE7, 481173000);
+    EXPECT_EQ(combined->longitudeE7, 115166667);
+    EXPECT_EQ(combined->speedCentiKmh, 4148);
+    EXPECT_EQ(combined->altitudeCm, 54540);
+    EXPECT_EQ(combined->hdopCenti, 90);
+    EXPECT_EQ(combined->satellites, 8);
+    EXPECT_TRUE(combined->isValid());
+    
+    // Распаковка согласуется с обычным парсингом
+    parser.reset();
+    parser.parseLine("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*3D");
+    auto point = parser.parseLine("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4F");
+    ASSERT_TRUE(point.has_value());
+    GpsPoint unpacked = combined->toPoint();
+    EXPECT_EQ(unpacked.timestamp, point->timestamp);
+    EXPECT_NEAR(unpacked.latitude, point->latitude, 1e-7);
+    EXPECT_NEAR(unpacked.longitude, point->longitude, 1e-7);
+    EXPECT_NEAR(unpacked.speed, point->speed, 0.01);
+    EXPECT_NEAR(unpacked.altitude, point->altitude, 0.01);
+}
+
+TEST_F(ParserTest, ParseLinePacked_InvalidChecksum_ReturnsNullopt) {
+    auto packed = parser.parseLinePacked("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*FF");
+    EXPECT_FALSE(packed.has_value());
+}
+
+TEST_F(ParserTest, ParseLinePacked_BrokenSentenceKeepsCachedRmc) {
+    ASSERT_TRUE(parser.parseLinePacked("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,,,*3D").has_value());
+    // Обрезанное RMC с верной контрольной суммой не разбирается
+    EXPECT_FALSE(parser.parseLinePacked("$GPRMC,123519,A,4807.038,N*57").has_value());
+    
+    auto combined = parser.parseLinePacked("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*4F");
+    ASSERT_TRUE(combined.has_value());
+    EXPECT_EQ(combined->speedCentiKmh, 4148);
+    EXPECT_EQ(combined->altitudeCm, 54540);
+}
+
+TEST_F(ParserTest, GpsPoint_DateFitsIntoPadding) {
+    GpsPoint p;
+    EXPECT_EQ(p.dateMs(), -1);
+    p.setDateMs(764380800000LL);
+    EXPECT_EQ(p.dateDay, 8847);
+    EXPECT_EQ(p.dateMs(), 764380800000LL);
+    p.setDateMs(-1);
+    EXPECT_EQ(p.dateMs(), -1);
+    
+    // Дата не увеличивает точку: 8 полей по 8 байт и указатель подписи
+    EXPECT_LE(sizeof(GpsPoint), 8 * sizeof(double) + sizeof(const char*));
+}
+
+TEST_F(ParserTest, PackedGpsPoint_RoundTripsWithinQuantization) {
+    GpsPoint p;
+    p.latitude = -33.8688197;
+    p.longitude = 151.2092955;
+    p.speed = 87.654;
+    p.course = 359.99;
+    p.altitude = -12.34;
+    p.satellites = 11;
+    p.hdop = 1.3f;
+    p.timestamp = 86399999;
+    p.isValid = true;
+    
+    PackedGpsPoint packed = PackedGpsPoint::fromPoint(p);
+    GpsPoint back = packed.toPoint();
+    EXPECT_NEAR(back.latitude, p.latitude, 1e-7);
+    EXPECT_NEAR(back.longitude, p.longitude, 1e-7);
+    EXPECT_NEAR(back.speed, p.speed, 0.005);
+    EXPECT_NEAR(back.course, p.course, 0.005);
+    EXPECT_NEAR(back.altitude, p.altitude, 0.005);
+    EXPECT_NEAR(back.hdop, p.hdop, 0.005);
+    EXPECT_EQ(back.satellites, 11);
+    EXPECT_EQ(back.timestamp, p.timestamp);
+    EXPECT_TRUE(back.isValid);
+    
+    // Скорость вне диапазона насыщается
+    p.speed = 1000.0;
+    EXPECT_EQ(PackedGpsPoint::fromPoint(p).speedCentiKmh, 0xFFFF);
+}
+
+TEST_F(ParserTest, ParseFixed_TooManyDigits_ReturnsFalse) {
+    std::int64_t value = 0;
+    // 17 значащих цифр и 2 знака дробной части - больше MAX_FIXED_DIGITS
+    EXPECT_FALSE(NmeaParser::parseFixed("12345678901234567", 2, value));
+    EXPECT_FALSE(NmeaParser::parseFixed("99999999999999999999999", 0, value));
+    // Ведущие нули не считаются
+    ASSERT_TRUE(NmeaParser::parseFixed("0000000000000000000012.5", 2, value));
+    EXPECT_EQ(value, 1250);
+    ASSERT_TRUE(NmeaParser::parseFixed("1234567890123456", 2, value));
+    EXPECT_EQ(value, 123456789012345600LL);
+    
+    auto packed = parser.parseLinePacked("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,1234567890123456789.5,M,47.0,M,,*4A");
+    ASSERT_TRUE(packed.has_value());
+    EXPECT_EQ(packed->altitudeCm, 0);
+}
+
+TEST_F(ParserTest, ParseLine_CarriesDateAcrossMidnight) {
+    auto rmc = parser.parseLine("$GPRMC,235959,A,4807.038,N,01131.000,E,022.4,084.4,230394,,*1D");
+    ASSERT_TRUE(rmc.has_value());
+    EXPECT_EQ(rmc->dateMs(), 764380800000LL);
+    
+    // GGA после полуночи раньше RMC с новой датой - уже следующие сутки
+    auto gga = parser.parseLine("$GPGGA,000001,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*43");
+    ASSERT_TRUE(gga.has_value());
+    EXPECT_EQ(gga->timestamp, 1000u);
+    EXPECT_EQ(gga->dateMs(), 764380800000LL + 86400000LL);
+    
+    parser.reset();
+    auto noDate = parser.parseLine("$GPGGA,000001,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*43");
+    ASSERT_TRUE(noDate.has_value());
+    EXPECT_EQ(noDate->dateMs(), -1);
+}
+
+TEST_F(ParserTest, ParseLinePacked_EpochFlagOnlyWithDate) {
+    auto gga = parser.parseLinePacked("$GPGGA,000001,4807.038,N,01131.000,E,1,08,0.9,545.4,M,47.0,M,,*43");
+    ASSERT_TRUE(gga.has_value());
+    EXPECT_FALSE(gga->hasEpochTime());
+    EXPECT_EQ(gga->timestamp, 1000);
+    
+    auto rmc = parser.parseLinePacked("$GPRMC,235959,A,4807.038,N,01131.000,E,022.4,084.4,230394,,*1D");
+    ASSERT_TRUE(rmc.has_value());
+    EXPECT_TRUE(rmc->hasEpochTime());
+    EXPECT_EQ(rmc->timestamp, 764380800000LL + 86399000LL);
+    
+    // Дата переживает упаковку
+    GpsPoint point = rmc->toPoint();
+    EXPECT_EQ(point.timestamp, 86399000u);
+    EXPECT_EQ(point.dateMs(), 764380800000LL);
+    PackedGpsPoint again = PackedGpsPoint::fromPoint(point);
+    EXPECT_EQ(again.timestamp, rmc->timestamp);
+    EXPECT_TRUE(again.hasEpochTime());
+}
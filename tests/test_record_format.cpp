@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "record_format.h"
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+namespace {
+    // Прежнее форматирование через iostream - эталон раскладки записей
+    std::string referenceTime(unsigned long long timestampMs) {
+        unsigned long long seconds = timestampMs / 1000;
+        int hours = seconds / 3600;
+        int minutes = (seconds % 3600) / 60;
+        int secs = seconds % 60;
+        std::ostringstream oss;
+        oss << std::setfill('0') << std::setw(2) << hours << ":"
+            << std::setw(2) << minutes << ":"
+            << std::setw(2) << secs;
+        return oss.str();
+    }
+    
+    std::string referenceCoordinate(double value, const char* positive, const char* negative) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(5) << std::fabs(value);
+        oss << (value >= 0 ? positive : negative);
+        return oss.str();
+    }
+    
+    std::string referencePoint(const GpsPoint& point) {
+        std::ostringstream out;
+        out << "[" << referenceTime(point.timestamp) << "] "
+            << "Coordinates: " << referenceCoordinate(point.latitude, "°N", "°S") << ", "
+            << referenceCoordinate(point.longitude, "°E", "°W") << "\n"
+            << "               Speed: " << std::fixed << std::setprecision(1) << point.speed << " km/h";
+        if (point.speed < 0.1) {
+            out << " (stopped)";
+        }
+        out << ", Course: " << std::fixed << std::setprecision(1) << point.course << "°\n"
+            << "               Altitude: " << std::fixed << std::setprecision(0) << point.altitude << "m"
+            << ", Satellites: " << point.satellites
+            << ", HDOP: " << std::fixed << std::setprecision(1) << point.hdop << "\n";
+        if (point.label) {
+            out << "               Road: " << point.label << "\n";
+        }
+        return out.str();
+    }
+    
+    std::string formatted(const GpsPoint& point) {
+        std::vector<char> buffer(record_format::TYPICAL_CAPACITY);
+        size_t length = record_format::render(buffer, [&](char* out, size_t capacity) {
+            return record_format::formatPoint(point, out, capacity);
+        });
+        return std::string(buffer.data(), length);
+    }
+}
+
+TEST(RecordFormatTest, Point_MatchesIostreamLayout) {
+    GpsPoint p;
+    p.latitude = 48.1173;
+    p.longitude = 11.5167;
+    p.speed = 41.5;
+    p.course = 84.4;
+    p.altitude = 545.4;
+    p.satellites = 8;
+    p.hdop = 0.9f;
+    p.timestamp = 12 * 3600 * 1000 + 35 * 60 * 1000 + 19 * 1000;
+    EXPECT_EQ(formatted(p),
+              "[12:35:19] Coordinates: 48.11730°N, 11.51670°E\n"
+              "               Speed: 41.5 km/h, Course: 84.4°\n"
+              "               Altitude: 545m, Satellites: 8, HDOP: 0.9\n");
+}
+
+TEST(RecordFormatTest, RandomPoints_MatchReference) {
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> lat(-90.0, 90.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    std::uniform_real_distribution<double> speed(0.0, 300.0);
+    std::uniform_real_distribution<double> course(0.0, 360.0);
+    std::uniform_real_distribution<double> alt(-500.0, 9000.0);
+    std::uniform_real_distribution<float> hdop(0.0f, 50.0f);
+    std::uniform_int_distribution<unsigned long long> ts(0, 3ULL * 24 * 3600 * 1000);
+    
+    for (int i = 0; i < 20000; i++) {
+        GpsPoint p;
+        p.latitude = lat(rng);
+        p.longitude = lon(rng);
+        // Часть значений - на границах округления
+        p.speed = (i % 7 == 0) ? std::round(speed(rng) * 20.0) / 20.0 : speed(rng);
+        p.course = (i % 5 == 0) ? std::round(course(rng) * 2.0) / 2.0 : course(rng);
+        p.altitude = (i % 3 == 0) ? std::round(alt(rng)) + 0.5 : alt(rng);
+        p.satellites = static_cast<int>(rng() % 40);
+        p.hdop = hdop(rng);
+        p.timestamp = ts(rng);
+        p.label = (i % 11 == 0) ? "Tverskaya" : nullptr;
+        ASSERT_EQ(formatted(p), referencePoint(p)) << "iteration " << i;
+    }
+}
+
+TEST(RecordFormatTest, EdgeValues_MatchReference) {
+    const double values[] = {0.0, -0.0, 0.05, 0.049999, 0.1, -0.00000499, 2.5, 3.5, -2.5,
+                             99.999995, 1e10, -1e-10, 179.999999};
+    for (double v : values) {
+        GpsPoint p;
+        p.latitude = v;
+        p.longitude = -v;
+        p.speed = v;
+        p.course = v;
+        p.altitude = v;
+        p.hdop = static_cast<float>(v);
+        p.satellites = -1;
+        EXPECT_EQ(formatted(p), referencePoint(p)) << "value " << v;
+    }
+}
+
+TEST(RecordFormatTest, Messages_MatchLayout) {
+    char buf[128];
+    size_t n = record_format::formatInvalidFix(3723000, buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n), "[01:02:03] No valid GPS fix\n");
+    n = record_format::formatParseError("bad checksum", buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n), "Parse error: bad checksum\n");
+    n = record_format::formatRejected("speed", buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n), "Point rejected: speed\n");
+    
+    GpsEvent event;
+    event.type = GpsEvent::Type::ZONE_EXIT;
+    event.source = "GeofenceFilter";
+    event.subject = "depot";
+    event.timestamp = 3723000;
+    event.latitude = -33.5;
+    event.longitude = -70.25;
+    event.durationMs = 65400;
+    n = record_format::formatEvent(event, buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n),
+              "[01:02:03] Event: GeofenceFilter EXIT 'depot' at 33.50000°S, 70.25000°W, duration: 65s\n");
+    
+    event.subject.clear();
+    event.durationMs = 0;
+    n = record_format::formatEvent(event, buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n), "[01:02:03] Event: GeofenceFilter EXIT at 33.50000°S, 70.25000°W\n");
+}
+
+TEST(RecordFormatTest, SmallBuffer_ReportsFullLengthAndRenderGrows) {
+    std::string longError(2000, 'x');
+    char small[16];
+    size_t n = record_format::formatParseError(longError, small, sizeof(small));
+    EXPECT_EQ(n, longError.size() + 14);
+    EXPECT_EQ(std::string(small, sizeof(small)), "Parse error: xxx");
+    
+    std::vector<char> buffer(record_format::TYPICAL_CAPACITY);
+    n = record_format::render(buffer, [&](char* out, size_t capacity) {
+        return record_format::formatParseError(longError, out, capacity);
+    });
+    EXPECT_EQ(std::string(buffer.data(), n), "Parse error: " + longError + "\n");
+}
+
+TEST(RecordFormatTest, LongTimestamp_HoursWiderThanTwoDigits) {
+    char buf[64];
+    size_t n = record_format::formatInvalidFix(150ULL * 3600 * 1000 + 5000, buf, sizeof(buf));
+    EXPECT_EQ(std::string(buf, n), "[150:00:05] No valid GPS fix\n");
+}
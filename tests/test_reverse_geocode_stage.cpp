@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+#include "reverse_geocode_stage.h"
+#include "console_display.h"
+#include "mock_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace {
+    const double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+    
+    // Расстояние до сегмента полным перебором в той же метрике, что и индекс
+    double bruteDistance(double lat, double lon, double lat1, double lon1, double lat2, double lon2) {
+        double k = std::cos(lat * M_PI / 180.0);
+        double px = lon * k, ax = lon1 * k, bx = lon2 * k;
+        double dx = bx - ax, dy = lat2 - lat1;
+        double len2 = dx * dx + dy * dy;
+        double t = len2 > 0 ? std::max(0.0, std::min(1.0, ((px - ax) * dx + (lat - lat1) * dy) / len2)) : 0.0;
+        return std::hypot(ax + t * dx - px, lat1 + t * dy - lat) * METERS_PER_DEG;
+    }
+}
+
+class RoadIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Две параллельные улицы с запада на восток в 100 м друг от друга
+        index.addSegment("Tverskaya", 55.7500, 37.6000, 55.7500, 37.6100);
+        index.addSegment("Arbat", 55.7500 + 100.0 / METERS_PER_DEG, 37.6000,
+                         55.7500 + 100.0 / METERS_PER_DEG, 37.6100);
+        index.build();
+    }
+    
+    RoadIndex index;
+};
+
+TEST_F(RoadIndexTest, Nearest_PicksCloserSegment) {
+    RoadIndex::Match match;
+    ASSERT_TRUE(index.nearest(55.7500 + 30.0 / METERS_PER_DEG, 37.605, 50.0, match));
+    EXPECT_STREQ(match.name, "Tverskaya");
+    EXPECT_NEAR(match.distance, 30.0, 0.01);
+    
+    ASSERT_TRUE(index.nearest(55.7500 + 70.0 / METERS_PER_DEG, 37.605, 50.0, match));
+    EXPECT_STREQ(match.name, "Arbat");
+    EXPECT_NEAR(match.distance, 30.0, 0.01);
+}
+
+TEST_F(RoadIndexTest, Nearest_BeyondMaxDistance_NoMatch) {
+    RoadIndex::Match match;
+    EXPECT_FALSE(index.nearest(55.7500 - 60.0 / METERS_PER_DEG, 37.605, 50.0, match));
+    EXPECT_EQ(match.name, nullptr);
+    EXPECT_EQ(match.segment, RoadIndex::NO_SEGMENT);
+}
+
+TEST_F(RoadIndexTest, Nearest_HintFartherThanBest_Ignored) {
+    RoadIndex::Match match;
+    ASSERT_TRUE(index.nearest(55.7500 + 10.0 / METERS_PER_DEG, 37.605, 200.0, match, 1));
+    EXPECT_STREQ(match.name, "Tverskaya");
+}
+
+TEST_F(RoadIndexTest, RandomNetwork_MatchesBruteForce) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> lat(55.70, 55.80);
+    std::uniform_real_distribution<double> lon(37.50, 37.70);
+    std::uniform_real_distribution<double> step(-0.002, 0.002);
+    
+    RoadIndex random(0.002);
+    struct Seg { double lat1, lon1, lat2, lon2; };
+    std::vector<Seg> segs;
+    for (int i = 0; i < 3000; i++) {
+        Seg s;
+        s.lat1 = lat(rng);
+        s.lon1 = lon(rng);
+        s.lat2 = s.lat1 + step(rng);
+        s.lon2 = s.lon1 + step(rng);
+        segs.push_back(s);
+        random.addSegment("road" + std::to_string(i), s.lat1, s.lon1, s.lat2, s.lon2);
+    }
+    random.build();
+    ASSERT_EQ(random.size(), segs.size());
+    
+    std::uint32_t hint = RoadIndex::NO_SEGMENT;
+    for (int q = 0; q < 2000; q++) {
+        double qlat = lat(rng), qlon = lon(rng);
+        double best = 1e18;
+        for (const auto& s : segs) {
+            best = std::min(best, bruteDistance(qlat, qlon, s.lat1, s.lon1, s.lat2, s.lon2));
+        }
+        
+        RoadIndex::Match match;
+        bool found = random.nearest(qlat, qlon, 150.0, match, hint);
+        if (best <= 150.0 - 1e-6) {
+            ASSERT_TRUE(found) << "query " << q;
+            EXPECT_NEAR(match.distance, best, 1e-6) << "query " << q;
+        } else if (best > 150.0 + 1e-6) {
+            EXPECT_FALSE(found) << "query " << q;
+        }
+        // Подсказка из предыдущего запроса не должна менять ответ
+        hint = match.segment;
+    }
+}
+
+TEST_F(RoadIndexTest, DiagonalSegment_RegisteredOnlyInCrossedCells) {
+    // Диагональ 1 x 1 градус при ячейке 0.01: прямоугольник - 10000 ячеек,
+    // сам отрезок проходит примерно через 200
+    RoadIndex diagonal(0.01);
+    diagonal.addSegment("Diagonal", 55.003, 37.004, 56.003, 38.004);
+    diagonal.build();
+    EXPECT_LE(diagonal.getEntryCount(), 300u);
+    EXPECT_GE(diagonal.getEntryCount(), 100u);
+    
+    // Точки вдоль отрезка и рядом с ним находят его так же, как перебором
+    for (int i = 0; i <= 100; i++) {
+        const double t = i / 100.0;
+        const double lat = 55.003 + t + (i % 2 ? 0.0003 : -0.0003);
+        const double lon = 37.004 + t;
+        RoadIndex::Match match;
+        ASSERT_TRUE(diagonal.nearest(lat, lon, 100.0, match)) << i;
+        EXPECT_NEAR(match.distance, bruteDistance(lat, lon, 55.003, 37.004, 56.003, 38.004), 1e-6) << i;
+    }
+}
+
+TEST_F(RoadIndexTest, SaveAndMapIndex_SameResults) {
+    const std::string path = "test_road_index.bin";
+    ASSERT_TRUE(index.saveIndex(path));
+    
+    RoadIndex mapped;
+    ASSERT_TRUE(mapped.loadIndex(path));
+    EXPECT_TRUE(mapped.isMapped());
+    EXPECT_EQ(mapped.size(), 2u);
+    EXPECT_DOUBLE_EQ(mapped.getCellSize(), index.getCellSize());
+    
+    RoadIndex::Match match;
+    ASSERT_TRUE(mapped.nearest(55.7500 + 70.0 / METERS_PER_DEG, 37.605, 50.0, match));
+    EXPECT_STREQ(match.name, "Arbat");
+    
+    // Добавление к отображенному индексу сохраняет прежние сегменты
+    mapped.addSegment("Ring", 55.7600, 37.6000, 55.7600, 37.6100);
+    mapped.build();
+    EXPECT_FALSE(mapped.isMapped());
+    EXPECT_EQ(mapped.size(), 3u);
+    ASSERT_TRUE(mapped.nearest(55.7500, 37.605, 50.0, match));
+    EXPECT_STREQ(match.name, "Tverskaya");
+    std::remove(path.c_str());
+}
+
+TEST_F(RoadIndexTest, LoadIndex_InvalidFile_Rejected) {
+    const std::string path = "test_road_index_bad.bin";
+    {
+        std::ofstream file(path);
+        file << "not an index at all, just some text";
+    }
+    RoadIndex bad;
+    EXPECT_FALSE(bad.loadIndex(path));
+    EXPECT_FALSE(bad.loadIndex("missing_road_index.bin"));
+    EXPECT_EQ(bad.size(), 0u);
+    std::remove(path.c_str());
+}
+
+TEST_F(RoadIndexTest, LoadIndex_CorruptTables_Rejected) {
+    const std::string path = "test_road_index_corrupt.bin";
+    ASSERT_TRUE(index.saveIndex(path));
+    std::string image;
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        image = ss.str();
+    }
+    
+    // Заголовок: сигнатура, размер ячейки, число сегментов, ячеек, записей, размер имен
+    auto field = [](std::string& data, size_t offset) {
+        return reinterpret_cast<std::uint64_t*>(&data[offset]);
+    };
+    const std::uint64_t cellCount = *field(image, 24);
+    const size_t segments = 48;
+    const size_t offsets = segments + 2 * 40 + cellCount * 8;
+    const size_t entries = (offsets + (cellCount + 1) * 4 + 7) & ~size_t(7);
+    
+    auto rejects = [&](const std::string& data) {
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        RoadIndex corrupt;
+        return !corrupt.loadIndex(path) && corrupt.size() == 0;
+    };
+    
+    std::string bad = image;
+    *field(bad, 16) = 1ULL << 60;   // переполнение размера таблицы сегментов
+    EXPECT_TRUE(rejects(bad));
+    
+    bad = image;
+    *field(bad, 32) = ~0ULL;        // записей больше, чем помещается в uint32
+    EXPECT_TRUE(rejects(bad));
+    
+    bad = image;
+    *field(bad, segments + 40 + 32) = *field(bad, 40);   // имя второго сегмента за блоком имен
+    EXPECT_TRUE(rejects(bad));
+    
+    bad = image;
+    reinterpret_cast<std::uint32_t*>(&bad[entries])[0] = 2;   // несуществующий сегмент
+    EXPECT_TRUE(rejects(bad));
+    
+    bad = image;
+    reinterpret_cast<std::uint32_t*>(&bad[offsets])[cellCount] = 1000;   // смещение за записями
+    EXPECT_TRUE(rejects(bad));
+    
+    EXPECT_FALSE(rejects(image));
+    std::remove(path.c_str());
+}
+
+TEST_F(RoadIndexTest, LoadSegments_SkipsCommentsAndBadLines) {
+    const std::string path = "test_road_segments.csv";
+    {
+        std::ofstream file(path);
+        file << "# name;lat1;lon1;lat2;lon2\n"
+             << "Tverskaya;55.75;37.60;55.76;37.61\n"
+             << "\n"
+             << "Broken;55.75;abc;55.76;37.61\n"
+             << "Arbat\t55.74\t37.58\t55.75\t37.59\r\n";
+    }
+    RoadIndex loaded;
+    ASSERT_TRUE(loaded.loadSegments(path));
+    EXPECT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded.getSkippedLines(), 1u);
+    EXPECT_STREQ(loaded.getName(1), "Arbat");
+    std::remove(path.c_str());
+}
+
+class ReverseGeocodeStageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto mock = std::make_unique<MockDisplay>();
+        display = mock.get();
+        stage = std::make_unique<ReverseGeocodeStage>(std::move(mock), 50.0);
+        stage->getIndex().addSegment("Tverskaya", 55.7500, 37.6000, 55.7500, 37.6100);
+        stage->getIndex().build();
+    }
+    
+    GpsPoint createPoint(double northMeters, double lon = 37.605) {
+        GpsPoint p;
+        p.latitude = 55.75 + northMeters / METERS_PER_DEG;
+        p.longitude = lon;
+        p.isValid = true;
+        return p;
+    }
+    
+    MockDisplay* display = nullptr;
+    std::unique_ptr<ReverseGeocodeStage> stage;
+};
+
+TEST_F(ReverseGeocodeStageTest, Point_GetsLabel) {
+    stage->showPoint(createPoint(10.0));
+    ASSERT_EQ(display->getCalls().size(), 1u);
+    ASSERT_NE(display->getCalls()[0].point.label, nullptr);
+    EXPECT_STREQ(display->getCalls()[0].point.label, "Tverskaya");
+    EXPECT_EQ(stage->getMatchCount(), 1u);
+}
+
+TEST_F(ReverseGeocodeStageTest, FarPoint_NoLabel) {
+    stage->showPoint(createPoint(500.0));
+    ASSERT_EQ(display->getCalls().size(), 1u);
+    EXPECT_EQ(display->getCalls()[0].point.label, nullptr);
+    EXPECT_EQ(stage->getMatchCount(), 0u);
+}
+
+TEST_F(ReverseGeocodeStageTest, RepeatedCoordinates_CacheHit) {
+    for (int i = 0; i < 10; i++) {
+        stage->showPoint(createPoint(5.0));
+    }
+    EXPECT_EQ(stage->getQueryCount(), 10u);
+    EXPECT_EQ(stage->getCacheHitCount(), 9u);
+    EXPECT_EQ(stage->getMatchCount(), 10u);
+    
+    stage->showInvalidFix(0);
+    stage->showPoint(createPoint(5.0));
+    EXPECT_EQ(stage->getCacheHitCount(), 9u);
+}
+
+TEST_F(ReverseGeocodeStageTest, Label_OutlivesMappedIndexAndStage) {
+    const std::string path = "test_geocode_label.bin";
+    ASSERT_TRUE(stage->getIndex().saveIndex(path));
+    
+    GpsPoint kept;
+    {
+        auto mock = std::make_unique<MockDisplay>();
+        MockDisplay* out = mock.get();
+        ReverseGeocodeStage mapped(std::move(mock), 50.0);
+        ASSERT_TRUE(mapped.getIndex().loadIndex(path));
+        ASSERT_TRUE(mapped.getIndex().isMapped());
+        mapped.showPoint(createPoint(10.0));
+        mapped.showPoint(createPoint(12.0));
+        ASSERT_EQ(out->getCalls().size(), 2u);
+        kept = out->getCalls()[1].point;
+        // Подпись - строка из пула, а не указатель в отображенный файл
+        EXPECT_EQ(kept.label, out->getCalls()[0].point.label);
+        EXPECT_EQ(kept.label, internLabel("Tverskaya"));
+    }
+    std::remove(path.c_str());
+    
+    // Стадия и отображение файла уже освобождены
+    ASSERT_NE(kept.label, nullptr);
+    EXPECT_STREQ(kept.label, "Tverskaya");
+    EXPECT_EQ(internLabel(""), nullptr);
+    EXPECT_EQ(internLabel(nullptr), nullptr);
+}
+
+TEST_F(ReverseGeocodeStageTest, ConsoleDisplay_PrintsRoad) {
+    std::ostringstream out;
+    ReverseGeocodeStage console(std::make_unique<ConsoleDisplay>(out), 50.0);
+    console.getIndex().addSegment("Tverskaya", 55.7500, 37.6000, 55.7500, 37.6100);
+    console.getIndex().build();
+    console.showPoint(createPoint(10.0));
+    EXPECT_NE(out.str().find("Road: Tverskaya\n"), std::string::npos);
+}
+
+TEST_F(ReverseGeocodeStageTest, JsonConfig_BuildsAndCachesIndex) {
+    const std::string segments = "test_geocode_segments.csv";
+    const std::string indexPath = "test_geocode_index.bin";
+    std::remove(indexPath.c_str());
+    {
+        std::ofstream file(segments);
+        file << "Tverskaya;55.75;37.60;55.75;37.61\n";
+    }
+    
+    JsonConfig config;
+    config.setDisplayType("console");
+    StageConfig geocode;
+    geocode.type = "ReverseGeocodeStage";
+    geocode.params["maxDistance"] = 30.0;
+    geocode.stringParams["segmentsFile"] = segments;
+    geocode.stringParams["indexFile"] = indexPath;
+    config.addOutputStage(geocode);
+    
+    {
+        GpsPipeline pipeline(config);
+        auto* stage = dynamic_cast<ReverseGeocodeStage*>(pipeline.getDisplay());
+        ASSERT_NE(stage, nullptr);
+        EXPECT_DOUBLE_EQ(stage->getMaxDistance(), 30.0);
+        EXPECT_EQ(stage->getIndex().size(), 1u);
+        EXPECT_FALSE(stage->getIndex().isMapped());
+    }
+    
+    // Второй запуск использует сохраненный индекс
+    std::remove(segments.c_str());
+    GpsPipeline pipeline(config);
+    auto* stage = dynamic_cast<ReverseGeocodeStage*>(pipeline.getDisplay());
+    ASSERT_NE(stage, nullptr);
+    EXPECT_TRUE(stage->getIndex().isMapped());
+    EXPECT_EQ(stage->getIndex().size(), 1u);
+    std::remove(indexPath.c_str());
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include "segment_compressor.h"
+#include "file_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#ifdef GPS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+class SegmentCompressorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_segment_compressor_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "out.log").string();
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    std::string writeSegment(const std::string& suffix, size_t lines) {
+        std::string name = path + "." + suffix;
+        std::ofstream file(name);
+        for (size_t i = 0; i < lines; i++) {
+            file << "[12:00:" << i % 60 << "] Coordinates: 55.75000°N, 37.61000°E\n";
+        }
+        return name;
+    }
+    
+    static std::string readFile(const std::string& name) {
+        std::ifstream file(name, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+    
+    static std::string readGzip(const std::string& name) {
+#ifdef GPS_HAVE_ZLIB
+        std::string text;
+        gzFile file = gzopen(name.c_str(), "rb");
+        if (!file) return text;
+        char buffer[4096];
+        int n;
+        while ((n = gzread(file, buffer, sizeof(buffer))) > 0) {
+            text.append(buffer, static_cast<size_t>(n));
+        }
+        gzclose(file);
+        return text;
+#else
+        return readFile(name);
+#endif
+    }
+    
+    std::vector<std::string> listDir() const {
+        std::vector<std::string> names;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            names.push_back(entry.path().filename().string());
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+    
+    fs::path dir;
+    std::string path;
+};
+
+TEST_F(SegmentCompressorTest, Submit_CompressesAndRemovesSource) {
+    if (!SegmentCompressor::isAvailable()) GTEST_SKIP() << "built without zlib";
+    
+    std::string segment = writeSegment("20260101_000000_000", 1000);
+    std::string original = readFile(segment);
+    
+    SegmentCompressor compressor(path);
+    EXPECT_TRUE(compressor.submit(segment));
+    compressor.wait();
+    
+    EXPECT_EQ(listDir(), std::vector<std::string>{"out.log.20260101_000000_000.gz"});
+    EXPECT_EQ(readGzip(segment + ".gz"), original);
+    EXPECT_LT(fs::file_size(segment + ".gz"), original.size() / 4);
+    EXPECT_EQ(compressor.getCompressedCount(), 1u);
+}
+
+TEST_F(SegmentCompressorTest, Startup_RecoversInterruptedWork) {
+    if (!SegmentCompressor::isAvailable()) GTEST_SKIP() << "built without zlib";
+    
+    // Сжатие прервано на записи временного файла
+    std::string pending = writeSegment("20260101_000000_000", 10);
+    std::ofstream(pending + ".gz.tmp") << "partial";
+    // Сжатие завершено, но исходный файл не успели удалить
+    std::string done = writeSegment("20260101_000001_000", 10);
+    {
+        SegmentCompressor compressor(path);
+        compressor.submit(done);
+        compressor.wait();
+    }
+    writeSegment("20260101_000001_000", 10);
+    std::ofstream(path) << "current";
+    
+    SegmentCompressor compressor(path);
+    compressor.wait();
+    EXPECT_EQ(listDir(), (std::vector<std::string>{
+        "out.log", "out.log.20260101_000000_000.gz", "out.log.20260101_000001_000.gz"}));
+    EXPECT_EQ(readFile(path), "current");
+}
+
+TEST_F(SegmentCompressorTest, Retention_RemovesOldestSegments) {
+    for (int i = 0; i < 5; i++) {
+        writeSegment("20260101_00000" + std::to_string(i) + "_000", 100);
+    }
+    {
+        SegmentCompressor compressor(path, 0, 8, 3, 0);
+        compressor.wait();
+        EXPECT_EQ(compressor.getRemovedCount(), 2u);
+    }
+    EXPECT_EQ(listDir(), (std::vector<std::string>{
+        "out.log.20260101_000002_000", "out.log.20260101_000003_000", "out.log.20260101_000004_000"}));
+    
+    // Ограничение по объему: остается только самый новый сегмент
+    size_t segmentSize = fs::file_size(dir / "out.log.20260101_000004_000");
+    SegmentCompressor compressor(path, 0, 8, 0, segmentSize + segmentSize / 2);
+    compressor.wait();
+    EXPECT_EQ(listDir(), std::vector<std::string>{"out.log.20260101_000004_000"});
+}
+
+TEST_F(SegmentCompressorTest, ForeignFiles_SurviveRescanAndRetention) {
+    for (int i = 0; i < 3; i++) {
+        writeSegment("20260101_00000" + std::to_string(i) + "_000", 100);
+    }
+    writeSegment("bak", 100);
+    writeSegment("20260101.old", 100);
+    std::ofstream(path + ".notes.gz.tmp") << "foreign";
+    
+    SegmentCompressor compressor(path, 1, 8, 1, 0);
+    compressor.wait();
+    EXPECT_EQ(compressor.getRemovedCount(), 2u);
+    std::string last = SegmentCompressor::isAvailable() ? "out.log.20260101_000002_000.gz" : "out.log.20260101_000002_000";
+    EXPECT_EQ(listDir(), (std::vector<std::string>{
+        "out.log.20260101.old", last, "out.log.bak", "out.log.notes.gz.tmp"}));
+}
+
+TEST_F(SegmentCompressorTest, QueueOverflow_SegmentsCompressedLater) {
+    if (!SegmentCompressor::isAvailable()) GTEST_SKIP() << "built without zlib";
+    
+    std::vector<std::string> segments;
+    for (int i = 0; i < 20; i++) {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), "20260101_0000%02d_000", i);
+        segments.push_back(writeSegment(suffix, 2000));
+    }
+    
+    SegmentCompressor compressor(path, 1, 1);
+    compressor.wait();   // восстановление при запуске сжимает уже лежащие сегменты
+    for (const auto& segment : segments) {
+        writeSegment(fs::path(segment).filename().string().substr(8) + ".1", 2000);
+    }
+    size_t accepted = 0;
+    for (const auto& segment : segments) {
+        accepted += compressor.submit(segment + ".1") ? 1 : 0;
+    }
+    compressor.wait();
+    
+    EXPECT_EQ(accepted + compressor.getOverflowCount(), segments.size());
+    for (const auto& name : listDir()) {
+        EXPECT_EQ(name.substr(name.size() - 3), ".gz") << name;
+    }
+    EXPECT_EQ(listDir().size(), 40u);
+}
+
+TEST_F(SegmentCompressorTest, FileDisplay_CompressesRotatedFiles) {
+    GpsPoint p;
+    p.latitude = 55.75;
+    p.longitude = 37.61;
+    p.isValid = true;
+    
+    size_t records = 0;
+    {
+        FileDisplay display(path, true, 4096, true, 10);
+        display.enableCompression(1, 0, 0);
+        for (int i = 0; i < 500; i++) {
+            p.timestamp = i * 1000ULL;
+            display.showPoint(p);
+            records++;
+        }
+    }
+    
+    size_t segments = 0;
+    std::string all;
+    for (const auto& name : listDir()) {
+        if (name == "out.log") continue;
+        if (SegmentCompressor::isAvailable()) {
+            EXPECT_EQ(name.substr(name.size() - 3), ".gz") << name;
+        }
+        all += readGzip((dir / name).string());
+        segments++;
+    }
+    all += readFile(path);
+    EXPECT_GT(segments, 1u);
+    EXPECT_EQ(static_cast<size_t>(std::count(all.begin(), all.end(), '\n')), records * 3);
+}
+
+TEST_F(SegmentCompressorTest, Pipeline_EnablesCompressionFromConfig) {
+    JsonConfig config;
+    config.setDisplayType("file");
+    config.setOutputFile(path);
+    config.setFileRotation(true);
+    config.setCompressRotated(true);
+    config.setRetainFiles(4);
+    
+    GpsPipeline pipeline(config);
+    auto* display = dynamic_cast<FileDisplay*>(pipeline.getDisplay());
+    ASSERT_NE(display, nullptr);
+    ASSERT_NE(display->getCompressor(), nullptr);
+    EXPECT_EQ(display->getCompressor()->isCompressing(), SegmentCompressor::isAvailable());
+    
+    JsonConfig plain;
+    plain.setDisplayType("file");
+    plain.setOutputFile(path);
+    GpsPipeline other(plain);
+    EXPECT_EQ(dynamic_cast<FileDisplay*>(other.getDisplay())->getCompressor(), nullptr);
+}
+
+TEST_F(SegmentCompressorTest, Pipeline_WarnsWhenCompressionIsIgnored) {
+    JsonConfig config;
+    config.setDisplayType("file");
+    config.setOutputFile(path);
+    config.setCompressRotated(true);
+    
+    // Без ротации сжимать нечего
+    testing::internal::CaptureStderr();
+    {
+        GpsPipeline pipeline(config);
+    }
+    EXPECT_NE(testing::internal::GetCapturedStderr().find("compressRotated requires fileRotation"), std::string::npos);
+    
+    config.setFileRotation(true);
+    testing::internal::CaptureStderr();
+    {
+        GpsPipeline pipeline(config);
+    }
+    std::string warning = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(warning.find("built without zlib") != std::string::npos, !SegmentCompressor::isAvailable()) << warning;
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "simplify_stage.h"
+#include "mock_display.h"
+#include "json_config.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+class SimplifyStageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto mock = std::make_unique<MockDisplay>();
+        display = mock.get();
+        stage = std::make_unique<SimplifyStage>(std::move(mock), 5.0, 1000);
+    }
+    
+    // Точка в метрах относительно начала координат (55.75, 37.61)
+    GpsPoint createPoint(double eastMeters, double northMeters, unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75 + northMeters / METERS_PER_DEG;
+        p.longitude = 37.61 + eastMeters / (METERS_PER_DEG * std::cos(55.75 * M_PI / 180.0));
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    std::vector<GpsPoint> outputPoints() const {
+        std::vector<GpsPoint> points;
+        for (const auto& call : display->getCalls()) {
+            if (call.type == DisplayCall::Type::POINT) {
+                points.push_back(call.point);
+            }
+        }
+        return points;
+    }
+    
+    // Расстояние от точки до отрезка, метры (локальная плоскость)
+    static double segmentDistance(const GpsPoint& p, const GpsPoint& a, const GpsPoint& b) {
+        double scale = METERS_PER_DEG * std::cos(a.latitude * M_PI / 180.0);
+        double px = (p.longitude - a.longitude) * scale, py = (p.latitude - a.latitude) * METERS_PER_DEG;
+        double ex = (b.longitude - a.longitude) * scale, ey = (b.latitude - a.latitude) * METERS_PER_DEG;
+        double len2 = ex * ex + ey * ey;
+        double t = len2 > 0 ? std::max(0.0, std::min(1.0, (px * ex + py * ey) / len2)) : 0.0;
+        return std::hypot(px - t * ex, py - t * ey);
+    }
+    
+    static constexpr double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+    
+    MockDisplay* display = nullptr;
+    std::unique_ptr<SimplifyStage> stage;
+};
+
+TEST_F(SimplifyStageTest, StraightLine_KeepsOnlyEndpoints) {
+    for (int i = 0; i < 500; i++) {
+        stage->showPoint(createPoint(i * 3.0, 0.0, i * 100ULL));
+    }
+    stage->flush();
+    
+    auto out = outputPoints();
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[0].timestamp, 0u);
+    EXPECT_EQ(out[1].timestamp, 49900u);
+    EXPECT_EQ(stage->getInputCount(), 500u);
+    EXPECT_EQ(stage->getOutputCount(), 2u);
+}
+
+TEST_F(SimplifyStageTest, RightAngle_KeepsCorner) {
+    for (int i = 0; i <= 50; i++) {
+        stage->showPoint(createPoint(i * 2.0, 0.0, i * 100ULL));
+    }
+    for (int i = 1; i <= 50; i++) {
+        stage->showPoint(createPoint(100.0, i * 2.0, (50 + i) * 100ULL));
+    }
+    stage->flush();
+    
+    // Вершина может сместиться от угла, но не дальше допуска
+    auto out = outputPoints();
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_GE(out[1].timestamp, 5000u);
+    EXPECT_LE(out[1].timestamp, 5200u);
+}
+
+TEST_F(SimplifyStageTest, MaxLookahead_BoundsDelay) {
+    stage->setMaxLookahead(10);
+    for (int i = 0; i < 100; i++) {
+        stage->showPoint(createPoint(i * 3.0, 0.0, i * 100ULL));
+    }
+    stage->flush();
+    
+    // Между соседними вершинами не больше maxLookahead точек
+    auto out = outputPoints();
+    ASSERT_GE(out.size(), 10u);
+    for (size_t i = 1; i < out.size(); i++) {
+        EXPECT_LE(out[i].timestamp - out[i - 1].timestamp, 1000u);
+    }
+}
+
+TEST_F(SimplifyStageTest, RandomTrack_StaysWithinTolerance) {
+    std::mt19937 rng(7);
+    std::normal_distribution<double> turn(0.0, 0.05);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    std::vector<GpsPoint> input;
+    double x = 0.0, y = 0.0, heading = 0.0;
+    for (int i = 0; i < 5000; i++) {
+        heading += turn(rng);
+        x += 3.0 * std::cos(heading);
+        y += 3.0 * std::sin(heading);
+        input.push_back(createPoint(x + noise(rng), y + noise(rng), i * 100ULL));
+        stage->showPoint(input.back());
+    }
+    stage->flush();
+    
+    auto out = outputPoints();
+    ASSERT_GE(out.size(), 2u);
+    EXPECT_EQ(out.front().timestamp, input.front().timestamp);
+    EXPECT_EQ(out.back().timestamp, input.back().timestamp);
+    
+    // Каждая исходная точка лежит в пределах допуска от своего отрезка
+    size_t seg = 0;
+    for (const auto& p : input) {
+        while (seg + 1 < out.size() && out[seg + 1].timestamp < p.timestamp) seg++;
+        if (seg + 1 >= out.size()) break;
+        EXPECT_LE(segmentDistance(p, out[seg], out[seg + 1]), 5.0 + 1e-6) << p.timestamp;
+    }
+    EXPECT_LT(out.size(), input.size() / 5);
+}
+
+TEST_F(SimplifyStageTest, Motorway_ReducesVolumeTenfold) {
+    // 10 Гц, 30 м/с, плавные повороты и шум 0.5 м
+    std::mt19937 rng(11);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    for (int i = 0; i < 36000; i++) {
+        double t = i * 0.1;
+        double x = 30.0 * t;
+        double y = 200.0 * std::sin(t / 120.0);
+        stage->showPoint(createPoint(x + noise(rng), y + noise(rng), i * 100ULL));
+    }
+    stage->flush();
+    EXPECT_GE(stage->getInputCount() / stage->getOutputCount(), 10u);
+}
+
+TEST_F(SimplifyStageTest, InvalidFix_BreaksTrack) {
+    for (int i = 0; i < 10; i++) {
+        stage->showPoint(createPoint(i * 3.0, 0.0, i * 100ULL));
+    }
+    stage->showInvalidFix(1000);
+    stage->showPoint(createPoint(500.0, 0.0, 2000));
+    
+    const auto& calls = display->getCalls();
+    ASSERT_EQ(calls.size(), 4u);
+    EXPECT_EQ(calls[0].type, DisplayCall::Type::POINT);
+    EXPECT_EQ(calls[1].type, DisplayCall::Type::POINT);
+    EXPECT_EQ(calls[1].timestamp, 900u);
+    EXPECT_EQ(calls[2].type, DisplayCall::Type::INVALID_FIX);
+    // После разрыва первая точка выводится сразу
+    EXPECT_EQ(calls[3].timestamp, 2000u);
+}
+
+TEST_F(SimplifyStageTest, Event_FlushesPendingFirst) {
+    stage->showPoint(createPoint(0.0, 0.0, 0));
+    stage->showPoint(createPoint(3.0, 0.0, 100));
+    GpsEvent event;
+    event.subject = "zone";
+    event.timestamp = 200;
+    stage->showEvent(event);
+    
+    const auto& calls = display->getCalls();
+    ASSERT_EQ(calls.size(), 3u);
+    EXPECT_EQ(calls[1].timestamp, 100u);
+    EXPECT_EQ(calls[2].type, DisplayCall::Type::EVENT);
+}
+
+TEST_F(SimplifyStageTest, Messages_PassThrough) {
+    stage->showParseError("bad checksum");
+    stage->showRejected("JumpFilter: point rejected");
+    EXPECT_EQ(display->getErrorCount(), 2);
+}
+
+TEST_F(SimplifyStageTest, JsonConfig_OutputStages_RoundTrip) {
+    JsonConfig config;
+    StageConfig simplify;
+    simplify.type = "SimplifyStage";
+    simplify.params["tolerance"] = 7.5;
+    simplify.params["maxLookahead"] = 50;
+    config.addOutputStage(simplify);
+    
+    const std::string path = "test_simplify_config.json";
+    ASSERT_TRUE(config.saveToFile(path));
+    
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(path));
+    ASSERT_EQ(loaded.getOutputStages().size(), 1u);
+    EXPECT_EQ(loaded.getOutputStages()[0].type, "SimplifyStage");
+    EXPECT_DOUBLE_EQ(loaded.getOutputStages()[0].params.at("tolerance"), 7.5);
+    EXPECT_DOUBLE_EQ(loaded.getOutputStages()[0].params.at("maxLookahead"), 50.0);
+    std::remove(path.c_str());
+}
@@ -218,4 +218,62 @@ TEST_F(SmoothingFilterTest, IsEnabled_ReturnsCorrectState) {
     
     filter->setEnabled(true);
     EXPECT_TRUE(filter->isEnabled());
-}
\ No newline at end of file
+}
+
+TEST_F(SmoothingFilterTest, Process_UsesTimestampDelta) {
+    // 10 Гц: dt = 0.1 с, сглаживание сильнее номинального (1 Гц)
+    auto point1 = createPoint(48.1173, 11.5167);
+    point1.timestamp = 1000;
+    filter->process(point1, *history);
+    
+    auto point2 = createPoint(48.1183, 11.5167);
+    point2.timestamp = 1100;
+    filter->process(point2, *history);
+    
+    double rc = 1.0 / (2.0 * M_PI * 0.1);
+    double alpha = 0.1 / (rc + 0.1);
+    EXPECT_NEAR(point2.latitude, 48.1173 + alpha * 0.001, 1e-12);
+}
+
+TEST_F(SmoothingFilterTest, Process_AfterDropout_FollowsMeasurement) {
+    auto point1 = createPoint(48.1173, 11.5167);
+    point1.timestamp = 1000;
+    filter->process(point1, *history);
+    
+    // Пропуск 60 секунд: alpha близка к 1, точка почти не сглаживается
+    auto point2 = createPoint(48.1273, 11.5267);
+    point2.timestamp = 61000;
+    filter->process(point2, *history);
+    
+    EXPECT_NEAR(point2.latitude, 48.1273, 0.0005);
+    EXPECT_GT(point2.latitude, 48.1173 + 0.9 * 0.01);
+}
+
+TEST_F(SmoothingFilterTest, Process_NonIncreasingTimestamps_UseSampleRate) {
+    auto point1 = createPoint(48.1173, 11.5167);
+    point1.timestamp = 5000;
+    filter->process(point1, *history);
+    
+    auto point2 = createPoint(48.1183, 11.5167);
+    point2.timestamp = 4000;
+    filter->process(point2, *history);
+    
+    double rc = 1.0 / (2.0 * M_PI * 0.1);
+    double alpha = 1.0 / (rc + 1.0);
+    EXPECT_NEAR(point2.latitude, 48.1173 + alpha * 0.001, 1e-12);
+}
+
+TEST_F(SmoothingFilterTest, Process_AcrossMidnight_UsesTimestampDelta) {
+    // 23:59:59 -> 00:00:01: dt = 2 с, а не номинальная 1 с
+    auto point1 = createPoint(48.1173, 11.5167);
+    point1.timestamp = 24ULL * 3600 * 1000 - 1000;
+    filter->process(point1, *history);
+    
+    auto point2 = createPoint(48.1183, 11.5167);
+    point2.timestamp = 1000;
+    filter->process(point2, *history);
+    
+    double rc = 1.0 / (2.0 * M_PI * 0.1);
+    double alpha = 2.0 / (rc + 2.0);
+    EXPECT_NEAR(point2.latitude, 48.1173 + alpha * 0.001, 1e-12);
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "stay_point_filter.h"
+#include "mock_display.h"
+#include "pipeline.h"
+#include "history.h"
+#include <cstdio>
+
+namespace {
+    // Смещение на dy метров к северу от базовой точки
+    const double METERS_PER_DEGREE = 111195.0;
+    
+    // Дописать контрольную сумму NMEA к телу предложения
+    std::string sentence(const std::string& body) {
+        unsigned char sum = 0;
+        for (char c : body) {
+            sum ^= static_cast<unsigned char>(c);
+        }
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "*%02X", sum);
+        return "$" + body + buf;
+    }
+}
+
+class StayPointFilterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        filter = std::make_unique<StayPointFilter>(30.0, 60.0);
+        filter->setDisplay(&display);
+    }
+    
+    GpsPoint createPoint(double northMeters, double speed, unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75 + northMeters / METERS_PER_DEGREE;
+        p.longitude = 37.61;
+        p.speed = speed;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    FilterResult feed(double northMeters, double speed, unsigned long long timestamp) {
+        GpsPoint p = createPoint(northMeters, speed, timestamp);
+        return filter->process(p, history);
+    }
+    
+    std::vector<GpsEvent> events() const {
+        std::vector<GpsEvent> result;
+        for (const auto& call : display.getCalls()) {
+            if (call.type == DisplayCall::Type::EVENT) {
+                result.push_back(call.event);
+            }
+        }
+        return result;
+    }
+    
+    MockDisplay display;
+    GpsHistory history;
+    std::unique_ptr<StayPointFilter> filter;
+};
+
+TEST_F(StayPointFilterTest, MovingPoints_Pass) {
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(feed(i * 15.0, 54.0, i * 1000ULL), FilterResult::PASS);
+    }
+    EXPECT_FALSE(filter->isStaying());
+    EXPECT_TRUE(events().empty());
+}
+
+TEST_F(StayPointFilterTest, SlowPointsBeforeMinDuration_Pass) {
+    for (int i = 0; i < 60; i++) {
+        EXPECT_EQ(feed(0.0, 0.5, i * 1000ULL), FilterResult::PASS);
+    }
+    EXPECT_FALSE(filter->isStaying());
+}
+
+TEST_F(StayPointFilterTest, LongStay_EmitsStartAndSuppresses) {
+    int passed = 0;
+    for (int i = 0; i < 3600; i++) {
+        // Дрейф приемника в пределах нескольких метров
+        if (feed((i % 7) - 3.0, 0.5, 10000 + i * 1000ULL) == FilterResult::PASS) {
+            passed++;
+        }
+    }
+    EXPECT_TRUE(filter->isStaying());
+    EXPECT_EQ(passed, 60);
+    
+    auto ev = events();
+    ASSERT_EQ(ev.size(), 1u);
+    EXPECT_EQ(ev[0].type, GpsEvent::Type::STAY_START);
+    EXPECT_EQ(ev[0].timestamp, 10000u);
+    EXPECT_EQ(ev[0].source, "StayPointFilter");
+    EXPECT_NEAR(ev[0].latitude, 55.75, 5.0 / METERS_PER_DEGREE);
+}
+
+TEST_F(StayPointFilterTest, LeavingRadius_EmitsEndWithDurationAndCentroid) {
+    for (int i = 0; i <= 300; i++) {
+        feed(i % 2 == 0 ? 2.0 : -2.0, 0.0, i * 1000ULL);
+    }
+    ASSERT_TRUE(filter->isStaying());
+    
+    EXPECT_EQ(feed(100.0, 30.0, 301000), FilterResult::PASS);
+    EXPECT_FALSE(filter->isStaying());
+    
+    auto ev = events();
+    ASSERT_EQ(ev.size(), 2u);
+    EXPECT_EQ(ev[1].type, GpsEvent::Type::STAY_END);
+    EXPECT_EQ(ev[1].timestamp, 300000u);
+    EXPECT_EQ(ev[1].durationMs, 300000u);
+    EXPECT_NEAR(ev[1].latitude, 55.75, 0.1 / METERS_PER_DEGREE);
+    EXPECT_NEAR(ev[1].longitude, 37.61, 1e-9);
+}
+
+TEST_F(StayPointFilterTest, FastPoint_ResetsCandidate) {
+    for (int i = 0; i < 50; i++) {
+        feed(0.0, 1.0, i * 1000ULL);
+    }
+    // Одна быстрая точка на месте (например, проезд по стоянке)
+    feed(0.0, 20.0, 50000);
+    for (int i = 51; i < 100; i++) {
+        EXPECT_EQ(feed(0.0, 1.0, i * 1000ULL), FilterResult::PASS);
+    }
+    EXPECT_FALSE(filter->isStaying());
+}
+
+TEST_F(StayPointFilterTest, SlowDriftOutsideRadius_NoStay) {
+    // 1 км/ч на север: за минуту ~17 м, но кластер остается в радиусе не дольше 60 с
+    for (int i = 0; i < 600; i++) {
+        EXPECT_EQ(feed(i * 1.0, 3.6, i * 1000ULL), FilterResult::PASS);
+    }
+    EXPECT_FALSE(filter->isStaying());
+}
+
+TEST_F(StayPointFilterTest, Heartbeat_PassesCentroidPeriodically) {
+    filter->setHeartbeat(300.0);
+    int heartbeats = 0;
+    for (int i = 0; i <= 3660; i++) {
+        GpsPoint p = createPoint(i % 2 == 0 ? 3.0 : -3.0, 0.3, i * 1000ULL);
+        if (filter->process(p, history) == FilterResult::PASS && filter->isStaying()) {
+            heartbeats++;
+            EXPECT_DOUBLE_EQ(p.speed, 0.0);
+            EXPECT_NEAR(p.latitude, 55.75, 0.1 / METERS_PER_DEGREE);
+        }
+    }
+    // Стоянка с 60 с, контрольные точки каждые 300 с до 3660 с
+    EXPECT_EQ(heartbeats, 12);
+}
+
+TEST_F(StayPointFilterTest, Flush_EndsActiveStay) {
+    for (int i = 0; i <= 120; i++) {
+        feed(0.0, 0.0, i * 1000ULL);
+    }
+    ASSERT_TRUE(filter->isStaying());
+    filter->flush();
+    EXPECT_FALSE(filter->isStaying());
+    
+    auto ev = events();
+    ASSERT_EQ(ev.size(), 2u);
+    EXPECT_EQ(ev[1].type, GpsEvent::Type::STAY_END);
+    EXPECT_EQ(ev[1].durationMs, 120000u);
+    
+    filter->flush();
+    EXPECT_EQ(events().size(), 2u);
+}
+
+TEST_F(StayPointFilterTest, MidnightWrap_CountsDuration) {
+    const unsigned long long dayMs = 24ULL * 3600 * 1000;
+    for (int i = 0; i <= 90; i++) {
+        feed(0.0, 0.0, (dayMs - 30000 + i * 1000ULL) % dayMs);
+    }
+    EXPECT_TRUE(filter->isStaying());
+    filter->flush();
+    EXPECT_EQ(events().back().durationMs, 90000u);
+}
+
+TEST_F(StayPointFilterTest, InvalidPoint_Rejected) {
+    GpsPoint p = createPoint(0.0, 0.0, 0);
+    p.isValid = false;
+    EXPECT_EQ(filter->process(p, history), FilterResult::REJECT);
+}
+
+TEST_F(StayPointFilterTest, Disabled_PassesEverything) {
+    filter->setEnabled(false);
+    for (int i = 0; i < 300; i++) {
+        EXPECT_EQ(feed(0.0, 0.0, i * 1000ULL), FilterResult::PASS);
+    }
+    EXPECT_TRUE(events().empty());
+}
+
+TEST(StayPointFilterPipelineTest, SuppressedPoints_NotShownOrStored) {
+    auto display = std::make_unique<MockDisplay>();
+    MockDisplay* mock = display.get();
+    
+    GpsPipeline pipeline(std::move(display));
+    pipeline.addFilter(std::make_unique<StayPointFilter>(30.0, 10.0), 1);
+    
+    // Стоим на месте 60 секунд: RMC и GGA на каждую секунду
+    for (int s = 0; s < 60; s++) {
+        char time[16];
+        std::snprintf(time, sizeof(time), "1200%02d.00", s);
+        pipeline.process(sentence(std::string("GPRMC,") + time + ",A,5545.0000,N,03736.6000,E,0.0,0.0,010124,,,A"));
+        pipeline.process(sentence(std::string("GPGGA,") + time + ",5545.0000,N,03736.6000,E,1,08,0.9,150.0,M,14.0,M,,"));
+    }
+    pipeline.flush();
+    
+    EXPECT_GT(pipeline.getSuppressedCount(), 90);
+    EXPECT_EQ(pipeline.getValidCount() + pipeline.getSuppressedCount(), 120);
+    EXPECT_EQ(mock->getPointCount(), pipeline.getValidCount());
+    EXPECT_EQ(mock->getEventCount(), 2);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "structured_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+class StructuredDisplayTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("gps_structured_display_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "out.txt").string();
+    }
+    
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+    
+    static GpsPoint createPoint() {
+        GpsPoint p;
+        p.latitude = 55.751244;
+        p.longitude = -37.618423;
+        p.speed = 42.5;
+        p.course = 90.0;
+        p.altitude = 150.25;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = 45296789;
+        p.isValid = true;
+        return p;
+    }
+    
+    static GpsEvent createEvent() {
+        GpsEvent e;
+        e.type = GpsEvent::Type::ZONE_EXIT;
+        e.source = "GeofenceFilter";
+        e.subject = "depot, north";
+        e.timestamp = 45300000;
+        e.latitude = 55.5;
+        e.longitude = 37.25;
+        e.durationMs = 65000;
+        return e;
+    }
+    
+    static std::string readFile(const std::string& name) {
+        std::ifstream file(name, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+    
+    fs::path dir;
+    std::string path;
+};
+
+TEST_F(StructuredDisplayTest, Csv_WritesHeaderAndUniformColumns) {
+    {
+        StructuredDisplay display(StructuredDisplay::Format::CSV, path);
+        GpsPoint p = createPoint();
+        p.label = "Tverskaya";
+        display.showPoint(p);
+        display.showInvalidFix(45297000);
+        display.showRejected("speed > 300");
+        display.showParseError("bad \"checksum\"");
+        display.showEvent(createEvent());
+    }
+    
+    EXPECT_EQ(readFile(path),
+              std::string(StructuredDisplay::CSV_COLUMNS) + "\n"
+              "point,45296789,55.751244,-37.618423,42.5,90,150.25,8,0.9,Tverskaya,,,,,\n"
+              "nofix,45297000,,,,,,,,,,,,,\n"
+              "rejected,,,,,,,,,,,,,,speed > 300\n"
+              "error,,,,,,,,,,,,,,\"bad \"\"checksum\"\"\"\n"
+              "event,45300000,55.5,37.25,,,,,,,EXIT,GeofenceFilter,\"depot, north\",65000,\n");
+}
+
+TEST_F(StructuredDisplayTest, Csv_HeaderOnlyOnceWhenAppending) {
+    { StructuredDisplay display(StructuredDisplay::Format::CSV, path); display.showInvalidFix(1000); }
+    { StructuredDisplay display(StructuredDisplay::Format::CSV, path); display.showInvalidFix(2000); }
+    
+    EXPECT_EQ(readFile(path),
+              std::string(StructuredDisplay::CSV_COLUMNS) + "\n"
+              "nofix,1000,,,,,,,,,,,,,\n"
+              "nofix,2000,,,,,,,,,,,,,\n");
+}
+
+TEST_F(StructuredDisplayTest, Ndjson_OneObjectPerLine) {
+    {
+        StructuredDisplay display(StructuredDisplay::Format::NDJSON, path);
+        display.showPoint(createPoint());
+        display.showInvalidFix(45297000);
+        display.showRejected("jump\n\t\x01");
+        display.showEvent(createEvent());
+    }
+    
+    EXPECT_EQ(readFile(path),
+              "{\"type\":\"point\",\"timestamp\":45296789,\"latitude\":55.751244,\"longitude\":-37.618423,"
+              "\"speed\":42.5,\"course\":90,\"altitude\":150.25,\"satellites\":8,\"hdop\":0.9}\n"
+              "{\"type\":\"nofix\",\"timestamp\":45297000}\n"
+              "{\"type\":\"rejected\",\"message\":\"jump\\n\\t\\u0001\"}\n"
+              "{\"type\":\"event\",\"timestamp\":45300000,\"latitude\":55.5,\"longitude\":37.25,"
+              "\"event\":\"EXIT\",\"source\":\"GeofenceFilter\",\"subject\":\"depot, north\",\"durationMs\":65000}\n");
+}
+
+TEST_F(StructuredDisplayTest, Geojson_FeatureSequence) {
+    {
+        StructuredDisplay display(StructuredDisplay::Format::GEOJSON, path);
+        display.showPoint(createPoint());
+        display.showParseError("bad");
+    }
+    
+    EXPECT_EQ(readFile(path),
+              "\x1e{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[-37.618423,55.751244,150.25]},"
+              "\"properties\":{\"type\":\"point\",\"timestamp\":45296789,"
+              "\"speed\":42.5,\"course\":90,\"altitude\":150.25,\"satellites\":8,\"hdop\":0.9}}\n"
+              "\x1e{\"type\":\"Feature\",\"geometry\":null,\"properties\":{\"type\":\"error\",\"message\":\"bad\"}}\n");
+}
+
+TEST_F(StructuredDisplayTest, Numbers_RoundTripExactly) {
+    GpsPoint p = createPoint();
+    p.latitude = 0.1 + 0.2;
+    p.longitude = -179.99999999999997;
+    {
+        StructuredDisplay display(StructuredDisplay::Format::CSV, path);
+        display.showPoint(p);
+    }
+    
+    std::string text = readFile(path);
+    std::string row = text.substr(text.find('\n') + 1);
+    std::vector<std::string> fields;
+    std::stringstream ss(row);
+    std::string field;
+    while (std::getline(ss, field, ',')) fields.push_back(field);
+    ASSERT_GE(fields.size(), 4u);
+    EXPECT_EQ(std::strtod(fields[2].c_str(), nullptr), p.latitude);
+    EXPECT_EQ(std::strtod(fields[3].c_str(), nullptr), p.longitude);
+}
+
+TEST_F(StructuredDisplayTest, NonFiniteValues_WrittenAsNull) {
+    GpsPoint p = createPoint();
+    p.speed = std::nan("");
+    {
+        StructuredDisplay display(StructuredDisplay::Format::NDJSON, path);
+        display.showPoint(p);
+    }
+    EXPECT_NE(readFile(path).find("\"speed\":null,"), std::string::npos);
+}
+
+TEST_F(StructuredDisplayTest, Csv_RotatedAndClearedFilesStartWithHeader) {
+    const std::string header = std::string(StructuredDisplay::CSV_COLUMNS) + "\n";
+    {
+        StructuredDisplay display(StructuredDisplay::Format::CSV, path, true, 300, true, 10);
+        for (int i = 0; i < 20; i++) {
+            display.showInvalidFix(i * 1000ULL);
+        }
+    }
+    
+    size_t files = 0;
+    size_t rows = 0;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string text = readFile(entry.path().string());
+        EXPECT_EQ(text.compare(0, header.size(), header), 0) << entry.path();
+        rows += std::count(text.begin(), text.end(), '\n') - 1;
+        files++;
+    }
+    EXPECT_GT(files, 1u);
+    EXPECT_EQ(rows, 20u);
+    
+    StructuredDisplay display(StructuredDisplay::Format::CSV, path);
+    display.showInvalidFix(5000);
+    display.clear();
+    display.showInvalidFix(7000);
+    EXPECT_EQ(readFile(path), header + "nofix,7000,,,,,,,,,,,,,\n");
+}
+
+TEST_F(StructuredDisplayTest, Pipeline_SelectsFormatByDisplayType) {
+    StructuredDisplay::Format format;
+    EXPECT_TRUE(StructuredDisplay::parseFormat("geojson", format));
+    EXPECT_EQ(format, StructuredDisplay::Format::GEOJSON);
+    EXPECT_FALSE(StructuredDisplay::parseFormat("xml", format));
+    
+    JsonConfig config;
+    config.setDisplayType("ndjson");
+    config.setOutputFile(path);
+    {
+        GpsPipeline pipeline(config);
+        pipeline.process("$GPRMC,bad");
+    }
+    EXPECT_EQ(readFile(path).rfind("{\"type\":\"error\",\"message\":", 0), 0u);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "throttle_stage.h"
+#include "mock_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <cmath>
+#include <cstdio>
+
+class ThrottleStageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto mock = std::make_unique<MockDisplay>();
+        display = mock.get();
+        // Только смещение 10 м; остальные критерии включаются в тестах
+        stage = std::make_unique<ThrottleStage>(std::move(mock), 10.0, 0.0, 0.0, 0.0);
+    }
+    
+    GpsPoint createPoint(double northMeters, unsigned long long timestamp,
+                         double speed = 0.0, double course = 0.0) {
+        GpsPoint p;
+        p.latitude = 55.75 + northMeters / METERS_PER_DEG;
+        p.longitude = 37.61;
+        p.speed = speed;
+        p.course = course;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    static constexpr double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+    
+    MockDisplay* display = nullptr;
+    std::unique_ptr<ThrottleStage> stage;
+};
+
+TEST_F(ThrottleStageTest, FirstPoint_AlwaysForwarded) {
+    stage->showPoint(createPoint(0.0, 0));
+    EXPECT_EQ(display->getPointCount(), 1);
+}
+
+TEST_F(ThrottleStageTest, Distance_ForwardsEveryTenMeters) {
+    for (int i = 0; i <= 100; i++) {
+        stage->showPoint(createPoint(i * 1.0, i * 1000ULL));
+    }
+    // Точки на 0, 11, 22, ... 99 м: смещение должно превысить порог
+    EXPECT_EQ(display->getPointCount(), 10);
+    EXPECT_EQ(stage->getInputCount(), 101u);
+    EXPECT_EQ(stage->getOutputCount(), 10u);
+}
+
+TEST_F(ThrottleStageTest, Stationary_OnlyHeartbeat) {
+    stage->setHeartbeat(60.0);
+    for (int i = 0; i < 3600; i++) {
+        stage->showPoint(createPoint(0.0, i * 1000ULL));
+    }
+    EXPECT_EQ(display->getPointCount(), 60);
+}
+
+TEST_F(ThrottleStageTest, Heartbeat_AcrossMidnight) {
+    stage->setHeartbeat(10.0);
+    const unsigned long long dayMs = 24ULL * 3600 * 1000;
+    stage->showPoint(createPoint(0.0, dayMs - 5000));
+    stage->showPoint(createPoint(0.0, 4000));
+    EXPECT_EQ(display->getPointCount(), 1);
+    stage->showPoint(createPoint(0.0, 5000));
+    EXPECT_EQ(display->getPointCount(), 2);
+}
+
+TEST_F(ThrottleStageTest, SpeedDelta_Forwards) {
+    stage->setSpeed(5.0);
+    stage->showPoint(createPoint(0.0, 0, 50.0));
+    stage->showPoint(createPoint(0.0, 1000, 54.0));
+    EXPECT_EQ(display->getPointCount(), 1);
+    stage->showPoint(createPoint(0.0, 2000, 44.0));
+    EXPECT_EQ(display->getPointCount(), 2);
+}
+
+TEST_F(ThrottleStageTest, CourseDelta_WrapsAroundNorth) {
+    stage->setCourse(15.0);
+    stage->showPoint(createPoint(0.0, 0, 30.0, 355.0));
+    stage->showPoint(createPoint(0.0, 1000, 30.0, 5.0));    // 10 градусов
+    EXPECT_EQ(display->getPointCount(), 1);
+    stage->showPoint(createPoint(0.0, 2000, 30.0, 15.0));   // 20 градусов
+    EXPECT_EQ(display->getPointCount(), 2);
+}
+
+TEST_F(ThrottleStageTest, CourseDelta_IgnoredWhenSlow) {
+    stage->setCourse(15.0);
+    stage->showPoint(createPoint(0.0, 0, 1.0, 0.0));
+    stage->showPoint(createPoint(0.0, 1000, 1.0, 180.0));
+    EXPECT_EQ(display->getPointCount(), 1);
+}
+
+TEST_F(ThrottleStageTest, InvalidFix_ForwardsNextPoint) {
+    stage->showPoint(createPoint(0.0, 0));
+    stage->showInvalidFix(1000);
+    stage->showPoint(createPoint(0.0, 2000));
+    EXPECT_EQ(display->getPointCount(), 2);
+    EXPECT_EQ(display->getInvalidFixCount(), 1);
+}
+
+TEST_F(ThrottleStageTest, Events_PassThrough) {
+    GpsEvent event;
+    event.type = GpsEvent::Type::STAY_START;
+    stage->showEvent(event);
+    stage->showRejected("reason");
+    EXPECT_EQ(display->getEventCount(), 1);
+    EXPECT_EQ(display->getCalls().size(), 2u);
+}
+
+TEST_F(ThrottleStageTest, JsonConfig_CreatesStage) {
+    JsonConfig config;
+    StageConfig throttle;
+    throttle.type = "ThrottleStage";
+    throttle.params["distance"] = 25.0;
+    throttle.params["heartbeat"] = 30.0;
+    config.addOutputStage(throttle);
+    config.setDisplayType("console");
+    
+    const std::string path = "test_throttle_config.json";
+    ASSERT_TRUE(config.saveToFile(path));
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(path));
+    std::remove(path.c_str());
+    
+    GpsPipeline pipeline(loaded);
+    auto* created = dynamic_cast<ThrottleStage*>(pipeline.getDisplay());
+    ASSERT_NE(created, nullptr);
+    EXPECT_DOUBLE_EQ(created->getDistance(), 25.0);
+    EXPECT_DOUBLE_EQ(created->getHeartbeat(), 30.0);
+    EXPECT_DOUBLE_EQ(created->getCourse(), 15.0);
+}
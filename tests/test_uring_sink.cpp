@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "uring_sink.h"
+#include "file_display.h"
+#include "json_config.h"
+#include "pipeline.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+class UringSinkTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!UringSink::isSupported()) {
+            GTEST_SKIP() << "io_uring is not available";
+        }
+        dir = fs::temp_directory_path() / ("gps_uring_sink_" + std::to_string(::getpid()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        path = (dir / "out.log").string();
+    }
+    
+    void TearDown() override {
+        if (!dir.empty()) {
+            fs::remove_all(dir);
+        }
+    }
+    
+    static std::string readFile(const std::string& name) {
+        std::ifstream file(name, std::ios::binary);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+    
+    static std::string record(size_t i) {
+        return "record " + std::to_string(i) + " " + std::string(i % 50, 'x') + "\n";
+    }
+    
+    static GpsPoint createPoint(unsigned long long timestamp) {
+        GpsPoint p;
+        p.latitude = 55.75;
+        p.longitude = 37.61;
+        p.speed = 42.0;
+        p.satellites = 8;
+        p.hdop = 0.9f;
+        p.timestamp = timestamp;
+        p.isValid = true;
+        return p;
+    }
+    
+    fs::path dir;
+    std::string path;
+};
+
+TEST_F(UringSinkTest, WritesRecordsInOrder) {
+    // Маленькие буферы и глубина 2: записи в полете, ожидания свободного буфера
+    auto sink = UringSink::create(path, false, 0, 2, 4096);
+    ASSERT_NE(sink, nullptr);
+    ASSERT_TRUE(sink->isOpen());
+    
+    std::string expected;
+    for (size_t i = 0; i < 20000; i++) {
+        std::string line = record(i);
+        expected += line;
+        sink->append(line);
+    }
+    sink->flush();
+    
+    EXPECT_EQ(readFile(path), expected);
+    EXPECT_EQ(sink->getBytesWritten(), expected.size());
+    // Записи собираются в буферы, а не идут по одной
+    EXPECT_LT(sink->getWriteCount(), 20000u);
+}
+
+TEST_F(UringSinkTest, LargeRecordSpansBuffers) {
+    auto sink = UringSink::create(path, false, 0, 2, 4096);
+    ASSERT_NE(sink, nullptr);
+    
+    std::string big(50000, 'a');
+    for (size_t i = 0; i < big.size(); i++) {
+        big[i] = static_cast<char>('a' + i % 26);
+    }
+    sink->append("head\n");
+    sink->append(big);
+    sink->append("tail\n");
+    sink->flush();
+    
+    EXPECT_EQ(readFile(path), "head\n" + big + "tail\n");
+}
+
+TEST_F(UringSinkTest, AppendsToExistingFile) {
+    {
+        std::ofstream file(path);
+        file << "existing\n";
+    }
+    {
+        auto sink = UringSink::create(path);
+        ASSERT_NE(sink, nullptr);
+        sink->append("appended\n");
+    }
+    EXPECT_EQ(readFile(path), "existing\nappended\n");
+}
+
+TEST_F(UringSinkTest, RotationWritesHeaderAndReportsSegment) {
+    auto sink = UringSink::create(path, true, 100, 4, 4096);
+    ASSERT_NE(sink, nullptr);
+    std::vector<std::string> segments;
+    sink->setRotationCallback([&](const std::string& segment) {
+        segments.push_back(segment);
+    });
+    sink->setHeader("header\n");
+    
+    for (size_t i = 0; i < 30; i++) {
+        sink->append(record(i));
+    }
+    sink->flush();
+    
+    ASSERT_FALSE(segments.empty());
+    std::string all;
+    for (const auto& segment : segments) {
+        std::string text = readFile(segment);
+        EXPECT_EQ(text.rfind("header\n", 0), 0u) << segment;
+        all += text.substr(7);
+    }
+    std::string current = readFile(path);
+    EXPECT_EQ(current.rfind("header\n", 0), 0u);
+    all += current.substr(7);
+    
+    std::string expected;
+    for (size_t i = 0; i < 30; i++) {
+        expected += record(i);
+    }
+    EXPECT_EQ(all, expected);
+}
+
+TEST_F(UringSinkTest, TruncateRewritesHeader) {
+    auto sink = UringSink::create(path);
+    ASSERT_NE(sink, nullptr);
+    sink->setHeader("header\n");
+    sink->append("one\n");
+    sink->truncate();
+    sink->append("two\n");
+    sink->flush();
+    EXPECT_EQ(readFile(path), "header\ntwo\n");
+}
+
+TEST_F(UringSinkTest, FileDisplayMatchesBlockingOutput) {
+    const std::string plainPath = (dir / "plain.log").string();
+    {
+        FileDisplay plain(plainPath);
+        FileDisplay uring(path);
+        ASSERT_TRUE(uring.enableUring(4));
+        ASSERT_NE(uring.getUringSink(), nullptr);
+        for (FileDisplay* display : {&plain, &uring}) {
+            for (unsigned long long t = 0; t < 1000; t++) {
+                display->showPoint(createPoint(36000000ULL + t * 1000));
+            }
+            display->showInvalidFix(36000000ULL);
+            display->showParseError("bad sentence");
+            display->showRejected("speed");
+            display->flush();
+        }
+    }
+    EXPECT_EQ(readFile(path), readFile(plainPath));
+}
+
+TEST_F(UringSinkTest, JsonConfig_IoBackendRoundTrip) {
+    JsonConfig config;
+    EXPECT_EQ(config.getIoBackend(), "write");
+    config.setIoBackend("uring");
+    
+    const std::string configPath = (dir / "config.json").string();
+    ASSERT_TRUE(config.saveToFile(configPath));
+    JsonConfig loaded;
+    ASSERT_TRUE(loaded.loadFromFile(configPath));
+    EXPECT_EQ(loaded.getIoBackend(), "uring");
+    
+    loaded.setDisplayType("file");
+    loaded.setOutputFile(path);
+    GpsPipeline pipeline(loaded);
+    auto* display = dynamic_cast<FileDisplay*>(pipeline.getDisplay());
+    ASSERT_NE(display, nullptr);
+    EXPECT_NE(display->getUringSink(), nullptr);
+}